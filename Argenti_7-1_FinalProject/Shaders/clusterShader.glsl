@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusterShader.glsl
+// ============
+// assign the light sources to the view space clusters on the GPU
+///////////////////////////////////////////////////////////////////////////////
+#version 440 core
+
+// must match LightClusters::WORKGROUP_SIZE
+#define WORKGROUP_SIZE 64
+
+layout (local_size_x = WORKGROUP_SIZE) in;
+
+// must match ShaderUniforms::LIGHT_SOURCE
+struct LightSource
+{
+	vec3 position;
+	float focalStrength;
+	vec3 ambientColor;
+	float specularIntensity;
+	vec3 diffuseColor;
+	float radius;
+	vec3 specularColor;
+};
+
+// all the light sources of the scene
+layout (std430) readonly buffer LightBlock
+{
+	LightSource lightSources[];
+};
+
+// the header is written by LightClusters::Assign() - must match
+// LightClusters::CLUSTER_HEADER - and it is followed by the count
+// and the light indices of every cluster
+layout (std430) buffer ClusterBlock
+{
+	uvec4 clusterCounts;
+	vec4 screenToTile;
+	vec4 depthToSlice;
+	uint clusterLights[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform mat4 inverseProjection;
+uniform uint lightCount;
+
+// view space position and radius of a batch of lights, with a
+// negative radius for a light that adds no color
+shared vec4 batchLights[WORKGROUP_SIZE];
+
+// the light adds color when any of its terms is not black
+bool IsLightLit(LightSource lightSource)
+{
+	return(any(greaterThan(lightSource.ambientColor + lightSource.diffuseColor, vec3(0.0))) ||
+		((lightSource.specularIntensity > 0.0) && any(greaterThan(lightSource.specularColor, vec3(0.0)))));
+}
+
+// the view space corner of a cluster at the passed in view depth
+vec3 UnprojectCorner(vec2 ndc, float viewDepth)
+{
+	vec4 clip = projection * vec4(0.0, 0.0, -viewDepth, 1.0);
+	vec4 corner = inverseProjection * vec4(ndc, clip.z / clip.w, 1.0);
+
+	return(corner.xyz / corner.w);
+}
+
+void main()
+{
+	uint clusterIndex = gl_GlobalInvocationID.x;
+	uint clusterTotal = clusterCounts.x * clusterCounts.y * clusterCounts.z;
+	bool bCluster = (clusterIndex < clusterTotal);
+
+	// view space bounds of the cluster from its eight corners
+	uvec3 cell = uvec3(
+		clusterIndex % clusterCounts.x,
+		(clusterIndex / clusterCounts.x) % clusterCounts.y,
+		clusterIndex / (clusterCounts.x * clusterCounts.y));
+	vec2 ndcMin = vec2(cell.xy) / vec2(clusterCounts.xy) * 2.0 - 1.0;
+	vec2 ndcMax = vec2(cell.xy + 1u) / vec2(clusterCounts.xy) * 2.0 - 1.0;
+	float depthRange = depthToSlice.w / depthToSlice.z;
+	float nearDepth = depthToSlice.z * pow(depthRange, float(cell.z) / float(clusterCounts.z));
+	float farDepth = depthToSlice.z * pow(depthRange, float(cell.z + 1u) / float(clusterCounts.z));
+
+	vec3 boundsMin = vec3(1.0e30);
+	vec3 boundsMax = vec3(-1.0e30);
+	for (int i = 0; i < 8; i++)
+	{
+		vec2 ndc = vec2(((i & 1) != 0) ? ndcMax.x : ndcMin.x, ((i & 2) != 0) ? ndcMax.y : ndcMin.y);
+		vec3 corner = UnprojectCorner(ndc, ((i & 4) != 0) ? farDepth : nearDepth);
+		boundsMin = min(boundsMin, corner);
+		boundsMax = max(boundsMax, corner);
+	}
+
+	uint listStart = clusterIndex * clusterCounts.w;
+	uint listCount = 0u;
+
+	// every thread loads one light of the batch, and then every
+	// thread tests its cluster against the whole batch - all the
+	// threads of the group reach the barriers, also the ones past
+	// the last cluster
+	for (uint batchStart = 0u; batchStart < lightCount; batchStart += WORKGROUP_SIZE)
+	{
+		uint lightIndex = batchStart + gl_LocalInvocationID.x;
+		vec4 batchLight = vec4(0.0, 0.0, 0.0, -1.0);
+		if ((lightIndex < lightCount) && (IsLightLit(lightSources[lightIndex]) == true))
+		{
+			vec4 viewPosition = view * vec4(lightSources[lightIndex].position, 1.0);
+			batchLight = vec4(viewPosition.xyz, max(lightSources[lightIndex].radius, 0.0));
+		}
+		batchLights[gl_LocalInvocationID.x] = batchLight;
+		barrier();
+
+		uint batchCount = min(uint(WORKGROUP_SIZE), lightCount - batchStart);
+		for (uint i = 0u; (bCluster == true) && (i < batchCount); i++)
+		{
+			vec4 light = batchLights[i];
+			if (light.w < 0.0)
+			{
+				continue;
+			}
+			// a light with a radius of 0 reaches every cluster
+			if (light.w > 0.0)
+			{
+				vec3 offset = clamp(light.xyz, boundsMin, boundsMax) - light.xyz;
+				if (dot(offset, offset) > light.w * light.w)
+				{
+					continue;
+				}
+			}
+			if (listCount + 1u < clusterCounts.w)
+			{
+				clusterLights[listStart + 1u + listCount] = batchStart + i;
+				listCount++;
+			}
+		}
+		barrier();
+	}
+
+	if (bCluster == true)
+	{
+		clusterLights[listStart] = listCount;
+	}
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// cullShader.glsl
+// ============
+// cull the indirect draw commands against the view frustum on the GPU
+///////////////////////////////////////////////////////////////////////////////
+#version 440 core
+
+// must match GpuCuller::WORKGROUP_SIZE
+layout (local_size_x = 64) in;
+
+// must match InstancedMeshes::INSTANCE_DATA
+struct DrawData
+{
+	mat4 model;
+	vec4 color;
+	int materialIndex;
+};
+
+// must match InstancedMeshes::DRAW_COMMAND
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+// must match GpuCuller::CULL_OBJECT
+struct CullObject
+{
+	vec4 sphere;
+	uint batch;
+};
+
+// all the draws of the frame, in the sorted packet order
+layout (std430) readonly buffer CullDrawDataBlock
+{
+	DrawData drawData[];
+};
+
+layout (std430) readonly buffer CullCommandBlock
+{
+	DrawCommand commands[];
+};
+
+layout (std430) readonly buffer CullObjectBlock
+{
+	CullObject objects[];
+};
+
+// first command of every batch
+layout (std430) readonly buffer BatchFirstBlock
+{
+	uint batchFirstCommands[];
+};
+
+// the visible draws, packed at the start of the range of their batch
+layout (std430) writeonly buffer DrawDataBlock
+{
+	DrawData visibleDrawData[];
+};
+
+layout (std430) writeonly buffer VisibleCommandBlock
+{
+	DrawCommand visibleCommands[];
+};
+
+// number of visible draws in every batch, cleared before the pass
+layout (std430) buffer BatchCountBlock
+{
+	uint batchCounts[];
+};
+
+// the inside of a plane is where dot(plane.xyz, point) + plane.w >= 0
+uniform vec4 frustumPlanes[6];
+uniform uint objectCount;
+
+void main()
+{
+	uint objectIndex = gl_GlobalInvocationID.x;
+
+	if (objectIndex >= objectCount)
+	{
+		return;
+	}
+
+	// the object is outside when its sphere is completely behind
+	// any one of the planes
+	vec4 sphere = objects[objectIndex].sphere;
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(frustumPlanes[i].xyz, sphere.xyz) + frustumPlanes[i].w < -sphere.w)
+		{
+			return;
+		}
+	}
+
+	uint batch = objects[objectIndex].batch;
+	uint slot = batchFirstCommands[batch] + atomicAdd(batchCounts[batch], 1u);
+
+	visibleCommands[slot] = commands[objectIndex];
+	visibleDrawData[slot] = drawData[objectIndex];
+}
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+// fragmentShader.glsl
+// ============
+// shade the scene meshes with textures, colors and clustered Phong lighting
+///////////////////////////////////////////////////////////////////////////////
+#version 440 core
+
+#define TOTAL_MATERIALS 32
+#define TOTAL_TEXTURES 256
+#define TOTAL_TEXTURE_ARRAYS 16
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+in vec4 fragmentObjectColor;
+flat in int fragmentMaterialIndex;
+
+out vec4 outFragmentColor;
+
+// must match ShaderUniforms::MATERIAL_ENTRY
+struct Material
+{
+	vec3 ambientColor;
+	float ambientStrength;
+	vec3 diffuseColor;
+	float shininess;
+	vec3 specularColor;
+};
+
+// must match ShaderUniforms::LIGHT_SOURCE
+struct LightSource
+{
+	vec3 position;
+	float focalStrength;
+	vec3 ambientColor;
+	float specularIntensity;
+	vec3 diffuseColor;
+	float radius;
+	vec3 specularColor;
+};
+
+// per-frame camera data - must match ShaderUniforms::CAMERA_BLOCK
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+// all the light sources of the scene
+layout (std430) readonly buffer LightBlock
+{
+	LightSource lightSources[];
+};
+
+// the lights that reach every view space cluster, written by the
+// cluster shader - must match LightClusters::CLUSTER_HEADER
+layout (std430) readonly buffer ClusterBlock
+{
+	uvec4 clusterCounts;
+	vec4 screenToTile;
+	vec4 depthToSlice;
+	uint clusterLights[];
+};
+
+// table of all the defined materials, selected by the material index
+layout (std140) uniform MaterialBlock
+{
+	Material materials[TOTAL_MATERIALS];
+};
+
+// array, layer and finest resident mipmap level of every texture,
+// selected by textureIndex - must match ShaderUniforms::TEXTURE_LOCATION
+layout (std140) uniform TextureBlock
+{
+	ivec4 textureLocations[TOTAL_TEXTURES];
+};
+
+uniform bool bUseTexture = false;
+uniform bool bUseLighting = false;
+uniform sampler2DArray objectTextureArrays[TOTAL_TEXTURE_ARRAYS];
+uniform int textureIndex = 0;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+// true while the depth pre-pass only writes the depth buffer
+uniform bool bDepthOnly = false;
+
+vec3 CalculateLightSource(LightSource lightSource, Material material, vec3 lightNormal, vec3 viewDirection);
+vec4 SampleObjectTexture();
+uint FindCluster();
+
+void main()
+{
+	// the color writes are masked off during the depth pre-pass,
+	// so the lighting is skipped
+	if (bDepthOnly == true)
+	{
+		outFragmentColor = vec4(0.0);
+		return;
+	}
+
+	if (bUseLighting == true)
+	{
+		// properties
+		vec3 lightNormal = normalize(fragmentVertexNormal);
+		vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+		vec3 phongResult = vec3(0.0f);
+		Material material = materials[fragmentMaterialIndex];
+
+		// only the lights that reach the cluster of the fragment
+		uint listStart = FindCluster() * clusterCounts.w;
+		uint listCount = clusterLights[listStart];
+		for (uint i = 0u; i < listCount; i++)
+		{
+			phongResult += CalculateLightSource(lightSources[clusterLights[listStart + 1u + i]], material, lightNormal, viewDirection);
+		}
+
+		if (bUseTexture == true)
+		{
+			vec4 textureColor = SampleObjectTexture();
+			outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
+		}
+		else
+		{
+			outFragmentColor = vec4(phongResult * fragmentObjectColor.xyz, fragmentObjectColor.w);
+		}
+	}
+	else
+	{
+		if (bUseTexture == true)
+		{
+			outFragmentColor = SampleObjectTexture();
+		}
+		else
+		{
+			outFragmentColor = fragmentObjectColor;
+		}
+	}
+}
+
+// sample the layer of the texture array that holds the object texture -
+// the index is the same for the whole draw, so the sampler array can be
+// indexed with it, and the levels finer than the ones that have been
+// streamed in are never read
+vec4 SampleObjectTexture()
+{
+	ivec4 textureLocation = textureLocations[textureIndex];
+	vec2 textureCoordinate = fragmentTextureCoordinate * UVscale;
+	vec3 arrayCoordinate = vec3(textureCoordinate, float(textureLocation.y));
+	float lod = max(textureQueryLod(objectTextureArrays[textureLocation.x], textureCoordinate).y, float(textureLocation.z));
+
+	return(textureLod(objectTextureArrays[textureLocation.x], arrayCoordinate, lod));
+}
+
+// find the cluster of the fragment from its screen tile and the slice
+// of its view depth
+uint FindCluster()
+{
+	vec2 tile = (gl_FragCoord.xy - screenToTile.xy) * screenToTile.zw;
+	uvec2 clusterTile = uvec2(clamp(tile, vec2(0.0), vec2(clusterCounts.xy - 1u)));
+	float viewDepth = -(view * vec4(fragmentPosition, 1.0)).z;
+	float slice = log(max(viewDepth, depthToSlice.z)) * depthToSlice.x - depthToSlice.y;
+	uint clusterSlice = uint(clamp(slice, 0.0, float(clusterCounts.z - 1u)));
+
+	return(clusterTile.x + clusterCounts.x * (clusterTile.y + clusterCounts.y * clusterSlice));
+}
+
+// calculate the ambient, diffuse and specular contribution of one light
+// source - a light with a radius fades out smoothly towards the radius
+vec3 CalculateLightSource(LightSource lightSource, Material material, vec3 lightNormal, vec3 viewDirection)
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+
+	// ambient lighting
+	ambient = lightSource.ambientColor * material.ambientColor * material.ambientStrength;
+
+	// diffuse lighting
+	vec3 lightDirection = normalize(lightSource.position - fragmentPosition);
+	float impact = max(dot(lightNormal, lightDirection), 0.0);
+	diffuse = impact * lightSource.diffuseColor * material.diffuseColor;
+
+	// specular lighting
+	vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+	float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0), lightSource.focalStrength);
+	specular = lightSource.specularIntensity * specularComponent * material.specularColor * lightSource.specularColor;
+
+	float falloff = 1.0;
+	if (lightSource.radius > 0.0)
+	{
+		float distanceRatio = length(lightSource.position - fragmentPosition) / lightSource.radius;
+		falloff = clamp(1.0 - distanceRatio * distanceRatio * distanceRatio * distanceRatio, 0.0, 1.0);
+		falloff *= falloff;
+	}
+
+	return((ambient + diffuse + specular) * falloff);
+}
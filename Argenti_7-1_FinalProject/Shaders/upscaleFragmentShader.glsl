@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// upscaleFragmentShader.glsl
+// ============
+// stretch the scene of the render target over the window and sharpen it
+///////////////////////////////////////////////////////////////////////////////
+#version 440 core
+
+in vec2 sourceCoordinate;
+
+out vec4 outFragmentColor;
+
+uniform sampler2D sourceTexture;
+// size of one texel of the render target
+uniform vec2 sourceTexelSize = vec2(1.0f, 1.0f);
+// part of the render target that the scene was drawn into
+uniform vec2 sourceScale = vec2(1.0f, 1.0f);
+// 0 for a soft and 1 for the strongest sharpening
+uniform float sharpness = 0.5f;
+
+vec3 SampleSource(vec2 coordinate);
+
+void main()
+{
+	// the filtered center and its four neighbours one texel away
+	vec3 center = SampleSource(sourceCoordinate);
+	vec3 north = SampleSource(sourceCoordinate + vec2(0.0, sourceTexelSize.y));
+	vec3 south = SampleSource(sourceCoordinate - vec2(0.0, sourceTexelSize.y));
+	vec3 east = SampleSource(sourceCoordinate + vec2(sourceTexelSize.x, 0.0));
+	vec3 west = SampleSource(sourceCoordinate - vec2(sourceTexelSize.x, 0.0));
+
+	// the sharpening is weakened where the local contrast is already
+	// high, so the edges do not ring
+	vec3 minimum = min(center, min(min(north, south), min(east, west)));
+	vec3 maximum = max(center, max(max(north, south), max(east, west)));
+	vec3 amount = sqrt(clamp(min(minimum, 1.0 - maximum) / max(maximum, vec3(0.0001)), 0.0, 1.0));
+	vec3 weight = amount * (-1.0 / mix(8.0, 5.0, clamp(sharpness, 0.0, 1.0)));
+
+	vec3 color = (center + (north + south + east + west) * weight) / (1.0 + 4.0 * weight);
+	outFragmentColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
+
+// sample the render target, without reaching past the part that the
+// scene was drawn into
+vec3 SampleSource(vec2 coordinate)
+{
+	vec2 halfTexel = sourceTexelSize * 0.5;
+
+	return(texture(sourceTexture, clamp(coordinate, halfTexel, sourceScale - halfTexel)).rgb);
+}
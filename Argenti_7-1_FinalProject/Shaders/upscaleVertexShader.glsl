@@ -0,0 +1,21 @@
+///////////////////////////////////////////////////////////////////////////////
+// upscaleVertexShader.glsl
+// ============
+// cover the window with one triangle for the upscale pass
+///////////////////////////////////////////////////////////////////////////////
+#version 440 core
+
+out vec2 sourceCoordinate;
+
+// part of the render target that the scene was drawn into
+uniform vec2 sourceScale = vec2(1.0f, 1.0f);
+
+void main()
+{
+	// the vertices 0, 1 and 2 are at (0, 0), (2, 0) and (0, 2),
+	// so the triangle covers the whole window without a vertex buffer
+	vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+
+	sourceCoordinate = position * sourceScale;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexShader.glsl
+// ============
+// transform the scene meshes into clip space for the fragment shader
+///////////////////////////////////////////////////////////////////////////////
+#version 440 core
+
+// gl_DrawID of the indirect draws
+#extension GL_ARB_shader_draw_parameters : enable
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// per-instance data - must match InstancedMeshes::INSTANCE_DATA
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+layout (location = 8) in int inInstanceMaterialIndex;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+out vec4 fragmentObjectColor;
+flat out int fragmentMaterialIndex;
+
+// per-frame camera data - must match ShaderUniforms::CAMERA_BLOCK
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+// per-draw data of the indirect draws - must match
+// InstancedMeshes::INSTANCE_DATA
+struct DrawData
+{
+	mat4 model;
+	vec4 color;
+	int materialIndex;
+};
+
+layout (std430) readonly buffer DrawDataBlock
+{
+	DrawData drawData[];
+};
+
+uniform mat4 model;
+uniform vec4 objectColor = vec4(1.0f);
+uniform int materialIndex = 0;
+uniform bool bUseInstancing = false;
+uniform bool bUseDrawData = false;
+uniform int drawDataOffset = 0;
+
+// the depth pre-pass and the lit pass must compute the same depths
+invariant gl_Position;
+
+// index of the draw inside of the current indirect draw call
+int GetDrawID()
+{
+#ifdef GL_ARB_shader_draw_parameters
+	return(gl_DrawIDARB);
+#else
+	return(0);
+#endif
+}
+
+void main()
+{
+	mat4 objectModel = model;
+
+	// indirect draws read the per-object values from the draw
+	// data of their command, and instanced draws read them from
+	// the instance attributes instead of the uniforms
+	if (bUseDrawData == true)
+	{
+		DrawData data = drawData[drawDataOffset + GetDrawID()];
+		objectModel = data.model;
+		fragmentObjectColor = data.color;
+		fragmentMaterialIndex = data.materialIndex;
+	}
+	else if (bUseInstancing == true)
+	{
+		objectModel = inInstanceModel;
+		fragmentObjectColor = inInstanceColor;
+		fragmentMaterialIndex = inInstanceMaterialIndex;
+	}
+	else
+	{
+		fragmentObjectColor = objectColor;
+		fragmentMaterialIndex = materialIndex;
+	}
+
+	// transform the vertex position into clip space
+	gl_Position = projection * view * objectModel * vec4(inVertexPosition, 1.0f);
+
+	// pass the world space position, normal and texture coordinate
+	// to the fragment shader for the lighting calculations
+	fragmentPosition = vec3(objectModel * vec4(inVertexPosition, 1.0f));
+	fragmentVertexNormal = mat3(transpose(inverse(objectModel))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate;
+}
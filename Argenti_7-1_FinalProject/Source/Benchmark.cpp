@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.cpp
+// ============
+// render the scene offscreen and measure the frame time distribution
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// longest wait on one frame fence, in nanoseconds
+	const GLuint64 g_FenceTimeout = 1000000000;
+
+	/***********************************************************
+	 *  GetPercentile()
+	 *
+	 *  This function is used for getting a percentile of the
+	 *  sorted frame times with the nearest rank method.
+	 ***********************************************************/
+	double GetPercentile(const std::vector<double>& sortedTimes, double percentile)
+	{
+		if (sortedTimes.empty() == true)
+		{
+			return(0.0);
+		}
+
+		int rank = (int)ceil(percentile / 100.0 * (double)sortedTimes.size());
+		if (rank < 1)
+		{
+			rank = 1;
+		}
+
+		return(sortedTimes[rank - 1]);
+	}
+}
+
+/***********************************************************
+ *  Benchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Benchmark::Benchmark()
+{
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_frameFences[i] = NULL;
+	}
+	m_frameIndex = 0;
+	m_bMeasuring = false;
+	m_objectCount = 0;
+}
+
+/***********************************************************
+ *  ~Benchmark()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+Benchmark::~Benchmark()
+{
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		if (NULL != m_frameFences[i])
+		{
+			glDeleteSync(m_frameFences[i]);
+			m_frameFences[i] = NULL;
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (0 != m_colorBuffer)
+	{
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		m_colorBuffer = 0;
+	}
+	if (0 != m_depthBuffer)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateFramebuffer()
+ *
+ *  This method is used for creating the offscreen framebuffer
+ *  with a color and a depth attachment of the passed in size.
+ ***********************************************************/
+bool Benchmark::CreateFramebuffer(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "The benchmark framebuffer is not complete, status:" << status << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  StartMeasuring()
+ *
+ *  This method is used for starting to record the frame times
+ *  once the warm up frames are done.
+ ***********************************************************/
+void Benchmark::StartMeasuring()
+{
+	m_bMeasuring = true;
+	m_frameTimes.clear();
+	m_objectCount = 0;
+	m_measureStart = std::chrono::steady_clock::now();
+	m_lastFrameEnd = m_measureStart;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for directing the next frame into the
+ *  offscreen framebuffer.
+ ***********************************************************/
+void Benchmark::BeginFrame()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_width, m_height);
+}
+
+/***********************************************************
+ *  WaitForFence()
+ *
+ *  This method is used for blocking until the GPU has passed
+ *  the passed in fence, and for freeing the fence.
+ ***********************************************************/
+void Benchmark::WaitForFence(GLsync& fence)
+{
+	if (NULL == fence)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+	}
+
+	glDeleteSync(fence);
+	fence = NULL;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing a frame.  The frame from
+ *  FRAMES_IN_FLIGHT frames ago is waited on, and the time since
+ *  the end of the last frame is recorded.
+ ***********************************************************/
+void Benchmark::EndFrame(int objectCount)
+{
+	GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	WaitForFence(m_frameFences[m_frameIndex]);
+	m_frameFences[m_frameIndex] = fence;
+	m_frameIndex = (m_frameIndex + 1) % FRAMES_IN_FLIGHT;
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (m_bMeasuring == true)
+	{
+		std::chrono::duration<double, std::milli> frameTime = now - m_lastFrameEnd;
+		m_frameTimes.push_back(frameTime.count());
+		m_objectCount += objectCount;
+	}
+	m_lastFrameEnd = now;
+}
+
+/***********************************************************
+ *  PrintResults()
+ *
+ *  This method is used for printing the frame time
+ *  percentiles and the throughput of the measured frames.
+ *  The last line has a fixed key=value format, so that runs
+ *  can be compared by scripts.
+ ***********************************************************/
+void Benchmark::PrintResults(int sceneCopies) const
+{
+	if (m_frameTimes.empty() == true)
+	{
+		std::cout << "No benchmark frames were measured" << std::endl;
+		return;
+	}
+
+	std::vector<double> sortedTimes = m_frameTimes;
+	std::sort(sortedTimes.begin(), sortedTimes.end());
+
+	int frameCount = (int)sortedTimes.size();
+	std::chrono::duration<double> totalTime = m_lastFrameEnd - m_measureStart;
+	double seconds = (totalTime.count() > 0.0) ? totalTime.count() : 1.0;
+	double framesPerSecond = frameCount / seconds;
+	double objectsPerSecond = m_objectCount / seconds;
+	double p50 = GetPercentile(sortedTimes, 50.0);
+	double p95 = GetPercentile(sortedTimes, 95.0);
+	double p99 = GetPercentile(sortedTimes, 99.0);
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "INFO: Benchmark of " << sceneCopies << " scene copies, "
+		<< m_objectCount / frameCount << " objects per frame, "
+		<< frameCount << " frames" << std::endl;
+	std::cout << "INFO: Frame time p50:" << p50 << " ms, p95:" << p95 << " ms, p99:" << p99
+		<< " ms, min:" << sortedTimes.front() << " ms, max:" << sortedTimes.back() << " ms" << std::endl;
+	std::cout << "INFO: Throughput " << framesPerSecond << " frames/s, "
+		<< std::setprecision(0) << objectsPerSecond << " objects/s" << std::endl;
+
+	std::cout << std::setprecision(3)
+		<< "BENCHMARK copies=" << sceneCopies
+		<< " objects=" << m_objectCount / frameCount
+		<< " frames=" << frameCount
+		<< " p50_ms=" << p50
+		<< " p95_ms=" << p95
+		<< " p99_ms=" << p99
+		<< " fps=" << framesPerSecond
+		<< " objects_per_second=" << std::setprecision(0) << objectsPerSecond << std::endl;
+}
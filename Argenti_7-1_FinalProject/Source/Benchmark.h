@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.h
+// ============
+// render the scene offscreen and measure the frame time distribution
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <vector>
+
+/***********************************************************
+ *  Benchmark
+ *
+ *  This class renders the frames into an offscreen
+ *  framebuffer and records the time of every frame.  A fence
+ *  per frame keeps at most two frames in flight, so the
+ *  recorded times follow the GPU instead of only measuring
+ *  how fast the commands are queued.
+ ***********************************************************/
+class Benchmark
+{
+public:
+	// constructor
+	Benchmark();
+	// destructor
+	~Benchmark();
+
+	// frames that can be queued before the CPU waits on the GPU
+	static const int FRAMES_IN_FLIGHT = 2;
+
+private:
+	// the offscreen framebuffer and its attachments
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+	// fences of the frames in flight
+	GLsync m_frameFences[FRAMES_IN_FLIGHT];
+	int m_frameIndex;
+
+	// true once the warm up frames are done
+	bool m_bMeasuring;
+	std::chrono::steady_clock::time_point m_lastFrameEnd;
+	std::chrono::steady_clock::time_point m_measureStart;
+	// measured frame times in milliseconds
+	std::vector<double> m_frameTimes;
+	// objects submitted in all the measured frames
+	long long m_objectCount;
+
+	// wait until the GPU has passed a fence and free it
+	void WaitForFence(GLsync& fence);
+
+public:
+	// create the offscreen framebuffer
+	bool CreateFramebuffer(int width, int height);
+
+	// start recording the frame times
+	void StartMeasuring();
+	bool IsMeasuring() const { return m_bMeasuring; }
+
+	// bind the offscreen framebuffer for the next frame
+	void BeginFrame();
+	// finish a frame and record its time
+	void EndFrame(int objectCount);
+
+	// number of recorded frames
+	int GetMeasuredFrames() const { return (int)m_frameTimes.size(); }
+
+	// print the frame time percentiles and the throughput
+	void PrintResults(int sceneCopies) const;
+};
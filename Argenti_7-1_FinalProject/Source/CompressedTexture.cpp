@@ -0,0 +1,568 @@
+///////////////////////////////////////////////////////////////////////////////
+// compressedtexture.cpp
+// ============
+// bake texture images into compressed KTX files and map them for uploading
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CompressedTexture.h"
+
+#include "stb_image.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// file identifier of the KTX 1.1 container
+	const unsigned char g_KtxIdentifier[12] =
+	{
+		0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+	};
+	// written by the baker so that the byte order can be checked
+	const uint32_t g_KtxEndianness = 0x04030201;
+
+	// header of the KTX container, following the identifier
+	struct KTX_HEADER
+	{
+		uint32_t endianness;
+		uint32_t glType;
+		uint32_t glTypeSize;
+		uint32_t glFormat;
+		uint32_t glInternalFormat;
+		uint32_t glBaseInternalFormat;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t numberOfArrayElements;
+		uint32_t numberOfFaces;
+		uint32_t numberOfMipmapLevels;
+		uint32_t bytesOfKeyValueData;
+	};
+
+	static_assert(sizeof(KTX_HEADER) == 52, "KTX_HEADER does not match the KTX file layout");
+
+	/***********************************************************
+	 *  PackColor565()
+	 *
+	 *  This function is used for rounding an 8-bit RGB color to
+	 *  the 5:6:5 format of the block endpoints.
+	 ***********************************************************/
+	uint16_t PackColor565(const unsigned char* color)
+	{
+		uint16_t red = (uint16_t)((color[0] * 31 + 127) / 255);
+		uint16_t green = (uint16_t)((color[1] * 63 + 127) / 255);
+		uint16_t blue = (uint16_t)((color[2] * 31 + 127) / 255);
+
+		return((uint16_t)((red << 11) | (green << 5) | blue));
+	}
+
+	/***********************************************************
+	 *  UnpackColor565()
+	 *
+	 *  This function is used for expanding a 5:6:5 endpoint back
+	 *  to the 8-bit RGB color the GPU decodes it to.
+	 ***********************************************************/
+	void UnpackColor565(uint16_t packed, int* color)
+	{
+		int red = (packed >> 11) & 31;
+		int green = (packed >> 5) & 63;
+		int blue = packed & 31;
+
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	/***********************************************************
+	 *  EncodeColorBlock()
+	 *
+	 *  This function is used for encoding the colors of a 4x4
+	 *  block of RGBA pixels into an 8 byte BC1 color block.  The
+	 *  endpoints are the inset corners of the bounding box of the
+	 *  block colors, and every pixel gets the nearest of the four
+	 *  palette colors.
+	 ***********************************************************/
+	void EncodeColorBlock(const unsigned char block[16][4], unsigned char* output)
+	{
+		unsigned char minColor[3] = { 255, 255, 255 };
+		unsigned char maxColor[3] = { 0, 0, 0 };
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int channel = 0; channel < 3; channel++)
+			{
+				if (block[i][channel] < minColor[channel])
+				{
+					minColor[channel] = block[i][channel];
+				}
+				if (block[i][channel] > maxColor[channel])
+				{
+					maxColor[channel] = block[i][channel];
+				}
+			}
+		}
+
+		// move the endpoints in a little, which lowers the error for
+		// the colors inside of the box
+		for (int channel = 0; channel < 3; channel++)
+		{
+			int inset = (maxColor[channel] - minColor[channel]) >> 4;
+			minColor[channel] = (unsigned char)(minColor[channel] + inset);
+			maxColor[channel] = (unsigned char)(maxColor[channel] - inset);
+		}
+
+		uint16_t color0 = PackColor565(maxColor);
+		uint16_t color1 = PackColor565(minColor);
+		// the first endpoint has to be the larger one for the four
+		// color mode of the block
+		if (color0 < color1)
+		{
+			uint16_t swap = color0;
+			color0 = color1;
+			color1 = swap;
+		}
+
+		int palette[4][3];
+		UnpackColor565(color0, palette[0]);
+		UnpackColor565(color1, palette[1]);
+		for (int channel = 0; channel < 3; channel++)
+		{
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				int bestDistance = -1;
+
+				for (int entry = 0; entry < 4; entry++)
+				{
+					int distance = 0;
+					for (int channel = 0; channel < 3; channel++)
+					{
+						int difference = block[i][channel] - palette[entry][channel];
+						distance += difference * difference;
+					}
+					if ((bestDistance < 0) || (distance < bestDistance))
+					{
+						bestDistance = distance;
+						bestIndex = entry;
+					}
+				}
+				indices |= (uint32_t)bestIndex << (i * 2);
+			}
+		}
+
+		output[0] = (unsigned char)(color0 & 0xFF);
+		output[1] = (unsigned char)(color0 >> 8);
+		output[2] = (unsigned char)(color1 & 0xFF);
+		output[3] = (unsigned char)(color1 >> 8);
+		for (int i = 0; i < 4; i++)
+		{
+			output[4 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeAlphaBlock()
+	 *
+	 *  This function is used for encoding the alpha values of a
+	 *  4x4 block of RGBA pixels into an 8 byte BC3 alpha block
+	 *  with eight interpolated alpha values.
+	 ***********************************************************/
+	void EncodeAlphaBlock(const unsigned char block[16][4], unsigned char* output)
+	{
+		int alpha0 = 0;
+		int alpha1 = 255;
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (block[i][3] > alpha0)
+			{
+				alpha0 = block[i][3];
+			}
+			if (block[i][3] < alpha1)
+			{
+				alpha1 = block[i][3];
+			}
+		}
+
+		int palette[8];
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		for (int entry = 1; entry < 7; entry++)
+		{
+			palette[entry + 1] = ((7 - entry) * alpha0 + entry * alpha1) / 7;
+		}
+
+		uint64_t indices = 0;
+		if (alpha0 != alpha1)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				int bestDistance = 256;
+
+				for (int entry = 0; entry < 8; entry++)
+				{
+					int distance = block[i][3] - palette[entry];
+					if (distance < 0)
+					{
+						distance = -distance;
+					}
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = entry;
+					}
+				}
+				indices |= (uint64_t)bestIndex << (i * 3);
+			}
+		}
+
+		output[0] = (unsigned char)alpha0;
+		output[1] = (unsigned char)alpha1;
+		for (int i = 0; i < 6; i++)
+		{
+			output[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+		}
+	}
+
+	/***********************************************************
+	 *  CompressImage()
+	 *
+	 *  This function is used for compressing an RGBA image into
+	 *  BC1 blocks, or BC3 blocks when the alpha is kept.  The
+	 *  edge pixels are repeated for images that are not a
+	 *  multiple of four in size.
+	 ***********************************************************/
+	void CompressImage(
+		const std::vector<unsigned char>& pixels,
+		int width,
+		int height,
+		bool bKeepAlpha,
+		std::vector<unsigned char>& output)
+	{
+		const int blockSize = bKeepAlpha ? 16 : 8;
+		int blocksWide = (width + 3) / 4;
+		int blocksHigh = (height + 3) / 4;
+
+		output.resize((size_t)blocksWide * blocksHigh * blockSize);
+
+		for (int blockY = 0; blockY < blocksHigh; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				unsigned char block[16][4];
+				unsigned char* pOutput = &output[((size_t)blockY * blocksWide + blockX) * blockSize];
+
+				for (int i = 0; i < 16; i++)
+				{
+					int x = blockX * 4 + (i % 4);
+					int y = blockY * 4 + (i / 4);
+					if (x >= width)
+					{
+						x = width - 1;
+					}
+					if (y >= height)
+					{
+						y = height - 1;
+					}
+					memcpy(block[i], &pixels[((size_t)y * width + x) * 4], 4);
+				}
+
+				if (bKeepAlpha == true)
+				{
+					EncodeAlphaBlock(block, pOutput);
+					pOutput += 8;
+				}
+				EncodeColorBlock(block, pOutput);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  DownsampleImage()
+	 *
+	 *  This function is used for halving the size of an RGBA
+	 *  image with a box filter, for the next mipmap level.
+	 ***********************************************************/
+	void DownsampleImage(
+		const std::vector<unsigned char>& pixels,
+		int width,
+		int height,
+		std::vector<unsigned char>& output,
+		int& outputWidth,
+		int& outputHeight)
+	{
+		outputWidth = (width > 1) ? width / 2 : 1;
+		outputHeight = (height > 1) ? height / 2 : 1;
+		output.resize((size_t)outputWidth * outputHeight * 4);
+
+		for (int y = 0; y < outputHeight; y++)
+		{
+			int y0 = y * 2;
+			int y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+
+			for (int x = 0; x < outputWidth; x++)
+			{
+				int x0 = x * 2;
+				int x1 = (x0 + 1 < width) ? x0 + 1 : x0;
+
+				for (int channel = 0; channel < 4; channel++)
+				{
+					int sum =
+						pixels[((size_t)y0 * width + x0) * 4 + channel] +
+						pixels[((size_t)y0 * width + x1) * 4 + channel] +
+						pixels[((size_t)y1 * width + x0) * 4 + channel] +
+						pixels[((size_t)y1 * width + x1) * 4 + channel];
+					output[((size_t)y * outputWidth + x) * 4 + channel] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CompressedTexture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CompressedTexture::CompressedTexture()
+{
+	m_internalFormat = 0;
+}
+
+/***********************************************************
+ *  ~CompressedTexture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CompressedTexture::~CompressedTexture()
+{
+	Close();
+}
+
+/***********************************************************
+ *  GetBakedFilename()
+ *
+ *  This method is used for getting the name of the baked file
+ *  for a texture image file.  The baked file is stored next
+ *  to the image with the .ktx extension.
+ ***********************************************************/
+std::string CompressedTexture::GetBakedFilename(const char* sourceFilename)
+{
+	std::string bakedFilename = sourceFilename;
+	size_t extension = bakedFilename.find_last_of('.');
+	size_t directory = bakedFilename.find_last_of("/\\");
+
+	if ((extension != std::string::npos) &&
+		((directory == std::string::npos) || (extension > directory)))
+	{
+		bakedFilename.erase(extension);
+	}
+
+	return(bakedFilename + ".ktx");
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for converting an image file into a
+ *  KTX file with a compressed mipmap chain.  Images without
+ *  an alpha channel are stored as BC1 (DXT1), the others as
+ *  BC3 (DXT5).
+ ***********************************************************/
+bool CompressedTexture::Bake(const char* sourceFilename, const char* bakedFilename)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// the baked images have to be flipped like the loaded ones
+	stbi_set_flip_vertically_on_load(true);
+
+	// always decode to RGBA, so all the levels use one layout
+	unsigned char* image = stbi_load(sourceFilename, &width, &height, &colorChannels, 4);
+	if (NULL == image)
+	{
+		std::cout << "Could not load image:" << sourceFilename << std::endl;
+		return(false);
+	}
+
+	bool bKeepAlpha = (colorChannels == 4);
+	std::vector<unsigned char> pixels(image, image + (size_t)width * height * 4);
+	stbi_image_free(image);
+
+	std::ofstream bakedFile(bakedFilename, std::ios::binary | std::ios::trunc);
+	if (!bakedFile)
+	{
+		std::cout << "Could not create baked texture:" << bakedFilename << std::endl;
+		return(false);
+	}
+
+	// count the levels down to 1x1
+	uint32_t levelCount = 1;
+	for (int size = (width > height) ? width : height; size > 1; size /= 2)
+	{
+		levelCount++;
+	}
+
+	KTX_HEADER header;
+	header.endianness = g_KtxEndianness;
+	header.glType = 0;
+	header.glTypeSize = 1;
+	header.glFormat = 0;
+	header.glInternalFormat = bKeepAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	header.glBaseInternalFormat = bKeepAlpha ? GL_RGBA : GL_RGB;
+	header.pixelWidth = (uint32_t)width;
+	header.pixelHeight = (uint32_t)height;
+	header.pixelDepth = 0;
+	header.numberOfArrayElements = 0;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = levelCount;
+	header.bytesOfKeyValueData = 0;
+
+	bakedFile.write((const char*)g_KtxIdentifier, sizeof(g_KtxIdentifier));
+	bakedFile.write((const char*)&header, sizeof(header));
+
+	std::vector<unsigned char> blocks;
+	std::vector<unsigned char> nextLevel;
+	size_t compressedSize = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		CompressImage(pixels, width, height, bKeepAlpha, blocks);
+
+		// the blocks are always a multiple of four bytes, so no
+		// mipmap padding is needed
+		uint32_t imageSize = (uint32_t)blocks.size();
+		bakedFile.write((const char*)&imageSize, sizeof(imageSize));
+		bakedFile.write((const char*)blocks.data(), imageSize);
+		compressedSize += imageSize;
+
+		if (level + 1 < levelCount)
+		{
+			int nextWidth = 0;
+			int nextHeight = 0;
+			DownsampleImage(pixels, width, height, nextLevel, nextWidth, nextHeight);
+			pixels.swap(nextLevel);
+			width = nextWidth;
+			height = nextHeight;
+		}
+	}
+
+	if (!bakedFile)
+	{
+		std::cout << "Could not write baked texture:" << bakedFilename << std::endl;
+		return(false);
+	}
+
+	std::cout << "Baked texture:" << bakedFilename << ", levels:" << levelCount << ", format:" << (bKeepAlpha ? "BC3" : "BC1") << ", bytes:" << compressedSize << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for mapping a baked texture file and
+ *  finding the compressed blocks of its mipmap levels.  Only
+ *  the files written by Bake() are accepted.
+ ***********************************************************/
+bool CompressedTexture::Load(const char* bakedFilename)
+{
+	Close();
+
+	if (m_file.Open(bakedFilename) == false)
+	{
+		return(false);
+	}
+
+	const unsigned char* pData = m_file.GetData();
+	size_t fileSize = m_file.GetSize();
+	KTX_HEADER header;
+
+	if ((fileSize < sizeof(g_KtxIdentifier) + sizeof(header)) ||
+		(memcmp(pData, g_KtxIdentifier, sizeof(g_KtxIdentifier)) != 0))
+	{
+		std::cout << "Not a KTX texture file:" << bakedFilename << std::endl;
+		Close();
+		return(false);
+	}
+
+	memcpy(&header, pData + sizeof(g_KtxIdentifier), sizeof(header));
+	if ((header.endianness != g_KtxEndianness) ||
+		((header.glInternalFormat != GL_COMPRESSED_RGB_S3TC_DXT1_EXT) &&
+		 (header.glInternalFormat != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)) ||
+		(header.pixelDepth > 1) ||
+		(header.numberOfArrayElements != 0) ||
+		(header.numberOfFaces != 1))
+	{
+		std::cout << "Unsupported KTX texture file:" << bakedFilename << std::endl;
+		Close();
+		return(false);
+	}
+
+	size_t offset = sizeof(g_KtxIdentifier) + sizeof(header) + header.bytesOfKeyValueData;
+	uint32_t levelCount = (header.numberOfMipmapLevels > 0) ? header.numberOfMipmapLevels : 1;
+	int width = (int)header.pixelWidth;
+	int height = (int)header.pixelHeight;
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		uint32_t imageSize = 0;
+
+		if (offset + sizeof(imageSize) > fileSize)
+		{
+			break;
+		}
+		memcpy(&imageSize, pData + offset, sizeof(imageSize));
+		offset += sizeof(imageSize);
+		if (offset + imageSize > fileSize)
+		{
+			break;
+		}
+
+		MIP_LEVEL mipLevel;
+		mipLevel.width = width;
+		mipLevel.height = height;
+		mipLevel.imageSize = (GLsizei)imageSize;
+		mipLevel.pData = pData + offset;
+		m_levels.push_back(mipLevel);
+
+		// every level is padded to four bytes
+		offset += (imageSize + 3) & ~3u;
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	if (m_levels.size() != levelCount)
+	{
+		std::cout << "Truncated KTX texture file:" << bakedFilename << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_internalFormat = header.glInternalFormat;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the baked texture file.
+ ***********************************************************/
+void CompressedTexture::Close()
+{
+	m_levels.clear();
+	m_internalFormat = 0;
+	m_file.Close();
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// compressedtexture.h
+// ============
+// bake texture images into compressed KTX files and map them for uploading
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  CompressedTexture
+ *
+ *  This class converts texture images into S3TC compressed
+ *  KTX files with the whole mipmap chain, as an offline step.
+ *  A baked file is memory mapped when it is loaded, and the
+ *  compressed blocks of every mipmap level are handed to
+ *  glCompressedTexImage2D() straight from the mapping.
+ ***********************************************************/
+class CompressedTexture
+{
+public:
+	// constructor
+	CompressedTexture();
+	// destructor
+	~CompressedTexture();
+
+	struct MIP_LEVEL
+	{
+		int width;
+		int height;
+		GLsizei imageSize;
+		// compressed blocks inside the mapped file
+		const unsigned char* pData;
+	};
+
+private:
+	// mapped contents of the baked file
+	MappedFile m_file;
+	// compressed format of the blocks
+	GLenum m_internalFormat;
+	// all the mipmap levels, starting with the full size image
+	std::vector<MIP_LEVEL> m_levels;
+
+public:
+	// convert an image file into a baked compressed texture file
+	static bool Bake(const char* sourceFilename, const char* bakedFilename);
+	// get the name of the baked file for a texture image file
+	static std::string GetBakedFilename(const char* sourceFilename);
+
+	// map a baked texture file and find its mipmap levels
+	bool Load(const char* bakedFilename);
+	// unmap the baked texture file
+	void Close();
+
+	// access the loaded texture
+	bool IsLoaded() const { return m_levels.empty() == false; }
+	GLenum GetInternalFormat() const { return m_internalFormat; }
+	const std::vector<MIP_LEVEL>& GetLevels() const { return m_levels; }
+};
@@ -0,0 +1,387 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// render the scene at a resolution that follows the measured GPU time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// the scale changes in steps of this size, so the viewport
+	// does not change size on every frame
+	const float g_ScaleStep = 0.05f;
+	// the GPU time is read a few frames late, so the scale is left
+	// alone for this many frames after it has changed
+	const int g_SettleFrames = 8;
+	// a lower scale aims for this part of the target frame time
+	const double g_TargetHeadroom = 0.9;
+	// the scale only grows while the GPU time is below this part
+	// of the target frame time
+	const double g_ScaleUpThreshold = 0.75;
+	// texture unit of the render target in the upscale pass, above
+	// the units of the scene texture arrays
+	const int g_UpscaleTextureUnit = 30;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution()
+{
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthBuffer = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+	m_scale = 1.0f;
+	m_minimumScale = 0.5f;
+	m_targetFrameTime = 1000.0 / 60.0;
+	m_framesSinceChange = 0;
+	m_programID = 0;
+	m_vertexArray = 0;
+	m_sourceTextureLocation = -1;
+	m_sourceTexelSizeLocation = -1;
+	m_sourceScaleLocation = -1;
+	m_sharpnessLocation = -1;
+	m_sharpness = 0.5f;
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	DestroyTarget();
+
+	if (0 != m_vertexArray)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used for creating the offscreen target with
+ *  a color texture, which the upscale pass samples, and a
+ *  depth attachment of the passed in size.
+ ***********************************************************/
+bool DynamicResolution::CreateTarget(int width, int height)
+{
+	m_targetWidth = width;
+	m_targetHeight = height;
+
+	glGenTextures(1, &m_colorTexture);
+	glActiveTexture(GL_TEXTURE0 + g_UpscaleTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "The dynamic resolution target is not complete, status:" << status << std::endl;
+		DestroyTarget();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTarget()
+ *
+ *  This method is used for freeing the offscreen target.
+ ***********************************************************/
+void DynamicResolution::DestroyTarget()
+{
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (0 != m_colorTexture)
+	{
+		glDeleteTextures(1, &m_colorTexture);
+		m_colorTexture = 0;
+	}
+	if (0 != m_depthBuffer)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+}
+
+/***********************************************************
+ *  LoadShader()
+ *
+ *  This method is used for building the sharpening upscale
+ *  shader through the program cache.  The full window
+ *  triangle is made from the vertex IDs, so the vertex array
+ *  has no buffers.
+ ***********************************************************/
+bool DynamicResolution::LoadShader(
+	const char* vertexShaderFile,
+	const char* fragmentShaderFile,
+	ProgramBinaryCache* pProgramCache)
+{
+	if (NULL == pProgramCache)
+	{
+		return(false);
+	}
+
+	GLuint programID = pProgramCache->LoadProgram(vertexShaderFile, fragmentShaderFile, "upscaleShader");
+	if (0 == programID)
+	{
+		std::cout << "The upscale shader did not build, the scene is stretched without sharpening" << std::endl;
+		return(false);
+	}
+
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+	}
+	m_programID = programID;
+	m_sourceTextureLocation = glGetUniformLocation(m_programID, "sourceTexture");
+	m_sourceTexelSizeLocation = glGetUniformLocation(m_programID, "sourceTexelSize");
+	m_sourceScaleLocation = glGetUniformLocation(m_programID, "sourceScale");
+	m_sharpnessLocation = glGetUniformLocation(m_programID, "sharpness");
+
+	if (0 == m_vertexArray)
+	{
+		glGenVertexArrays(1, &m_vertexArray);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetTargetFrameTime()
+ *
+ *  This method is used for setting the GPU time of one frame
+ *  that the scale aims for, in milliseconds.
+ ***********************************************************/
+void DynamicResolution::SetTargetFrameTime(double milliseconds)
+{
+	if (milliseconds > 0.0)
+	{
+		m_targetFrameTime = milliseconds;
+	}
+}
+
+/***********************************************************
+ *  SetMinimumScale()
+ *
+ *  This method is used for setting the smallest fraction of
+ *  the window size that the scene is drawn at.
+ ***********************************************************/
+void DynamicResolution::SetMinimumScale(float scale)
+{
+	if (scale < g_ScaleStep)
+	{
+		scale = g_ScaleStep;
+	}
+	if (scale > 1.0f)
+	{
+		scale = 1.0f;
+	}
+
+	m_minimumScale = scale;
+	if (m_scale < m_minimumScale)
+	{
+		m_scale = m_minimumScale;
+	}
+}
+
+/***********************************************************
+ *  SetSharpness()
+ *
+ *  This method is used for setting the strength of the
+ *  sharpening of the upscale pass, from 0 to 1.
+ ***********************************************************/
+void DynamicResolution::SetSharpness(float sharpness)
+{
+	m_sharpness = (sharpness < 0.0f) ? 0.0f : ((sharpness > 1.0f) ? 1.0f : sharpness);
+}
+
+/***********************************************************
+ *  UpdateScale()
+ *
+ *  This method is used for changing the scale from the GPU
+ *  time of the latest finished frame.  The cost of a frame
+ *  mostly grows with its pixels, so an over budget frame
+ *  shrinks the scale by the square root of the time it has
+ *  to shed, at once.  The scale only grows by one step at a
+ *  time and only with enough headroom, so it does not swing
+ *  back and forth around the target.
+ ***********************************************************/
+void DynamicResolution::UpdateScale(double gpuMilliseconds)
+{
+	m_framesSinceChange++;
+	if ((gpuMilliseconds <= 0.0) || (m_framesSinceChange < g_SettleFrames))
+	{
+		return;
+	}
+
+	float scale = m_scale;
+	if (gpuMilliseconds > m_targetFrameTime)
+	{
+		scale = m_scale * (float)sqrt(m_targetFrameTime * g_TargetHeadroom / gpuMilliseconds);
+		scale = floorf(scale / g_ScaleStep + 0.001f) * g_ScaleStep;
+	}
+	else if (gpuMilliseconds < m_targetFrameTime * g_ScaleUpThreshold)
+	{
+		scale = m_scale + g_ScaleStep;
+	}
+
+	if (scale < m_minimumScale)
+	{
+		scale = m_minimumScale;
+	}
+	if (scale > 1.0f)
+	{
+		scale = 1.0f;
+	}
+
+	if (fabsf(scale - m_scale) > 0.001f)
+	{
+		m_scale = scale;
+		m_framesSinceChange = 0;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the offscreen target for
+ *  the scene and setting the viewport to the scaled size.  A
+ *  resized window creates the target again at its new size.
+ *  A minimized window has no size, so the target is kept at
+ *  one pixel at least.
+ ***********************************************************/
+bool DynamicResolution::BeginFrame(int windowWidth, int windowHeight, double gpuMilliseconds)
+{
+	if (windowWidth < 1)
+	{
+		windowWidth = 1;
+	}
+	if (windowHeight < 1)
+	{
+		windowHeight = 1;
+	}
+
+	if ((windowWidth != m_targetWidth) || (windowHeight != m_targetHeight))
+	{
+		DestroyTarget();
+		if (CreateTarget(windowWidth, windowHeight) == false)
+		{
+			return(false);
+		}
+		// the frames at the old size do not tell the cost of the new one
+		m_framesSinceChange = 0;
+	}
+
+	UpdateScale(gpuMilliseconds);
+
+	m_renderWidth = (int)((float)m_targetWidth * m_scale + 0.5f);
+	m_renderHeight = (int)((float)m_targetHeight * m_scale + 0.5f);
+	if (m_renderWidth < 1)
+	{
+		m_renderWidth = 1;
+	}
+	if (m_renderHeight < 1)
+	{
+		m_renderHeight = 1;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_renderWidth, m_renderHeight);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stretching the drawn part of the
+ *  target over the window.  At the full scale the pixels are
+ *  only copied, and without the upscale shader they are
+ *  filtered by a linear blit instead of being sharpened.
+ ***********************************************************/
+void DynamicResolution::EndFrame()
+{
+	if (0 == m_framebuffer)
+	{
+		return;
+	}
+
+	bool bFullScale = (m_renderWidth == m_targetWidth) && (m_renderHeight == m_targetHeight);
+	if ((bFullScale == true) || (0 == m_programID))
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(
+			0, 0, m_renderWidth, m_renderHeight,
+			0, 0, m_targetWidth, m_targetHeight,
+			GL_COLOR_BUFFER_BIT,
+			bFullScale ? GL_NEAREST : GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, m_targetWidth, m_targetHeight);
+		return;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, m_targetWidth, m_targetHeight);
+	glDisable(GL_DEPTH_TEST);
+
+	glUseProgram(m_programID);
+	glActiveTexture(GL_TEXTURE0 + g_UpscaleTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+	glUniform1i(m_sourceTextureLocation, g_UpscaleTextureUnit);
+	glUniform2f(m_sourceTexelSizeLocation, 1.0f / (float)m_targetWidth, 1.0f / (float)m_targetHeight);
+	glUniform2f(
+		m_sourceScaleLocation,
+		(float)m_renderWidth / (float)m_targetWidth,
+		(float)m_renderHeight / (float)m_targetHeight);
+	glUniform1f(m_sharpnessLocation, m_sharpness);
+
+	glBindVertexArray(m_vertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	glUseProgram(0);
+	glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// render the scene at a resolution that follows the measured GPU time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ProgramBinaryCache.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class renders the scene into an offscreen target and
+ *  stretches it over the window with a sharpening pass.  The
+ *  part of the target that the scene is drawn into shrinks
+ *  when the GPU time of the frames is over the target frame
+ *  time, and grows again in small steps once there is enough
+ *  headroom, so a heavy view keeps its frame rate at a lower
+ *  resolution.  The target is only created again when the
+ *  window is resized, because a new scale only changes the
+ *  viewport inside of it.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	// constructor
+	DynamicResolution();
+	// destructor
+	~DynamicResolution();
+
+private:
+	// the offscreen target, which is as large as the window
+	GLuint m_framebuffer;
+	GLuint m_colorTexture;
+	GLuint m_depthBuffer;
+	int m_targetWidth;
+	int m_targetHeight;
+	// part of the target that the current frame is drawn into
+	int m_renderWidth;
+	int m_renderHeight;
+
+	// fraction of the window size that the scene is drawn at
+	float m_scale;
+	float m_minimumScale;
+	// GPU time that the scale aims for, in milliseconds
+	double m_targetFrameTime;
+	// frames since the scale was last changed
+	int m_framesSinceChange;
+
+	// the sharpening upscale pass - the target is blitted when
+	// the shader could not be built
+	GLuint m_programID;
+	GLuint m_vertexArray;
+	GLint m_sourceTextureLocation;
+	GLint m_sourceTexelSizeLocation;
+	GLint m_sourceScaleLocation;
+	GLint m_sharpnessLocation;
+	float m_sharpness;
+
+	// create and free the offscreen target
+	bool CreateTarget(int width, int height);
+	void DestroyTarget();
+	// change the scale from the GPU time of a finished frame
+	void UpdateScale(double gpuMilliseconds);
+
+	// the GL objects can not be shared between two objects
+	DynamicResolution(const DynamicResolution&);
+	DynamicResolution& operator=(const DynamicResolution&);
+
+public:
+	// build the upscale shader through the program cache - false
+	// is returned when it can not be built, and the target is then
+	// stretched without sharpening
+	bool LoadShader(
+		const char* vertexShaderFile,
+		const char* fragmentShaderFile,
+		ProgramBinaryCache* pProgramCache);
+
+	// GPU time of a frame that the scale aims for, in milliseconds
+	void SetTargetFrameTime(double milliseconds);
+	// smallest fraction of the window size that the scene is drawn at
+	void SetMinimumScale(float scale);
+	// strength of the sharpening, from 0 to 1
+	void SetSharpness(float sharpness);
+
+	// bind the target for the scene of a window with the passed in
+	// size - false is returned when there is no target, and the
+	// scene is then drawn into the window
+	bool BeginFrame(int windowWidth, int windowHeight, double gpuMilliseconds);
+	// stretch the drawn part of the target over the window - the
+	// scene shader program is unbound
+	void EndFrame();
+
+	// size of the part of the target that the scene is drawn into
+	int GetRenderWidth() const { return m_renderWidth; }
+	int GetRenderHeight() const { return m_renderHeight; }
+	float GetScale() const { return m_scale; }
+};
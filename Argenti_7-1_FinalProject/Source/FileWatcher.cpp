@@ -0,0 +1,513 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.cpp
+// ============
+// watch the asset files for changes on a background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <cctype>
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// a written file is handed out once it has been left alone
+	// for this long
+	const int g_SettleMilliseconds = 150;
+	// the thread checks whether it has to finish this often
+	const int g_WaitMilliseconds = 100;
+#ifdef _WIN32
+	// size of the buffer that the changes of a folder are read into
+	const int g_ChangeBufferBytes = 16 * 1024;
+	// the changes that are reported for a folder
+	const DWORD g_ChangeFilter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+#endif
+
+	// file names are not case sensitive on Windows
+	std::string NormalizeName(const std::string& name)
+	{
+		std::string normalized = name;
+#ifdef _WIN32
+		for (size_t i = 0; i < normalized.size(); i++)
+		{
+			normalized[i] = (char)std::tolower((unsigned char)normalized[i]);
+		}
+#endif
+		return(normalized);
+	}
+}
+
+/***********************************************************
+ *  FileWatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FileWatcher::FileWatcher()
+{
+#ifndef _WIN32
+	m_inotifyFile = -1;
+#endif
+	m_bRunning.store(false);
+}
+
+/***********************************************************
+ *  ~FileWatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FileWatcher::~FileWatcher()
+{
+	Stop();
+	m_files.clear();
+	m_directories.clear();
+}
+
+/***********************************************************
+ *  WatchFile()
+ *
+ *  This method is used for adding a file to the watched
+ *  files.  Its folder is watched once for all the files in
+ *  it.  The index of the file is returned, or -1 when the
+ *  watcher is already running.
+ ***********************************************************/
+int FileWatcher::WatchFile(const char* filename)
+{
+	if ((NULL == filename) || (m_bRunning.load() == true))
+	{
+		return(-1);
+	}
+
+	std::string path = filename;
+	std::string directory = ".";
+	std::string name = path;
+	size_t separator = path.find_last_of("/\\");
+	if (separator != std::string::npos)
+	{
+		directory = path.substr(0, separator);
+		name = path.substr(separator + 1);
+	}
+
+	for (int i = 0; i < (int)m_files.size(); i++)
+	{
+		if (m_files[i].filename == path)
+		{
+			return(i);
+		}
+	}
+
+	int directoryIndex = -1;
+	for (int i = 0; i < (int)m_directories.size(); i++)
+	{
+		if (NormalizeName(m_directories[i].path) == NormalizeName(directory))
+		{
+			directoryIndex = i;
+			break;
+		}
+	}
+	if (directoryIndex < 0)
+	{
+		WATCHED_DIRECTORY watchedDirectory;
+		watchedDirectory.path = directory;
+#ifdef _WIN32
+		watchedDirectory.hDirectory = INVALID_HANDLE_VALUE;
+		watchedDirectory.hEvent = NULL;
+		watchedDirectory.pOverlapped = NULL;
+#else
+		watchedDirectory.watchDescriptor = -1;
+#endif
+		directoryIndex = (int)m_directories.size();
+		m_directories.push_back(watchedDirectory);
+	}
+
+	WATCHED_FILE file;
+	file.filename = path;
+	file.name = NormalizeName(name);
+	file.directoryIndex = directoryIndex;
+	file.bChanged = false;
+	m_files.push_back(file);
+
+	return((int)m_files.size() - 1);
+}
+
+/***********************************************************
+ *  GetFilename()
+ *
+ *  This method is used for getting the name of a watched
+ *  file, as it was passed to WatchFile().
+ ***********************************************************/
+const char* FileWatcher::GetFilename(int fileIndex) const
+{
+	if ((fileIndex < 0) || (fileIndex >= (int)m_files.size()))
+	{
+		return("");
+	}
+
+	return(m_files[fileIndex].filename.c_str());
+}
+
+/***********************************************************
+ *  OpenDirectories()
+ *
+ *  This method is used for opening the watched folders.  A
+ *  folder that can not be opened is skipped, and false is
+ *  returned when none of them could be opened.
+ ***********************************************************/
+bool FileWatcher::OpenDirectories()
+{
+	int openCount = 0;
+
+#ifdef _WIN32
+	for (int i = 0; i < (int)m_directories.size(); i++)
+	{
+		WATCHED_DIRECTORY& directory = m_directories[i];
+
+		directory.hDirectory = CreateFileA(
+			directory.path.c_str(),
+			FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL,
+			OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			NULL);
+		if (INVALID_HANDLE_VALUE == directory.hDirectory)
+		{
+			std::cout << "Could not watch the folder:" << directory.path << std::endl;
+			continue;
+		}
+
+		OVERLAPPED* pOverlapped = new OVERLAPPED();
+		pOverlapped->hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+		directory.hEvent = pOverlapped->hEvent;
+		directory.pOverlapped = pOverlapped;
+		directory.changeBuffer.resize(g_ChangeBufferBytes / sizeof(unsigned long));
+		openCount++;
+	}
+#else
+	m_inotifyFile = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotifyFile < 0)
+	{
+		std::cout << "Could not create the inotify instance for watching the asset files" << std::endl;
+		return(false);
+	}
+
+	for (int i = 0; i < (int)m_directories.size(); i++)
+	{
+		WATCHED_DIRECTORY& directory = m_directories[i];
+
+		// editors either write the file in place or rename a
+		// new file over it
+		directory.watchDescriptor = inotify_add_watch(
+			m_inotifyFile,
+			directory.path.c_str(),
+			IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (directory.watchDescriptor < 0)
+		{
+			std::cout << "Could not watch the folder:" << directory.path << std::endl;
+			continue;
+		}
+		openCount++;
+	}
+#endif
+
+	if (openCount == 0)
+	{
+		CloseDirectories();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CloseDirectories()
+ *
+ *  This method is used for closing the watched folders.
+ ***********************************************************/
+void FileWatcher::CloseDirectories()
+{
+#ifdef _WIN32
+	for (int i = 0; i < (int)m_directories.size(); i++)
+	{
+		WATCHED_DIRECTORY& directory = m_directories[i];
+
+		if (INVALID_HANDLE_VALUE != directory.hDirectory)
+		{
+			CloseHandle(directory.hDirectory);
+			directory.hDirectory = INVALID_HANDLE_VALUE;
+		}
+		if (NULL != directory.hEvent)
+		{
+			CloseHandle(directory.hEvent);
+			directory.hEvent = NULL;
+		}
+		if (NULL != directory.pOverlapped)
+		{
+			delete (OVERLAPPED*)directory.pOverlapped;
+			directory.pOverlapped = NULL;
+		}
+	}
+#else
+	// closing the instance also removes all of its watches
+	if (m_inotifyFile >= 0)
+	{
+		close(m_inotifyFile);
+		m_inotifyFile = -1;
+	}
+	for (int i = 0; i < (int)m_directories.size(); i++)
+	{
+		m_directories[i].watchDescriptor = -1;
+	}
+#endif
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for opening the folders of all the
+ *  watched files and starting the watcher thread.
+ ***********************************************************/
+bool FileWatcher::Start()
+{
+	if ((m_bRunning.load() == true) || (m_files.empty() == true))
+	{
+		return(false);
+	}
+
+	if (OpenDirectories() == false)
+	{
+		return(false);
+	}
+
+	m_bRunning.store(true);
+	m_thread = std::thread(&FileWatcher::Run, this);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for asking the watcher thread to
+ *  finish, waiting until it has, and closing the folders.
+ ***********************************************************/
+void FileWatcher::Stop()
+{
+	m_bRunning.store(false);
+	if (m_thread.joinable() == true)
+	{
+		m_thread.join();
+	}
+	CloseDirectories();
+}
+
+/***********************************************************
+ *  MarkChanged()
+ *
+ *  This method is used for queueing a change of the watched
+ *  file with the passed in name in a folder.  The changes of
+ *  the other files in the folder are ignored.
+ ***********************************************************/
+void FileWatcher::MarkChanged(int directoryIndex, const std::string& name)
+{
+	std::string normalized = NormalizeName(name);
+	std::lock_guard<std::mutex> lock(m_changeMutex);
+
+	for (int i = 0; i < (int)m_files.size(); i++)
+	{
+		WATCHED_FILE& file = m_files[i];
+		if ((file.directoryIndex == directoryIndex) && (file.name == normalized))
+		{
+			file.bChanged = true;
+			file.lastChange = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is the loop of the watcher thread.  It waits
+ *  for the changes of the folders with a timeout, so that it
+ *  notices when it has to finish.  On Windows the reads of
+ *  the folder changes are issued and cancelled on this
+ *  thread.
+ ***********************************************************/
+void FileWatcher::Run()
+{
+#ifdef _WIN32
+	std::vector<HANDLE> events;
+	std::vector<int> eventDirectories;
+
+	for (int i = 0; i < (int)m_directories.size(); i++)
+	{
+		WATCHED_DIRECTORY& directory = m_directories[i];
+		if (NULL == directory.pOverlapped)
+		{
+			continue;
+		}
+
+		if (ReadDirectoryChangesW(
+			directory.hDirectory,
+			&directory.changeBuffer[0],
+			(DWORD)(directory.changeBuffer.size() * sizeof(unsigned long)),
+			FALSE,
+			g_ChangeFilter,
+			NULL,
+			(OVERLAPPED*)directory.pOverlapped,
+			NULL) == FALSE)
+		{
+			continue;
+		}
+		events.push_back(directory.hEvent);
+		eventDirectories.push_back(i);
+	}
+
+	while ((m_bRunning.load() == true) && (events.empty() == false))
+	{
+		DWORD result = WaitForMultipleObjects((DWORD)events.size(), &events[0], FALSE, g_WaitMilliseconds);
+		if (result >= WAIT_OBJECT_0 + (DWORD)events.size())
+		{
+			continue;
+		}
+
+		WATCHED_DIRECTORY& directory = m_directories[eventDirectories[result - WAIT_OBJECT_0]];
+		OVERLAPPED* pOverlapped = (OVERLAPPED*)directory.pOverlapped;
+		DWORD byteCount = 0;
+
+		if ((GetOverlappedResult(directory.hDirectory, pOverlapped, &byteCount, FALSE) == TRUE) && (byteCount > 0))
+		{
+			const unsigned char* pChange = (const unsigned char*)&directory.changeBuffer[0];
+			while (true)
+			{
+				const FILE_NOTIFY_INFORMATION* pInfo = (const FILE_NOTIFY_INFORMATION*)pChange;
+
+				if ((pInfo->Action == FILE_ACTION_MODIFIED) ||
+					(pInfo->Action == FILE_ACTION_ADDED) ||
+					(pInfo->Action == FILE_ACTION_RENAMED_NEW_NAME))
+				{
+					char name[MAX_PATH];
+					int nameLength = WideCharToMultiByte(
+						CP_ACP,
+						0,
+						pInfo->FileName,
+						(int)(pInfo->FileNameLength / sizeof(WCHAR)),
+						name,
+						sizeof(name) - 1,
+						NULL,
+						NULL);
+					name[nameLength] = '\0';
+					MarkChanged(eventDirectories[result - WAIT_OBJECT_0], name);
+				}
+
+				if (pInfo->NextEntryOffset == 0)
+				{
+					break;
+				}
+				pChange += pInfo->NextEntryOffset;
+			}
+		}
+
+		// the next changes of the folder are read into the same buffer
+		ResetEvent(directory.hEvent);
+		ReadDirectoryChangesW(
+			directory.hDirectory,
+			&directory.changeBuffer[0],
+			(DWORD)(directory.changeBuffer.size() * sizeof(unsigned long)),
+			FALSE,
+			g_ChangeFilter,
+			NULL,
+			pOverlapped,
+			NULL);
+	}
+
+	// the pending reads are cancelled before their buffers go away
+	for (int i = 0; i < (int)eventDirectories.size(); i++)
+	{
+		WATCHED_DIRECTORY& directory = m_directories[eventDirectories[i]];
+		DWORD byteCount = 0;
+		CancelIo(directory.hDirectory);
+		GetOverlappedResult(directory.hDirectory, (OVERLAPPED*)directory.pOverlapped, &byteCount, TRUE);
+	}
+#else
+	// the events are read into memory that is aligned for them
+	alignas(struct inotify_event) char eventBuffer[4096];
+	pollfd pollFile;
+	pollFile.fd = m_inotifyFile;
+	pollFile.events = POLLIN;
+
+	while (m_bRunning.load() == true)
+	{
+		pollFile.revents = 0;
+		if ((poll(&pollFile, 1, g_WaitMilliseconds) <= 0) || ((pollFile.revents & POLLIN) == 0))
+		{
+			continue;
+		}
+
+		ssize_t byteCount = read(m_inotifyFile, eventBuffer, sizeof(eventBuffer));
+		ssize_t offset = 0;
+		while ((byteCount > 0) && (offset + (ssize_t)sizeof(struct inotify_event) <= byteCount))
+		{
+			const struct inotify_event* pEvent = (const struct inotify_event*)(eventBuffer + offset);
+
+			if (pEvent->len > 0)
+			{
+				for (int i = 0; i < (int)m_directories.size(); i++)
+				{
+					if (m_directories[i].watchDescriptor == pEvent->wd)
+					{
+						MarkChanged(i, pEvent->name);
+					}
+				}
+			}
+			offset += sizeof(struct inotify_event) + pEvent->len;
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  CollectChanges()
+ *
+ *  This method is used for getting the indices of the files
+ *  that have changed and have not been written again for a
+ *  short time.  Their changes are removed from the queue,
+ *  and the number of changed files is returned.
+ ***********************************************************/
+int FileWatcher::CollectChanges(std::vector<int>& changedFiles)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	int changeCount = 0;
+
+	changedFiles.clear();
+	if (m_bRunning.load() == false)
+	{
+		return(0);
+	}
+
+	std::lock_guard<std::mutex> lock(m_changeMutex);
+	for (int i = 0; i < (int)m_files.size(); i++)
+	{
+		WATCHED_FILE& file = m_files[i];
+		if ((file.bChanged == true) &&
+			(now - file.lastChange >= std::chrono::milliseconds(g_SettleMilliseconds)))
+		{
+			file.bChanged = false;
+			changedFiles.push_back(i);
+			changeCount++;
+		}
+	}
+
+	return(changeCount);
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.h
+// ============
+// watch the asset files for changes on a background thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FileWatcher
+ *
+ *  This class watches the folders of a list of files on a
+ *  background thread - with inotify on Linux and with
+ *  ReadDirectoryChangesW on Windows - and queues the files
+ *  that were written.  A file is only handed out once it has
+ *  not been written for a short time, because editors save
+ *  a file in several steps, and a file that is written many
+ *  times is only handed out once.  The queued changes are
+ *  collected on the GL thread between frames.
+ ***********************************************************/
+class FileWatcher
+{
+public:
+	// constructor
+	FileWatcher();
+	// destructor
+	~FileWatcher();
+
+private:
+	struct WATCHED_FILE
+	{
+		std::string filename;
+		// name of the file inside of its folder
+		std::string name;
+		int directoryIndex;
+		// true while a change of the file is queued
+		bool bChanged;
+		std::chrono::steady_clock::time_point lastChange;
+	};
+
+	struct WATCHED_DIRECTORY
+	{
+		std::string path;
+#ifdef _WIN32
+		// handles of the opened folder and of the event that is
+		// signaled when a read of its changes has finished
+		void* hDirectory;
+		void* hEvent;
+		void* pOverlapped;
+		// the changes are read into DWORD aligned memory
+		std::vector<unsigned long> changeBuffer;
+#else
+		int watchDescriptor;
+#endif
+	};
+
+	std::vector<WATCHED_FILE> m_files;
+	std::vector<WATCHED_DIRECTORY> m_directories;
+#ifndef _WIN32
+	// the inotify instance of all the folders
+	int m_inotifyFile;
+#endif
+	// guards the change flags of the files
+	std::mutex m_changeMutex;
+	std::thread m_thread;
+	// cleared to ask the thread to finish
+	std::atomic<bool> m_bRunning;
+
+	// the loop of the watcher thread
+	void Run();
+	// queue a change of the file with the passed in name in a folder
+	void MarkChanged(int directoryIndex, const std::string& name);
+	// open and close the folders for watching
+	bool OpenDirectories();
+	void CloseDirectories();
+
+	// the thread can not be shared between two objects
+	FileWatcher(const FileWatcher&);
+	FileWatcher& operator=(const FileWatcher&);
+
+public:
+	// add a file to watch, must be called before Start() - the
+	// index of the file is returned with its changes
+	int WatchFile(const char* filename);
+	// get the name of a watched file
+	const char* GetFilename(int fileIndex) const;
+
+	// start and stop the watcher thread
+	bool Start();
+	void Stop();
+	bool IsRunning() const { return m_bRunning.load(); }
+
+	// get the files that have changed since the last call - must
+	// be called on the thread that applies the changes
+	int CollectChanges(std::vector<int>& changedFiles);
+};
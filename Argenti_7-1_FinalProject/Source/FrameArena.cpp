@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// allocate the transient render data of a frame from a linear arena
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+// declaration of global variables and defines
+namespace
+{
+	// round a size or an offset up to a multiple of the alignment,
+	// which has to be a power of two
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return((value + alignment - 1) & ~(alignment - 1));
+	}
+}
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t blockBytes)
+{
+	blockBytes = AlignUp(blockBytes, DEFAULT_ALIGNMENT);
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_blocks[i].pMemory = new unsigned char[blockBytes];
+		m_blocks[i].capacity = blockBytes;
+		m_blocks[i].usedBytes = 0;
+		m_blocks[i].requestedBytes = 0;
+	}
+	m_currentBlock = 0;
+	m_peakBytes = 0;
+	m_growCount = 0;
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		for (int j = 0; j < (int)m_blocks[i].overflow.size(); j++)
+		{
+			delete[] m_blocks[i].overflow[j];
+		}
+		m_blocks[i].overflow.clear();
+
+		delete[] m_blocks[i].pMemory;
+		m_blocks[i].pMemory = NULL;
+	}
+}
+
+/***********************************************************
+ *  ResetBlock()
+ *
+ *  This method is used for emptying a block before it is
+ *  reused.  When the last frame of the block did not fit, the
+ *  block is allocated again with the room that the frame
+ *  asked for.
+ ***********************************************************/
+void FrameArena::ResetBlock(ARENA_BLOCK& block)
+{
+	for (int i = 0; i < (int)block.overflow.size(); i++)
+	{
+		delete[] block.overflow[i];
+	}
+	block.overflow.clear();
+
+	if (block.requestedBytes > block.capacity)
+	{
+		delete[] block.pMemory;
+		block.capacity = AlignUp(block.requestedBytes, DEFAULT_ALIGNMENT);
+		block.pMemory = new unsigned char[block.capacity];
+		m_growCount++;
+	}
+
+	block.usedBytes = 0;
+	block.requestedBytes = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a new frame.  The block
+ *  of the frame before the previous one is reset, so all the
+ *  data that was allocated from it is released at once.
+ ***********************************************************/
+void FrameArena::BeginFrame()
+{
+	m_currentBlock = (m_currentBlock + 1) % FRAMES_IN_FLIGHT;
+	ResetBlock(m_blocks[m_currentBlock]);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for getting memory for the current
+ *  frame.  The memory stays valid until the block of the
+ *  frame is reset, and it is never freed on its own.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	ARENA_BLOCK& block = m_blocks[m_currentBlock];
+
+	if (bytes == 0)
+	{
+		bytes = 1;
+	}
+
+	size_t offset = AlignUp(block.usedBytes, alignment);
+	block.requestedBytes = AlignUp(block.requestedBytes, alignment) + bytes;
+	if (block.requestedBytes > m_peakBytes)
+	{
+		m_peakBytes = block.requestedBytes;
+	}
+
+	if (offset + bytes <= block.capacity)
+	{
+		block.usedBytes = offset + bytes;
+		return(block.pMemory + offset);
+	}
+
+	// the allocation does not fit, so it comes from the heap until
+	// the block has grown, with room for moving it to the alignment
+	unsigned char* pMemory = new unsigned char[bytes + alignment];
+	block.overflow.push_back(pMemory);
+
+	return((void*)AlignUp((size_t)pMemory, alignment));
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// allocate the transient render data of a frame from a linear arena
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class hands out the memory for the data that only
+ *  lives for one frame by bumping an offset in a block that
+ *  was allocated up front.  There is one block per frame in
+ *  flight, so the data of the previous frame stays valid
+ *  while the next frame is built, and starting a frame resets
+ *  its block by setting the offset back to zero.  A frame
+ *  that needs more than its block holds gets the rest from
+ *  the heap, and the block is grown to the size that was
+ *  needed when it is reused, so the arena stops allocating
+ *  once the scene has reached its largest frame.  The arena
+ *  is only used by the render thread.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// constructor
+	FrameArena(size_t blockBytes);
+	// destructor
+	~FrameArena();
+
+	// frames whose data is kept at the same time
+	static const int FRAMES_IN_FLIGHT = 2;
+	// alignment of the allocations, enough for the vector types
+	static const size_t DEFAULT_ALIGNMENT = 16;
+
+private:
+	struct ARENA_BLOCK
+	{
+		unsigned char* pMemory;
+		size_t capacity;
+		// bytes handed out from the block
+		size_t usedBytes;
+		// bytes the frame asked for, including what did not fit
+		size_t requestedBytes;
+		// allocations that did not fit into the block
+		std::vector<unsigned char*> overflow;
+	};
+
+	ARENA_BLOCK m_blocks[FRAMES_IN_FLIGHT];
+	// block of the current frame
+	int m_currentBlock;
+	// most bytes that any frame asked for
+	size_t m_peakBytes;
+	// number of times that a block had to grow
+	int m_growCount;
+
+	// free the overflow of a block and grow it if it was too small
+	void ResetBlock(ARENA_BLOCK& block);
+
+public:
+	// switch to the block of the next frame and reset it
+	void BeginFrame();
+
+	// get memory that stays valid until the block is reset
+	void* Allocate(size_t bytes, size_t alignment = DEFAULT_ALIGNMENT);
+	// get memory for an array of plain data, the elements are
+	// not initialized
+	template <typename T>
+	T* AllocateArray(size_t count)
+	{
+		size_t alignment = (alignof(T) > DEFAULT_ALIGNMENT) ? alignof(T) : DEFAULT_ALIGNMENT;
+		return((T*)Allocate(sizeof(T) * count, alignment));
+	}
+
+	// bytes asked for by the current frame
+	size_t GetUsedBytes() const { return m_blocks[m_currentBlock].requestedBytes; }
+	// most bytes asked for by any frame, for checking the size
+	size_t GetPeakBytes() const { return m_peakBytes; }
+	// number of times that a block had to grow
+	int GetGrowCount() const { return m_growCount; }
+};
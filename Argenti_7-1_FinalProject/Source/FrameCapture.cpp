@@ -0,0 +1,622 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// read the rendered frames back and write them into images or a video
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <csignal>
+#endif
+
+// declaration of global variables and defines
+namespace
+{
+	// longest wait on one readback fence, in nanoseconds
+	const GLuint64 g_FenceTimeout = 1000000000;
+	// frames that can be read back before the encoder thread has
+	// written them, which bounds the memory of a slow encoder
+	const int g_EncodeFrameCount = 8;
+	// digits of the frame number in the image filenames
+	const int g_FrameNumberDigits = 5;
+	// size of the header of an uncompressed TGA file
+	const int g_TgaHeaderBytes = 18;
+
+	/***********************************************************
+	 *  OpenPipe() / ClosePipe()
+	 *
+	 *  These functions are used for starting a command with a
+	 *  pipe into its standard input, and for waiting for it to
+	 *  finish.  The exit status of the command is returned.
+	 ***********************************************************/
+	FILE* OpenPipe(const std::string& command)
+	{
+#ifdef _WIN32
+		return(_popen(command.c_str(), "wb"));
+#else
+		// a command that exits early must not end the program
+		// with the signal of the broken pipe
+		signal(SIGPIPE, SIG_IGN);
+		return(popen(command.c_str(), "w"));
+#endif
+	}
+
+	int ClosePipe(FILE* pPipe)
+	{
+#ifdef _WIN32
+		return(_pclose(pPipe));
+#else
+		return(pclose(pPipe));
+#endif
+	}
+
+	/***********************************************************
+	 *  IsImageFilename()
+	 *
+	 *  This function is used for checking whether the frames
+	 *  are written as an image sequence instead of a video.
+	 ***********************************************************/
+	bool IsImageFilename(const std::string& filename)
+	{
+		if (filename.size() < 4)
+		{
+			return(false);
+		}
+
+		std::string extension = filename.substr(filename.size() - 4);
+		return((extension == ".tga") || (extension == ".TGA"));
+	}
+}
+
+/***********************************************************
+ *  FrameCapture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameCapture::FrameCapture()
+{
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+	m_frameRate = 0;
+	m_frameBytes = 0;
+	m_readbackBuffer = 0;
+	m_pReadbackMemory = NULL;
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		m_slots[i].offset = 0;
+		m_slots[i].fence = NULL;
+		m_slots[i].frameNumber = 0;
+	}
+	m_oldestSlot = 0;
+	m_slotsInFlight = 0;
+	m_capturedFrames = 0;
+	m_bVideo = false;
+	m_pPipe = NULL;
+	m_bStopEncoder = false;
+	m_bEncodeFailed = false;
+	m_encodedFrames = 0;
+}
+
+/***********************************************************
+ *  ~FrameCapture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameCapture::~FrameCapture()
+{
+	StopEncoder();
+
+	if (NULL != m_pPipe)
+	{
+		ClosePipe(m_pPipe);
+		m_pPipe = NULL;
+	}
+
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		if (NULL != m_slots[i].fence)
+		{
+			glDeleteSync(m_slots[i].fence);
+			m_slots[i].fence = NULL;
+		}
+	}
+
+	if (0 != m_readbackBuffer)
+	{
+		if (NULL != m_pReadbackMemory)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			m_pReadbackMemory = NULL;
+		}
+		glDeleteBuffers(1, &m_readbackBuffer);
+		m_readbackBuffer = 0;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (0 != m_colorBuffer)
+	{
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		m_colorBuffer = 0;
+	}
+	if (0 != m_depthBuffer)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+
+	for (int i = 0; i < (int)m_allFrames.size(); i++)
+	{
+		delete[] m_allFrames[i];
+	}
+	m_allFrames.clear();
+	m_freeFrames.clear();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for creating the offscreen framebuffer
+ *  and the readback buffer of the passed in size, opening the
+ *  output and starting the encoder thread.  The frame rate is
+ *  the rate of the encoded video.
+ ***********************************************************/
+bool FrameCapture::Start(const char* filename, int width, int height, int frameRate)
+{
+	if ((NULL == filename) || (width <= 0) || (height <= 0) || (frameRate <= 0))
+	{
+		std::cout << "The frame capture needs a filename, a size and a frame rate" << std::endl;
+		return(false);
+	}
+
+	m_filename = filename;
+	m_bVideo = (IsImageFilename(m_filename) == false);
+	m_width = width;
+	m_height = height;
+	m_frameRate = frameRate;
+	m_frameBytes = (size_t)width * (size_t)height * 4;
+
+	if ((CreateFramebuffer() == false) || (CreateReadbackBuffer() == false))
+	{
+		return(false);
+	}
+	if ((m_bVideo == true) && (OpenVideoPipe() == false))
+	{
+		return(false);
+	}
+
+	for (int i = 0; i < g_EncodeFrameCount; i++)
+	{
+		unsigned char* pPixels = new unsigned char[m_frameBytes];
+		m_allFrames.push_back(pPixels);
+		m_freeFrames.push_back(pPixels);
+	}
+
+	m_bStopEncoder = false;
+	m_encoder = std::thread(&FrameCapture::EncoderThread, this);
+
+	std::cout << "INFO: Capturing " << width << "x" << height << " frames at " << frameRate << " fps into "
+		<< (m_bVideo ? "the video " : "the images ") << m_filename << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateFramebuffer()
+ *
+ *  This method is used for creating the offscreen framebuffer
+ *  with a color and a depth attachment of the capture size.
+ ***********************************************************/
+bool FrameCapture::CreateFramebuffer()
+{
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "The capture framebuffer is not complete, status:" << status << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateReadbackBuffer()
+ *
+ *  This method is used for creating the pixel buffer that the
+ *  frames are copied into, with one slot per frame in flight.
+ *  It stays mapped for the lifetime of the capture when
+ *  buffer storage is supported, and every slot is mapped on
+ *  its own while it is read back otherwise.
+ ***********************************************************/
+bool FrameCapture::CreateReadbackBuffer()
+{
+	const GLbitfield mapFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr bufferSize = (GLsizeiptr)(m_frameBytes * READBACK_SLOTS);
+
+	glGenBuffers(1, &m_readbackBuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+	if (GLEW_ARB_buffer_storage)
+	{
+		// the driver keeps the storage in system memory, where the
+		// CPU reads it the fastest
+		glBufferStorage(GL_PIXEL_PACK_BUFFER, bufferSize, NULL, mapFlags | GL_CLIENT_STORAGE_BIT);
+		m_pReadbackMemory = (unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bufferSize, mapFlags);
+	}
+	else
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, bufferSize, NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if ((GLEW_ARB_buffer_storage) && (NULL == m_pReadbackMemory))
+	{
+		std::cout << "Could not map the capture readback buffer" << std::endl;
+		return(false);
+	}
+
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		m_slots[i].offset = (GLintptr)(m_frameBytes * i);
+		m_slots[i].fence = NULL;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  OpenVideoPipe()
+ *
+ *  This method is used for starting ffmpeg with the raw
+ *  pixels of the frames as its input.  The rows are read
+ *  bottom up, so ffmpeg flips the frames, and trims them to
+ *  an even size for the 4:2:0 encoding.
+ ***********************************************************/
+bool FrameCapture::OpenVideoPipe()
+{
+	std::ostringstream command;
+
+	command << "ffmpeg -loglevel error -y"
+		<< " -f rawvideo -pix_fmt bgra -s " << m_width << "x" << m_height
+		<< " -r " << m_frameRate << " -i -"
+		<< " -vf \"vflip,crop=trunc(iw/2)*2:trunc(ih/2)*2\""
+		<< " -c:v libx264 -pix_fmt yuv420p \"" << m_filename << "\"";
+
+	m_pPipe = OpenPipe(command.str());
+	if (NULL == m_pPipe)
+	{
+		std::cout << "Could not start ffmpeg to encode the video:" << m_filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the offscreen framebuffer,
+ *  which the next frame is rendered into.
+ ***********************************************************/
+void FrameCapture::BeginFrame()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for queueing the copy of the rendered
+ *  frame into the next readback slot.  The copy only runs
+ *  once the GPU has finished the frame, so the CPU only waits
+ *  for it when all the slots are in flight.  The copies that
+ *  have finished in the meantime are handed to the encoder
+ *  thread in the order of their frames.  False is returned
+ *  once a frame could not be written.
+ ***********************************************************/
+bool FrameCapture::CaptureFrame()
+{
+	if (0 == m_readbackBuffer)
+	{
+		return(false);
+	}
+
+	if (m_slotsInFlight == READBACK_SLOTS)
+	{
+		ReadBackOldest(true);
+	}
+
+	READBACK_SLOT& slot = m_slots[(m_oldestSlot + m_slotsInFlight) % READBACK_SLOTS];
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+	glReadPixels(0, 0, m_width, m_height, GL_BGRA, GL_UNSIGNED_BYTE, (void*)slot.offset);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.frameNumber = m_capturedFrames;
+	m_capturedFrames++;
+	m_slotsInFlight++;
+
+	while (ReadBackOldest(false) == true)
+	{
+	}
+
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	return(m_bEncodeFailed == false);
+}
+
+/***********************************************************
+ *  ReadBackOldest()
+ *
+ *  This method is used for copying the pixels of the oldest
+ *  slot in flight into a free frame of the encoder thread.
+ *  Without bWait nothing is done while the GPU is still busy
+ *  with the copy.  The GL thread waits for a free frame when
+ *  the encoder thread falls behind, so a capture that is
+ *  faster than the encoder does not use more memory.
+ ***********************************************************/
+bool FrameCapture::ReadBackOldest(bool bWait)
+{
+	if (m_slotsInFlight == 0)
+	{
+		return(false);
+	}
+
+	READBACK_SLOT& slot = m_slots[m_oldestSlot];
+	GLenum waitResult = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, bWait ? g_FenceTimeout : 0);
+	while ((waitResult == GL_TIMEOUT_EXPIRED) && (bWait == true))
+	{
+		waitResult = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+	}
+	if (waitResult == GL_TIMEOUT_EXPIRED)
+	{
+		return(false);
+	}
+	if (waitResult == GL_WAIT_FAILED)
+	{
+		std::cout << "Waiting for the readback of the captured frame " << slot.frameNumber << " failed" << std::endl;
+	}
+	glDeleteSync(slot.fence);
+	slot.fence = NULL;
+
+	unsigned char* pPixels = NULL;
+	{
+		std::unique_lock<std::mutex> lock(m_queueMutex);
+		m_frameFreed.wait(lock, [this] { return (m_freeFrames.empty() == false); });
+		pPixels = m_freeFrames.back();
+		m_freeFrames.pop_back();
+	}
+
+	if (NULL != m_pReadbackMemory)
+	{
+		memcpy(pPixels, m_pReadbackMemory + slot.offset, m_frameBytes);
+	}
+	else
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+		void* pSource = glMapBufferRange(GL_PIXEL_PACK_BUFFER, slot.offset, (GLsizeiptr)m_frameBytes, GL_MAP_READ_BIT);
+		if (NULL != pSource)
+		{
+			memcpy(pPixels, pSource, m_frameBytes);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	ENCODE_FRAME frame;
+	frame.frameNumber = slot.frameNumber;
+	frame.pPixels = pPixels;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_encodeQueue.push_back(frame);
+	}
+	m_frameAvailable.notify_one();
+
+	m_oldestSlot = (m_oldestSlot + 1) % READBACK_SLOTS;
+	m_slotsInFlight--;
+
+	return(true);
+}
+
+/***********************************************************
+ *  EncoderThread()
+ *
+ *  This method is the loop of the encoder thread.  The frames
+ *  are written in the order they were read back, and their
+ *  memory is handed back to the GL thread afterwards.  The
+ *  thread finishes once it is asked to stop and all the
+ *  queued frames are written.
+ ***********************************************************/
+void FrameCapture::EncoderThread()
+{
+	while (true)
+	{
+		ENCODE_FRAME frame;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_frameAvailable.wait(lock, [this] { return (m_bStopEncoder == true) || (m_encodeQueue.empty() == false); });
+			if (m_encodeQueue.empty() == true)
+			{
+				return;
+			}
+			frame = m_encodeQueue.front();
+			m_encodeQueue.pop_front();
+		}
+
+		// the frames after a failed one are only dropped
+		bool bWritten = false;
+		if (m_bEncodeFailed == false)
+		{
+			bWritten = EncodeFrame(frame);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			if (bWritten == true)
+			{
+				m_encodedFrames++;
+			}
+			else
+			{
+				m_bEncodeFailed = true;
+			}
+			m_freeFrames.push_back(frame.pPixels);
+		}
+		m_frameFreed.notify_one();
+	}
+}
+
+/***********************************************************
+ *  EncodeFrame()
+ *
+ *  This method is used for writing the pixels of one frame
+ *  into the video pipe, or into an uncompressed TGA file.
+ *  The rows of a TGA file are stored bottom up in BGRA order,
+ *  just like they are read back, so no conversion is needed.
+ ***********************************************************/
+bool FrameCapture::EncodeFrame(const ENCODE_FRAME& frame)
+{
+	if (m_bVideo == true)
+	{
+		if (fwrite(frame.pPixels, 1, m_frameBytes, m_pPipe) != m_frameBytes)
+		{
+			std::cout << "Could not write the captured frame " << frame.frameNumber << " into ffmpeg" << std::endl;
+			return(false);
+		}
+		return(true);
+	}
+
+	std::string filename = GetImageFilename(frame.frameNumber);
+	std::ofstream imageFile(filename.c_str(), std::ios::binary);
+	if (!imageFile)
+	{
+		std::cout << "Could not create the captured image:" << filename << std::endl;
+		return(false);
+	}
+
+	// an uncompressed true color image of 32 bits per pixel, with
+	// the first row at the bottom - the alpha bits are marked as
+	// unused, because the blended objects leave them below one
+	unsigned char header[g_TgaHeaderBytes] = {};
+	header[2] = 2;
+	header[12] = (unsigned char)(m_width & 0xFF);
+	header[13] = (unsigned char)((m_width >> 8) & 0xFF);
+	header[14] = (unsigned char)(m_height & 0xFF);
+	header[15] = (unsigned char)((m_height >> 8) & 0xFF);
+	header[16] = 32;
+	header[17] = 0;
+
+	imageFile.write((const char*)header, g_TgaHeaderBytes);
+	imageFile.write((const char*)frame.pPixels, (std::streamsize)m_frameBytes);
+	if (!imageFile)
+	{
+		std::cout << "Could not write the captured image:" << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetImageFilename()
+ *
+ *  This method is used for getting the name of the image file
+ *  of a frame, which is the capture filename with the frame
+ *  number in front of the extension.
+ ***********************************************************/
+std::string FrameCapture::GetImageFilename(int frameNumber) const
+{
+	std::ostringstream filename;
+
+	filename << m_filename.substr(0, m_filename.size() - 4)
+		<< "_" << std::setw(g_FrameNumberDigits) << std::setfill('0') << frameNumber
+		<< m_filename.substr(m_filename.size() - 4);
+
+	return(filename.str());
+}
+
+/***********************************************************
+ *  StopEncoder()
+ *
+ *  This method is used for asking the encoder thread to stop
+ *  once it has written the queued frames, and for waiting
+ *  until it has finished.
+ ***********************************************************/
+void FrameCapture::StopEncoder()
+{
+	if (m_encoder.joinable() == false)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_bStopEncoder = true;
+	}
+	m_frameAvailable.notify_all();
+	m_encoder.join();
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for reading back the frames that are
+ *  still in flight, waiting until the encoder thread has
+ *  written all of them and closing the output.  For a video
+ *  it waits until ffmpeg has finished the file.
+ ***********************************************************/
+bool FrameCapture::Finish()
+{
+	while (ReadBackOldest(true) == true)
+	{
+	}
+	StopEncoder();
+
+	bool bSuccess = (m_bEncodeFailed == false);
+	if (NULL != m_pPipe)
+	{
+		int exitStatus = ClosePipe(m_pPipe);
+		m_pPipe = NULL;
+		if (exitStatus != 0)
+		{
+			std::cout << "ffmpeg could not encode the video:" << m_filename << ", exit status:" << exitStatus << std::endl;
+			bSuccess = false;
+		}
+	}
+
+	std::cout << "INFO: Captured " << m_encodedFrames << " of " << m_capturedFrames << " frames into " << m_filename << std::endl;
+
+	return(bSuccess);
+}
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// read the rendered frames back and write them into images or a video
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class renders the frames into an offscreen
+ *  framebuffer and copies every frame into a ring of pixel
+ *  buffers, with a fence per copy.  A frame is only read
+ *  from its buffer once its fence has passed, so the CPU
+ *  does not wait for the GPU to finish the frame it has just
+ *  queued.  The pixels are handed to an encoder thread, which
+ *  writes them as a numbered sequence of TGA images, or pipes
+ *  them into ffmpeg to be encoded into a video file.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// constructor
+	FrameCapture();
+	// destructor
+	~FrameCapture();
+
+	// frames that are copied into the pixel buffers before the
+	// oldest one has to be read back
+	static const int READBACK_SLOTS = 3;
+
+private:
+	// one region of the readback buffer with the fence of its copy
+	struct READBACK_SLOT
+	{
+		GLintptr offset;
+		GLsync fence;
+		int frameNumber;
+	};
+
+	// a frame that has been read back for the encoder thread
+	struct ENCODE_FRAME
+	{
+		int frameNumber;
+		unsigned char* pPixels;
+	};
+
+	// the offscreen framebuffer and its attachments
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+	int m_frameRate;
+	size_t m_frameBytes;
+
+	// the pixel buffer holding the slots, persistently mapped when
+	// buffer storage is supported
+	GLuint m_readbackBuffer;
+	unsigned char* m_pReadbackMemory;
+	READBACK_SLOT m_slots[READBACK_SLOTS];
+	int m_oldestSlot;
+	int m_slotsInFlight;
+	int m_capturedFrames;
+
+	// the image files or the video file the frames are written to
+	std::string m_filename;
+	bool m_bVideo;
+	FILE* m_pPipe;
+
+	// encoder thread and the frames shared with it
+	std::thread m_encoder;
+	std::mutex m_queueMutex;
+	std::condition_variable m_frameAvailable;
+	std::condition_variable m_frameFreed;
+	std::deque<ENCODE_FRAME> m_encodeQueue;
+	std::vector<unsigned char*> m_freeFrames;
+	std::vector<unsigned char*> m_allFrames;
+	bool m_bStopEncoder;
+	bool m_bEncodeFailed;
+	int m_encodedFrames;
+
+	// write the frames that are read back until the capture ends
+	void EncoderThread();
+	// create the offscreen framebuffer and the readback buffer
+	bool CreateFramebuffer();
+	bool CreateReadbackBuffer();
+	// start ffmpeg with the pixels of the frames as its input
+	bool OpenVideoPipe();
+	// hand the oldest copied frame to the encoder thread, false when
+	// bWait is false and the GPU has not finished the copy yet
+	bool ReadBackOldest(bool bWait);
+	// write one frame into its image file or into the video pipe
+	bool EncodeFrame(const ENCODE_FRAME& frame);
+	// name of the image file of a frame
+	std::string GetImageFilename(int frameNumber) const;
+	// finish writing the queued frames and stop the encoder thread
+	void StopEncoder();
+
+	// the encoder thread can not be shared between two objects
+	FrameCapture(const FrameCapture&);
+	FrameCapture& operator=(const FrameCapture&);
+
+public:
+	// start capturing frames of the passed in size - a filename
+	// ending in .tga is written as a numbered image sequence, and
+	// any other filename is encoded into a video by ffmpeg
+	bool Start(const char* filename, int width, int height, int frameRate);
+
+	// bind the offscreen framebuffer for the next frame
+	void BeginFrame();
+	// queue the copy of the finished frame, and hand the copies
+	// that the GPU has finished to the encoder thread
+	bool CaptureFrame();
+	// write all the captured frames and close the output
+	bool Finish();
+
+	// number of frames that have been captured
+	int GetCapturedFrames() const { return m_capturedFrames; }
+};
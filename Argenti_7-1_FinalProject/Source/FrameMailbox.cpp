@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// framemailbox.cpp
+// ============
+// hand the latest frame snapshot from the simulation to the renderer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameMailbox.h"
+
+/***********************************************************
+ *  FrameMailbox()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameMailbox::FrameMailbox()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		m_slots[i].view = glm::mat4(1.0f);
+		m_slots[i].projection = glm::mat4(1.0f);
+		m_slots[i].viewPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+		m_slots[i].stepNumber = 0;
+		m_slots[i].simulationTime = 0.0;
+	}
+	m_writeSlot = 0;
+	m_readySlot.store(1);
+	m_readSlot = 2;
+}
+
+/***********************************************************
+ *  ~FrameMailbox()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameMailbox::~FrameMailbox()
+{
+}
+
+/***********************************************************
+ *  Publish()
+ *
+ *  This method is used for making the slot that the producer
+ *  has filled in the latest snapshot.  The producer gets the
+ *  previous ready slot back to write the next snapshot into.
+ *  The release order makes the written snapshot visible to
+ *  the consumer before the new index is.
+ ***********************************************************/
+void FrameMailbox::Publish()
+{
+	int previous = m_readySlot.exchange(m_writeSlot | FRESH_BIT, std::memory_order_acq_rel);
+	m_writeSlot = previous & SLOT_MASK;
+}
+
+/***********************************************************
+ *  AcquireLatest()
+ *
+ *  This method is used for swapping the slot of the consumer
+ *  with the latest published snapshot.  False is returned
+ *  when nothing was published since the last call, and the
+ *  consumer keeps reading the snapshot it already has.
+ ***********************************************************/
+bool FrameMailbox::AcquireLatest()
+{
+	if ((m_readySlot.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+	{
+		return(false);
+	}
+
+	int previous = m_readySlot.exchange(m_readSlot, std::memory_order_acq_rel);
+	m_readSlot = previous & SLOT_MASK;
+
+	return(true);
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// framemailbox.h
+// ============
+// hand the latest frame snapshot from the simulation to the renderer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+
+/***********************************************************
+ *  FrameMailbox
+ *
+ *  This class is a lock-free triple buffer of frame
+ *  snapshots with one producer and one consumer.  The
+ *  producer always has a slot to write into and the consumer
+ *  always has a slot to read from, and the third slot holds
+ *  the latest published snapshot.  Publishing and acquiring
+ *  only swap slot indices with one atomic exchange, so
+ *  neither side ever waits for the other, and the consumer
+ *  skips the snapshots that it was too slow to see.
+ ***********************************************************/
+class FrameMailbox
+{
+public:
+	// constructor
+	FrameMailbox();
+	// destructor
+	~FrameMailbox();
+
+	// everything the renderer needs from one simulation step -
+	// the scene transforms and the lights are set up once when
+	// the scene is prepared, so only the camera changes
+	struct FRAME_SNAPSHOT
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 viewPosition;
+		// number of the simulation step, starting at 1
+		unsigned int stepNumber;
+		// seconds of simulation time at the end of the step
+		double simulationTime;
+	};
+
+private:
+	// the low bits of the ready index select a slot, and the fresh
+	// bit is set while the consumer has not seen the slot yet
+	static const int SLOT_MASK = 3;
+	static const int FRESH_BIT = 4;
+
+	FRAME_SNAPSHOT m_slots[3];
+	// slot owned by the producer
+	int m_writeSlot;
+	// slot owned by the consumer
+	int m_readSlot;
+	// slot of the latest published snapshot
+	std::atomic<int> m_readySlot;
+
+public:
+	// get the slot to fill in - only called by the producer
+	FRAME_SNAPSHOT& BeginWrite() { return m_slots[m_writeSlot]; }
+	// make the filled in slot the latest snapshot
+	void Publish();
+
+	// switch to the latest snapshot if a new one was published
+	// since the last call - only called by the consumer
+	bool AcquireLatest();
+	// get the acquired snapshot - only called by the consumer
+	const FRAME_SNAPSHOT& GetLatest() const { return m_slots[m_readSlot]; }
+};
@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// space the presented frames with vsync, adaptive sync or a frame deadline
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables and defines
+namespace
+{
+	// the sleep can wake up late, so the last part of the wait
+	// before a deadline is spent yielding instead
+	const std::chrono::microseconds g_SpinMargin(1000);
+
+	// command line names in the same order as the PACING_MODE values
+	const char* g_ModeNames[] =
+	{
+		"vsync",
+		"adaptive",
+		"sleep",
+		"uncapped"
+	};
+	const int g_ModeCount = sizeof(g_ModeNames) / sizeof(g_ModeNames[0]);
+}
+
+/***********************************************************
+ *  FramePacer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacer::FramePacer()
+{
+	m_mode = PACING_VSYNC;
+	m_targetFrameTime = 1000.0 / 60.0;
+	m_bDeadlineSet = false;
+
+#ifdef _WIN32
+	// the default timer of Windows only wakes a sleep up every
+	// 15.6 ms, which is too coarse for the frame deadlines
+	timeBeginPeriod(1);
+#endif
+}
+
+/***********************************************************
+ *  ~FramePacer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+/***********************************************************
+ *  SetMode()
+ *
+ *  This method is used for selecting how the frames are
+ *  paced.  The swap interval is set by the next Apply().
+ ***********************************************************/
+void FramePacer::SetMode(PACING_MODE mode)
+{
+	m_mode = mode;
+	m_bDeadlineSet = false;
+}
+
+/***********************************************************
+ *  SetTargetFrameTime()
+ *
+ *  This method is used for setting the time between two
+ *  frames of the deadline mode, in milliseconds.
+ ***********************************************************/
+void FramePacer::SetTargetFrameTime(double milliseconds)
+{
+	if (milliseconds > 0.0)
+	{
+		m_targetFrameTime = milliseconds;
+	}
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for setting the swap interval of the
+ *  context that is current on the calling thread.  Adaptive
+ *  sync needs the swap control tear extension, and falls
+ *  back to vsync without it.
+ ***********************************************************/
+void FramePacer::Apply()
+{
+	int swapInterval = 1;
+
+	switch (m_mode)
+	{
+	case PACING_ADAPTIVE_SYNC:
+		if ((glfwExtensionSupported("WGL_EXT_swap_control_tear") == GLFW_TRUE) ||
+			(glfwExtensionSupported("GLX_EXT_swap_control_tear") == GLFW_TRUE))
+		{
+			swapInterval = -1;
+		}
+		else
+		{
+			std::cout << "Adaptive sync is not supported by the driver, the frames are paced with vsync" << std::endl;
+		}
+		break;
+	case PACING_SLEEP_UNTIL_DEADLINE:
+	case PACING_UNCAPPED:
+		swapInterval = 0;
+		break;
+	default:
+		break;
+	}
+
+	glfwSwapInterval(swapInterval);
+	m_bDeadlineSet = false;
+}
+
+/***********************************************************
+ *  WaitForNextFrame()
+ *
+ *  This method is used for waiting until the next frame is
+ *  due in the deadline mode.  The deadlines are spaced by the
+ *  target frame time from the first frame on, so a short
+ *  frame does not move them.  A frame that misses its
+ *  deadline by more than a whole frame starts the deadlines
+ *  over, instead of rushing the next frames to catch up.
+ ***********************************************************/
+void FramePacer::WaitForNextFrame()
+{
+	if (m_mode != PACING_SLEEP_UNTIL_DEADLINE)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::duration frameTime =
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double, std::milli>(m_targetFrameTime));
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (m_bDeadlineSet == false)
+	{
+		m_deadline = now + frameTime;
+		m_bDeadlineSet = true;
+	}
+	if (now > m_deadline + frameTime)
+	{
+		m_deadline = now + frameTime;
+	}
+
+	if (m_deadline - now > g_SpinMargin)
+	{
+		std::this_thread::sleep_until(m_deadline - g_SpinMargin);
+	}
+	while (std::chrono::steady_clock::now() < m_deadline)
+	{
+		std::this_thread::yield();
+	}
+
+	m_deadline += frameTime;
+}
+
+/***********************************************************
+ *  ParseMode()
+ *
+ *  This method is used for getting the pacing mode of a name
+ *  of the --pacing command line option.
+ ***********************************************************/
+bool FramePacer::ParseMode(const char* name, PACING_MODE& mode)
+{
+	for (int i = 0; i < g_ModeCount; i++)
+	{
+		if (strcmp(name, g_ModeNames[i]) == 0)
+		{
+			mode = (PACING_MODE)i;
+			return(true);
+		}
+	}
+
+	std::cout << "Unknown frame pacing mode:" << name << ", the modes are vsync, adaptive, sleep and uncapped" << std::endl;
+	return(false);
+}
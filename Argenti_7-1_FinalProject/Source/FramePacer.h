@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// space the presented frames with vsync, adaptive sync or a frame deadline
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+
+/***********************************************************
+ *  FramePacer
+ *
+ *  This class decides when the next frame is started.  With
+ *  vsync the swap waits for the display refresh, and with
+ *  adaptive sync it only waits while the frames are on time,
+ *  so a late frame tears instead of waiting for the next
+ *  refresh.  The deadline mode does not wait on the display
+ *  at all and sleeps until the next multiple of the target
+ *  frame time instead, which keeps the frame rate steady
+ *  below the refresh rate of the display.
+ ***********************************************************/
+class FramePacer
+{
+public:
+	// constructor
+	FramePacer();
+	// destructor
+	~FramePacer();
+
+	// ways of pacing the frames
+	enum PACING_MODE
+	{
+		PACING_VSYNC = 0,
+		PACING_ADAPTIVE_SYNC,
+		PACING_SLEEP_UNTIL_DEADLINE,
+		PACING_UNCAPPED
+	};
+
+private:
+	PACING_MODE m_mode;
+	// time between two frames in the deadline mode, in milliseconds
+	double m_targetFrameTime;
+	// start of the next frame in the deadline mode
+	std::chrono::steady_clock::time_point m_deadline;
+	bool m_bDeadlineSet;
+
+public:
+	// select the pacing mode - applied by the next Apply()
+	void SetMode(PACING_MODE mode);
+	PACING_MODE GetMode() const { return m_mode; }
+	// time between two frames in the deadline mode, in milliseconds
+	void SetTargetFrameTime(double milliseconds);
+
+	// set the swap interval of the pacing mode - must be called on
+	// the thread that the OpenGL context is current on
+	void Apply();
+	// wait until the next frame is due, after the swap
+	void WaitForNextFrame();
+
+	// get the mode of a command line name - false is returned when
+	// the name is not known
+	static bool ParseMode(const char* name, PACING_MODE& mode);
+};
@@ -0,0 +1,727 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// measure the CPU and GPU time of the parts of every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables and defines
+namespace
+{
+	// zone names in the same order as the PROFILE_ZONE values
+	const char* g_ZoneNames[FrameProfiler::ZONE_COUNT] =
+	{
+		"PrepareSceneView",
+		"RenderScene",
+		"RenderDesktop",
+		"RenderLegoMan",
+		"RenderSodaCan",
+		"RenderHeadPhones",
+		"RenderLampBase",
+		"RecordCommandLists",
+		"AssignLights",
+		"ExecuteRenderQueue",
+		"Upscale",
+		"CaptureFrame",
+		"SwapBuffers",
+		"PaceFrame",
+		"PollEvents"
+	};
+
+	// zones that issue GL commands and get a GPU timer query - the
+	// queries can not be nested, so only one of any nested zones
+	const bool g_GpuZones[FrameProfiler::ZONE_COUNT] =
+	{
+		true,		// PrepareSceneView
+		false,		// RenderScene
+		false,		// RenderDesktop
+		false,		// RenderLegoMan
+		false,		// RenderSodaCan
+		false,		// RenderHeadPhones
+		false,		// RenderLampBase
+		false,		// RecordCommandLists
+		true,		// AssignLights
+		true,		// ExecuteRenderQueue
+		true,		// Upscale
+		false,		// CaptureFrame
+		false,		// SwapBuffers
+		false,		// PaceFrame
+		false		// PollEvents
+	};
+
+	// counter names in the same order as the PROFILE_COUNTER values
+	const char* g_CounterNames[FrameProfiler::COUNTER_COUNT] =
+	{
+		"draw_calls",
+		"uniform_uploads",
+		"frame_arena_kb",
+		"shaded_ksamples",
+		"prepass_ksamples",
+		"overdraw_saved_ksamples",
+		"render_scale_percent",
+		"render_packets",
+		"instanced_draws",
+		"indirect_draws",
+		"state_changes",
+		"saved_state_changes",
+		"culled_objects",
+		"resident_meshes",
+		"mesh_draw_loads",
+		"texture_resident_kb",
+		"texture_pending_loads",
+		"texture_evicted_levels"
+	};
+
+	// frames kept in flight before their GPU queries are read
+	const int g_QueryFrames = 4;
+	// the overlay shows the averages over this interval
+	const double g_OverlayIntervalMicroseconds = 500000.0;
+	// size of the overlay bars in pixels
+	const int g_BarMargin = 10;
+	const int g_BarHeight = 4;
+	const int g_BarRowHeight = 11;
+	const float g_PixelsPerMillisecond = 20.0f;
+	// frame time of 60 frames per second, marked in the overlay
+	const float g_FrameBudgetMilliseconds = 1000.0f / 60.0f;
+}
+
+/***********************************************************
+ *  FrameProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameProfiler::FrameProfiler()
+{
+	m_startTime = std::chrono::steady_clock::now();
+	m_currentFrame = 0;
+	m_frameNumber = 0;
+	m_bInFrame = false;
+	m_activeGpuZone = -1;
+	m_activeSampleCounter = -1;
+	m_frameSum = 0.0;
+	m_gpuFrameSum = 0.0;
+	m_sumCount = 0;
+	m_lastOverlayUpdate = 0.0;
+	m_frameAverage = 0.0;
+	m_gpuFrameAverage = 0.0;
+	m_latestGpuFrameTime = 0.0;
+	m_bFirstTraceEvent = true;
+
+	for (int i = 0; i < ZONE_COUNT; i++)
+	{
+		m_zoneStart[i] = 0.0;
+		m_zoneSums[i].cpuMilliseconds = 0.0;
+		m_zoneSums[i].gpuMilliseconds = 0.0;
+		m_zoneAverages[i].cpuMilliseconds = 0.0;
+		m_zoneAverages[i].gpuMilliseconds = 0.0;
+	}
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_counterSums[i] = 0;
+		m_counterAverages[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~FrameProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameProfiler::~FrameProfiler()
+{
+	for (int i = 0; i < (int)m_frames.size(); i++)
+	{
+		glDeleteQueries(ZONE_COUNT, m_frames[i].queries);
+		glDeleteQueries(COUNTER_COUNT, m_frames[i].sampleQueries);
+	}
+	m_frames.clear();
+
+	if (m_csvFile.is_open())
+	{
+		m_csvFile.close();
+	}
+	if (m_traceFile.is_open())
+	{
+		m_traceFile << "\n]\n";
+		m_traceFile.close();
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the GPU timer and sample
+ *  queries of all the frames in flight.
+ ***********************************************************/
+bool FrameProfiler::Initialize()
+{
+	m_frames.resize(g_QueryFrames);
+	for (int i = 0; i < g_QueryFrames; i++)
+	{
+		FRAME_RECORD& frame = m_frames[i];
+		frame.bValid = false;
+		frame.frameNumber = 0;
+		frame.startMicroseconds = 0.0;
+		frame.frameMicroseconds = 0.0;
+		glGenQueries(ZONE_COUNT, frame.queries);
+		glGenQueries(COUNTER_COUNT, frame.sampleQueries);
+		for (int zone = 0; zone < ZONE_COUNT; zone++)
+		{
+			frame.cpuMicroseconds[zone] = 0.0;
+			frame.gpuMicroseconds[zone] = -1.0;
+			frame.bQueryIssued[zone] = false;
+		}
+		for (int counter = 0; counter < COUNTER_COUNT; counter++)
+		{
+			frame.counters[counter] = 0;
+			frame.bSampleQueryIssued[counter] = false;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  OpenCsvFile()
+ *
+ *  This method is used for streaming one line per frame with
+ *  the zone times and counters into a CSV file.
+ ***********************************************************/
+bool FrameProfiler::OpenCsvFile(const char* filename)
+{
+	m_csvFile.open(filename, std::ios::trunc);
+	if (!m_csvFile)
+	{
+		std::cout << "Could not open the profiler CSV file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_csvFile << "frame,frame_ms";
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_csvFile << "," << g_CounterNames[i];
+	}
+	for (int i = 0; i < ZONE_COUNT; i++)
+	{
+		m_csvFile << "," << g_ZoneNames[i] << "_cpu_ms";
+		if (g_GpuZones[i] == true)
+		{
+			m_csvFile << "," << g_ZoneNames[i] << "_gpu_ms";
+		}
+	}
+	m_csvFile << "\n";
+
+	return(true);
+}
+
+/***********************************************************
+ *  OpenTraceFile()
+ *
+ *  This method is used for streaming the zones of every frame
+ *  into a file in the Chrome trace event format, which can be
+ *  opened in chrome://tracing or Perfetto.
+ ***********************************************************/
+bool FrameProfiler::OpenTraceFile(const char* filename)
+{
+	m_traceFile.open(filename, std::ios::trunc);
+	if (!m_traceFile)
+	{
+		std::cout << "Could not open the profiler trace file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_traceFile << "[\n";
+	m_bFirstTraceEvent = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetMicroseconds()
+ *
+ *  This method is used for getting the CPU time since the
+ *  profiler was created.
+ ***********************************************************/
+double FrameProfiler::GetMicroseconds() const
+{
+	std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - m_startTime;
+
+	return(elapsed.count());
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the measurements of a new
+ *  frame.  The frame that used the same queries before is
+ *  resolved first.
+ ***********************************************************/
+void FrameProfiler::BeginFrame()
+{
+	if (m_frames.empty() == true)
+	{
+		return;
+	}
+
+	m_currentFrame = (int)(m_frameNumber % g_QueryFrames);
+	FRAME_RECORD& frame = m_frames[m_currentFrame];
+
+	if (frame.bValid == true)
+	{
+		ResolveFrame(frame);
+	}
+
+	frame.bValid = true;
+	frame.frameNumber = m_frameNumber;
+	frame.startMicroseconds = GetMicroseconds();
+	frame.frameMicroseconds = 0.0;
+	frame.events.clear();
+	for (int zone = 0; zone < ZONE_COUNT; zone++)
+	{
+		frame.cpuMicroseconds[zone] = 0.0;
+		frame.gpuMicroseconds[zone] = -1.0;
+		frame.bQueryIssued[zone] = false;
+	}
+	for (int counter = 0; counter < COUNTER_COUNT; counter++)
+	{
+		frame.counters[counter] = 0;
+		frame.bSampleQueryIssued[counter] = false;
+	}
+
+	m_bInFrame = true;
+	m_frameNumber++;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the measurements of the
+ *  current frame.
+ ***********************************************************/
+void FrameProfiler::EndFrame()
+{
+	if (m_bInFrame == false)
+	{
+		return;
+	}
+
+	FRAME_RECORD& frame = m_frames[m_currentFrame];
+	frame.frameMicroseconds = GetMicroseconds() - frame.startMicroseconds;
+	m_bInFrame = false;
+}
+
+/***********************************************************
+ *  BeginZone()
+ *
+ *  This method is used for starting the measurement of a
+ *  zone.  GPU zones also start their timer query, unless
+ *  another GPU zone is still open.
+ ***********************************************************/
+void FrameProfiler::BeginZone(PROFILE_ZONE zone)
+{
+	if ((m_bInFrame == false) || (zone < 0) || (zone >= ZONE_COUNT))
+	{
+		return;
+	}
+
+	FRAME_RECORD& frame = m_frames[m_currentFrame];
+
+	if ((g_GpuZones[zone] == true) &&
+		(m_activeGpuZone < 0) &&
+		(frame.bQueryIssued[zone] == false))
+	{
+		glBeginQuery(GL_TIME_ELAPSED, frame.queries[zone]);
+		frame.bQueryIssued[zone] = true;
+		m_activeGpuZone = zone;
+	}
+
+	m_zoneStart[zone] = GetMicroseconds();
+}
+
+/***********************************************************
+ *  EndZone()
+ *
+ *  This method is used for finishing the measurement of a
+ *  zone.
+ ***********************************************************/
+void FrameProfiler::EndZone(PROFILE_ZONE zone)
+{
+	if ((m_bInFrame == false) || (zone < 0) || (zone >= ZONE_COUNT))
+	{
+		return;
+	}
+
+	FRAME_RECORD& frame = m_frames[m_currentFrame];
+	ZONE_EVENT event;
+	event.zone = zone;
+	event.startMicroseconds = m_zoneStart[zone];
+	event.durationMicroseconds = GetMicroseconds() - m_zoneStart[zone];
+	frame.events.push_back(event);
+	frame.cpuMicroseconds[zone] += event.durationMicroseconds;
+
+	if (m_activeGpuZone == zone)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_activeGpuZone = -1;
+	}
+}
+
+/***********************************************************
+ *  SetCounter()
+ *
+ *  This method is used for setting a counted event of the
+ *  current frame.
+ ***********************************************************/
+void FrameProfiler::SetCounter(PROFILE_COUNTER counter, int value)
+{
+	if ((m_bInFrame == false) || (counter < 0) || (counter >= COUNTER_COUNT))
+	{
+		return;
+	}
+
+	m_frames[m_currentFrame].counters[counter] = value;
+}
+
+/***********************************************************
+ *  BeginSampleCount()
+ *
+ *  This method is used for starting to count the samples
+ *  that pass the depth test into a counter of the current
+ *  frame.  The count is read with the timer queries when the
+ *  frame is resolved, and it is skipped while another count
+ *  is still running.
+ ***********************************************************/
+void FrameProfiler::BeginSampleCount(PROFILE_COUNTER counter)
+{
+	if ((m_bInFrame == false) || (counter < 0) || (counter >= COUNTER_COUNT))
+	{
+		return;
+	}
+
+	FRAME_RECORD& frame = m_frames[m_currentFrame];
+
+	if ((m_activeSampleCounter < 0) && (frame.bSampleQueryIssued[counter] == false))
+	{
+		glBeginQuery(GL_SAMPLES_PASSED, frame.sampleQueries[counter]);
+		frame.bSampleQueryIssued[counter] = true;
+		m_activeSampleCounter = counter;
+	}
+}
+
+/***********************************************************
+ *  EndSampleCount()
+ *
+ *  This method is used for finishing the sample count of a
+ *  counter.
+ ***********************************************************/
+void FrameProfiler::EndSampleCount(PROFILE_COUNTER counter)
+{
+	if (m_activeSampleCounter == counter)
+	{
+		glEndQuery(GL_SAMPLES_PASSED);
+		m_activeSampleCounter = -1;
+	}
+}
+
+/***********************************************************
+ *  ResolveFrame()
+ *
+ *  This method is used for reading the GPU query results of
+ *  a finished frame.  A query that is still not available
+ *  after all the frames in flight is skipped instead of
+ *  waited on.  The overdraw that the depth pre-pass saved is
+ *  the difference between the samples of the pre-pass, which
+ *  the lit pass would have shaded without it, and the samples
+ *  that were shaded.  The frame is then added to the averages
+ *  and written to the output files.
+ ***********************************************************/
+void FrameProfiler::ResolveFrame(FRAME_RECORD& frame)
+{
+	double gpuFrameMicroseconds = 0.0;
+	bool bGpuTimeRead = false;
+
+	for (int zone = 0; zone < ZONE_COUNT; zone++)
+	{
+		if (frame.bQueryIssued[zone] == false)
+		{
+			continue;
+		}
+
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(frame.queries[zone], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == GL_TRUE)
+		{
+			GLuint64 elapsedNanoseconds = 0;
+			glGetQueryObjectui64v(frame.queries[zone], GL_QUERY_RESULT, &elapsedNanoseconds);
+			frame.gpuMicroseconds[zone] = (double)elapsedNanoseconds / 1000.0;
+			gpuFrameMicroseconds += frame.gpuMicroseconds[zone];
+			bGpuTimeRead = true;
+		}
+	}
+
+	bool bSamplesCounted[COUNTER_COUNT];
+	for (int counter = 0; counter < COUNTER_COUNT; counter++)
+	{
+		bSamplesCounted[counter] = false;
+		if (frame.bSampleQueryIssued[counter] == false)
+		{
+			continue;
+		}
+
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(frame.sampleQueries[counter], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == GL_TRUE)
+		{
+			GLuint64 sampleCount = 0;
+			glGetQueryObjectui64v(frame.sampleQueries[counter], GL_QUERY_RESULT, &sampleCount);
+			frame.counters[counter] = (int)(sampleCount / 1000);
+			bSamplesCounted[counter] = true;
+		}
+	}
+	if ((bSamplesCounted[COUNTER_PREPASS_KILOSAMPLES] == true) &&
+		(bSamplesCounted[COUNTER_SHADED_KILOSAMPLES] == true))
+	{
+		frame.counters[COUNTER_OVERDRAW_SAVED_KILOSAMPLES] =
+			frame.counters[COUNTER_PREPASS_KILOSAMPLES] - frame.counters[COUNTER_SHADED_KILOSAMPLES];
+	}
+
+	for (int zone = 0; zone < ZONE_COUNT; zone++)
+	{
+		m_zoneSums[zone].cpuMilliseconds += frame.cpuMicroseconds[zone] / 1000.0;
+		if (frame.gpuMicroseconds[zone] >= 0.0)
+		{
+			m_zoneSums[zone].gpuMilliseconds += frame.gpuMicroseconds[zone] / 1000.0;
+		}
+	}
+	for (int counter = 0; counter < COUNTER_COUNT; counter++)
+	{
+		m_counterSums[counter] += frame.counters[counter];
+	}
+	m_frameSum += frame.frameMicroseconds / 1000.0;
+	m_gpuFrameSum += gpuFrameMicroseconds / 1000.0;
+	m_sumCount++;
+	if (bGpuTimeRead == true)
+	{
+		m_latestGpuFrameTime = gpuFrameMicroseconds / 1000.0;
+	}
+
+	if (m_csvFile.is_open())
+	{
+		WriteCsvFrame(frame);
+	}
+	if (m_traceFile.is_open())
+	{
+		WriteTraceFrame(frame);
+	}
+
+	frame.bValid = false;
+}
+
+/***********************************************************
+ *  WriteCsvFrame()
+ *
+ *  This method is used for writing one line with the times
+ *  and counters of a frame into the CSV file.  GPU times that
+ *  were not available are left empty.
+ ***********************************************************/
+void FrameProfiler::WriteCsvFrame(const FRAME_RECORD& frame)
+{
+	m_csvFile << frame.frameNumber << "," << std::fixed << std::setprecision(4) << frame.frameMicroseconds / 1000.0;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_csvFile << "," << frame.counters[i];
+	}
+	for (int i = 0; i < ZONE_COUNT; i++)
+	{
+		m_csvFile << "," << frame.cpuMicroseconds[i] / 1000.0;
+		if (g_GpuZones[i] == true)
+		{
+			m_csvFile << ",";
+			if (frame.gpuMicroseconds[i] >= 0.0)
+			{
+				m_csvFile << frame.gpuMicroseconds[i] / 1000.0;
+			}
+		}
+	}
+	m_csvFile << "\n";
+}
+
+/***********************************************************
+ *  WriteTraceFrame()
+ *
+ *  This method is used for writing the zones of a frame into
+ *  the trace file as complete events.  The CPU zones are on
+ *  thread 1, and the GPU zones on thread 2.  Elapsed time
+ *  queries have no start time, so a GPU zone is placed at the
+ *  start of its CPU zone.
+ ***********************************************************/
+void FrameProfiler::WriteTraceFrame(const FRAME_RECORD& frame)
+{
+	bool bGpuWritten[ZONE_COUNT] = {};
+
+	m_traceFile << std::fixed << std::setprecision(3);
+
+	for (int i = 0; i < (int)frame.events.size(); i++)
+	{
+		const ZONE_EVENT& event = frame.events[i];
+
+		m_traceFile << (m_bFirstTraceEvent ? "" : ",\n");
+		m_bFirstTraceEvent = false;
+		m_traceFile << "{\"name\":\"" << g_ZoneNames[event.zone] << "\",\"cat\":\"cpu\",\"ph\":\"X\""
+			<< ",\"ts\":" << event.startMicroseconds
+			<< ",\"dur\":" << event.durationMicroseconds
+			<< ",\"pid\":1,\"tid\":1}";
+
+		if ((frame.gpuMicroseconds[event.zone] >= 0.0) && (bGpuWritten[event.zone] == false))
+		{
+			m_traceFile << ",\n{\"name\":\"" << g_ZoneNames[event.zone] << "\",\"cat\":\"gpu\",\"ph\":\"X\""
+				<< ",\"ts\":" << event.startMicroseconds
+				<< ",\"dur\":" << frame.gpuMicroseconds[event.zone]
+				<< ",\"pid\":1,\"tid\":2}";
+			bGpuWritten[event.zone] = true;
+		}
+	}
+
+	m_traceFile << (m_bFirstTraceEvent ? "" : ",\n");
+	m_bFirstTraceEvent = false;
+	m_traceFile << "{\"name\":\"counters\",\"ph\":\"C\",\"ts\":" << frame.startMicroseconds << ",\"pid\":1,\"args\":{";
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_traceFile << (i > 0 ? "," : "") << "\"" << g_CounterNames[i] << "\":" << frame.counters[i];
+	}
+	m_traceFile << "}}";
+}
+
+/***********************************************************
+ *  FormatTitle()
+ *
+ *  This method is used for formatting the window title with
+ *  the averages of the frame timings and the counters.
+ ***********************************************************/
+std::string FrameProfiler::FormatTitle(const char* windowTitle) const
+{
+	std::ostringstream title;
+	title << windowTitle << std::fixed << std::setprecision(2)
+		<< " | " << ((m_frameAverage > 0.0) ? 1000.0 / m_frameAverage : 0.0) << " fps"
+		<< " | CPU " << m_frameAverage << " ms"
+		<< " | GPU " << m_gpuFrameAverage << " ms"
+		<< " | draws " << m_counterAverages[COUNTER_DRAW_CALLS]
+		<< " | packets " << m_counterAverages[COUNTER_RENDER_PACKETS]
+		<< " | culled " << m_counterAverages[COUNTER_CULLED_OBJECTS]
+		<< " | uniforms " << m_counterAverages[COUNTER_UNIFORM_UPLOADS]
+		<< " | shaded " << m_counterAverages[COUNTER_SHADED_KILOSAMPLES] << "k"
+		<< " | saved " << m_counterAverages[COUNTER_OVERDRAW_SAVED_KILOSAMPLES] << "k"
+		<< " | scale " << m_counterAverages[COUNTER_RENDER_SCALE_PERCENT] << "%";
+
+	return(title.str());
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for updating the averages shown in the
+ *  window title, when a window is passed in, and for drawing
+ *  one CPU bar (green) and one GPU bar (orange) per zone in
+ *  the top left of the window.  The white line marks the
+ *  frame time of 60 frames per second.  The bars are drawn
+ *  with scissored clears, so no shader state is changed.
+ ***********************************************************/
+void FrameProfiler::DrawOverlay(GLFWwindow* pWindow, const char* windowTitle)
+{
+	double now = GetMicroseconds();
+
+	if ((now - m_lastOverlayUpdate >= g_OverlayIntervalMicroseconds) && (m_sumCount > 0))
+	{
+		for (int i = 0; i < ZONE_COUNT; i++)
+		{
+			m_zoneAverages[i].cpuMilliseconds = m_zoneSums[i].cpuMilliseconds / m_sumCount;
+			m_zoneAverages[i].gpuMilliseconds = m_zoneSums[i].gpuMilliseconds / m_sumCount;
+			m_zoneSums[i].cpuMilliseconds = 0.0;
+			m_zoneSums[i].gpuMilliseconds = 0.0;
+		}
+		for (int i = 0; i < COUNTER_COUNT; i++)
+		{
+			m_counterAverages[i] = m_counterSums[i] / m_sumCount;
+			m_counterSums[i] = 0;
+		}
+		m_frameAverage = m_frameSum / m_sumCount;
+		m_gpuFrameAverage = m_gpuFrameSum / m_sumCount;
+		m_frameSum = 0.0;
+		m_gpuFrameSum = 0.0;
+		m_sumCount = 0;
+		m_lastOverlayUpdate = now;
+
+		if (NULL != pWindow)
+		{
+			glfwSetWindowTitle(pWindow, FormatTitle(windowTitle).c_str());
+		}
+	}
+
+	GLint viewport[4];
+	GLfloat clearColor[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glEnable(GL_SCISSOR_TEST);
+
+	int maxBarWidth = viewport[2] - 2 * g_BarMargin;
+	for (int i = 0; i < ZONE_COUNT; i++)
+	{
+		int top = viewport[1] + viewport[3] - g_BarMargin - i * g_BarRowHeight;
+		int cpuWidth = (int)(m_zoneAverages[i].cpuMilliseconds * g_PixelsPerMillisecond);
+		int gpuWidth = (int)(m_zoneAverages[i].gpuMilliseconds * g_PixelsPerMillisecond);
+
+		if (cpuWidth > maxBarWidth)
+		{
+			cpuWidth = maxBarWidth;
+		}
+		if (gpuWidth > maxBarWidth)
+		{
+			gpuWidth = maxBarWidth;
+		}
+
+		if (cpuWidth > 0)
+		{
+			glScissor(viewport[0] + g_BarMargin, top - g_BarHeight, cpuWidth, g_BarHeight);
+			glClearColor(0.2f, 0.9f, 0.3f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+		if (gpuWidth > 0)
+		{
+			glScissor(viewport[0] + g_BarMargin, top - 2 * g_BarHeight, gpuWidth, g_BarHeight);
+			glClearColor(1.0f, 0.6f, 0.1f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+	}
+
+	// frame budget marker
+	glScissor(
+		viewport[0] + g_BarMargin + (int)(g_FrameBudgetMilliseconds * g_PixelsPerMillisecond),
+		viewport[1] + viewport[3] - g_BarMargin - ZONE_COUNT * g_BarRowHeight,
+		1,
+		ZONE_COUNT * g_BarRowHeight);
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glDisable(GL_SCISSOR_TEST);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+}
+
+/***********************************************************
+ *  GetZoneName()
+ *
+ *  This method is used for getting the name of a zone.
+ ***********************************************************/
+const char* FrameProfiler::GetZoneName(PROFILE_ZONE zone)
+{
+	if ((zone < 0) || (zone >= ZONE_COUNT))
+	{
+		return("");
+	}
+
+	return(g_ZoneNames[zone]);
+}
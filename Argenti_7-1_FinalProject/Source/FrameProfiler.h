@@ -0,0 +1,245 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// measure the CPU and GPU time of the parts of every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FrameProfiler
+ *
+ *  This class measures the CPU time of the profiled zones of
+ *  every frame, and the GPU time of the zones that issue GL
+ *  commands with GL_TIME_ELAPSED queries.  The queries are
+ *  kept in a ring over several frames and only read once
+ *  their results are available, so the GPU is never waited
+ *  on.  The averages are shown in the window title and as
+ *  bars over the scene, and every frame can be streamed to a
+ *  CSV file or a Chrome trace file.
+ ***********************************************************/
+class FrameProfiler
+{
+public:
+	// constructor
+	FrameProfiler();
+	// destructor
+	~FrameProfiler();
+
+	// IDs of the profiled parts of the frame
+	enum PROFILE_ZONE
+	{
+		ZONE_PREPARE_SCENE_VIEW = 0,
+		ZONE_RENDER_SCENE,
+		ZONE_RENDER_DESKTOP,
+		ZONE_RENDER_LEGO_MAN,
+		ZONE_RENDER_SODA_CAN,
+		ZONE_RENDER_HEAD_PHONES,
+		ZONE_RENDER_LAMP_BASE,
+		ZONE_RECORD_COMMAND_LISTS,
+		ZONE_ASSIGN_LIGHTS,
+		ZONE_EXECUTE_RENDER_QUEUE,
+		ZONE_UPSCALE,
+		ZONE_CAPTURE_FRAME,
+		ZONE_SWAP_BUFFERS,
+		ZONE_PACE_FRAME,
+		ZONE_POLL_EVENTS,
+		ZONE_COUNT
+	};
+
+	// IDs of the counted events of the frame
+	enum PROFILE_COUNTER
+	{
+		COUNTER_DRAW_CALLS = 0,
+		COUNTER_UNIFORM_UPLOADS,
+		COUNTER_FRAME_ARENA_KILOBYTES,
+		// opaque samples that passed the depth test in the lit pass
+		// and in the depth pre-pass, counted by the GPU
+		COUNTER_SHADED_KILOSAMPLES,
+		COUNTER_PREPASS_KILOSAMPLES,
+		// samples the pre-pass kept from being shaded more than once
+		COUNTER_OVERDRAW_SAVED_KILOSAMPLES,
+		// percent of the window size that the scene is rendered at
+		COUNTER_RENDER_SCALE_PERCENT,
+		// draw packets of the render queue, the draws that several
+		// packets were merged into, and the state changes issued and
+		// saved by the sorting
+		COUNTER_RENDER_PACKETS,
+		COUNTER_INSTANCED_DRAWS,
+		COUNTER_INDIRECT_DRAWS,
+		COUNTER_STATE_CHANGES,
+		COUNTER_SAVED_STATE_CHANGES,
+		// objects skipped by the view frustum culling
+		COUNTER_CULLED_OBJECTS,
+		// meshes resident in the mesh cache, and the meshes that had
+		// to be loaded while a frame was drawn, which stalled it
+		COUNTER_RESIDENT_MESHES,
+		COUNTER_MESH_DRAW_LOADS,
+		// video memory of the resident texture levels, the loads of
+		// finer levels in flight and the levels left out so far
+		COUNTER_TEXTURE_RESIDENT_KILOBYTES,
+		COUNTER_TEXTURE_PENDING_LOADS,
+		COUNTER_TEXTURE_EVICTED_LEVELS,
+		COUNTER_COUNT
+	};
+
+private:
+	// one measured pass through a zone
+	struct ZONE_EVENT
+	{
+		int zone;
+		double startMicroseconds;
+		double durationMicroseconds;
+	};
+
+	// everything measured in one frame, kept until the GPU
+	// results of the frame are available
+	struct FRAME_RECORD
+	{
+		bool bValid;
+		long long frameNumber;
+		double startMicroseconds;
+		double frameMicroseconds;
+		double cpuMicroseconds[ZONE_COUNT];
+		double gpuMicroseconds[ZONE_COUNT];
+		GLuint queries[ZONE_COUNT];
+		bool bQueryIssued[ZONE_COUNT];
+		int counters[COUNTER_COUNT];
+		// GL_SAMPLES_PASSED queries of the counters that the GPU counts
+		GLuint sampleQueries[COUNTER_COUNT];
+		bool bSampleQueryIssued[COUNTER_COUNT];
+		std::vector<ZONE_EVENT> events;
+	};
+
+	// averages shown in the overlay
+	struct ZONE_AVERAGE
+	{
+		double cpuMilliseconds;
+		double gpuMilliseconds;
+	};
+
+	std::chrono::steady_clock::time_point m_startTime;
+	// frames kept in flight until their GPU queries are read
+	std::vector<FRAME_RECORD> m_frames;
+	int m_currentFrame;
+	long long m_frameNumber;
+	bool m_bInFrame;
+	// zone that has a GL_TIME_ELAPSED query running - these
+	// queries can not be nested
+	int m_activeGpuZone;
+	// counter that has a GL_SAMPLES_PASSED query running
+	int m_activeSampleCounter;
+	// start times of the open zones
+	double m_zoneStart[ZONE_COUNT];
+
+	// sums over the current overlay interval
+	ZONE_AVERAGE m_zoneSums[ZONE_COUNT];
+	double m_frameSum;
+	double m_gpuFrameSum;
+	int m_counterSums[COUNTER_COUNT];
+	int m_sumCount;
+	double m_lastOverlayUpdate;
+	// averages of the last overlay interval
+	ZONE_AVERAGE m_zoneAverages[ZONE_COUNT];
+	double m_frameAverage;
+	double m_gpuFrameAverage;
+	int m_counterAverages[COUNTER_COUNT];
+	// GPU time of the latest frame whose queries were read
+	double m_latestGpuFrameTime;
+
+	// output files
+	std::ofstream m_csvFile;
+	std::ofstream m_traceFile;
+	bool m_bFirstTraceEvent;
+
+	// microseconds since the profiler was created
+	double GetMicroseconds() const;
+	// read the results of a finished frame and pass them on
+	void ResolveFrame(FRAME_RECORD& frame);
+	// write a finished frame to the output files
+	void WriteCsvFrame(const FRAME_RECORD& frame);
+	void WriteTraceFrame(const FRAME_RECORD& frame);
+
+public:
+	// create the GPU queries - needs the OpenGL context
+	bool Initialize();
+
+	// stream every frame to a CSV file or a Chrome trace file
+	bool OpenCsvFile(const char* filename);
+	bool OpenTraceFile(const char* filename);
+
+	// mark the start and the end of a frame
+	void BeginFrame();
+	void EndFrame();
+
+	// mark the start and the end of a zone
+	void BeginZone(PROFILE_ZONE zone);
+	void EndZone(PROFILE_ZONE zone);
+
+	// set a counted event for the current frame
+	void SetCounter(PROFILE_COUNTER counter, int value);
+	// count the samples that pass the depth test into a counter of
+	// the current frame - the counts can not be nested
+	void BeginSampleCount(PROFILE_COUNTER counter);
+	void EndSampleCount(PROFILE_COUNTER counter);
+
+	// draw the timing bars and update the window title - the
+	// title is left alone when the window is NULL
+	void DrawOverlay(GLFWwindow* pWindow, const char* windowTitle);
+	// format the window title with the averages
+	std::string FormatTitle(const char* windowTitle) const;
+
+	// averages of the last overlay interval in milliseconds
+	double GetAverageFrameTime() const { return m_frameAverage; }
+	double GetAverageGpuTime() const { return m_gpuFrameAverage; }
+	// GPU time of the latest resolved frame in milliseconds, which
+	// is a few frames behind the current one - 0 until the first
+	// queries have been read
+	double GetLatestGpuTime() const { return m_latestGpuFrameTime; }
+
+	// get the name of a zone
+	static const char* GetZoneName(PROFILE_ZONE zone);
+};
+
+/***********************************************************
+ *  ProfileZone
+ *
+ *  This class measures a zone for as long as it is in scope.
+ *  A NULL profiler is allowed and measures nothing.
+ ***********************************************************/
+class ProfileZone
+{
+public:
+	ProfileZone(FrameProfiler* pProfiler, FrameProfiler::PROFILE_ZONE zone)
+	{
+		m_pProfiler = pProfiler;
+		m_zone = zone;
+		if (NULL != m_pProfiler)
+		{
+			m_pProfiler->BeginZone(m_zone);
+		}
+	}
+	~ProfileZone()
+	{
+		if (NULL != m_pProfiler)
+		{
+			m_pProfiler->EndZone(m_zone);
+		}
+	}
+
+private:
+	FrameProfiler* m_pProfiler;
+	FrameProfiler::PROFILE_ZONE m_zone;
+
+	// a zone can only be closed once
+	ProfileZone(const ProfileZone&);
+	ProfileZone& operator=(const ProfileZone&);
+};
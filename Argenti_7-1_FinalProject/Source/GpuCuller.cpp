@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.cpp
+// ============
+// cull and compact the indirect draw commands with a compute shader
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuCuller.h"
+
+#include "InstancedMeshes.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables and defines
+namespace
+{
+	// storage block names of the CULL_BINDING values after the first,
+	// which is the visible draw data
+	const char* g_CullBlockNames[] =
+	{
+		"CullDrawDataBlock",
+		"CullCommandBlock",
+		"CullObjectBlock",
+		"BatchFirstBlock",
+		"VisibleCommandBlock",
+		"BatchCountBlock"
+	};
+
+	// the object layout must match the std430 layout in the cull shader
+	static_assert(sizeof(GpuCuller::CULL_OBJECT) == 32, "CULL_OBJECT does not match the std430 layout");
+}
+
+/***********************************************************
+ *  GpuCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuCuller::GpuCuller()
+{
+	m_programID = 0;
+	m_frustumPlanesLocation = -1;
+	m_objectCountLocation = -1;
+	m_objectBuffer = 0;
+	m_batchFirstBuffer = 0;
+	m_visibleDrawDataBuffer = 0;
+	m_visibleCommandBuffer = 0;
+	m_batchCountBuffer = 0;
+	m_capacity = 0;
+}
+
+/***********************************************************
+ *  ~GpuCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuCuller::~GpuCuller()
+{
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+	if (0 != m_objectBuffer)
+	{
+		glDeleteBuffers(1, &m_objectBuffer);
+		glDeleteBuffers(1, &m_batchFirstBuffer);
+		glDeleteBuffers(1, &m_visibleDrawDataBuffer);
+		glDeleteBuffers(1, &m_visibleCommandBuffer);
+		glDeleteBuffers(1, &m_batchCountBuffer);
+		m_objectBuffer = 0;
+		m_batchFirstBuffer = 0;
+		m_visibleDrawDataBuffer = 0;
+		m_visibleCommandBuffer = 0;
+		m_batchCountBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling and linking the cull
+ *  shader from the passed in file.  0 is returned when the
+ *  file can not be read or the shader does not compile.
+ ***********************************************************/
+GLuint GpuCuller::CompileProgram(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open the cull shader file:" << filename << std::endl;
+		return(0);
+	}
+
+	std::stringstream source;
+	source << file.rdbuf();
+	std::string sourceText = source.str();
+	const char* pSource = sourceText.c_str();
+
+	GLint success = GL_FALSE;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &pSource, NULL);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (GL_FALSE == success)
+	{
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not compile the cull shader:" << filename << std::endl << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (GL_FALSE == success)
+	{
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not link the cull shader:" << filename << std::endl << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadShader()
+ *
+ *  This method is used for getting the cull shader program,
+ *  from the program cache when one is passed in, or else by
+ *  compiling it.  False is returned when the shader can not
+ *  be built, and the scene is then culled on the CPU.
+ ***********************************************************/
+bool GpuCuller::LoadShader(const char* filename, ProgramBinaryCache* pProgramCache)
+{
+	GLuint programID = 0;
+
+	// the cull inputs are bound after the blocks of the scene shader
+	GLint bindingCount = 0;
+	glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &bindingCount);
+	if (bindingCount < CULL_BINDING_COUNT)
+	{
+		std::cout << "The cull shader needs " << CULL_BINDING_COUNT << " storage buffer bindings, the driver has " << bindingCount << std::endl;
+		return(false);
+	}
+
+	if (NULL != pProgramCache)
+	{
+		ProgramBinaryCache::SHADER_STAGE stage;
+		stage.type = GL_COMPUTE_SHADER;
+		stage.filename = filename;
+		programID = pProgramCache->LoadProgram(&stage, 1, "cullShader");
+	}
+	else
+	{
+		programID = CompileProgram(filename);
+	}
+	if (0 == programID)
+	{
+		return(false);
+	}
+
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+	}
+	m_programID = programID;
+	m_frustumPlanesLocation = glGetUniformLocation(m_programID, "frustumPlanes");
+	m_objectCountLocation = glGetUniformLocation(m_programID, "objectCount");
+	BindProgramBlocks();
+
+	if (0 == m_objectBuffer)
+	{
+		glGenBuffers(1, &m_objectBuffer);
+		glGenBuffers(1, &m_batchFirstBuffer);
+		glGenBuffers(1, &m_visibleDrawDataBuffer);
+		glGenBuffers(1, &m_visibleCommandBuffer);
+		glGenBuffers(1, &m_batchCountBuffer);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BindProgramBlocks()
+ *
+ *  This method is used for attaching the storage blocks of
+ *  the cull shader to their binding points.
+ ***********************************************************/
+void GpuCuller::BindProgramBlocks()
+{
+	GLuint blockIndex = glGetProgramResourceIndex(m_programID, GL_SHADER_STORAGE_BLOCK, "DrawDataBlock");
+	if (GL_INVALID_INDEX != blockIndex)
+	{
+		glShaderStorageBlockBinding(m_programID, blockIndex, VISIBLE_DRAW_DATA_BINDING);
+	}
+	else
+	{
+		std::cout << "Cull shader does not declare the storage block DrawDataBlock" << std::endl;
+	}
+
+	for (int i = DRAW_DATA_BINDING; i < CULL_BINDING_COUNT; i++)
+	{
+		const char* pBlockName = g_CullBlockNames[i - DRAW_DATA_BINDING];
+
+		blockIndex = glGetProgramResourceIndex(m_programID, GL_SHADER_STORAGE_BLOCK, pBlockName);
+		if (GL_INVALID_INDEX == blockIndex)
+		{
+			std::cout << "Cull shader does not declare the storage block " << pBlockName << std::endl;
+			continue;
+		}
+		glShaderStorageBlockBinding(m_programID, blockIndex, i);
+	}
+}
+
+/***********************************************************
+ *  ReserveOutput()
+ *
+ *  This method is used for making room in the output buffers
+ *  for the passed in number of commands.  The buffers only
+ *  grow, and they are only written by the GPU.
+ ***********************************************************/
+void GpuCuller::ReserveOutput(int commandCount)
+{
+	if (commandCount <= m_capacity)
+	{
+		return;
+	}
+
+	m_capacity = commandCount;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_visibleDrawDataBuffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		sizeof(InstancedMeshes::INSTANCE_DATA) * m_capacity,
+		NULL,
+		GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_visibleCommandBuffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		sizeof(InstancedMeshes::DRAW_COMMAND) * m_capacity,
+		NULL,
+		GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for running the cull shader over the
+ *  commands of the frame.  It runs one thread per command,
+ *  and the visible commands and their draw data are written
+ *  to the output buffers.  The visible draw data is left
+ *  bound for the vertex shader, and the current program is
+ *  left unbound, so the caller has to select its shader
+ *  program again before drawing.
+ ***********************************************************/
+void GpuCuller::Cull(
+	const VisibilityCuller::FRUSTUM& frustum,
+	GLuint sourceBuffer,
+	GLintptr drawDataOffset,
+	GLintptr commandOffset,
+	const CULL_OBJECT* pObjects,
+	int objectCount,
+	const GLuint* pBatchFirstCommands,
+	int batchCount)
+{
+	if ((IsLoaded() == false) || (objectCount <= 0) || (batchCount <= 0))
+	{
+		return;
+	}
+
+	ReserveOutput(objectCount);
+
+	// the inputs are orphaned, so the driver does not have to wait
+	// for the pass of the previous frame
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		sizeof(CULL_OBJECT) * objectCount,
+		pObjects,
+		GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_batchFirstBuffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		sizeof(GLuint) * batchCount,
+		pBatchFirstCommands,
+		GL_STREAM_DRAW);
+	// the counts are cleared by the driver, so there is no array
+	// of zeros to upload
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_batchCountBuffer);
+	glBufferData(
+		GL_SHADER_STORAGE_BUFFER,
+		sizeof(GLuint) * batchCount,
+		NULL,
+		GL_STREAM_DRAW);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_DRAW_DATA_BINDING, m_visibleDrawDataBuffer);
+	glBindBufferRange(
+		GL_SHADER_STORAGE_BUFFER,
+		DRAW_DATA_BINDING,
+		sourceBuffer,
+		drawDataOffset,
+		sizeof(InstancedMeshes::INSTANCE_DATA) * objectCount);
+	glBindBufferRange(
+		GL_SHADER_STORAGE_BUFFER,
+		COMMAND_BINDING,
+		sourceBuffer,
+		commandOffset,
+		sizeof(InstancedMeshes::DRAW_COMMAND) * objectCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BATCH_FIRST_BINDING, m_batchFirstBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_COMMAND_BINDING, m_visibleCommandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BATCH_COUNT_BINDING, m_batchCountBuffer);
+
+	glUseProgram(m_programID);
+	glUniform4fv(m_frustumPlanesLocation, 6, &frustum.planes[0].x);
+	glUniform1ui(m_objectCountLocation, (GLuint)objectCount);
+	glDispatchCompute((GLuint)((objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+	glUseProgram(0);
+
+	// the draws read the commands, the counts and the draw data
+	// that were written by the pass
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.h
+// ============
+// cull and compact the indirect draw commands with a compute shader
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ProgramBinaryCache.h"
+#include "ShaderUniforms.h"
+#include "VisibilityCuller.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  GpuCuller
+ *
+ *  This class runs a compute pass over the indirect draw
+ *  commands of a frame.  Every command has a bounding sphere
+ *  and belongs to a batch, a range of the commands that is
+ *  drawn with one call.  The commands inside of the view
+ *  frustum are packed at the start of the range of their
+ *  batch together with their draw data, and the number of
+ *  visible commands of every batch is counted with atomics,
+ *  so the draws are issued with
+ *  glMultiDrawElementsIndirectCount() and the counts are
+ *  never read back by the CPU.
+ ***********************************************************/
+class GpuCuller
+{
+public:
+	// constructor
+	GpuCuller();
+	// destructor
+	~GpuCuller();
+
+	// bounding sphere and batch of one command - must match
+	// CullObject in the cull shader
+	struct CULL_OBJECT
+	{
+		glm::vec4 sphere;
+		GLuint batch;
+		GLuint padding[3];
+	};
+
+	// threads in one work group of the cull shader
+	static const int WORKGROUP_SIZE = 64;
+
+private:
+	// binding points of the storage blocks of the cull shader -
+	// the visible draw data is written to the block that the
+	// vertex shader reads the draw data from, and the inputs
+	// follow the storage blocks of the scene shader, so the
+	// lights and clusters stay bound
+	enum CULL_BINDING
+	{
+		VISIBLE_DRAW_DATA_BINDING = ShaderUniforms::DRAW_DATA_STORAGE_BINDING,
+		DRAW_DATA_BINDING = ShaderUniforms::STORAGE_BINDING_COUNT,
+		COMMAND_BINDING,
+		OBJECT_BINDING,
+		BATCH_FIRST_BINDING,
+		VISIBLE_COMMAND_BINDING,
+		BATCH_COUNT_BINDING,
+		CULL_BINDING_COUNT
+	};
+
+	// the linked compute program
+	GLuint m_programID;
+	GLint m_frustumPlanesLocation;
+	GLint m_objectCountLocation;
+	// input buffers uploaded for every pass
+	GLuint m_objectBuffer;
+	GLuint m_batchFirstBuffer;
+	// output buffers written by the pass
+	GLuint m_visibleDrawDataBuffer;
+	GLuint m_visibleCommandBuffer;
+	GLuint m_batchCountBuffer;
+	// number of commands the output buffers have room for
+	int m_capacity;
+
+	// compile and link the cull shader from its file
+	GLuint CompileProgram(const char* filename);
+	// attach the storage blocks of the program to their binding points
+	void BindProgramBlocks();
+	// make room in the output buffers for the passed in commands
+	void ReserveOutput(int commandCount);
+
+public:
+	// compile and link the cull shader, or load it from the
+	// passed in program cache when it is not NULL
+	bool LoadShader(const char* filename, ProgramBinaryCache* pProgramCache = NULL);
+	// check whether the cull shader has been loaded
+	bool IsLoaded() const { return (0 != m_programID); }
+
+	// cull the commands and the draw data of the frame, which are
+	// read from the passed in offsets of the source buffer - there
+	// is one object per command, and pBatchFirstCommands holds the
+	// first command of every batch
+	void Cull(
+		const VisibilityCuller::FRUSTUM& frustum,
+		GLuint sourceBuffer,
+		GLintptr drawDataOffset,
+		GLintptr commandOffset,
+		const CULL_OBJECT* pObjects,
+		int objectCount,
+		const GLuint* pBatchFirstCommands,
+		int batchCount);
+
+	// outputs of the last pass - the commands of a batch start at
+	// the first command of the batch, and the count of the batch
+	// is at batch * sizeof(GLuint) in the count buffer
+	GLuint GetVisibleDrawDataBuffer() const { return m_visibleDrawDataBuffer; }
+	GLuint GetVisibleCommandBuffer() const { return m_visibleCommandBuffer; }
+	GLuint GetBatchCountBuffer() const { return m_batchCountBuffer; }
+};
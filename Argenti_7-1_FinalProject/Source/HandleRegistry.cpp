@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// handleregistry.cpp
+// ============
+// hand out integer handles for tagged scene resources
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HandleRegistry.h"
+
+// declaration of global variables and defines
+namespace
+{
+	// returned for handles that have not been registered
+	const std::string g_EmptyTag;
+}
+
+/***********************************************************
+ *  HandleRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HandleRegistry::HandleRegistry()
+{
+}
+
+/***********************************************************
+ *  ~HandleRegistry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HandleRegistry::~HandleRegistry()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Register()
+ *
+ *  This method is used for registering a tag.  A new tag
+ *  gets the next consecutive handle, and a tag that has
+ *  already been registered keeps its handle.
+ ***********************************************************/
+int HandleRegistry::Register(const std::string& tag)
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_handles.find(tag);
+	if (found != m_handles.end())
+	{
+		return(found->second);
+	}
+
+	int handle = (int)m_tags.size();
+	m_handles[tag] = handle;
+	m_tags.push_back(tag);
+
+	return(handle);
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  This method is used for getting the handle of the passed
+ *  in tag, or INVALID_HANDLE when it is not registered.
+ ***********************************************************/
+int HandleRegistry::Find(const std::string& tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_handles.find(tag);
+	if (found == m_handles.end())
+	{
+		return(INVALID_HANDLE);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  GetTag()
+ *
+ *  This method is used for getting the tag that has been
+ *  registered for the passed in handle.
+ ***********************************************************/
+const std::string& HandleRegistry::GetTag(int handle) const
+{
+	if ((handle < 0) || (handle >= (int)m_tags.size()))
+	{
+		return(g_EmptyTag);
+	}
+
+	return(m_tags[handle]);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the registered tags.
+ ***********************************************************/
+void HandleRegistry::Clear()
+{
+	m_handles.clear();
+	m_tags.clear();
+}
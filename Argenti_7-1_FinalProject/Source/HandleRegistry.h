@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// handleregistry.h
+// ============
+// hand out integer handles for tagged scene resources
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  HandleRegistry
+ *
+ *  This class hands out consecutive integer handles for the
+ *  tags of loaded resources, such as textures and materials.
+ *  The hashed tag lookup is only meant to be used while the
+ *  scene is loaded - the render path works with the handles,
+ *  which index straight into the resource arrays.
+ ***********************************************************/
+class HandleRegistry
+{
+public:
+	// constructor
+	HandleRegistry();
+	// destructor
+	~HandleRegistry();
+
+	// value returned when a tag has not been registered
+	static const int INVALID_HANDLE = -1;
+
+private:
+	// hashed lookup from tag to handle
+	std::unordered_map<std::string, int> m_handles;
+	// tags indexed by handle
+	std::vector<std::string> m_tags;
+
+public:
+	// register a tag and get its handle
+	int Register(const std::string& tag);
+	// find the handle of a registered tag
+	int Find(const std::string& tag) const;
+	// get the tag of a handle
+	const std::string& GetTag(int handle) const;
+	// number of registered handles
+	int GetCount() const { return (int)m_tags.size(); }
+	// remove all the registered handles
+	void Clear();
+};
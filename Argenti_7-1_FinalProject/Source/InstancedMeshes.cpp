@@ -0,0 +1,748 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.cpp
+// ============
+// basic shape meshes that can be drawn many times with one draw call
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InstancedMeshes.h"
+
+#include <cmath>
+#include <cstddef>
+
+// declaration of global variables and defines
+namespace
+{
+	// each vertex has a position, a normal and a texture coordinate
+	const int g_FloatsPerVertex = 8;
+	// tessellation of the round meshes at every level of detail
+	const int g_CylinderSides[InstancedMeshes::LOD_LEVEL_COUNT] = { 36, 18, 9 };
+	const int g_SphereSlices[InstancedMeshes::LOD_LEVEL_COUNT] = { 36, 18, 10 };
+	const int g_SphereStacks[InstancedMeshes::LOD_LEVEL_COUNT] = { 18, 9, 5 };
+	const float g_Pi = 3.14159265358979f;
+
+	// the instance layout must match the attributes in the vertex shader
+	static_assert(sizeof(InstancedMeshes::INSTANCE_DATA) == 96, "INSTANCE_DATA does not match the instance attributes");
+	// the command layout must match DrawElementsIndirectCommand
+	static_assert(sizeof(InstancedMeshes::DRAW_COMMAND) == 20, "DRAW_COMMAND does not match the indirect command layout");
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  This function is used for appending one vertex to the
+	 *  passed in vertex list.
+	 ***********************************************************/
+	void AddVertex(
+		std::vector<GLfloat>& vertices,
+		glm::vec3 position,
+		glm::vec3 normal,
+		glm::vec2 textureCoordinate)
+	{
+		vertices.push_back(position.x);
+		vertices.push_back(position.y);
+		vertices.push_back(position.z);
+		vertices.push_back(normal.x);
+		vertices.push_back(normal.y);
+		vertices.push_back(normal.z);
+		vertices.push_back(textureCoordinate.x);
+		vertices.push_back(textureCoordinate.y);
+	}
+}
+
+/***********************************************************
+ *  InstancedMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InstancedMeshes::InstancedMeshes()
+{
+	for (int i = 0; i < INSTANCED_MESH_COUNT; i++)
+	{
+		for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+		{
+			m_meshes[i][level].firstIndex = 0;
+			m_meshes[i][level].baseVertex = 0;
+		}
+		m_levelCounts[i] = 0;
+	}
+	m_buffers[0] = 0;
+	m_buffers[1] = 0;
+	m_instancedVao = 0;
+	m_indirectVao = 0;
+}
+
+/***********************************************************
+ *  ~InstancedMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InstancedMeshes::~InstancedMeshes()
+{
+	DestroyBuffers();
+}
+
+/***********************************************************
+ *  CreateMesh()
+ *
+ *  This method is used for keeping the vertices and indices
+ *  of a mesh until the shared buffers are uploaded.  The
+ *  indices are relative to the first vertex of the mesh.
+ ***********************************************************/
+void InstancedMeshes::CreateMesh(
+	INSTANCED_MESH mesh,
+	int lodLevel,
+	const std::vector<GLfloat>& vertices,
+	const std::vector<GLuint>& indices)
+{
+	MESH_RANGE& range = m_meshes[mesh][lodLevel];
+
+	range.vertices = vertices;
+	range.indices = indices;
+
+	if (m_levelCounts[mesh] < lodLevel + 1)
+	{
+		m_levelCounts[mesh] = lodLevel + 1;
+	}
+}
+
+/***********************************************************
+ *  DestroyMesh()
+ *
+ *  This method is used for removing a mesh from the shared
+ *  buffers the next time they are uploaded.
+ ***********************************************************/
+void InstancedMeshes::DestroyMesh(INSTANCED_MESH mesh, int lodLevel)
+{
+	MESH_RANGE& range = m_meshes[mesh][lodLevel];
+
+	range.vertices.clear();
+	range.indices.clear();
+	range.firstIndex = 0;
+	range.baseVertex = 0;
+
+	if (m_levelCounts[mesh] > lodLevel)
+	{
+		m_levelCounts[mesh] = lodLevel;
+	}
+}
+
+/***********************************************************
+ *  UploadMeshes()
+ *
+ *  This method is used for copying the vertices and indices
+ *  of all the loaded meshes into the shared vertex and index
+ *  buffers, one mesh after the other, and for recording the
+ *  range of every mesh.  The vertex arrays are created the
+ *  first time.
+ ***********************************************************/
+void InstancedMeshes::UploadMeshes()
+{
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	for (int i = 0; i < INSTANCED_MESH_COUNT; i++)
+	{
+		for (int level = 0; level < m_levelCounts[i]; level++)
+		{
+			MESH_RANGE& range = m_meshes[i][level];
+
+			range.firstIndex = (GLuint)indices.size();
+			range.baseVertex = (GLint)(vertices.size() / g_FloatsPerVertex);
+			vertices.insert(vertices.end(), range.vertices.begin(), range.vertices.end());
+			indices.insert(indices.end(), range.indices.begin(), range.indices.end());
+		}
+	}
+
+	if (0 == m_buffers[0])
+	{
+		glGenBuffers(2, m_buffers);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_buffers[0]);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffers[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if (0 == m_instancedVao)
+	{
+		m_instancedVao = CreateVertexArray(true);
+		m_indirectVao = CreateVertexArray(false);
+	}
+}
+
+/***********************************************************
+ *  CreateVertexArray()
+ *
+ *  This method is used for creating a vertex array over the
+ *  shared buffers.  The mesh vertices are read from vertex
+ *  buffer binding 0.  The instanced vertex array also reads
+ *  the instance data from binding 1, which is attached to the
+ *  instance buffer when the meshes are drawn.
+ ***********************************************************/
+GLuint InstancedMeshes::CreateVertexArray(bool bInstanced)
+{
+	const GLsizei stride = sizeof(GLfloat) * g_FloatsPerVertex;
+	GLuint vao = 0;
+
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffers[1]);
+
+	// position, normal and texture coordinate of the mesh vertices
+	glBindVertexBuffer(VERTEX_BINDING, m_buffers[0], 0, stride);
+	glEnableVertexAttribArray(0);
+	glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+	glVertexAttribBinding(0, VERTEX_BINDING);
+	glEnableVertexAttribArray(1);
+	glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3);
+	glVertexAttribBinding(1, VERTEX_BINDING);
+	glEnableVertexAttribArray(2);
+	glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 6);
+	glVertexAttribBinding(2, VERTEX_BINDING);
+
+	if (bInstanced == true)
+	{
+		// the model matrix takes one attribute location per column
+		for (GLuint column = 0; column < 4; column++)
+		{
+			glEnableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+			glVertexAttribFormat(
+				INSTANCE_MODEL_LOCATION + column,
+				4,
+				GL_FLOAT,
+				GL_FALSE,
+				(GLuint)(offsetof(INSTANCE_DATA, model) + sizeof(glm::vec4) * column));
+			glVertexAttribBinding(INSTANCE_MODEL_LOCATION + column, INSTANCE_BINDING);
+		}
+		glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+		glVertexAttribFormat(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, offsetof(INSTANCE_DATA, color));
+		glVertexAttribBinding(INSTANCE_COLOR_LOCATION, INSTANCE_BINDING);
+		glEnableVertexAttribArray(INSTANCE_MATERIAL_LOCATION);
+		glVertexAttribIFormat(INSTANCE_MATERIAL_LOCATION, 1, GL_INT, offsetof(INSTANCE_DATA, materialIndex));
+		glVertexAttribBinding(INSTANCE_MATERIAL_LOCATION, INSTANCE_BINDING);
+
+		// the instance attributes advance once per instance
+		glVertexBindingDivisor(INSTANCE_BINDING, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	return(vao);
+}
+
+/***********************************************************
+ *  DestroyBuffers()
+ *
+ *  This method is used for freeing the shared buffers and the
+ *  vertex arrays of the meshes.
+ ***********************************************************/
+void InstancedMeshes::DestroyBuffers()
+{
+	if (0 != m_instancedVao)
+	{
+		glDeleteVertexArrays(1, &m_instancedVao);
+		m_instancedVao = 0;
+	}
+	if (0 != m_indirectVao)
+	{
+		glDeleteVertexArrays(1, &m_indirectVao);
+		m_indirectVao = 0;
+	}
+	if (0 != m_buffers[0])
+	{
+		glDeleteBuffers(2, m_buffers);
+		m_buffers[0] = 0;
+		m_buffers[1] = 0;
+	}
+}
+
+/***********************************************************
+ *  BuildBoxGeometry()
+ *
+ *  This method is used for building a box that is one unit
+ *  in size and centered on the origin.  Every face gets the
+ *  whole texture.  The box has one level of detail.
+ ***********************************************************/
+int InstancedMeshes::BuildBoxGeometry(MESH_GEOMETRY* pLevels)
+{
+	std::vector<GLfloat>& vertices = pLevels[0].vertices;
+	std::vector<GLuint>& indices = pLevels[0].indices;
+
+	vertices.clear();
+	indices.clear();
+
+	// normal, horizontal and vertical texture axis of each face
+	const glm::vec3 faceAxes[6][3] =
+	{
+		{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) }
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		glm::vec3 normal = faceAxes[face][0];
+		glm::vec3 uAxis = faceAxes[face][1] * 0.5f;
+		glm::vec3 vAxis = faceAxes[face][2] * 0.5f;
+		glm::vec3 center = normal * 0.5f;
+		GLuint firstVertex = (GLuint)(vertices.size() / g_FloatsPerVertex);
+
+		AddVertex(vertices, center - uAxis - vAxis, normal, glm::vec2(0.0f, 0.0f));
+		AddVertex(vertices, center + uAxis - vAxis, normal, glm::vec2(1.0f, 0.0f));
+		AddVertex(vertices, center + uAxis + vAxis, normal, glm::vec2(1.0f, 1.0f));
+		AddVertex(vertices, center - uAxis + vAxis, normal, glm::vec2(0.0f, 1.0f));
+
+		indices.push_back(firstVertex);
+		indices.push_back(firstVertex + 1);
+		indices.push_back(firstVertex + 2);
+		indices.push_back(firstVertex);
+		indices.push_back(firstVertex + 2);
+		indices.push_back(firstVertex + 3);
+	}
+
+	return(1);
+}
+
+/***********************************************************
+ *  BuildCylinderGeometry()
+ *
+ *  This method is used for building a cylinder with a radius
+ *  of one unit that goes from 0 to 1 along the Y axis, at
+ *  every level of detail.  The texture is wrapped once around
+ *  the side.
+ ***********************************************************/
+int InstancedMeshes::BuildCylinderGeometry(MESH_GEOMETRY* pLevels)
+{
+	for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+	{
+		std::vector<GLfloat>& vertices = pLevels[level].vertices;
+		std::vector<GLuint>& indices = pLevels[level].indices;
+		int sides = g_CylinderSides[level];
+
+		vertices.clear();
+		indices.clear();
+
+		// side of the cylinder - the seam vertices are duplicated
+		// so that the texture wraps around without a jump
+		for (int i = 0; i <= sides; i++)
+		{
+			float u = (float)i / sides;
+			float angle = u * 2.0f * g_Pi;
+			glm::vec3 normal = glm::vec3(cosf(angle), 0.0f, sinf(angle));
+
+			AddVertex(vertices, normal, normal, glm::vec2(u, 0.0f));
+			AddVertex(vertices, normal + glm::vec3(0.0f, 1.0f, 0.0f), normal, glm::vec2(u, 1.0f));
+		}
+		for (int i = 0; i < sides; i++)
+		{
+			GLuint bottom = i * 2;
+			GLuint top = bottom + 1;
+
+			indices.push_back(bottom);
+			indices.push_back(top);
+			indices.push_back(bottom + 2);
+			indices.push_back(bottom + 2);
+			indices.push_back(top);
+			indices.push_back(top + 2);
+		}
+
+		// bottom and top caps
+		for (int cap = 0; cap < 2; cap++)
+		{
+			float height = (float)cap;
+			glm::vec3 normal = glm::vec3(0.0f, (cap == 0) ? -1.0f : 1.0f, 0.0f);
+			GLuint center = (GLuint)(vertices.size() / g_FloatsPerVertex);
+
+			AddVertex(vertices, glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+			for (int i = 0; i <= sides; i++)
+			{
+				float angle = (float)i / sides * 2.0f * g_Pi;
+				float x = cosf(angle);
+				float z = sinf(angle);
+
+				AddVertex(
+					vertices,
+					glm::vec3(x, height, z),
+					normal,
+					glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z));
+			}
+			for (int i = 0; i < sides; i++)
+			{
+				indices.push_back(center);
+				if (cap == 0)
+				{
+					indices.push_back(center + 1 + i);
+					indices.push_back(center + 2 + i);
+				}
+				else
+				{
+					indices.push_back(center + 2 + i);
+					indices.push_back(center + 1 + i);
+				}
+			}
+		}
+
+	}
+
+	return(LOD_LEVEL_COUNT);
+}
+
+/***********************************************************
+ *  BuildSphereGeometry()
+ *
+ *  This method is used for building a sphere with a radius
+ *  of one unit that is centered on the origin, at every level
+ *  of detail.
+ ***********************************************************/
+int InstancedMeshes::BuildSphereGeometry(MESH_GEOMETRY* pLevels)
+{
+	for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+	{
+		std::vector<GLfloat>& vertices = pLevels[level].vertices;
+		std::vector<GLuint>& indices = pLevels[level].indices;
+		int slices = g_SphereSlices[level];
+		int stacks = g_SphereStacks[level];
+
+		vertices.clear();
+		indices.clear();
+
+		for (int stack = 0; stack <= stacks; stack++)
+		{
+			float v = (float)stack / stacks;
+			float phi = v * g_Pi;
+
+			for (int slice = 0; slice <= slices; slice++)
+			{
+				float u = (float)slice / slices;
+				float theta = u * 2.0f * g_Pi;
+				glm::vec3 normal = glm::vec3(
+					sinf(phi) * cosf(theta),
+					cosf(phi),
+					sinf(phi) * sinf(theta));
+
+				AddVertex(vertices, normal, normal, glm::vec2(u, 1.0f - v));
+			}
+		}
+		for (int stack = 0; stack < stacks; stack++)
+		{
+			for (int slice = 0; slice < slices; slice++)
+			{
+				GLuint upper = stack * (slices + 1) + slice;
+				GLuint lower = upper + slices + 1;
+
+				indices.push_back(upper);
+				indices.push_back(upper + 1);
+				indices.push_back(lower);
+				indices.push_back(upper + 1);
+				indices.push_back(lower + 1);
+				indices.push_back(lower);
+			}
+		}
+
+	}
+
+	return(LOD_LEVEL_COUNT);
+}
+
+/***********************************************************
+ *  BuildMeshGeometry()
+ *
+ *  This method is used for building the vertices and indices
+ *  of every level of detail of a mesh.  Nothing is uploaded,
+ *  so it can be called on any thread.  The number of built
+ *  levels is returned.
+ ***********************************************************/
+int InstancedMeshes::BuildMeshGeometry(INSTANCED_MESH mesh, MESH_GEOMETRY* pLevels)
+{
+	int levelCount = 0;
+
+	switch (mesh)
+	{
+	case INSTANCED_BOX:
+		levelCount = BuildBoxGeometry(pLevels);
+		break;
+	case INSTANCED_CYLINDER:
+		levelCount = BuildCylinderGeometry(pLevels);
+		break;
+	case INSTANCED_SPHERE:
+		levelCount = BuildSphereGeometry(pLevels);
+		break;
+	default:
+		break;
+	}
+
+	return(levelCount);
+}
+
+/***********************************************************
+ *  StoreMesh()
+ *
+ *  This method is used for adding the built levels of detail
+ *  of a mesh to the shared buffers, and for uploading them.
+ ***********************************************************/
+void InstancedMeshes::StoreMesh(INSTANCED_MESH mesh, const MESH_GEOMETRY* pLevels, int levelCount)
+{
+	if ((mesh < 0) || (mesh >= INSTANCED_MESH_COUNT) || (levelCount <= 0))
+	{
+		return;
+	}
+
+	for (int level = 0; (level < levelCount) && (level < LOD_LEVEL_COUNT); level++)
+	{
+		CreateMesh(mesh, level, pLevels[level].vertices, pLevels[level].indices);
+	}
+	UploadMeshes();
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  This method is used for building a mesh and uploading it
+ *  right away on the GL thread.
+ ***********************************************************/
+void InstancedMeshes::LoadMesh(INSTANCED_MESH mesh)
+{
+	MESH_GEOMETRY levels[LOD_LEVEL_COUNT];
+
+	StoreMesh(mesh, levels, BuildMeshGeometry(mesh, levels));
+}
+
+/***********************************************************
+ *  UnloadMesh()
+ *
+ *  This method is used for removing every level of detail of
+ *  a mesh from the shared buffers.  The other meshes are
+ *  uploaded again without it.
+ ***********************************************************/
+void InstancedMeshes::UnloadMesh(INSTANCED_MESH mesh)
+{
+	if (IsMeshLoaded(mesh) == false)
+	{
+		return;
+	}
+
+	for (int level = m_levelCounts[mesh] - 1; level >= 0; level--)
+	{
+		DestroyMesh(mesh, level);
+	}
+	UploadMeshes();
+}
+
+/***********************************************************
+ *  IsMeshLoaded()
+ *
+ *  This method is used for checking whether the passed in
+ *  mesh has been loaded and can be drawn.
+ ***********************************************************/
+bool InstancedMeshes::IsMeshLoaded(INSTANCED_MESH mesh) const
+{
+	if ((mesh < 0) || (mesh >= INSTANCED_MESH_COUNT))
+	{
+		return(false);
+	}
+
+	return((m_levelCounts[mesh] > 0) && (0 != m_instancedVao));
+}
+
+/***********************************************************
+ *  GetLevelCount()
+ *
+ *  This method is used for getting the number of tessellation
+ *  levels that have been loaded for the passed in mesh.
+ ***********************************************************/
+int InstancedMeshes::GetLevelCount(INSTANCED_MESH mesh) const
+{
+	if ((mesh < 0) || (mesh >= INSTANCED_MESH_COUNT))
+	{
+		return(0);
+	}
+
+	return(m_levelCounts[mesh]);
+}
+
+/***********************************************************
+ *  GetMeshBytes()
+ *
+ *  This method is used for getting the number of bytes that
+ *  the levels of detail of a mesh take in the shared buffers.
+ ***********************************************************/
+size_t InstancedMeshes::GetMeshBytes(INSTANCED_MESH mesh) const
+{
+	size_t byteCount = 0;
+
+	if ((mesh < 0) || (mesh >= INSTANCED_MESH_COUNT))
+	{
+		return(0);
+	}
+
+	for (int level = 0; level < m_levelCounts[mesh]; level++)
+	{
+		byteCount += sizeof(GLfloat) * m_meshes[mesh][level].vertices.size();
+		byteCount += sizeof(GLuint) * m_meshes[mesh][level].indices.size();
+	}
+
+	return(byteCount);
+}
+
+/***********************************************************
+ *  ClampLevel()
+ *
+ *  This method is used for clamping a level of detail to the
+ *  levels that have been loaded for the passed in mesh.
+ ***********************************************************/
+int InstancedMeshes::ClampLevel(INSTANCED_MESH mesh, int lodLevel) const
+{
+	if (lodLevel >= m_levelCounts[mesh])
+	{
+		lodLevel = m_levelCounts[mesh] - 1;
+	}
+	if (lodLevel < 0)
+	{
+		lodLevel = 0;
+	}
+
+	return(lodLevel);
+}
+
+/***********************************************************
+ *  DrawMeshInstanced()
+ *
+ *  This method is used for drawing all the instances of a
+ *  mesh at one level of detail with one draw call.  The
+ *  instance buffer is attached to the instance binding at the
+ *  passed in offset.
+ ***********************************************************/
+void InstancedMeshes::DrawMeshInstanced(
+	INSTANCED_MESH mesh,
+	int lodLevel,
+	int instanceCount,
+	GLuint instanceBuffer,
+	GLintptr bufferOffset)
+{
+	if ((IsMeshLoaded(mesh) == false) || (instanceCount <= 0) || (0 == instanceBuffer))
+	{
+		return;
+	}
+
+	const MESH_RANGE& range = m_meshes[mesh][ClampLevel(mesh, lodLevel)];
+
+	glBindVertexArray(m_instancedVao);
+	glBindVertexBuffer(INSTANCE_BINDING, instanceBuffer, bufferOffset, sizeof(INSTANCE_DATA));
+	glDrawElementsInstancedBaseVertex(
+		GL_TRIANGLES,
+		(GLsizei)range.indices.size(),
+		GL_UNSIGNED_INT,
+		(const void*)(sizeof(GLuint) * range.firstIndex),
+		instanceCount,
+		range.baseVertex);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  BuildDrawCommand()
+ *
+ *  This method is used for filling the indirect draw command
+ *  that draws one instance of a mesh at one level of detail
+ *  from the shared buffers.
+ ***********************************************************/
+bool InstancedMeshes::BuildDrawCommand(INSTANCED_MESH mesh, int lodLevel, DRAW_COMMAND& command) const
+{
+	if (IsMeshLoaded(mesh) == false)
+	{
+		return(false);
+	}
+
+	const MESH_RANGE& range = m_meshes[mesh][ClampLevel(mesh, lodLevel)];
+
+	command.count = (GLuint)range.indices.size();
+	command.instanceCount = 1;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DrawMeshesIndirect()
+ *
+ *  This method is used for drawing a list of commands from
+ *  an indirect draw buffer with one draw call.  The commands
+ *  can draw any of the meshes in the shared buffers.
+ ***********************************************************/
+void InstancedMeshes::DrawMeshesIndirect(GLuint commandBuffer, GLintptr bufferOffset, int drawCount)
+{
+	if ((0 == m_indirectVao) || (0 == commandBuffer) || (drawCount <= 0))
+	{
+		return;
+	}
+
+	glBindVertexArray(m_indirectVao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glMultiDrawElementsIndirect(
+		GL_TRIANGLES,
+		GL_UNSIGNED_INT,
+		(const void*)bufferOffset,
+		drawCount,
+		sizeof(DRAW_COMMAND));
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  DrawMeshesIndirectCount()
+ *
+ *  This method is used for drawing a list of commands from
+ *  an indirect draw buffer with one draw call, when the
+ *  number of commands was written to a buffer by the GPU.
+ ***********************************************************/
+void InstancedMeshes::DrawMeshesIndirectCount(
+	GLuint commandBuffer,
+	GLintptr bufferOffset,
+	GLuint countBuffer,
+	GLintptr countOffset,
+	int maxDrawCount)
+{
+	if ((0 == m_indirectVao) || (0 == commandBuffer) || (0 == countBuffer) || (maxDrawCount <= 0))
+	{
+		return;
+	}
+
+	glBindVertexArray(m_indirectVao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBindBuffer(GL_PARAMETER_BUFFER_ARB, countBuffer);
+	glMultiDrawElementsIndirectCountARB(
+		GL_TRIANGLES,
+		GL_UNSIGNED_INT,
+		(const void*)bufferOffset,
+		countOffset,
+		maxDrawCount,
+		sizeof(DRAW_COMMAND));
+	glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  The following methods are used for drawing the instances
+ *  of the meshes from the passed in instance buffer.
+ ***********************************************************/
+void InstancedMeshes::DrawBoxMeshInstanced(int instanceCount, GLuint instanceBuffer, GLintptr bufferOffset)
+{
+	DrawMeshInstanced(INSTANCED_BOX, 0, instanceCount, instanceBuffer, bufferOffset);
+}
+
+void InstancedMeshes::DrawCylinderMeshInstanced(int instanceCount, GLuint instanceBuffer, GLintptr bufferOffset, int lodLevel)
+{
+	DrawMeshInstanced(INSTANCED_CYLINDER, lodLevel, instanceCount, instanceBuffer, bufferOffset);
+}
+
+void InstancedMeshes::DrawSphereMeshInstanced(int instanceCount, GLuint instanceBuffer, GLintptr bufferOffset, int lodLevel)
+{
+	DrawMeshInstanced(INSTANCED_SPHERE, lodLevel, instanceCount, instanceBuffer, bufferOffset);
+}
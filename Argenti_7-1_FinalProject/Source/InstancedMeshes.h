@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.h
+// ============
+// basic shape meshes that can be drawn many times with one draw call
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  InstancedMeshes
+ *
+ *  This class builds the box, cylinder and sphere meshes with
+ *  the same size and texture mapping as the basic shape meshes,
+ *  and adds per-instance vertex attributes to them.  The model
+ *  matrix, color and material index of every instance are read
+ *  from an instance buffer, so all the instances of a mesh are
+ *  drawn with one glDrawElementsInstanced() call.
+ *
+ *  The round meshes are built at several tessellation levels,
+ *  so that small or distant objects can be drawn with fewer
+ *  vertices.  Level 0 has the most detail.
+ *
+ *  All the meshes share one vertex buffer and one index
+ *  buffer, and each mesh is a range of them.  This lets the
+ *  scene draw any mix of the meshes with one
+ *  glMultiDrawElementsIndirect() call.
+ ***********************************************************/
+class InstancedMeshes
+{
+public:
+	// constructor
+	InstancedMeshes();
+	// destructor
+	~InstancedMeshes();
+
+	// meshes that can be drawn instanced
+	enum INSTANCED_MESH
+	{
+		INSTANCED_BOX = 0,
+		INSTANCED_CYLINDER,
+		INSTANCED_SPHERE,
+		INSTANCED_MESH_COUNT
+	};
+
+	// layout of one instance in the instance buffer - must match
+	// the instance attributes in the vertex shader
+	struct INSTANCE_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		GLint materialIndex;
+		GLint padding[3];
+	};
+
+	// most tessellation levels of one mesh
+	static const int LOD_LEVEL_COUNT = 3;
+
+	// vertex attribute locations of the instance data
+	static const GLuint INSTANCE_MODEL_LOCATION = 3;
+	static const GLuint INSTANCE_COLOR_LOCATION = 7;
+	static const GLuint INSTANCE_MATERIAL_LOCATION = 8;
+
+	// layout of one command in an indirect draw buffer - matches
+	// the DrawElementsIndirectCommand structure of OpenGL
+	struct DRAW_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// vertices and indices of one level of detail of a mesh,
+	// before they are added to the shared buffers
+	struct MESH_GEOMETRY
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+	};
+
+private:
+	// one mesh and its range in the shared buffers
+	struct MESH_RANGE
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		GLuint firstIndex;
+		GLint baseVertex;
+	};
+
+	// vertex buffer bindings of the mesh vertices and the instances
+	static const GLuint VERTEX_BINDING = 0;
+	static const GLuint INSTANCE_BINDING = 1;
+
+	MESH_RANGE m_meshes[INSTANCED_MESH_COUNT][LOD_LEVEL_COUNT];
+	// number of loaded tessellation levels of every mesh
+	int m_levelCounts[INSTANCED_MESH_COUNT];
+	// shared vertex buffer and index buffer of all the meshes
+	GLuint m_buffers[2];
+	// vertex arrays with and without the instance attributes
+	GLuint m_instancedVao;
+	GLuint m_indirectVao;
+
+	// keep the vertices and indices of a mesh for the shared buffers
+	void CreateMesh(
+		INSTANCED_MESH mesh,
+		int lodLevel,
+		const std::vector<GLfloat>& vertices,
+		const std::vector<GLuint>& indices);
+	// remove a mesh from the shared buffers
+	void DestroyMesh(INSTANCED_MESH mesh, int lodLevel);
+	// copy all the meshes into the shared buffers
+	void UploadMeshes();
+	// create a vertex array over the shared buffers
+	GLuint CreateVertexArray(bool bInstanced);
+	// free the shared buffers and the vertex arrays
+	void DestroyBuffers();
+	// clamp a level of detail to the loaded levels of a mesh
+	int ClampLevel(INSTANCED_MESH mesh, int lodLevel) const;
+	// build the levels of detail of one mesh
+	static int BuildBoxGeometry(MESH_GEOMETRY* pLevels);
+	static int BuildCylinderGeometry(MESH_GEOMETRY* pLevels);
+	static int BuildSphereGeometry(MESH_GEOMETRY* pLevels);
+	// draw the instances of a mesh from the instance buffer
+	void DrawMeshInstanced(
+		INSTANCED_MESH mesh,
+		int lodLevel,
+		int instanceCount,
+		GLuint instanceBuffer,
+		GLintptr bufferOffset);
+
+public:
+	// build the LOD_LEVEL_COUNT levels of pLevels for a mesh without
+	// touching GL, so it can run on a worker thread - the number
+	// of built levels is returned
+	static int BuildMeshGeometry(INSTANCED_MESH mesh, MESH_GEOMETRY* pLevels);
+	// add built levels of a mesh to the shared buffers - must be
+	// called on the GL thread
+	void StoreMesh(INSTANCED_MESH mesh, const MESH_GEOMETRY* pLevels, int levelCount);
+	// build and store a mesh on the GL thread
+	void LoadMesh(INSTANCED_MESH mesh);
+	// remove a mesh from the shared buffers
+	void UnloadMesh(INSTANCED_MESH mesh);
+
+	// check whether a mesh has been loaded
+	bool IsMeshLoaded(INSTANCED_MESH mesh) const;
+	// number of tessellation levels of a loaded mesh
+	int GetLevelCount(INSTANCED_MESH mesh) const;
+	// size of a loaded mesh in the shared buffers
+	size_t GetMeshBytes(INSTANCED_MESH mesh) const;
+
+	// draw the instances of the meshes - the instance buffer holds
+	// instanceCount INSTANCE_DATA entries starting at bufferOffset,
+	// and a level past the last one draws the last level
+	void DrawBoxMeshInstanced(int instanceCount, GLuint instanceBuffer, GLintptr bufferOffset = 0);
+	void DrawCylinderMeshInstanced(int instanceCount, GLuint instanceBuffer, GLintptr bufferOffset = 0, int lodLevel = 0);
+	void DrawSphereMeshInstanced(int instanceCount, GLuint instanceBuffer, GLintptr bufferOffset = 0, int lodLevel = 0);
+
+	// fill the indirect draw command of one instance of a mesh
+	bool BuildDrawCommand(INSTANCED_MESH mesh, int lodLevel, DRAW_COMMAND& command) const;
+	// draw drawCount commands of an indirect draw buffer, starting
+	// at bufferOffset, with one call - the instance attributes are
+	// not used by these draws
+	void DrawMeshesIndirect(GLuint commandBuffer, GLintptr bufferOffset, int drawCount);
+	// draw the commands of an indirect draw buffer with one call,
+	// reading the number of commands from the count buffer at
+	// countOffset - at most maxDrawCount commands are drawn
+	void DrawMeshesIndirectCount(
+		GLuint commandBuffer,
+		GLintptr bufferOffset,
+		GLuint countBuffer,
+		GLintptr countOffset,
+		int maxDrawCount);
+};
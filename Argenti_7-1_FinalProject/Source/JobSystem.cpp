@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// run small jobs in parallel on a pool of work-stealing threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(int workerCount)
+{
+	m_nextQueue.store(0);
+	m_queuedJobs.store(0);
+	m_bStopping = false;
+
+	// the thread that waits for the jobs is the last core
+	if (workerCount < 0)
+	{
+		workerCount = (int)std::thread::hardware_concurrency() - 1;
+		if (workerCount < 0)
+		{
+			workerCount = 0;
+		}
+	}
+
+	// there is always one queue, so the jobs can be queued
+	// even when they are all run by the waiting thread
+	int queueCount = (workerCount > 0) ? workerCount : 1;
+	for (int i = 0; i < queueCount; i++)
+	{
+		JOB_QUEUE* pQueue = new JOB_QUEUE();
+		pQueue->head = 0;
+		pQueue->count = 0;
+		m_queues.push_back(pQueue);
+	}
+	for (int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::WorkerMain, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_bStopping = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (int i = 0; i < (int)m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+
+	for (int i = 0; i < (int)m_queues.size(); i++)
+	{
+		delete m_queues[i];
+	}
+	m_queues.clear();
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is the loop of a worker thread.  It runs the
+ *  jobs of its own queue and steals from the other queues,
+ *  and it sleeps while there is no queued job anywhere.
+ ***********************************************************/
+void JobSystem::WorkerMain(int workerIndex)
+{
+	while (true)
+	{
+		JOB job;
+
+		if (FindJob(workerIndex, job) == true)
+		{
+			RunJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait(lock, [this]() { return (m_bStopping == true) || (m_queuedJobs.load() > 0); });
+		if ((m_bStopping == true) && (m_queuedJobs.load() == 0))
+		{
+			return;
+		}
+	}
+}
+
+/***********************************************************
+ *  PopJob()
+ *
+ *  This method is used for taking the newest job from the
+ *  tail of a queue, which is the job that its owner queued
+ *  last and most likely still has in the cache.
+ ***********************************************************/
+bool JobSystem::PopJob(int queueIndex, JOB& job)
+{
+	JOB_QUEUE* pQueue = m_queues[queueIndex];
+	std::lock_guard<std::mutex> lock(pQueue->mutex);
+
+	if (pQueue->count == 0)
+	{
+		return(false);
+	}
+
+	pQueue->count--;
+	job = pQueue->jobs[(pQueue->head + pQueue->count) % QUEUE_CAPACITY];
+	m_queuedJobs.fetch_sub(1);
+
+	return(true);
+}
+
+/***********************************************************
+ *  StealJob()
+ *
+ *  This method is used for taking the oldest job from the
+ *  head of a queue that belongs to another thread.
+ ***********************************************************/
+bool JobSystem::StealJob(int queueIndex, JOB& job)
+{
+	JOB_QUEUE* pQueue = m_queues[queueIndex];
+	std::lock_guard<std::mutex> lock(pQueue->mutex);
+
+	if (pQueue->count == 0)
+	{
+		return(false);
+	}
+
+	job = pQueue->jobs[pQueue->head];
+	pQueue->head = (pQueue->head + 1) % QUEUE_CAPACITY;
+	pQueue->count--;
+	m_queuedJobs.fetch_sub(1);
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindJob()
+ *
+ *  This method is used for taking a job from the preferred
+ *  queue, or for stealing one from the other queues in turn
+ *  when the preferred queue is empty.
+ ***********************************************************/
+bool JobSystem::FindJob(int preferredQueue, JOB& job)
+{
+	int queueCount = (int)m_queues.size();
+
+	if (m_queuedJobs.load() <= 0)
+	{
+		return(false);
+	}
+
+	if ((preferredQueue >= 0) && (PopJob(preferredQueue % queueCount, job) == true))
+	{
+		return(true);
+	}
+
+	int start = (preferredQueue >= 0) ? preferredQueue + 1 : 0;
+	for (int i = 0; i < queueCount; i++)
+	{
+		if (StealJob((start + i) % queueCount, job) == true)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  RunJob()
+ *
+ *  This method is used for running a job and counting it as
+ *  finished.  The release order makes everything that the job
+ *  wrote visible to the thread that sees the counter at zero.
+ ***********************************************************/
+void JobSystem::RunJob(const JOB& job)
+{
+	job.pFunction(job.pData);
+	job.pCounter->pendingJobs.fetch_sub(1, std::memory_order_release);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a job.  The queues get
+ *  the jobs in turn, and a job is run right away when its
+ *  queue is full.
+ ***********************************************************/
+void JobSystem::Submit(JOB_FUNCTION pFunction, void* pData, JOB_COUNTER& counter)
+{
+	JOB job;
+	job.pFunction = pFunction;
+	job.pData = pData;
+	job.pCounter = &counter;
+
+	counter.pendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+	JOB_QUEUE* pQueue = m_queues[m_nextQueue.fetch_add(1) % m_queues.size()];
+	{
+		std::lock_guard<std::mutex> lock(pQueue->mutex);
+		if (pQueue->count < QUEUE_CAPACITY)
+		{
+			pQueue->jobs[(pQueue->head + pQueue->count) % QUEUE_CAPACITY] = job;
+			pQueue->count++;
+			m_queuedJobs.fetch_add(1);
+			pQueue = NULL;
+		}
+	}
+
+	if (NULL != pQueue)
+	{
+		RunJob(job);
+		return;
+	}
+
+	// the lock makes sure that a worker that is about to sleep
+	// sees the new job or gets the notification
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+	}
+	m_wakeCondition.notify_one();
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method is used for waiting until all the jobs of a
+ *  counter have finished.  The waiting thread runs queued
+ *  jobs in the meantime, so the jobs also finish when there
+ *  are no worker threads.
+ ***********************************************************/
+void JobSystem::Wait(JOB_COUNTER& counter)
+{
+	while (counter.pendingJobs.load(std::memory_order_acquire) > 0)
+	{
+		JOB job;
+
+		if (FindJob(-1, job) == true)
+		{
+			RunJob(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
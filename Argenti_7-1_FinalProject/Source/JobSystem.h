@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// run small jobs in parallel on a pool of work-stealing threads
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class keeps one worker thread per spare CPU core and
+ *  one job queue per worker.  A worker runs the newest job of
+ *  its own queue first, and when its queue is empty it steals
+ *  the oldest job of another queue, so the work spreads out
+ *  even when the jobs take different times.  A job is a plain
+ *  function and a data pointer, so submitting one does not
+ *  allocate memory.  The thread that waits for a counter
+ *  runs jobs too, instead of sleeping.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// constructor - a negative worker count uses one worker per
+	// spare CPU core
+	JobSystem(int workerCount = -1);
+	// destructor
+	~JobSystem();
+
+	typedef void (*JOB_FUNCTION)(void* pData);
+
+	// number of the submitted jobs that have not finished yet
+	struct JOB_COUNTER
+	{
+		std::atomic<int> pendingJobs;
+
+		JOB_COUNTER() : pendingJobs(0) {}
+	};
+
+	// most jobs waiting in the queue of one worker
+	static const int QUEUE_CAPACITY = 256;
+
+private:
+	struct JOB
+	{
+		JOB_FUNCTION pFunction;
+		void* pData;
+		JOB_COUNTER* pCounter;
+	};
+
+	// a fixed ring of jobs - the owner takes from the tail and
+	// the other threads steal from the head
+	struct JOB_QUEUE
+	{
+		std::mutex mutex;
+		JOB jobs[QUEUE_CAPACITY];
+		int head;
+		int count;
+	};
+
+	std::vector<std::thread> m_workers;
+	std::vector<JOB_QUEUE*> m_queues;
+	// queue that receives the next job from outside of the pool
+	std::atomic<unsigned int> m_nextQueue;
+	// jobs waiting in all the queues, for waking the workers
+	std::atomic<int> m_queuedJobs;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+	bool m_bStopping;
+
+	// the loop of a worker thread
+	void WorkerMain(int workerIndex);
+	// take the newest job of a queue
+	bool PopJob(int queueIndex, JOB& job);
+	// take the oldest job of a queue
+	bool StealJob(int queueIndex, JOB& job);
+	// take a job from the preferred queue or any other queue
+	bool FindJob(int preferredQueue, JOB& job);
+	// run a job and count it as finished
+	void RunJob(const JOB& job);
+
+public:
+	// number of worker threads, not counting the waiting thread
+	int GetWorkerCount() const { return (int)m_workers.size(); }
+
+	// queue a job - the counter is increased now and decreased
+	// when the job has finished
+	void Submit(JOB_FUNCTION pFunction, void* pData, JOB_COUNTER& counter);
+	// run jobs until all the jobs of the counter have finished
+	void Wait(JOB_COUNTER& counter);
+};
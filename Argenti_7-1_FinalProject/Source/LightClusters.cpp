@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.cpp
+// ============
+// assign the light sources to view space clusters with a compute shader
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightClusters.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables and defines
+namespace
+{
+	// closest view depth of the first slice, so the log of the
+	// depth stays finite for a projection through the camera
+	const float g_MinimumNearDepth = 0.01f;
+
+	// indices in a light list, the count and the lights
+	const int g_ClusterStride = LightClusters::MAX_CLUSTER_LIGHTS + 1;
+	const GLsizeiptr g_ClusterBufferBytes =
+		sizeof(LightClusters::CLUSTER_HEADER) + sizeof(GLuint) * LightClusters::CLUSTER_COUNT * g_ClusterStride;
+
+	// the header must match the std430 layout in the shaders, and
+	// the single list of the CPU path has to fit into the buffer
+	static_assert(sizeof(LightClusters::CLUSTER_HEADER) == 48, "CLUSTER_HEADER does not match the std430 layout");
+	static_assert(ShaderUniforms::MAX_LIGHTS < LightClusters::CLUSTER_COUNT * g_ClusterStride, "the light list of one cluster is too small");
+
+	/***********************************************************
+	 *  IsLightLit()
+	 *
+	 *  This function is used for checking that a light source
+	 *  adds some color, the same way as the cluster shader.
+	 ***********************************************************/
+	bool IsLightLit(const ShaderUniforms::LIGHT_SOURCE& light)
+	{
+		glm::vec3 color = light.ambientColor + light.diffuseColor;
+		if ((color.r > 0.0f) || (color.g > 0.0f) || (color.b > 0.0f))
+		{
+			return(true);
+		}
+
+		return((light.specularIntensity > 0.0f) &&
+			((light.specularColor.r > 0.0f) || (light.specularColor.g > 0.0f) || (light.specularColor.b > 0.0f)));
+	}
+}
+
+/***********************************************************
+ *  LightClusters()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightClusters::LightClusters()
+{
+	m_programID = 0;
+	m_viewLocation = -1;
+	m_projectionLocation = -1;
+	m_inverseProjectionLocation = -1;
+	m_lightCountLocation = -1;
+	m_clusterBuffer = 0;
+	m_bEnabled = true;
+	m_bAssigned = false;
+	m_lastView = glm::mat4(1.0f);
+	m_lastProjection = glm::mat4(1.0f);
+	for (int i = 0; i < 4; i++)
+	{
+		m_lastViewport[i] = 0;
+	}
+	m_lastLightRevision = -1;
+}
+
+/***********************************************************
+ *  ~LightClusters()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightClusters::~LightClusters()
+{
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+	if (0 != m_clusterBuffer)
+	{
+		glDeleteBuffers(1, &m_clusterBuffer);
+		m_clusterBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling and linking the cluster
+ *  shader from the passed in file.  0 is returned when the
+ *  file can not be read or the shader does not compile.
+ ***********************************************************/
+GLuint LightClusters::CompileProgram(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open the cluster shader file:" << filename << std::endl;
+		return(0);
+	}
+
+	std::stringstream source;
+	source << file.rdbuf();
+	std::string sourceText = source.str();
+	const char* pSource = sourceText.c_str();
+
+	GLint success = GL_FALSE;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &pSource, NULL);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (GL_FALSE == success)
+	{
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not compile the cluster shader:" << filename << std::endl << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (GL_FALSE == success)
+	{
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not link the cluster shader:" << filename << std::endl << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadShader()
+ *
+ *  This method is used for getting the cluster shader
+ *  program, from the program cache when one is passed in, or
+ *  else by compiling it.  False is returned when the shader
+ *  can not be built, and all the lights are then put into
+ *  one cluster.
+ ***********************************************************/
+bool LightClusters::LoadShader(const char* filename, ProgramBinaryCache* pProgramCache)
+{
+	GLuint programID = 0;
+
+	if (NULL != pProgramCache)
+	{
+		ProgramBinaryCache::SHADER_STAGE stage;
+		stage.type = GL_COMPUTE_SHADER;
+		stage.filename = filename;
+		programID = pProgramCache->LoadProgram(&stage, 1, "clusterShader");
+	}
+	else
+	{
+		programID = CompileProgram(filename);
+	}
+	if (0 == programID)
+	{
+		return(false);
+	}
+
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+	}
+	m_programID = programID;
+	m_viewLocation = glGetUniformLocation(m_programID, "view");
+	m_projectionLocation = glGetUniformLocation(m_programID, "projection");
+	m_inverseProjectionLocation = glGetUniformLocation(m_programID, "inverseProjection");
+	m_lightCountLocation = glGetUniformLocation(m_programID, "lightCount");
+	BindProgramBlocks();
+	m_bAssigned = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  BindProgramBlocks()
+ *
+ *  This method is used for attaching the storage blocks of
+ *  the cluster shader to the binding points that the scene
+ *  shader reads them from.
+ ***********************************************************/
+void LightClusters::BindProgramBlocks()
+{
+	const char* blockNames[] = { "LightBlock", "ClusterBlock" };
+	GLuint bindings[] = { ShaderUniforms::LIGHT_STORAGE_BINDING, ShaderUniforms::CLUSTER_STORAGE_BINDING };
+
+	for (int i = 0; i < 2; i++)
+	{
+		GLuint blockIndex = glGetProgramResourceIndex(m_programID, GL_SHADER_STORAGE_BLOCK, blockNames[i]);
+		if (GL_INVALID_INDEX == blockIndex)
+		{
+			std::cout << "Cluster shader does not declare the storage block " << blockNames[i] << std::endl;
+			continue;
+		}
+		glShaderStorageBlockBinding(m_programID, blockIndex, bindings[i]);
+	}
+}
+
+/***********************************************************
+ *  CreateClusterBuffer()
+ *
+ *  This method is used for creating the buffer of the
+ *  ClusterBlock, with room for the lists of all the clusters.
+ ***********************************************************/
+void LightClusters::CreateClusterBuffer()
+{
+	if (0 != m_clusterBuffer)
+	{
+		return;
+	}
+
+	glGenBuffers(1, &m_clusterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clusterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, g_ClusterBufferBytes, NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  AssignAllLights()
+ *
+ *  This method is used for writing one cluster that covers
+ *  the whole view and holds all the lit light sources.  It
+ *  is used without the cluster shader.
+ ***********************************************************/
+void LightClusters::AssignAllLights(const ShaderUniforms* pShaderUniforms)
+{
+	std::vector<GLuint> lightList(1, 0);
+
+	for (int i = 0; i < pShaderUniforms->GetLightCount(); i++)
+	{
+		if (IsLightLit(pShaderUniforms->GetLightSource(i)) == true)
+		{
+			lightList.push_back((GLuint)i);
+		}
+	}
+	lightList[0] = (GLuint)(lightList.size() - 1);
+
+	CLUSTER_HEADER header;
+	header.clusterCounts[0] = 1;
+	header.clusterCounts[1] = 1;
+	header.clusterCounts[2] = 1;
+	header.clusterCounts[3] = (GLuint)lightList.size();
+	header.screenToTile = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+	header.depthToSlice = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clusterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), &header);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(header), sizeof(GLuint) * lightList.size(), &lightList[0]);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Assign()
+ *
+ *  This method is used for assigning the light sources to
+ *  the clusters of the camera in the passed in uniforms and
+ *  of the passed in viewport, as x, y, width and height.
+ *  The compute pass runs one thread per cluster, and the
+ *  lights are shared by the threads of a work group in
+ *  batches, so every light is only read once per group.
+ *  The lists are left bound for the fragment shader, and the
+ *  current program is left unbound when the pass ran, so
+ *  the caller has to select its shader program again.
+ ***********************************************************/
+bool LightClusters::Assign(const ShaderUniforms* pShaderUniforms, const int viewport[4])
+{
+	if ((NULL == pShaderUniforms) || (0 == pShaderUniforms->GetLightBuffer()))
+	{
+		return(false);
+	}
+
+	CreateClusterBuffer();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ShaderUniforms::CLUSTER_STORAGE_BINDING, m_clusterBuffer);
+
+	const ShaderUniforms::CAMERA_BLOCK& camera = pShaderUniforms->GetCameraBlock();
+	bool bClustered = (m_bEnabled == true) && (IsLoaded() == true);
+
+	// the lists only change with the lights when they are not
+	// clustered, and also with the camera and viewport when they are
+	if ((m_bAssigned == true) && (m_lastLightRevision == pShaderUniforms->GetLightRevision()) &&
+		((bClustered == false) ||
+		 ((memcmp(&m_lastView, &camera.view, sizeof(m_lastView)) == 0) &&
+		  (memcmp(&m_lastProjection, &camera.projection, sizeof(m_lastProjection)) == 0) &&
+		  (memcmp(m_lastViewport, viewport, sizeof(m_lastViewport)) == 0))))
+	{
+		return(false);
+	}
+	m_bAssigned = true;
+	m_lastView = camera.view;
+	m_lastProjection = camera.projection;
+	memcpy(m_lastViewport, viewport, sizeof(m_lastViewport));
+	m_lastLightRevision = pShaderUniforms->GetLightRevision();
+
+	if (bClustered == false)
+	{
+		AssignAllLights(pShaderUniforms);
+		return(false);
+	}
+
+	// the view depth of the near and far planes, from a
+	// perspective or an orthographic projection
+	const glm::mat4& projection = camera.projection;
+	float nearDepth = 0.0f;
+	float farDepth = 0.0f;
+	if (projection[2][3] != 0.0f)
+	{
+		nearDepth = projection[3][2] / (projection[2][2] - 1.0f);
+		farDepth = projection[3][2] / (projection[2][2] + 1.0f);
+	}
+	else
+	{
+		nearDepth = (projection[3][2] + 1.0f) / projection[2][2];
+		farDepth = (projection[3][2] - 1.0f) / projection[2][2];
+	}
+	nearDepth = (nearDepth > g_MinimumNearDepth) ? nearDepth : g_MinimumNearDepth;
+	farDepth = (farDepth > nearDepth * 2.0f) ? farDepth : nearDepth * 2.0f;
+
+	float width = (viewport[2] > 0) ? (float)viewport[2] : 1.0f;
+	float height = (viewport[3] > 0) ? (float)viewport[3] : 1.0f;
+	float logDepthRange = log(farDepth / nearDepth);
+
+	CLUSTER_HEADER header;
+	header.clusterCounts[0] = CLUSTER_COUNT_X;
+	header.clusterCounts[1] = CLUSTER_COUNT_Y;
+	header.clusterCounts[2] = CLUSTER_COUNT_Z;
+	header.clusterCounts[3] = g_ClusterStride;
+	header.screenToTile = glm::vec4(
+		(float)viewport[0],
+		(float)viewport[1],
+		CLUSTER_COUNT_X / width,
+		CLUSTER_COUNT_Y / height);
+	header.depthToSlice = glm::vec4(
+		CLUSTER_COUNT_Z / logDepthRange,
+		CLUSTER_COUNT_Z * log(nearDepth) / logDepthRange,
+		nearDepth,
+		farDepth);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clusterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), &header);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ShaderUniforms::LIGHT_STORAGE_BINDING, pShaderUniforms->GetLightBuffer());
+
+	glm::mat4 inverseProjection = glm::inverse(projection);
+
+	glUseProgram(m_programID);
+	glUniformMatrix4fv(m_viewLocation, 1, GL_FALSE, glm::value_ptr(camera.view));
+	glUniformMatrix4fv(m_projectionLocation, 1, GL_FALSE, glm::value_ptr(projection));
+	glUniformMatrix4fv(m_inverseProjectionLocation, 1, GL_FALSE, glm::value_ptr(inverseProjection));
+	glUniform1ui(m_lightCountLocation, (GLuint)pShaderUniforms->GetLightCount());
+	glDispatchCompute((GLuint)((CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+	glUseProgram(0);
+
+	// the fragment shader reads the lists written by the pass
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for assigning the lights to clusters,
+ *  or for putting all of them into one cluster, which shades
+ *  every fragment with all the lit light sources.
+ ***********************************************************/
+void LightClusters::SetEnabled(bool bEnabled)
+{
+	m_bEnabled = bEnabled;
+	m_bAssigned = false;
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.h
+// ============
+// assign the light sources to view space clusters with a compute shader
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ProgramBinaryCache.h"
+#include "ShaderUniforms.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  LightClusters
+ *
+ *  This class splits the view frustum into a grid of
+ *  clusters - screen tiles that are cut into slices along
+ *  the view depth, with the slices growing exponentially
+ *  from the near to the far plane.  A compute pass tests the
+ *  bounding sphere of every light source against the bounds
+ *  of every cluster and writes the list of the lights that
+ *  reach each cluster into the ClusterBlock.  The fragment
+ *  shader then finds the cluster of the fragment and only
+ *  shades it with the lights in that list.  Light sources
+ *  without any color are left out of all the lists, and a
+ *  light with a radius of 0 is in every list.  The pass only
+ *  runs again when the camera, the viewport or the lights
+ *  have changed.
+ ***********************************************************/
+class LightClusters
+{
+public:
+	// constructor
+	LightClusters();
+	// destructor
+	~LightClusters();
+
+	// size of the cluster grid - the ClusterBlock holds a count
+	// and MAX_CLUSTER_LIGHTS light indices for every cluster
+	static const int CLUSTER_COUNT_X = 16;
+	static const int CLUSTER_COUNT_Y = 9;
+	static const int CLUSTER_COUNT_Z = 24;
+	static const int CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+	static const int MAX_CLUSTER_LIGHTS = 64;
+
+	// threads in one work group of the cluster shader
+	static const int WORKGROUP_SIZE = 64;
+
+	// start of the ClusterBlock - must match the cluster and the
+	// fragment shaders
+	struct CLUSTER_HEADER
+	{
+		// clusters along x, y and z, and the stride of the lists
+		GLuint clusterCounts[4];
+		// viewport origin and the tiles per pixel along x and y
+		glm::vec4 screenToTile;
+		// scale and bias from the log of the view depth to the
+		// slice, and the view depth of the near and far planes
+		glm::vec4 depthToSlice;
+	};
+
+private:
+	// the linked compute program
+	GLuint m_programID;
+	GLint m_viewLocation;
+	GLint m_projectionLocation;
+	GLint m_inverseProjectionLocation;
+	GLint m_lightCountLocation;
+	// buffer of the ClusterBlock
+	GLuint m_clusterBuffer;
+	// true to assign the lights to clusters, and false to put all
+	// of them into one cluster
+	bool m_bEnabled;
+	// inputs of the last pass, which is skipped when none of
+	// them has changed
+	bool m_bAssigned;
+	glm::mat4 m_lastView;
+	glm::mat4 m_lastProjection;
+	int m_lastViewport[4];
+	int m_lastLightRevision;
+
+	// compile and link the cluster shader from its file
+	GLuint CompileProgram(const char* filename);
+	// attach the storage blocks of the program to their binding points
+	void BindProgramBlocks();
+	// create the buffer of the ClusterBlock
+	void CreateClusterBuffer();
+	// put all the lit light sources into one cluster on the CPU
+	void AssignAllLights(const ShaderUniforms* pShaderUniforms);
+
+public:
+	// compile and link the cluster shader, or load it from the
+	// passed in program cache when it is not NULL
+	bool LoadShader(const char* filename, ProgramBinaryCache* pProgramCache = NULL);
+	// check whether the cluster shader has been loaded
+	bool IsLoaded() const { return (0 != m_programID); }
+
+	// assign the lights of the passed in uniforms to the clusters
+	// of its camera and of the passed in viewport, returns true
+	// when the compute pass ran and the current program is unbound
+	bool Assign(const ShaderUniforms* pShaderUniforms, const int viewport[4]);
+
+	// assign the lights to clusters, or put them all into one
+	void SetEnabled(bool bEnabled);
+	bool IsEnabled() const { return m_bEnabled; }
+};
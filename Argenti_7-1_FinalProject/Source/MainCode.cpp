@@ -1,5 +1,10 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // command line options
+#include <atomic>           // render thread
+#include <mutex>
+#include <string>
+#include <thread>
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +18,16 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "ProgramBinaryCache.h"
+#include "MeshCache.h"
+#include "ShaderUniforms.h"
+#include "FrameProfiler.h"
+#include "Benchmark.h"
+#include "DynamicResolution.h"
+#include "FramePacer.h"
+#include "FrameCapture.h"
+#include "FrameMailbox.h"
+#include "SimulationThread.h"
 
 // Namespace for declaring global variables
 namespace
@@ -27,14 +42,48 @@ namespace
 	SceneManager* g_SceneManager = nullptr;
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
+	// shader uniforms object for setting uniforms without name lookups
+	ShaderUniforms* g_ShaderUniforms = nullptr;
+	// program cache object for loading the linked shaders from disk
+	ProgramBinaryCache* g_ProgramCache = nullptr;
+	// mesh cache object for sharing the shape meshes between the scenes
+	MeshCache* g_MeshCache = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// frame profiler object for measuring the CPU and GPU time of every frame
+	FrameProfiler* g_FrameProfiler = nullptr;
+	// dynamic resolution object for drawing the scene at a lower resolution
+	// when the GPU falls behind, NULL to draw it into the window
+	DynamicResolution* g_DynamicResolution = nullptr;
+	// frame pacer object for deciding when the next frame is started
+	FramePacer* g_FramePacer = nullptr;
+
+	// warm up frames rendered before the benchmark is measured
+	const int g_BenchmarkWarmupFrames = 60;
+
+	// set to ask the render thread to finish
+	std::atomic<bool> g_bStopRendering(false);
+	// window title formatted by the render thread, which is set
+	// on the main thread because GLFW only allows it there
+	std::mutex g_WindowTitleMutex;
+	std::string g_WindowTitle;
+	// longest wait for input events on the main thread, in seconds
+	const double g_EventWaitSeconds = 0.05;
+	// frame rate that is aimed for when the display refresh rate is unknown
+	const int g_DefaultTargetFrameRate = 60;
+	// video memory the streamed texture levels may take, in megabytes
+	const int g_DefaultTextureBudgetMB = 256;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+void RenderFrame();
+int RunBenchmark(int frameCount, int sceneCopies);
+int RunCapture(const char* filename, int frameCount, int frameRate);
+void RunThreaded();
+void RenderThreadMain();
 
 
 /***********************************************************
@@ -45,6 +94,100 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// the scene is described by a text or binary scene file with
+	// the --scene <file> option instead of the built-in scene
+	const char* sceneFilename = NULL;
+	// the prepared scene is written into a scene file with the
+	// --export-scene <file> option
+	const char* exportFilename = NULL;
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--scene") == 0)
+		{
+			sceneFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--export-scene") == 0)
+		{
+			exportFilename = argv[++i];
+		}
+	}
+
+	// the --bake-textures option converts the scene textures into
+	// compressed files offline, and the --compile-scene <text>
+	// <binary> option converts a text scene file into a binary one,
+	// both without opening a window
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bake-textures") == 0)
+		{
+			return(SceneManager::BakeSceneTextures(sceneFilename) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		if ((strcmp(argv[i], "--compile-scene") == 0) && (i + 2 < argc))
+		{
+			return(SceneFile::Compile(argv[i + 1], argv[i + 2]) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+
+	// the --benchmark option renders a fixed number of frames into
+	// a hidden window along the scripted camera path, and prints
+	// the frame times - the scene can be repeated with the
+	// --benchmark-copies <count> option
+	bool bBenchmark = false;
+	int benchmarkFrames = 600;
+	int benchmarkCopies = 1;
+	// the window is rendered on its own thread and the camera is
+	// moved on a simulation thread, unless the --single-thread
+	// option is passed
+	bool bSingleThread = false;
+	// the linked shader programs are saved for the next launch,
+	// unless the --no-shader-cache option is passed
+	bool bShaderCache = true;
+	// the --capture <file> option renders the scripted camera path
+	// into a hidden window and writes the frames into a video, or
+	// into numbered images when the file ends in .tga - the scene
+	// clock moves by a fixed step of the --capture-fps <rate>
+	// option, and the --capture-frames <count> option sets the
+	// length, one loop of the path by default
+	const char* captureFilename = NULL;
+	int captureFrames = 0;
+	int captureFrameRate = 30;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			bBenchmark = true;
+		}
+		else if (strcmp(argv[i], "--single-thread") == 0)
+		{
+			bSingleThread = true;
+		}
+		else if (strcmp(argv[i], "--no-shader-cache") == 0)
+		{
+			bShaderCache = false;
+		}
+		else if ((strcmp(argv[i], "--benchmark-frames") == 0) && (i + 1 < argc))
+		{
+			benchmarkFrames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--benchmark-copies") == 0) && (i + 1 < argc))
+		{
+			benchmarkCopies = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--capture") == 0) && (i + 1 < argc))
+		{
+			captureFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--capture-frames") == 0) && (i + 1 < argc))
+		{
+			captureFrames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--capture-fps") == 0) && (i + 1 < argc))
+		{
+			captureFrameRate = atoi(argv[++i]);
+		}
+	}
+	bool bCapture = (NULL != captureFilename) && (bBenchmark == false);
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -53,12 +196,15 @@ int main(int argc, char* argv[])
 
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
+	// try to create a new shader uniforms object
+	g_ShaderUniforms = new ShaderUniforms();
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderManager,
+		g_ShaderUniforms);
 
 	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE, !bBenchmark && !bCapture);
 
 	// if GLEW fails initialization, then terminate the application
 	if (InitializeGLEW() == false)
@@ -66,52 +212,307 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		"../../Utilities/shaders/fragmentShader.glsl");
+	// try to create a new program cache object - the linked
+	// programs are kept in the ShaderCache folder, and they are
+	// only compiled again when a shader or the driver has changed
+	g_ProgramCache = new ProgramBinaryCache("ShaderCache");
+	g_ProgramCache->SetEnabled(bShaderCache);
+
+	// load the shader code from the external GLSL files - the
+	// project shaders declare the uniform blocks for the camera,
+	// the light sources and the material table
+	GLuint programID = g_ProgramCache->LoadProgram(
+		"Shaders/vertexShader.glsl",
+		"Shaders/fragmentShader.glsl",
+		"sceneShader");
+	if (0 != programID)
+	{
+		g_ShaderManager->m_programID = programID;
+	}
+	else
+	{
+		g_ShaderManager->LoadShaders(
+			"Shaders/vertexShader.glsl",
+			"Shaders/fragmentShader.glsl");
+	}
 	g_ShaderManager->use();
 
+	// look up the uniform locations once, so that the per-draw
+	// setters do not need any string lookups
+	g_ShaderUniforms->ResolveLocations(g_ShaderManager->m_programID);
+
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager(
+		g_ShaderManager,
+		g_ShaderUniforms);
+
+	// the repeated meshes are drawn instanced unless the
+	// --no-instancing option is passed on the command line, and
+	// the objects outside of the view are skipped unless the
+	// --no-culling option is passed, and small objects are drawn
+	// with fewer vertices unless the --no-lod option is passed -
+	// the shared meshes are drawn with multi-draw indirect calls
+	// unless the --no-indirect option is passed, and they are
+	// culled by a compute shader with the --gpu-culling option -
+	// the parts of the scene are recorded on several threads
+	// unless the --no-parallel-recording option is passed, and the
+	// fragments are only shaded with the lights of their cluster
+	// unless the --no-light-clusters option is passed - the opaque
+	// objects are drawn front to back, or batched by their state
+	// with the --state-sorted option, or lit after a depth-only
+	// pass with the --depth-prepass option - the edited shaders,
+	// textures and scene materials are rebuilt while the scene is
+	// running with the --hot-reload option, and the front, side
+	// and top views are drawn next to the camera view with the
+	// --multi-view option - the finer texture levels are streamed
+	// in within the --texture-budget-mb <size> budget unless the
+	// --no-texture-streaming option is passed, and the capture
+	// loads the whole images so that every run gives the same frames
+	bool bTextureStreaming = !bCapture;
+	int textureBudgetMB = g_DefaultTextureBudgetMB;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-instancing") == 0)
+		{
+			g_SceneManager->SetInstancedRendering(false);
+		}
+		else if (strcmp(argv[i], "--no-culling") == 0)
+		{
+			g_SceneManager->SetFrustumCulling(false);
+		}
+		else if (strcmp(argv[i], "--no-lod") == 0)
+		{
+			g_SceneManager->SetLevelOfDetail(false);
+		}
+		else if (strcmp(argv[i], "--no-indirect") == 0)
+		{
+			g_SceneManager->SetIndirectDrawing(false);
+		}
+		else if (strcmp(argv[i], "--gpu-culling") == 0)
+		{
+			g_SceneManager->SetGpuCulling(true);
+		}
+		else if (strcmp(argv[i], "--no-parallel-recording") == 0)
+		{
+			g_SceneManager->SetParallelRecording(false);
+		}
+		else if (strcmp(argv[i], "--no-light-clusters") == 0)
+		{
+			g_SceneManager->SetClusteredLighting(false);
+		}
+		else if (strcmp(argv[i], "--state-sorted") == 0)
+		{
+			g_SceneManager->SetRenderMode(SceneManager::RENDER_MODE_STATE_SORTED);
+		}
+		else if (strcmp(argv[i], "--depth-prepass") == 0)
+		{
+			g_SceneManager->SetRenderMode(SceneManager::RENDER_MODE_DEPTH_PREPASS);
+		}
+		else if (strcmp(argv[i], "--hot-reload") == 0)
+		{
+			g_SceneManager->SetHotReload(true);
+		}
+		else if (strcmp(argv[i], "--multi-view") == 0)
+		{
+			g_ViewManager->SetMultiView(true);
+			g_SceneManager->SetMultiView(true);
+		}
+		else if (strcmp(argv[i], "--no-texture-streaming") == 0)
+		{
+			bTextureStreaming = false;
+		}
+		else if ((strcmp(argv[i], "--texture-budget-mb") == 0) && (i + 1 < argc))
+		{
+			textureBudgetMB = atoi(argv[++i]);
+		}
+	}
+	if (textureBudgetMB <= 0)
+	{
+		textureBudgetMB = g_DefaultTextureBudgetMB;
+	}
+	g_SceneManager->SetTextureStreaming(bTextureStreaming, (size_t)textureBudgetMB * 1024 * 1024);
+
+	// try to create a new frame profiler object - the frames are
+	// streamed to a file with the --profile-csv <file> and the
+	// --profile-trace <file> options
+	g_FrameProfiler = new FrameProfiler();
+	g_FrameProfiler->Initialize();
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--profile-csv") == 0)
+		{
+			g_FrameProfiler->OpenCsvFile(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--profile-trace") == 0)
+		{
+			g_FrameProfiler->OpenTraceFile(argv[++i]);
+		}
+	}
+	g_SceneManager->SetProfiler(g_FrameProfiler);
+	g_SceneManager->SetProgramCache(g_ProgramCache);
+	g_MeshCache = new MeshCache();
+	g_SceneManager->SetMeshCache(g_MeshCache);
+
+	if (bBenchmark == true)
+	{
+		g_SceneManager->SetSceneCopies(benchmarkCopies);
+	}
+	if (NULL != sceneFilename)
+	{
+		g_SceneManager->LoadSceneFile(sceneFilename);
+	}
 	g_SceneManager->PrepareScene();
+	if (NULL != exportFilename)
+	{
+		g_SceneManager->SaveSceneFile(exportFilename);
+	}
 
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+	// the frames are timed by the display refresh, or with the
+	// --pacing vsync|adaptive|sleep|uncapped option, and the scene
+	// is drawn at a lower resolution whenever the GPU time is over
+	// the frame time of the --target-fps <rate> option, or of the
+	// display refresh rate, unless the --no-dynamic-resolution
+	// option is passed - the benchmark and the capture always draw
+	// at the full resolution without waiting for the display
+	int targetFrameRate = g_DefaultTargetFrameRate;
+	GLFWmonitor* pMonitor = glfwGetPrimaryMonitor();
+	const GLFWvidmode* pVideoMode = (NULL != pMonitor) ? glfwGetVideoMode(pMonitor) : NULL;
+	if ((NULL != pVideoMode) && (pVideoMode->refreshRate > 0))
+	{
+		targetFrameRate = pVideoMode->refreshRate;
+	}
+	bool bDynamicResolution = !bBenchmark && !bCapture;
+	g_FramePacer = new FramePacer();
+	for (int i = 1; i < argc; i++)
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		if (strcmp(argv[i], "--no-dynamic-resolution") == 0)
+		{
+			bDynamicResolution = false;
+		}
+		else if ((strcmp(argv[i], "--target-fps") == 0) && (i + 1 < argc))
+		{
+			int frameRate = atoi(argv[++i]);
+			if (frameRate > 0)
+			{
+				targetFrameRate = frameRate;
+			}
+		}
+		else if ((strcmp(argv[i], "--pacing") == 0) && (i + 1 < argc))
+		{
+			FramePacer::PACING_MODE pacingMode = FramePacer::PACING_VSYNC;
+			if (FramePacer::ParseMode(argv[++i], pacingMode) == true)
+			{
+				g_FramePacer->SetMode(pacingMode);
+			}
+		}
+	}
+	g_FramePacer->SetTargetFrameTime(1000.0 / (double)targetFrameRate);
+	if (bDynamicResolution == true)
+	{
+		g_DynamicResolution = new DynamicResolution();
+		g_DynamicResolution->SetTargetFrameTime(1000.0 / (double)targetFrameRate);
+		g_DynamicResolution->LoadShader(
+			"Shaders/upscaleVertexShader.glsl",
+			"Shaders/upscaleFragmentShader.glsl",
+			g_ProgramCache);
+		// the upscale shader is loaded after the scene shader
+		g_ShaderManager->use();
+	}
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	int exitCode = EXIT_SUCCESS;
+	if (bBenchmark == true)
+	{
+		exitCode = RunBenchmark(benchmarkFrames, benchmarkCopies);
+	}
+	else if (bCapture == true)
+	{
+		exitCode = RunCapture(captureFilename, captureFrames, captureFrameRate);
+	}
+	else if (bSingleThread == false)
+	{
+		RunThreaded();
+	}
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+	bool bInteractive = (bBenchmark == false) && (bCapture == false) && (bSingleThread == true);
+	if (bInteractive == true)
+	{
+		g_FramePacer->Apply();
+	}
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while ((bInteractive == true) && !glfwWindowShouldClose(g_Window))
+	{
+		g_FrameProfiler->BeginFrame();
+
+		// render the 3D scene into the back buffer
+		RenderFrame();
 
+		// draw the frame timings over the scene
+		g_FrameProfiler->DrawOverlay(g_Window, WINDOW_TITLE);
 
 		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_SWAP_BUFFERS);
+			glfwSwapBuffers(g_Window);
+		}
+
+		// wait until the next frame is due
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_PACE_FRAME);
+			g_FramePacer->WaitForNextFrame();
+		}
 
 		// query the latest GLFW events
-		glfwPollEvents();
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_POLL_EVENTS);
+			glfwPollEvents();
+		}
+
+		g_FrameProfiler->EndFrame();
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_DynamicResolution)
+	{
+		delete g_DynamicResolution;
+		g_DynamicResolution = NULL;
+	}
+	if (NULL != g_FramePacer)
+	{
+		delete g_FramePacer;
+		g_FramePacer = NULL;
+	}
+	if (NULL != g_FrameProfiler)
+	{
+		delete g_FrameProfiler;
+		g_FrameProfiler = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	if (NULL != g_MeshCache)
+	{
+		delete g_MeshCache;
+		g_MeshCache = NULL;
+	}
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
+	if (NULL != g_ShaderUniforms)
+	{
+		delete g_ShaderUniforms;
+		g_ShaderUniforms = NULL;
+	}
+	if (NULL != g_ProgramCache)
+	{
+		delete g_ProgramCache;
+		g_ProgramCache = NULL;
+	}
 	if (NULL != g_ShaderManager)
 	{
 		delete g_ShaderManager;
@@ -119,7 +520,305 @@ int main(int argc, char* argv[])
 	}
 
 	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	exit(exitCode); 
+}
+
+/***********************************************************
+ *	RenderFrame()
+ *
+ *  This function is used to render one frame of the 3D scene
+ *  into the bound framebuffer, or into the target of the
+ *  dynamic resolution, which is then stretched over the
+ *  window.  The viewport follows the size of the window, so
+ *  a resized window is drawn at its new size.
+ ***********************************************************/
+void RenderFrame()
+{
+	g_ShaderUniforms->ResetUploadCount();
+
+	int width = g_ViewManager->GetWindowWidth();
+	int height = g_ViewManager->GetWindowHeight();
+	bool bScaled = false;
+	if (NULL != g_DynamicResolution)
+	{
+		bScaled = g_DynamicResolution->BeginFrame(width, height, g_FrameProfiler->GetLatestGpuTime());
+	}
+	if (bScaled == true)
+	{
+		width = g_DynamicResolution->GetRenderWidth();
+		height = g_DynamicResolution->GetRenderHeight();
+	}
+	else
+	{
+		glViewport(0, 0, width, height);
+	}
+	g_SceneManager->SetViewport(0, 0, width, height);
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// convert from 3D object space to 2D view
+	{
+		ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_PREPARE_SCENE_VIEW);
+		g_ViewManager->PrepareSceneView();
+	}
+
+	// refresh the 3D scene
+	g_SceneManager->RenderScene();
+
+	int scalePercent = 100;
+	if (bScaled == true)
+	{
+		ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_UPSCALE);
+		g_DynamicResolution->EndFrame();
+		// the upscale pass unbinds the scene shader program
+		g_ShaderManager->use();
+		scalePercent = (int)(g_DynamicResolution->GetScale() * 100.0f + 0.5f);
+	}
+
+	g_FrameProfiler->SetCounter(FrameProfiler::COUNTER_DRAW_CALLS, g_SceneManager->GetDrawCallCount());
+	g_FrameProfiler->SetCounter(FrameProfiler::COUNTER_UNIFORM_UPLOADS, g_ShaderUniforms->GetUploadCount());
+	g_FrameProfiler->SetCounter(FrameProfiler::COUNTER_FRAME_ARENA_KILOBYTES, g_SceneManager->GetFrameArenaBytes() / 1024);
+	g_FrameProfiler->SetCounter(FrameProfiler::COUNTER_RENDER_SCALE_PERCENT, scalePercent);
+}
+
+/***********************************************************
+ *	RunBenchmark()
+ *
+ *  This function is used to render the benchmark frames into
+ *  an offscreen framebuffer with vsync off.  The camera moves
+ *  along the scripted path by a fixed step per frame, so every
+ *  run renders exactly the same frames.  Timing starts after
+ *  all the textures are loaded and the warm up frames are
+ *  done.
+ ***********************************************************/
+int RunBenchmark(int frameCount, int sceneCopies)
+{
+	if (frameCount <= 0)
+	{
+		std::cout << "The benchmark needs at least one frame" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	Benchmark* pBenchmark = new Benchmark();
+	if (pBenchmark->CreateFramebuffer(g_ViewManager->GetWindowWidth(), g_ViewManager->GetWindowHeight()) == false)
+	{
+		delete pBenchmark;
+		return(EXIT_FAILURE);
+	}
+
+	// do not wait for the display refresh
+	glfwSwapInterval(0);
+
+	float pathStep = g_ViewManager->GetCameraPathDuration() / (float)frameCount;
+	int warmupFrames = 0;
+
+	while ((pBenchmark->GetMeasuredFrames() < frameCount) && !glfwWindowShouldClose(g_Window))
+	{
+		if ((pBenchmark->IsMeasuring() == false) &&
+			(warmupFrames >= g_BenchmarkWarmupFrames) &&
+			(g_SceneManager->IsSceneLoaded() == true))
+		{
+			pBenchmark->StartMeasuring();
+		}
+
+		g_FrameProfiler->BeginFrame();
+		pBenchmark->BeginFrame();
+
+		// the warm up frames all show the start of the camera path
+		g_ViewManager->SetCameraPathTime(pathStep * (float)pBenchmark->GetMeasuredFrames());
+		RenderFrame();
+
+		pBenchmark->EndFrame(g_SceneManager->GetObjectCount());
+		warmupFrames++;
+
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_POLL_EVENTS);
+			glfwPollEvents();
+		}
+
+		g_FrameProfiler->EndFrame();
+	}
+
+	pBenchmark->PrintResults(sceneCopies);
+
+	delete pBenchmark;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(EXIT_SUCCESS);
+}
+
+/***********************************************************
+ *	RunCapture()
+ *
+ *  This function is used to render the frames of the scripted
+ *  camera path into the offscreen framebuffer of the frame
+ *  capture, which hands them to its encoder thread.  The
+ *  scene clock moves by one frame of the capture rate per
+ *  frame, and vsync is off, so the capture runs as fast as
+ *  the frames can be drawn and always gives the same frames.
+ *  The frames before all the textures are loaded show the
+ *  start of the path and are not captured.
+ ***********************************************************/
+int RunCapture(const char* filename, int frameCount, int frameRate)
+{
+	if (frameRate <= 0)
+	{
+		std::cout << "The capture needs a frame rate of at least one frame per second" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	if (frameCount <= 0)
+	{
+		frameCount = (int)(g_ViewManager->GetCameraPathDuration() * (float)frameRate + 0.5f);
+	}
+
+	FrameCapture* pCapture = new FrameCapture();
+	if (pCapture->Start(filename, g_ViewManager->GetWindowWidth(), g_ViewManager->GetWindowHeight(), frameRate) == false)
+	{
+		delete pCapture;
+		return(EXIT_FAILURE);
+	}
+
+	// do not wait for the display refresh
+	glfwSwapInterval(0);
+
+	float timeStep = 1.0f / (float)frameRate;
+	g_ViewManager->SetFixedTimeStep(timeStep);
+
+	bool bCaptured = true;
+	while ((bCaptured == true) && (pCapture->GetCapturedFrames() < frameCount) && !glfwWindowShouldClose(g_Window))
+	{
+		g_FrameProfiler->BeginFrame();
+		pCapture->BeginFrame();
+
+		g_ViewManager->SetCameraPathTime(timeStep * (float)pCapture->GetCapturedFrames());
+		RenderFrame();
+
+		if (g_SceneManager->IsSceneLoaded() == true)
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_CAPTURE_FRAME);
+			bCaptured = pCapture->CaptureFrame();
+		}
+
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_POLL_EVENTS);
+			glfwPollEvents();
+		}
+
+		g_FrameProfiler->EndFrame();
+	}
+
+	bool bSuccess = pCapture->Finish() && (bCaptured == true);
+	g_ViewManager->SetFixedTimeStep(0.0f);
+
+	delete pCapture;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(bSuccess ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	RunThreaded()
+ *
+ *  This function is used to run the window with three
+ *  threads.  The main thread only waits for the GLFW events
+ *  and captures the input, as GLFW requires, the simulation
+ *  thread moves the camera and publishes frame snapshots, and
+ *  the render thread draws the latest snapshot.  The OpenGL
+ *  context is current on the render thread while it runs,
+ *  and it is made current on the main thread again at the
+ *  end, so the managers can free their OpenGL objects.
+ ***********************************************************/
+void RunThreaded()
+{
+	FrameMailbox* pMailbox = new FrameMailbox();
+	SimulationThread* pSimulation = new SimulationThread(g_ViewManager, pMailbox);
+
+	// the camera is only moved by the simulation thread from now on
+	g_ViewManager->SetFrameMailbox(pMailbox);
+	pSimulation->Start();
+
+	glfwMakeContextCurrent(NULL);
+	g_bStopRendering.store(false);
+	std::thread renderThread(RenderThreadMain);
+
+	std::string shownTitle;
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		// the mouse callbacks are called while the events are handled
+		glfwWaitEventsTimeout(g_EventWaitSeconds);
+		g_ViewManager->PollInput();
+
+		std::string title;
+		{
+			std::lock_guard<std::mutex> lock(g_WindowTitleMutex);
+			title = g_WindowTitle;
+		}
+		if ((title.empty() == false) && (title != shownTitle))
+		{
+			glfwSetWindowTitle(g_Window, title.c_str());
+			shownTitle = title;
+		}
+	}
+
+	g_bStopRendering.store(true);
+	renderThread.join();
+	pSimulation->Stop();
+	g_ViewManager->SetFrameMailbox(NULL);
+
+	delete pSimulation;
+	delete pMailbox;
+
+	glfwMakeContextCurrent(g_Window);
+}
+
+/***********************************************************
+ *	RenderThreadMain()
+ *
+ *  This function is the loop of the render thread.  Each
+ *  frame draws the latest snapshot of the simulation thread
+ *  and hands the window title to the main thread.
+ ***********************************************************/
+void RenderThreadMain()
+{
+	glfwMakeContextCurrent(g_Window);
+	// the swap interval belongs to the context on this thread
+	g_FramePacer->Apply();
+
+	while (g_bStopRendering.load() == false)
+	{
+		g_FrameProfiler->BeginFrame();
+
+		// render the 3D scene into the back buffer
+		RenderFrame();
+
+		// draw the frame timings over the scene
+		g_FrameProfiler->DrawOverlay(NULL, WINDOW_TITLE);
+
+		// Flips the the back buffer with the front buffer every frame.
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_SWAP_BUFFERS);
+			glfwSwapBuffers(g_Window);
+		}
+
+		// wait until the next frame is due
+		{
+			ProfileZone zone(g_FrameProfiler, FrameProfiler::ZONE_PACE_FRAME);
+			g_FramePacer->WaitForNextFrame();
+		}
+
+		g_FrameProfiler->EndFrame();
+
+		std::string title = g_FrameProfiler->FormatTitle(WINDOW_TITLE);
+		std::lock_guard<std::mutex> lock(g_WindowTitleMutex);
+		g_WindowTitle = title;
+	}
+
+	glfwMakeContextCurrent(NULL);
 }
 
 /***********************************************************
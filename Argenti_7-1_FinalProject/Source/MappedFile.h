@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// read-only memory mapping of a whole file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a file into memory for reading, so that
+ *  its contents can be handed to OpenGL without copying them
+ *  into a separate buffer first.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+private:
+	// the mapped contents of the file
+	const unsigned char* m_pData;
+	size_t m_size;
+#ifdef _WIN32
+	// handles of the opened file and of its mapping
+	void* m_hFile;
+	void* m_hMapping;
+#endif
+
+	// the mapping can not be shared between two objects
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	// map the passed in file into memory
+	bool Open(const char* filename);
+	// unmap the file
+	void Close();
+
+	// access the mapped contents
+	bool IsOpen() const { return m_pData != NULL; }
+	const unsigned char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_size; }
+};
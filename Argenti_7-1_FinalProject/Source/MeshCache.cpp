@@ -0,0 +1,514 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// share the procedural meshes between scenes and load them when first used
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+// declaration of global variables and defines
+namespace
+{
+	/***********************************************************
+	 *  GetInstancedMesh()
+	 *
+	 *  This function is used for getting the instanced mesh
+	 *  of a primitive.  INSTANCED_MESH_COUNT is returned for the
+	 *  primitives that have no levels of detail.
+	 ***********************************************************/
+	InstancedMeshes::INSTANCED_MESH GetInstancedMesh(SceneGraph::MESH_TYPE mesh)
+	{
+		InstancedMeshes::INSTANCED_MESH instancedMesh = InstancedMeshes::INSTANCED_MESH_COUNT;
+
+		switch (mesh)
+		{
+		case SceneGraph::MESH_BOX:
+			instancedMesh = InstancedMeshes::INSTANCED_BOX;
+			break;
+		case SceneGraph::MESH_CYLINDER:
+			instancedMesh = InstancedMeshes::INSTANCED_CYLINDER;
+			break;
+		case SceneGraph::MESH_SPHERE:
+			instancedMesh = InstancedMeshes::INSTANCED_SPHERE;
+			break;
+		default:
+			break;
+		}
+
+		return(instancedMesh);
+	}
+
+	/***********************************************************
+	 *  GetPrimitive()
+	 *
+	 *  This function is used for getting the primitive that an
+	 *  instanced mesh is built for.
+	 ***********************************************************/
+	SceneGraph::MESH_TYPE GetPrimitive(InstancedMeshes::INSTANCED_MESH instancedMesh)
+	{
+		SceneGraph::MESH_TYPE mesh = SceneGraph::MESH_NONE;
+
+		switch (instancedMesh)
+		{
+		case InstancedMeshes::INSTANCED_BOX:
+			mesh = SceneGraph::MESH_BOX;
+			break;
+		case InstancedMeshes::INSTANCED_CYLINDER:
+			mesh = SceneGraph::MESH_CYLINDER;
+			break;
+		case InstancedMeshes::INSTANCED_SPHERE:
+			mesh = SceneGraph::MESH_SPHERE;
+			break;
+		default:
+			break;
+		}
+
+		return(mesh);
+	}
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache()
+{
+	m_pShapeMeshes = new ShapeMeshes();
+	m_pInstancedMeshes = new InstancedMeshes();
+
+	for (int tessellation = 0; tessellation < TESSELLATION_COUNT; tessellation++)
+	{
+		for (int mesh = 0; mesh < PRIMITIVE_COUNT; mesh++)
+		{
+			m_entries[tessellation][mesh].refCount = 0;
+			m_entries[tessellation][mesh].residency = MESH_NOT_LOADED;
+			m_entries[tessellation][mesh].bPrefetch = false;
+		}
+	}
+	m_drawLoads = 0;
+	m_prefetchLoads = 0;
+
+	// the meshes are small, so one thread is enough to build them
+	m_bStopWorker = false;
+	m_worker = std::thread(&MeshCache::WorkerThread, this);
+}
+
+/***********************************************************
+ *  ~MeshCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshCache::~MeshCache()
+{
+	// stop the worker thread - a mesh that is being built is
+	// finished first
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_bStopWorker = true;
+		m_requests.clear();
+	}
+	m_requestAvailable.notify_all();
+	m_worker.join();
+
+	// free the meshes that were never uploaded
+	while (m_builtMeshes.empty() == false)
+	{
+		delete m_builtMeshes.front();
+		m_builtMeshes.pop_front();
+	}
+
+	if (NULL != m_pShapeMeshes)
+	{
+		delete m_pShapeMeshes;
+		m_pShapeMeshes = NULL;
+	}
+	if (NULL != m_pInstancedMeshes)
+	{
+		delete m_pInstancedMeshes;
+		m_pInstancedMeshes = NULL;
+	}
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method is used for building the vertices and indices
+ *  of the prefetched instanced meshes.  The built meshes are
+ *  queued for the GL thread to upload.
+ ***********************************************************/
+void MeshCache::WorkerThread()
+{
+	while (true)
+	{
+		InstancedMeshes::INSTANCED_MESH mesh;
+
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_requestAvailable.wait(lock, [this] { return (m_bStopWorker == true) || (m_requests.empty() == false); });
+			if (m_bStopWorker == true)
+			{
+				return;
+			}
+			mesh = m_requests.front();
+			m_requests.pop_front();
+		}
+
+		BUILT_MESH* pBuiltMesh = new BUILT_MESH();
+		pBuiltMesh->mesh = mesh;
+		pBuiltMesh->levelCount = InstancedMeshes::BuildMeshGeometry(mesh, pBuiltMesh->levels);
+
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_builtMeshes.push_back(pBuiltMesh);
+	}
+}
+
+/***********************************************************
+ *  GetEntry()
+ *
+ *  This method is used for getting the cache entry of a
+ *  primitive at a tessellation.  The half torus is drawn from
+ *  the torus mesh, so they share one entry.  NULL is returned
+ *  for the primitives that are not generated at the passed in
+ *  tessellation.
+ ***********************************************************/
+MeshCache::MESH_ENTRY* MeshCache::GetEntry(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation)
+{
+	return(const_cast<MESH_ENTRY*>(static_cast<const MeshCache*>(this)->GetEntry(mesh, tessellation)));
+}
+
+const MeshCache::MESH_ENTRY* MeshCache::GetEntry(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation) const
+{
+	if ((mesh < 0) || (mesh >= PRIMITIVE_COUNT) ||
+		(tessellation < 0) || (tessellation >= TESSELLATION_COUNT))
+	{
+		return(NULL);
+	}
+
+	if (tessellation == TESSELLATION_LOD_CHAIN)
+	{
+		if (GetInstancedMesh(mesh) == InstancedMeshes::INSTANCED_MESH_COUNT)
+		{
+			return(NULL);
+		}
+	}
+	else if (mesh == SceneGraph::MESH_HALF_TORUS)
+	{
+		mesh = SceneGraph::MESH_TORUS;
+	}
+
+	return(&m_entries[tessellation][mesh]);
+}
+
+/***********************************************************
+ *  LoadBasicMesh()
+ *
+ *  This method is used for generating and uploading one of
+ *  the basic shape meshes.  The shape meshes upload while
+ *  they are generated, so this has to run on the GL thread.
+ ***********************************************************/
+void MeshCache::LoadBasicMesh(SceneGraph::MESH_TYPE mesh)
+{
+	MESH_ENTRY* pEntry = GetEntry(mesh, TESSELLATION_BASIC);
+
+	if ((NULL == pEntry) || (pEntry->residency == MESH_RESIDENT))
+	{
+		return;
+	}
+
+	switch (mesh)
+	{
+	case SceneGraph::MESH_BOX:
+		m_pShapeMeshes->LoadBoxMesh();
+		break;
+	case SceneGraph::MESH_PLANE:
+		m_pShapeMeshes->LoadPlaneMesh();
+		break;
+	case SceneGraph::MESH_CYLINDER:
+		m_pShapeMeshes->LoadCylinderMesh();
+		break;
+	case SceneGraph::MESH_CONE:
+		m_pShapeMeshes->LoadConeMesh();
+		break;
+	case SceneGraph::MESH_PRISM:
+		m_pShapeMeshes->LoadPrismMesh();
+		break;
+	case SceneGraph::MESH_PYRAMID4:
+		m_pShapeMeshes->LoadPyramid4Mesh();
+		break;
+	case SceneGraph::MESH_SPHERE:
+		m_pShapeMeshes->LoadSphereMesh();
+		break;
+	case SceneGraph::MESH_TAPERED_CYLINDER:
+		m_pShapeMeshes->LoadTaperedCylinderMesh();
+		break;
+	case SceneGraph::MESH_TORUS:
+	case SceneGraph::MESH_HALF_TORUS:
+		m_pShapeMeshes->LoadTorusMesh();
+		break;
+	default:
+		break;
+	}
+
+	pEntry->residency = MESH_RESIDENT;
+}
+
+/***********************************************************
+ *  AcquireMesh()
+ *
+ *  This method is used for adding a user of a mesh.  Nothing
+ *  is loaded until the mesh is drawn or prefetched.
+ ***********************************************************/
+void MeshCache::AcquireMesh(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation)
+{
+	MESH_ENTRY* pEntry = GetEntry(mesh, tessellation);
+
+	if (NULL != pEntry)
+	{
+		pEntry->refCount++;
+	}
+}
+
+/***********************************************************
+ *  ReleaseMesh()
+ *
+ *  This method is used for removing a user of a mesh.  An
+ *  instanced mesh that nobody uses any more is removed from
+ *  the shared buffers.  The shape meshes have no way to free
+ *  one mesh, so a basic mesh stays resident until the cache
+ *  is destroyed.
+ ***********************************************************/
+void MeshCache::ReleaseMesh(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation)
+{
+	MESH_ENTRY* pEntry = GetEntry(mesh, tessellation);
+
+	if ((NULL == pEntry) || (pEntry->refCount <= 0))
+	{
+		return;
+	}
+
+	pEntry->refCount--;
+	if (pEntry->refCount > 0)
+	{
+		return;
+	}
+
+	pEntry->bPrefetch = false;
+	if ((tessellation == TESSELLATION_LOD_CHAIN) && (pEntry->residency == MESH_RESIDENT))
+	{
+		m_pInstancedMeshes->UnloadMesh(GetInstancedMesh(mesh));
+		pEntry->residency = MESH_NOT_LOADED;
+	}
+}
+
+/***********************************************************
+ *  PrefetchMesh()
+ *
+ *  This method is used for loading an acquired mesh before it
+ *  is first drawn.  The instanced meshes are built on the
+ *  worker thread.  The basic meshes are uploaded while they
+ *  are generated, so they are loaded by the next call of
+ *  ProcessLoads() on the GL thread.
+ ***********************************************************/
+void MeshCache::PrefetchMesh(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation)
+{
+	MESH_ENTRY* pEntry = GetEntry(mesh, tessellation);
+
+	if ((NULL == pEntry) || (pEntry->refCount <= 0) || (pEntry->residency != MESH_NOT_LOADED))
+	{
+		return;
+	}
+
+	if (tessellation == TESSELLATION_LOD_CHAIN)
+	{
+		pEntry->residency = MESH_GENERATING;
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_requests.push_back(GetInstancedMesh(mesh));
+		}
+		m_requestAvailable.notify_one();
+	}
+	else
+	{
+		pEntry->bPrefetch = true;
+	}
+}
+
+/***********************************************************
+ *  ProcessLoads()
+ *
+ *  This method is used for uploading the instanced meshes
+ *  that the worker thread has built and the basic meshes
+ *  that have been prefetched.  A built mesh that nobody uses
+ *  any more is dropped.  The number of uploaded meshes is
+ *  returned.
+ ***********************************************************/
+int MeshCache::ProcessLoads()
+{
+	int loadCount = 0;
+
+	while (true)
+	{
+		BUILT_MESH* pBuiltMesh = NULL;
+
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			if (m_builtMeshes.empty() == true)
+			{
+				break;
+			}
+			pBuiltMesh = m_builtMeshes.front();
+			m_builtMeshes.pop_front();
+		}
+
+		MESH_ENTRY* pEntry = GetEntry(GetPrimitive(pBuiltMesh->mesh), TESSELLATION_LOD_CHAIN);
+
+		if (NULL == pEntry)
+		{
+			delete pBuiltMesh;
+			continue;
+		}
+		if ((pEntry->refCount > 0) && (pEntry->residency == MESH_GENERATING))
+		{
+			m_pInstancedMeshes->StoreMesh(pBuiltMesh->mesh, pBuiltMesh->levels, pBuiltMesh->levelCount);
+			pEntry->residency = MESH_RESIDENT;
+			m_prefetchLoads++;
+			loadCount++;
+		}
+		else if (pEntry->residency == MESH_GENERATING)
+		{
+			pEntry->residency = MESH_NOT_LOADED;
+		}
+		delete pBuiltMesh;
+	}
+
+	for (int mesh = 0; mesh < PRIMITIVE_COUNT; mesh++)
+	{
+		MESH_ENTRY& entry = m_entries[TESSELLATION_BASIC][mesh];
+
+		if ((entry.bPrefetch == true) && (entry.residency != MESH_RESIDENT))
+		{
+			LoadBasicMesh((SceneGraph::MESH_TYPE)mesh);
+			m_prefetchLoads++;
+			loadCount++;
+		}
+		entry.bPrefetch = false;
+	}
+
+	return(loadCount);
+}
+
+/***********************************************************
+ *  DrawBasicMesh()
+ *
+ *  This method is used for drawing a basic shape mesh.  The
+ *  mesh is generated and uploaded the first time it is drawn.
+ ***********************************************************/
+void MeshCache::DrawBasicMesh(SceneGraph::MESH_TYPE mesh)
+{
+	const MESH_ENTRY* pEntry = GetEntry(mesh, TESSELLATION_BASIC);
+
+	if (NULL == pEntry)
+	{
+		return;
+	}
+	if (pEntry->residency != MESH_RESIDENT)
+	{
+		LoadBasicMesh(mesh);
+		m_drawLoads++;
+	}
+
+	switch (mesh)
+	{
+	case SceneGraph::MESH_BOX:
+		m_pShapeMeshes->DrawBoxMesh();
+		break;
+	case SceneGraph::MESH_PLANE:
+		m_pShapeMeshes->DrawPlaneMesh();
+		break;
+	case SceneGraph::MESH_CYLINDER:
+		m_pShapeMeshes->DrawCylinderMesh();
+		break;
+	case SceneGraph::MESH_CONE:
+		m_pShapeMeshes->DrawConeMesh();
+		break;
+	case SceneGraph::MESH_PRISM:
+		m_pShapeMeshes->DrawPrismMesh();
+		break;
+	case SceneGraph::MESH_PYRAMID4:
+		m_pShapeMeshes->DrawPyramid4Mesh();
+		break;
+	case SceneGraph::MESH_SPHERE:
+		m_pShapeMeshes->DrawSphereMesh();
+		break;
+	case SceneGraph::MESH_TAPERED_CYLINDER:
+		m_pShapeMeshes->DrawTaperedCylinderMesh();
+		break;
+	case SceneGraph::MESH_TORUS:
+		m_pShapeMeshes->DrawTorusMesh();
+		break;
+	case SceneGraph::MESH_HALF_TORUS:
+		m_pShapeMeshes->DrawHalfTorusMesh();
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  IsMeshResident()
+ *
+ *  This method is used for checking whether a mesh has been
+ *  uploaded and can be drawn.
+ ***********************************************************/
+bool MeshCache::IsMeshResident(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation) const
+{
+	const MESH_ENTRY* pEntry = GetEntry(mesh, tessellation);
+
+	return((NULL != pEntry) && (pEntry->residency == MESH_RESIDENT));
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for counting the resident and the
+ *  referenced meshes of the cache.
+ ***********************************************************/
+MeshCache::RESIDENCY_STATS MeshCache::GetStats() const
+{
+	RESIDENCY_STATS stats;
+
+	stats.residentMeshes = 0;
+	stats.referencedMeshes = 0;
+	stats.drawLoads = m_drawLoads;
+	stats.prefetchLoads = m_prefetchLoads;
+	stats.unusedResidentMeshes = 0;
+	stats.instancedBytes = 0;
+
+	for (int tessellation = 0; tessellation < TESSELLATION_COUNT; tessellation++)
+	{
+		for (int mesh = 0; mesh < PRIMITIVE_COUNT; mesh++)
+		{
+			const MESH_ENTRY& entry = m_entries[tessellation][mesh];
+
+			if (entry.refCount > 0)
+			{
+				stats.referencedMeshes++;
+			}
+			if (entry.residency == MESH_RESIDENT)
+			{
+				stats.residentMeshes++;
+				if (entry.refCount <= 0)
+				{
+					stats.unusedResidentMeshes++;
+				}
+			}
+		}
+	}
+	for (int mesh = 0; mesh < InstancedMeshes::INSTANCED_MESH_COUNT; mesh++)
+	{
+		stats.instancedBytes += m_pInstancedMeshes->GetMeshBytes((InstancedMeshes::INSTANCED_MESH)mesh);
+	}
+
+	return(stats);
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// share the procedural meshes between scenes and load them when first used
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeMeshes.h"
+#include "InstancedMeshes.h"
+#include "SceneGraph.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/***********************************************************
+ *  MeshCache
+ *
+ *  This class holds the procedural meshes of the whole
+ *  program, so the scenes and viewports that draw the same
+ *  primitive share one copy of it.  A mesh is kept per
+ *  primitive and tessellation, and is only generated and
+ *  uploaded the first time it is drawn, or on a worker thread
+ *  when a prefetch hint is given for it.  The scenes acquire
+ *  the meshes they use and release them when they go away,
+ *  and a mesh that nobody uses any more is freed.
+ ***********************************************************/
+class MeshCache
+{
+public:
+	// constructor
+	MeshCache();
+	// destructor
+	~MeshCache();
+
+	// tessellations that a primitive is cached at
+	enum MESH_TESSELLATION
+	{
+		// the one tessellation of the basic shape meshes
+		TESSELLATION_BASIC = 0,
+		// the levels of detail of the instanced meshes
+		TESSELLATION_LOD_CHAIN,
+		TESSELLATION_COUNT
+	};
+
+	// number of primitives of the scene graph
+	static const int PRIMITIVE_COUNT = SceneGraph::MESH_HALF_TORUS + 1;
+
+	// residency of the cached meshes
+	struct RESIDENCY_STATS
+	{
+		int residentMeshes;
+		int referencedMeshes;
+		// meshes that were loaded when they were first drawn
+		int drawLoads;
+		// meshes that were loaded from a prefetch hint
+		int prefetchLoads;
+		// resident meshes that nobody uses any more and can not be freed
+		int unusedResidentMeshes;
+		// size of the resident instanced meshes
+		size_t instancedBytes;
+	};
+
+private:
+	enum MESH_RESIDENCY
+	{
+		MESH_NOT_LOADED = 0,
+		// the mesh is built on the worker thread
+		MESH_GENERATING,
+		MESH_RESIDENT
+	};
+
+	struct MESH_ENTRY
+	{
+		int refCount;
+		MESH_RESIDENCY residency;
+		// true to load the mesh before it is first drawn
+		bool bPrefetch;
+	};
+
+	// a mesh that has been built on the worker thread
+	struct BUILT_MESH
+	{
+		InstancedMeshes::INSTANCED_MESH mesh;
+		InstancedMeshes::MESH_GEOMETRY levels[InstancedMeshes::LOD_LEVEL_COUNT];
+		int levelCount;
+	};
+
+	// the cached meshes
+	ShapeMeshes* m_pShapeMeshes;
+	InstancedMeshes* m_pInstancedMeshes;
+	MESH_ENTRY m_entries[TESSELLATION_COUNT][PRIMITIVE_COUNT];
+	int m_drawLoads;
+	int m_prefetchLoads;
+
+	// worker thread and the queues shared with it
+	std::thread m_worker;
+	std::mutex m_queueMutex;
+	std::condition_variable m_requestAvailable;
+	std::deque<InstancedMeshes::INSTANCED_MESH> m_requests;
+	std::deque<BUILT_MESH*> m_builtMeshes;
+	bool m_bStopWorker;
+
+	// build the requested meshes until the cache is destroyed
+	void WorkerThread();
+	// get the entry of a primitive, NULL when it is not cached
+	MESH_ENTRY* GetEntry(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation);
+	const MESH_ENTRY* GetEntry(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation) const;
+	// generate and upload a basic shape mesh on the GL thread
+	void LoadBasicMesh(SceneGraph::MESH_TYPE mesh);
+
+	// the worker thread can not be shared between two objects
+	MeshCache(const MeshCache&);
+	MeshCache& operator=(const MeshCache&);
+
+public:
+	// add and remove a user of a mesh - the mesh is not loaded
+	// until it is drawn or prefetched
+	void AcquireMesh(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation);
+	void ReleaseMesh(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation);
+	// hint that an acquired mesh is going to be drawn soon
+	void PrefetchMesh(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation);
+
+	// upload the meshes that have been built or prefetched since
+	// the last call - must be called on the GL thread before the
+	// draws of a frame are recorded
+	int ProcessLoads();
+
+	// draw a basic shape mesh, loading it first when needed
+	void DrawBasicMesh(SceneGraph::MESH_TYPE mesh);
+	// get the instanced meshes - a mesh that is not resident yet
+	// is reported as not loaded
+	InstancedMeshes* GetInstancedMeshes() const { return m_pInstancedMeshes; }
+
+	// check whether a mesh is resident
+	bool IsMeshResident(SceneGraph::MESH_TYPE mesh, MESH_TESSELLATION tessellation) const;
+	// get the residency of the cached meshes
+	RESIDENCY_STATS GetStats() const;
+};
@@ -0,0 +1,387 @@
+///////////////////////////////////////////////////////////////////////////////
+// programbinarycache.cpp
+// ============
+// keep the linked shader programs on disk for the next launch
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProgramBinaryCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables and defines
+namespace
+{
+	// "PBIN" at the start of every cache file
+	const unsigned int g_CacheMagic = 0x4E494250;
+	// changed whenever the layout of the cache files changes
+	const unsigned int g_CacheVersion = 1;
+	// start value of the 64 bit FNV-1a hash
+	const unsigned long long g_HashOffsetBasis = 14695981039346656037ULL;
+	const unsigned long long g_HashPrime = 1099511628211ULL;
+
+	/***********************************************************
+	 *  CreateFolder()
+	 *
+	 *  This function is used for creating the cache folder.  A
+	 *  folder that already exists is left as it is.
+	 ***********************************************************/
+	void CreateFolder(const std::string& folder)
+	{
+#ifdef _WIN32
+		_mkdir(folder.c_str());
+#else
+		mkdir(folder.c_str(), 0755);
+#endif
+	}
+
+	/***********************************************************
+	 *  GetDriverString()
+	 *
+	 *  This function is used for getting one of the strings of
+	 *  the driver, or an empty string when there is none.
+	 ***********************************************************/
+	const char* GetDriverString(GLenum name)
+	{
+		const GLubyte* pString = glGetString(name);
+		return((NULL != pString) ? (const char*)pString : "");
+	}
+}
+
+/***********************************************************
+ *  ProgramBinaryCache()
+ *
+ *  The constructor for the class.  It needs the current GL
+ *  context, because the key of the cache starts with the
+ *  strings of the driver.
+ ***********************************************************/
+ProgramBinaryCache::ProgramBinaryCache(const char* cacheFolder)
+{
+	m_cacheFolder = cacheFolder;
+	m_hitCount = 0;
+	m_missCount = 0;
+
+	GLint formatCount = 0;
+	if (GLEW_ARB_get_program_binary)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	}
+	m_bSupported = (formatCount > 0);
+	m_bEnabled = m_bSupported;
+	if (m_bSupported == false)
+	{
+		std::cout << "Program binaries are not supported, the shaders are compiled on every launch" << std::endl;
+	}
+
+	const char* pVendor = GetDriverString(GL_VENDOR);
+	const char* pRenderer = GetDriverString(GL_RENDERER);
+	const char* pVersion = GetDriverString(GL_VERSION);
+
+	// the strings are hashed with their terminators, so that the
+	// parts can not run into each other
+	m_driverHash = HashText(g_HashOffsetBasis, pVendor, strlen(pVendor) + 1);
+	m_driverHash = HashText(m_driverHash, pRenderer, strlen(pRenderer) + 1);
+	m_driverHash = HashText(m_driverHash, pVersion, strlen(pVersion) + 1);
+}
+
+/***********************************************************
+ *  ~ProgramBinaryCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ProgramBinaryCache::~ProgramBinaryCache()
+{
+}
+
+/***********************************************************
+ *  ReadSource()
+ *
+ *  This method is used for reading a whole shader file into
+ *  the passed in string.
+ ***********************************************************/
+bool ProgramBinaryCache::ReadSource(const char* filename, std::string& source)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open the shader file:" << filename << std::endl;
+		return(false);
+	}
+
+	std::stringstream text;
+	text << file.rdbuf();
+	source = text.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  HashText()
+ *
+ *  This method is used for adding the passed in bytes to a
+ *  64 bit FNV-1a hash.
+ ***********************************************************/
+unsigned long long ProgramBinaryCache::HashText(
+	unsigned long long hash,
+	const char* pText,
+	size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)pText[i];
+		hash *= g_HashPrime;
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling the shader sources and
+ *  for linking them into a program.  The driver is told that
+ *  the binary is going to be read back when the cache is
+ *  turned on.
+ ***********************************************************/
+GLuint ProgramBinaryCache::CompileProgram(
+	const SHADER_STAGE* pStages,
+	const std::string* pSources,
+	int stageCount,
+	const char* programName)
+{
+	GLint success = GL_FALSE;
+	char infoLog[512];
+	std::vector<GLuint> shaderIDs;
+
+	for (int i = 0; i < stageCount; i++)
+	{
+		const char* pSource = pSources[i].c_str();
+
+		GLuint shaderID = glCreateShader(pStages[i].type);
+		glShaderSource(shaderID, 1, &pSource, NULL);
+		glCompileShader(shaderID);
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+		if (GL_FALSE == success)
+		{
+			glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+			std::cout << "Could not compile the shader:" << pStages[i].filename << std::endl << infoLog << std::endl;
+			glDeleteShader(shaderID);
+			for (int j = 0; j < (int)shaderIDs.size(); j++)
+			{
+				glDeleteShader(shaderIDs[j]);
+			}
+			return(0);
+		}
+		shaderIDs.push_back(shaderID);
+	}
+
+	GLuint programID = glCreateProgram();
+	for (int i = 0; i < (int)shaderIDs.size(); i++)
+	{
+		glAttachShader(programID, shaderIDs[i]);
+	}
+	if (m_bEnabled == true)
+	{
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(programID);
+	for (int i = 0; i < (int)shaderIDs.size(); i++)
+	{
+		glDetachShader(programID, shaderIDs[i]);
+		glDeleteShader(shaderIDs[i]);
+	}
+
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (GL_FALSE == success)
+	{
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Could not link the shader program:" << programName << std::endl << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadBinary()
+ *
+ *  This method is used for creating a program from the
+ *  binary in a cache file.  0 is returned when there is no
+ *  file, when it was saved for other sources or another
+ *  driver, or when the driver does not accept the binary.
+ ***********************************************************/
+GLuint ProgramBinaryCache::LoadBinary(const std::string& filename, unsigned long long key)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		return(0);
+	}
+
+	CACHE_HEADER header;
+	if (!file.read((char*)&header, sizeof(header)))
+	{
+		return(0);
+	}
+	if ((header.magic != g_CacheMagic) || (header.version != g_CacheVersion) ||
+		(header.key != key) || (header.binaryLength == 0))
+	{
+		return(0);
+	}
+
+	std::vector<char> binary(header.binaryLength);
+	if (!file.read(&binary[0], header.binaryLength))
+	{
+		return(0);
+	}
+
+	GLint success = GL_FALSE;
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, (GLenum)header.binaryFormat, &binary[0], (GLsizei)header.binaryLength);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (GL_FALSE == success)
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  SaveBinary()
+ *
+ *  This method is used for writing the binary of a linked
+ *  program into a cache file, behind the header with its
+ *  key.  A failed write is only reported, since the program
+ *  is then compiled again on the next launch.
+ ***********************************************************/
+void ProgramBinaryCache::SaveBinary(GLuint programID, const std::string& filename, unsigned long long key)
+{
+	GLint binaryLength = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(binaryLength);
+	GLsizei writtenLength = 0;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(programID, binaryLength, &writtenLength, &binaryFormat, &binary[0]);
+	if (writtenLength <= 0)
+	{
+		return;
+	}
+
+	CACHE_HEADER header;
+	header.magic = g_CacheMagic;
+	header.version = g_CacheVersion;
+	header.key = key;
+	header.binaryFormat = (unsigned int)binaryFormat;
+	header.binaryLength = (unsigned int)writtenLength;
+
+	CreateFolder(m_cacheFolder);
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if ((!file.is_open()) ||
+		(!file.write((const char*)&header, sizeof(header))) ||
+		(!file.write(&binary[0], writtenLength)))
+	{
+		std::cout << "Could not write the program binary:" << filename << std::endl;
+	}
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method is used for getting a linked program for the
+ *  passed in shader files.  The binary in the cache is used
+ *  when it was saved for the same sources and driver, and
+ *  otherwise the program is compiled and its binary is saved
+ *  for the next launch.
+ ***********************************************************/
+GLuint ProgramBinaryCache::LoadProgram(
+	const SHADER_STAGE* pStages,
+	int stageCount,
+	const char* programName)
+{
+	std::vector<std::string> sources(stageCount);
+	unsigned long long key = m_driverHash;
+
+	for (int i = 0; i < stageCount; i++)
+	{
+		if (ReadSource(pStages[i].filename, sources[i]) == false)
+		{
+			return(0);
+		}
+		key = HashText(key, (const char*)&pStages[i].type, sizeof(pStages[i].type));
+		key = HashText(key, sources[i].c_str(), sources[i].size() + 1);
+	}
+
+	std::string filename = m_cacheFolder + "/" + programName + ".bin";
+	if (m_bEnabled == true)
+	{
+		GLuint programID = LoadBinary(filename, key);
+		if (0 != programID)
+		{
+			m_hitCount++;
+			return(programID);
+		}
+	}
+
+	GLuint programID = CompileProgram(pStages, &sources[0], stageCount, programName);
+	if (0 == programID)
+	{
+		return(0);
+	}
+	m_missCount++;
+
+	if (m_bEnabled == true)
+	{
+		SaveBinary(programID, filename, key);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method is used for getting a linked program for the
+ *  passed in vertex and fragment shader files.
+ ***********************************************************/
+GLuint ProgramBinaryCache::LoadProgram(
+	const char* vertexShaderFile,
+	const char* fragmentShaderFile,
+	const char* programName)
+{
+	SHADER_STAGE stages[2];
+	stages[0].type = GL_VERTEX_SHADER;
+	stages[0].filename = vertexShaderFile;
+	stages[1].type = GL_FRAGMENT_SHADER;
+	stages[1].filename = fragmentShaderFile;
+
+	return(LoadProgram(stages, 2, programName));
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for turning the cache on or off.  The
+ *  programs are always compiled while it is off, and their
+ *  binaries are not saved.
+ ***********************************************************/
+void ProgramBinaryCache::SetEnabled(bool bEnabled)
+{
+	m_bEnabled = (bEnabled == true) && (m_bSupported == true);
+}
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// programbinarycache.h
+// ============
+// keep the linked shader programs on disk for the next launch
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+/***********************************************************
+ *  ProgramBinaryCache
+ *
+ *  This class compiles and links a shader program from its
+ *  GLSL files and saves the linked binary of the driver into
+ *  a file of the cache folder.  On the next launch the binary
+ *  is loaded with glProgramBinary() instead, as long as the
+ *  key in the file still matches - the key is a hash of the
+ *  shader sources and of the vendor, renderer and version of
+ *  the driver, so an edited shader or an updated driver makes
+ *  the program compile again.  A binary that the driver
+ *  rejects is also compiled again and replaced.
+ ***********************************************************/
+class ProgramBinaryCache
+{
+public:
+	// constructor
+	ProgramBinaryCache(const char* cacheFolder);
+	// destructor
+	~ProgramBinaryCache();
+
+	// one shader file of a program
+	struct SHADER_STAGE
+	{
+		GLenum type;
+		const char* filename;
+	};
+
+private:
+	// header in front of the binary in a cache file
+	struct CACHE_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long key;
+		unsigned int binaryFormat;
+		unsigned int binaryLength;
+	};
+
+	std::string m_cacheFolder;
+	// false when the driver can not return program binaries
+	bool m_bSupported;
+	bool m_bEnabled;
+	// hash of the driver strings, the start of every key
+	unsigned long long m_driverHash;
+	// programs that were loaded from the cache or compiled
+	int m_hitCount;
+	int m_missCount;
+
+	// read a whole shader file into the passed in string
+	static bool ReadSource(const char* filename, std::string& source);
+	// add text to a 64 bit FNV-1a hash
+	static unsigned long long HashText(unsigned long long hash, const char* pText, size_t length);
+	// compile the shader files and link them into a program
+	GLuint CompileProgram(
+		const SHADER_STAGE* pStages,
+		const std::string* pSources,
+		int stageCount,
+		const char* programName);
+	// create a program from the binary in a cache file
+	GLuint LoadBinary(const std::string& filename, unsigned long long key);
+	// write the binary of a linked program into a cache file
+	void SaveBinary(GLuint programID, const std::string& filename, unsigned long long key);
+
+public:
+	// load a program from the cache, or compile it and save it -
+	// 0 is returned when the program could not be built
+	GLuint LoadProgram(
+		const SHADER_STAGE* pStages,
+		int stageCount,
+		const char* programName);
+
+	// load a program from a vertex and a fragment shader file
+	GLuint LoadProgram(
+		const char* vertexShaderFile,
+		const char* fragmentShaderFile,
+		const char* programName);
+
+	// turn the cache off, so every program is compiled - it can
+	// only be turned on when the driver supports program binaries
+	void SetEnabled(bool bEnabled);
+	bool IsEnabled() const { return m_bEnabled; }
+
+	int GetHitCount() const { return m_hitCount; }
+	int GetMissCount() const { return m_missCount; }
+};
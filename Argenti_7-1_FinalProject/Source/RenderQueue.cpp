@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// collect, sort and batch the draw packets of the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+// declaration of global variables and defines
+namespace
+{
+	// bit layout of the sort key, from the most significant field
+	const int PASS_BITS = 1;
+	const int SHADER_BITS = 3;
+	const int LAYER_BITS = 4;
+	const int TEXTURE_BITS = 12;
+	const int MATERIAL_BITS = 12;
+	const int MESH_BITS = 5;
+	const int LOD_BITS = 3;
+	const int DEPTH_BITS = 24;
+
+	const int DEPTH_SHIFT = 0;
+	const int LOD_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+	const int MESH_SHIFT = LOD_SHIFT + LOD_BITS;
+	const int MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+	const int TEXTURE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+	const int LAYER_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+	const int SHADER_SHIFT = LAYER_SHIFT + LAYER_BITS;
+	const int PASS_SHIFT = SHADER_SHIFT + SHADER_BITS;
+	// the back to front packets only sort by their depth, which
+	// follows right after the pass
+	const int BACK_TO_FRONT_DEPTH_SHIFT = PASS_SHIFT - DEPTH_BITS;
+
+	static_assert(PASS_SHIFT + PASS_BITS == 64, "the sort key fields do not fill 64 bits");
+
+	// clamp a value into an unsigned bit field
+	uint64_t PackField(int value, int bits)
+	{
+		const int maxValue = (1 << bits) - 1;
+		if (value < 0)
+		{
+			value = 0;
+		}
+		if (value > maxValue)
+		{
+			value = maxValue;
+		}
+		return((uint64_t)value);
+	}
+
+	// order the packets by their sort keys, and packets with equal
+	// keys by their scene nodes, which is the order the command
+	// lists are merged in
+	bool ComparePackets(const RenderQueue::DRAW_PACKET& a, const RenderQueue::DRAW_PACKET& b)
+	{
+		if (a.sortKey != b.sortKey)
+		{
+			return(a.sortKey < b.sortKey);
+		}
+		return(a.nodeIndex < b.nodeIndex);
+	}
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+	ResetStats();
+}
+
+/***********************************************************
+ *  ~RenderQueue()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderQueue::~RenderQueue()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  BuildSortKey()
+ *
+ *  This method is used for packing the state of a draw into
+ *  a 64-bit key.  The most expensive state to change is in
+ *  the most significant bits.  Handles are stored plus one,
+ *  so that "no texture" or "no material" sorts first.  The
+ *  levels of detail of a mesh sort next to each other, and the
+ *  view depth is quantized so that equal state is drawn
+ *  front to back.  Front to back packets are first split into
+ *  layers by the top bits of their depth, and back to front
+ *  packets are sorted after every other packet by their depth
+ *  alone, because the blending order can not be batched.
+ ***********************************************************/
+uint64_t RenderQueue::BuildSortKey(
+	SORT_ORDER order,
+	int shader,
+	int textureHandle,
+	int materialHandle,
+	int mesh,
+	int lodLevel,
+	float viewDepth,
+	float farDepth)
+{
+	uint64_t sortKey = 0;
+	int depth = 0;
+
+	if (farDepth > 0.0f)
+	{
+		float normalizedDepth = viewDepth / farDepth;
+		if (normalizedDepth < 0.0f)
+		{
+			normalizedDepth = 0.0f;
+		}
+		if (normalizedDepth > 1.0f)
+		{
+			normalizedDepth = 1.0f;
+		}
+		depth = (int)(normalizedDepth * (float)((1 << DEPTH_BITS) - 1));
+	}
+
+	if (order == SORT_BACK_TO_FRONT)
+	{
+		sortKey |= PackField(1, PASS_BITS) << PASS_SHIFT;
+		sortKey |= PackField(((1 << DEPTH_BITS) - 1) - depth, DEPTH_BITS) << BACK_TO_FRONT_DEPTH_SHIFT;
+		return(sortKey);
+	}
+
+	if (order == SORT_FRONT_TO_BACK)
+	{
+		sortKey |= PackField(depth >> (DEPTH_BITS - LAYER_BITS), LAYER_BITS) << LAYER_SHIFT;
+	}
+
+	sortKey |= PackField(shader, SHADER_BITS) << SHADER_SHIFT;
+	sortKey |= PackField(textureHandle + 1, TEXTURE_BITS) << TEXTURE_SHIFT;
+	sortKey |= PackField(materialHandle + 1, MATERIAL_BITS) << MATERIAL_SHIFT;
+	sortKey |= PackField(mesh + 1, MESH_BITS) << MESH_SHIFT;
+	sortKey |= PackField(lodLevel, LOD_BITS) << LOD_SHIFT;
+	sortKey |= PackField(depth, DEPTH_BITS) << DEPTH_SHIFT;
+
+	return(sortKey);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the submitted draw
+ *  packets.  The allocated memory is kept for the next frame.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_packets.clear();
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for adding a draw packet to the queue.
+ ***********************************************************/
+void RenderQueue::Submit(const DRAW_PACKET& packet)
+{
+	m_packets.push_back(packet);
+}
+
+/***********************************************************
+ *  Append()
+ *
+ *  This method is used for adding the packets of a queue that
+ *  was recorded on its own to the end of this queue.
+ ***********************************************************/
+void RenderQueue::Append(const RenderQueue& other)
+{
+	m_packets.insert(m_packets.end(), other.m_packets.begin(), other.m_packets.end());
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for sorting the submitted packets by
+ *  their keys.  Every packet has its own scene node, so the
+ *  order does not depend on the sort algorithm, and the sort
+ *  does not need the buffer that a stable sort allocates on
+ *  every call.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	std::sort(m_packets.begin(), m_packets.end(), ComparePackets);
+}
+
+/***********************************************************
+ *  GetOpaqueCount()
+ *
+ *  This method is used for counting the packets that are not
+ *  blended.  The transparent packets are sorted after all the
+ *  opaque ones, so after Sort() this is also the index of the
+ *  first transparent packet.
+ ***********************************************************/
+int RenderQueue::GetOpaqueCount() const
+{
+	int opaqueCount = 0;
+
+	for (int i = 0; i < (int)m_packets.size(); i++)
+	{
+		if (m_packets[i].bTransparent == false)
+		{
+			opaqueCount++;
+		}
+	}
+
+	return(opaqueCount);
+}
+
+/***********************************************************
+ *  ResetStats()
+ *
+ *  This method is used for clearing the state change counters
+ *  before the queue is executed.
+ ***********************************************************/
+void RenderQueue::ResetStats()
+{
+	m_stats.packetCount = 0;
+	m_stats.drawCount = 0;
+	m_stats.instancedDraws = 0;
+	m_stats.instancedPackets = 0;
+	m_stats.indirectDraws = 0;
+	m_stats.indirectPackets = 0;
+	m_stats.naiveStateChanges = 0;
+	m_stats.textureModeChanges = 0;
+	m_stats.textureChanges = 0;
+	m_stats.colorChanges = 0;
+	m_stats.materialChanges = 0;
+	m_stats.meshChanges = 0;
+	m_stats.instancingChanges = 0;
+}
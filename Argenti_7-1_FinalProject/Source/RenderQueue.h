@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// collect, sort and batch the draw packets of the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class collects the draw packets that are submitted
+ *  while the scene is rendered and sorts them by a 64-bit
+ *  key, so that draws sharing the same shader, texture,
+ *  material and mesh are submitted next to each other.  It
+ *  also keeps the counters for the state changes that were
+ *  issued and saved when the queue was executed.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// constructor
+	RenderQueue();
+	// destructor
+	~RenderQueue();
+
+	// order of the packets that share the same state
+	enum SORT_ORDER
+	{
+		// batch the state of the packets, and draw the packets
+		// with equal state front to back
+		SORT_BY_STATE = 0,
+		// batch the state within layers of the view depth, which
+		// are drawn front to back, so that the nearer objects
+		// fill the depth buffer first
+		SORT_FRONT_TO_BACK,
+		// draw the transparent packets after all the opaque ones,
+		// strictly from the farthest to the nearest
+		SORT_BACK_TO_FRONT
+	};
+
+	struct DRAW_PACKET
+	{
+		// pass -> shader -> depth layer -> texture -> material ->
+		// mesh -> level of detail -> depth
+		uint64_t sortKey;
+		// scene node and cached world matrix of the drawn object
+		int nodeIndex;
+		const glm::mat4* pModelMatrix;
+		int mesh;
+		// tessellation level of the mesh, 0 has the most detail
+		int lodLevel;
+		bool bUseTexture;
+		int textureHandle;
+		glm::vec4 color;
+		int materialHandle;
+		// true when the packet is blended over the opaque packets
+		bool bTransparent;
+	};
+
+	struct QUEUE_STATS
+	{
+		// number of executed draw packets
+		int packetCount;
+		// number of issued draw calls, including the instanced ones
+		int drawCount;
+		// instanced draw calls and the packets drawn by them
+		int instancedDraws;
+		int instancedPackets;
+		// indirect draw calls and the packets drawn by them
+		int indirectDraws;
+		int indirectPackets;
+		// state changes if every packet set all of its state
+		int naiveStateChanges;
+		// state changes that were actually issued
+		int textureModeChanges;
+		int textureChanges;
+		int colorChanges;
+		int materialChanges;
+		int meshChanges;
+		int instancingChanges;
+
+		int GetIssuedStateChanges() const
+		{
+			return(textureModeChanges + textureChanges + colorChanges + materialChanges + meshChanges + instancingChanges);
+		}
+		int GetSavedStateChanges() const
+		{
+			return(naiveStateChanges - GetIssuedStateChanges());
+		}
+	};
+
+	// state that every packet sets when it is executed on its own
+	static const int STATES_PER_PACKET = 4;
+
+private:
+	// submitted draw packets
+	std::vector<DRAW_PACKET> m_packets;
+	// counters for the last execution of the queue
+	QUEUE_STATS m_stats;
+
+public:
+	// build the sort key of a draw packet
+	static uint64_t BuildSortKey(
+		SORT_ORDER order,
+		int shader,
+		int textureHandle,
+		int materialHandle,
+		int mesh,
+		int lodLevel,
+		float viewDepth,
+		float farDepth);
+
+	// remove all the submitted packets
+	void Clear();
+	// add a draw packet to the queue
+	void Submit(const DRAW_PACKET& packet);
+	// add all the packets of another queue to the end of this one
+	void Append(const RenderQueue& other);
+	// sort the packets by their keys
+	void Sort();
+
+	// access the submitted packets
+	const std::vector<DRAW_PACKET>& GetPackets() const { return m_packets; }
+	int GetPacketCount() const { return (int)m_packets.size(); }
+	// number of opaque packets - after Sort() they are the first ones
+	int GetOpaqueCount() const;
+
+	// access the counters of the last execution
+	QUEUE_STATS& GetStats() { return m_stats; }
+	const QUEUE_STATS& GetStats() const { return m_stats; }
+	void ResetStats();
+};
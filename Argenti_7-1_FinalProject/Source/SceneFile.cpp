@@ -0,0 +1,870 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// read and write the scene description as text or as a mapped binary file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables and defines
+namespace
+{
+	// "SCNB" at the start of every binary scene file
+	const unsigned int g_SceneFileMagic = 0x424E4353;
+	// changed whenever the layout of the records changes
+	const unsigned int g_SceneFileVersion = 2;
+	// alignment of the record arrays in the binary file
+	const unsigned int g_RecordAlignment = 16;
+
+	// names of the meshes in the order of SceneGraph::MESH_TYPE
+	const char* g_MeshNames[] =
+	{
+		"box",
+		"plane",
+		"cylinder",
+		"cone",
+		"prism",
+		"pyramid4",
+		"sphere",
+		"taperedCylinder",
+		"torus",
+		"halfTorus"
+	};
+	const int g_MeshNameCount = sizeof(g_MeshNames) / sizeof(g_MeshNames[0]);
+
+	// round an offset up to a multiple of the record alignment
+	unsigned int AlignUp(unsigned int value)
+	{
+		return(((value + g_RecordAlignment - 1) / g_RecordAlignment) * g_RecordAlignment);
+	}
+
+	/***********************************************************
+	 *  ReadValues()
+	 *
+	 *  This function is used for reading the passed in number
+	 *  of values that follow an attribute in a text line.
+	 ***********************************************************/
+	bool ReadValues(std::istringstream& stream, float* pValues, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (!(stream >> pValues[i]))
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  WriteValues()
+	 *
+	 *  This function is used for writing an attribute and its
+	 *  values into a text line.
+	 ***********************************************************/
+	void WriteValues(std::ostream& stream, const char* attribute, const float* pValues, int count)
+	{
+		stream << " " << attribute;
+		for (int i = 0; i < count; i++)
+		{
+			stream << " " << pValues[i];
+		}
+	}
+
+	/***********************************************************
+	 *  IsArrayInFile()
+	 *
+	 *  This function is used for checking that an array of the
+	 *  binary file is aligned and ends inside of the file.
+	 ***********************************************************/
+	bool IsArrayInFile(unsigned int offset, unsigned int count, size_t recordBytes, size_t fileBytes)
+	{
+		if ((offset % g_RecordAlignment) != 0)
+		{
+			return(false);
+		}
+
+		return((unsigned long long)offset + (unsigned long long)count * recordBytes <= fileBytes);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	static_assert(sizeof(TEXTURE_RECORD) == 8, "TEXTURE_RECORD is stored in the binary file");
+	static_assert(sizeof(MATERIAL_RECORD) == 48, "MATERIAL_RECORD is stored in the binary file");
+	static_assert(sizeof(LIGHT_RECORD) == 60, "LIGHT_RECORD is stored in the binary file");
+	static_assert(sizeof(NODE_RECORD) == 72, "NODE_RECORD is stored in the binary file");
+	static_assert(sizeof(FILE_HEADER) == 64, "FILE_HEADER is stored in the binary file");
+
+	Clear();
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	m_mappedFile.Close();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the records.  The
+ *  string table always starts with the empty string.
+ ***********************************************************/
+void SceneFile::Clear()
+{
+	m_mappedFile.Close();
+	m_textures.clear();
+	m_materials.clear();
+	m_lights.clear();
+	m_nodes.clear();
+	m_strings.assign(1, '\0');
+	m_stringOffsets.clear();
+
+	UseVectors();
+}
+
+/***********************************************************
+ *  UseVectors()
+ *
+ *  This method is used for pointing the records in use at
+ *  the parsed or added records.
+ ***********************************************************/
+void SceneFile::UseVectors()
+{
+	m_pTextures = m_textures.empty() ? NULL : &m_textures[0];
+	m_textureCount = (int)m_textures.size();
+	m_pMaterials = m_materials.empty() ? NULL : &m_materials[0];
+	m_materialCount = (int)m_materials.size();
+	m_pLights = m_lights.empty() ? NULL : &m_lights[0];
+	m_lightCount = (int)m_lights.size();
+	m_pNodes = m_nodes.empty() ? NULL : &m_nodes[0];
+	m_nodeCount = (int)m_nodes.size();
+	m_pStrings = &m_strings[0];
+	m_stringBytes = (unsigned int)m_strings.size();
+}
+
+/***********************************************************
+ *  CopyMappedRecords()
+ *
+ *  This method is used for copying the records of a mapped
+ *  file into the vectors before records are added, and for
+ *  unmapping the file.
+ ***********************************************************/
+void SceneFile::CopyMappedRecords()
+{
+	if (m_mappedFile.IsOpen() == false)
+	{
+		return;
+	}
+
+	m_textures.assign(m_pTextures, m_pTextures + m_textureCount);
+	m_materials.assign(m_pMaterials, m_pMaterials + m_materialCount);
+	m_lights.assign(m_pLights, m_pLights + m_lightCount);
+	m_nodes.assign(m_pNodes, m_pNodes + m_nodeCount);
+	m_strings.assign(m_pStrings, m_pStrings + m_stringBytes);
+	m_stringOffsets.clear();
+	m_mappedFile.Close();
+
+	UseVectors();
+}
+
+/***********************************************************
+ *  AddString()
+ *
+ *  This method is used for adding a string to the table.  A
+ *  string that is already in the table is not added again.
+ ***********************************************************/
+unsigned int SceneFile::AddString(const std::string& text)
+{
+	if (text.empty() == true)
+	{
+		return(NO_STRING);
+	}
+
+	std::map<std::string, unsigned int>::const_iterator found = m_stringOffsets.find(text);
+	if (found != m_stringOffsets.end())
+	{
+		return(found->second);
+	}
+
+	unsigned int offset = (unsigned int)m_strings.size();
+	m_strings.insert(m_strings.end(), text.begin(), text.end());
+	m_strings.push_back('\0');
+	m_stringOffsets[text] = offset;
+
+	// the table may have moved
+	m_pStrings = &m_strings[0];
+	m_stringBytes = (unsigned int)m_strings.size();
+
+	return(offset);
+}
+
+/***********************************************************
+ *  GetString()
+ *
+ *  This method is used for getting a string of the table.
+ *  The offsets of a mapped file are not checked when it is
+ *  loaded, so a bad offset returns the empty string here.
+ ***********************************************************/
+const char* SceneFile::GetString(unsigned int offset) const
+{
+	if (offset >= m_stringBytes)
+	{
+		return("");
+	}
+
+	return(m_pStrings + offset);
+}
+
+/***********************************************************
+ *  GetMeshName()
+ *
+ *  This method is used for getting the name of a mesh in
+ *  the text file.
+ ***********************************************************/
+const char* SceneFile::GetMeshName(SceneGraph::MESH_TYPE mesh)
+{
+	if (((int)mesh < 0) || ((int)mesh >= g_MeshNameCount))
+	{
+		return("");
+	}
+
+	return(g_MeshNames[mesh]);
+}
+
+/***********************************************************
+ *  FindMesh()
+ *
+ *  This method is used for finding the mesh with the passed
+ *  in name of the text file.
+ ***********************************************************/
+bool SceneFile::FindMesh(const std::string& name, SceneGraph::MESH_TYPE& mesh)
+{
+	for (int i = 0; i < g_MeshNameCount; i++)
+	{
+		if (name == g_MeshNames[i])
+		{
+			mesh = (SceneGraph::MESH_TYPE)i;
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture image and its
+ *  tag.
+ ***********************************************************/
+int SceneFile::AddTexture(
+	const std::string& tag,
+	const std::string& filename)
+{
+	CopyMappedRecords();
+
+	TEXTURE_RECORD record;
+	record.tagOffset = AddString(tag);
+	record.filenameOffset = AddString(filename);
+	m_textures.push_back(record);
+	UseVectors();
+
+	return(m_textureCount - 1);
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used for adding a material and its tag.
+ ***********************************************************/
+int SceneFile::AddMaterial(
+	const std::string& tag,
+	glm::vec3 ambientColor,
+	float ambientStrength,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float shininess)
+{
+	CopyMappedRecords();
+
+	MATERIAL_RECORD record;
+	for (int i = 0; i < 3; i++)
+	{
+		record.ambientColor[i] = ambientColor[i];
+		record.diffuseColor[i] = diffuseColor[i];
+		record.specularColor[i] = specularColor[i];
+	}
+	record.ambientStrength = ambientStrength;
+	record.shininess = shininess;
+	record.tagOffset = AddString(tag);
+	m_materials.push_back(record);
+	UseVectors();
+
+	return(m_materialCount - 1);
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light source.
+ ***********************************************************/
+int SceneFile::AddLight(
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity,
+	float radius)
+{
+	CopyMappedRecords();
+
+	LIGHT_RECORD record;
+	for (int i = 0; i < 3; i++)
+	{
+		record.position[i] = position[i];
+		record.ambientColor[i] = ambientColor[i];
+		record.diffuseColor[i] = diffuseColor[i];
+		record.specularColor[i] = specularColor[i];
+	}
+	record.focalStrength = focalStrength;
+	record.specularIntensity = specularIntensity;
+	record.radius = radius;
+	m_lights.push_back(record);
+	UseVectors();
+
+	return(m_lightCount - 1);
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a scene node.  The parent
+ *  has to be added before its children.
+ ***********************************************************/
+int SceneFile::AddNode(
+	const std::string& tag,
+	int parentIndex,
+	SceneGraph::MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	glm::vec3 rotationDegrees,
+	glm::vec3 positionXYZ,
+	const std::string& textureTag,
+	const std::string& materialTag,
+	glm::vec4 color)
+{
+	CopyMappedRecords();
+
+	NODE_RECORD record;
+	record.parentIndex = parentIndex;
+	record.mesh = (int)mesh;
+	record.tagOffset = AddString(tag);
+	record.textureTagOffset = AddString(textureTag);
+	record.materialTagOffset = AddString(materialTag);
+	for (int i = 0; i < 3; i++)
+	{
+		record.scaleXYZ[i] = scaleXYZ[i];
+		record.rotationDegrees[i] = rotationDegrees[i];
+		record.positionXYZ[i] = positionXYZ[i];
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		record.color[i] = color[i];
+	}
+	m_nodes.push_back(record);
+	UseVectors();
+
+	return(m_nodeCount - 1);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading a scene file.  A binary
+ *  file starts with its magic number, and every other file
+ *  is parsed as text.
+ ***********************************************************/
+bool SceneFile::Load(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open the scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	unsigned int magic = 0;
+	file.read((char*)&magic, sizeof(magic));
+	file.close();
+
+	if (magic == g_SceneFileMagic)
+	{
+		return(LoadBinary(filename));
+	}
+
+	return(LoadText(filename));
+}
+
+/***********************************************************
+ *  ParseLine()
+ *
+ *  This method is used for parsing one line of a text scene
+ *  file into a record.  The tags of the nodes are looked up
+ *  in the passed in map, which holds the last node with each
+ *  tag.  False is returned with the reason for a bad line.
+ ***********************************************************/
+bool SceneFile::ParseLine(
+	const std::string& line,
+	std::map<std::string, int>& nodeIndices,
+	std::string& error)
+{
+	std::istringstream stream(line.substr(0, line.find('#')));
+	std::string keyword;
+	std::string tag;
+	std::string attribute;
+
+	if (!(stream >> keyword))
+	{
+		return(true);
+	}
+
+	if (keyword == "texture")
+	{
+		std::string filename;
+		if (!(stream >> tag >> filename))
+		{
+			error = "a texture needs a tag and an image file";
+			return(false);
+		}
+		AddTexture(tag, filename);
+		return(true);
+	}
+
+	if (keyword == "material")
+	{
+		float ambientColor[3] = { 0.0f, 0.0f, 0.0f };
+		float ambientStrength = 0.0f;
+		float diffuseColor[3] = { 0.0f, 0.0f, 0.0f };
+		float specularColor[3] = { 0.0f, 0.0f, 0.0f };
+		float shininess = 0.0f;
+		bool bValid = (bool)(stream >> tag);
+
+		while ((bValid == true) && (stream >> attribute))
+		{
+			if (attribute == "ambient") bValid = ReadValues(stream, ambientColor, 3);
+			else if (attribute == "strength") bValid = ReadValues(stream, &ambientStrength, 1);
+			else if (attribute == "diffuse") bValid = ReadValues(stream, diffuseColor, 3);
+			else if (attribute == "specular") bValid = ReadValues(stream, specularColor, 3);
+			else if (attribute == "shininess") bValid = ReadValues(stream, &shininess, 1);
+			else bValid = false;
+		}
+		if (bValid == false)
+		{
+			error = "bad material " + tag + " near " + attribute;
+			return(false);
+		}
+		AddMaterial(
+			tag,
+			glm::vec3(ambientColor[0], ambientColor[1], ambientColor[2]),
+			ambientStrength,
+			glm::vec3(diffuseColor[0], diffuseColor[1], diffuseColor[2]),
+			glm::vec3(specularColor[0], specularColor[1], specularColor[2]),
+			shininess);
+		return(true);
+	}
+
+	if (keyword == "light")
+	{
+		float position[3] = { 0.0f, 0.0f, 0.0f };
+		float ambientColor[3] = { 0.0f, 0.0f, 0.0f };
+		float diffuseColor[3] = { 0.0f, 0.0f, 0.0f };
+		float specularColor[3] = { 0.0f, 0.0f, 0.0f };
+		float focalStrength = 0.0f;
+		float specularIntensity = 0.0f;
+		float radius = 0.0f;
+		bool bValid = true;
+
+		while ((bValid == true) && (stream >> attribute))
+		{
+			if (attribute == "position") bValid = ReadValues(stream, position, 3);
+			else if (attribute == "ambient") bValid = ReadValues(stream, ambientColor, 3);
+			else if (attribute == "diffuse") bValid = ReadValues(stream, diffuseColor, 3);
+			else if (attribute == "specular") bValid = ReadValues(stream, specularColor, 3);
+			else if (attribute == "focal") bValid = ReadValues(stream, &focalStrength, 1);
+			else if (attribute == "intensity") bValid = ReadValues(stream, &specularIntensity, 1);
+			else if (attribute == "radius") bValid = ReadValues(stream, &radius, 1);
+			else bValid = false;
+		}
+		if (bValid == false)
+		{
+			error = "bad light near " + attribute;
+			return(false);
+		}
+		AddLight(
+			glm::vec3(position[0], position[1], position[2]),
+			glm::vec3(ambientColor[0], ambientColor[1], ambientColor[2]),
+			glm::vec3(diffuseColor[0], diffuseColor[1], diffuseColor[2]),
+			glm::vec3(specularColor[0], specularColor[1], specularColor[2]),
+			focalStrength,
+			specularIntensity,
+			radius);
+		return(true);
+	}
+
+	if ((keyword == "group") || (keyword == "node"))
+	{
+		SceneGraph::MESH_TYPE mesh = SceneGraph::MESH_NONE;
+		std::string meshName;
+		std::string parentTag;
+		std::string textureTag;
+		std::string materialTag;
+		float scaleXYZ[3] = { 1.0f, 1.0f, 1.0f };
+		float rotationDegrees[3] = { 0.0f, 0.0f, 0.0f };
+		float positionXYZ[3] = { 0.0f, 0.0f, 0.0f };
+		float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		int parentIndex = -1;
+
+		if (!(stream >> tag))
+		{
+			error = "a " + keyword + " needs a tag";
+			return(false);
+		}
+		if ((keyword == "node") &&
+			((!(stream >> meshName)) || (FindMesh(meshName, mesh) == false)))
+		{
+			error = "node " + tag + " has the unknown mesh " + meshName;
+			return(false);
+		}
+
+		bool bValid = true;
+		while ((bValid == true) && (stream >> attribute))
+		{
+			if (attribute == "parent") bValid = (bool)(stream >> parentTag);
+			else if (attribute == "scale") bValid = ReadValues(stream, scaleXYZ, 3);
+			else if (attribute == "rotation") bValid = ReadValues(stream, rotationDegrees, 3);
+			else if (attribute == "position") bValid = ReadValues(stream, positionXYZ, 3);
+			else if (attribute == "texture") bValid = (bool)(stream >> textureTag);
+			else if (attribute == "material") bValid = (bool)(stream >> materialTag);
+			else if (attribute == "color") bValid = ReadValues(stream, color, 4);
+			else bValid = false;
+		}
+		if (bValid == false)
+		{
+			error = "bad " + keyword + " " + tag + " near " + attribute;
+			return(false);
+		}
+		if (parentTag.empty() == false)
+		{
+			std::map<std::string, int>::const_iterator found = nodeIndices.find(parentTag);
+			if (found == nodeIndices.end())
+			{
+				error = "the parent " + parentTag + " of " + tag + " has not been defined before it";
+				return(false);
+			}
+			parentIndex = found->second;
+		}
+
+		nodeIndices[tag] = AddNode(
+			tag,
+			parentIndex,
+			mesh,
+			glm::vec3(scaleXYZ[0], scaleXYZ[1], scaleXYZ[2]),
+			glm::vec3(rotationDegrees[0], rotationDegrees[1], rotationDegrees[2]),
+			glm::vec3(positionXYZ[0], positionXYZ[1], positionXYZ[2]),
+			textureTag,
+			materialTag,
+			glm::vec4(color[0], color[1], color[2], color[3]));
+		return(true);
+	}
+
+	error = "unknown record " + keyword;
+	return(false);
+}
+
+/***********************************************************
+ *  LoadText()
+ *
+ *  This method is used for parsing a text scene file.  The
+ *  records are kept when the whole file could be parsed.
+ ***********************************************************/
+bool SceneFile::LoadText(const char* filename)
+{
+	Clear();
+
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open the scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	std::map<std::string, int> nodeIndices;
+	std::string line;
+	std::string error;
+	int lineNumber = 0;
+
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if (ParseLine(line, nodeIndices, error) == false)
+		{
+			std::cout << "Scene file " << filename << " line " << lineNumber << ": " << error << std::endl;
+			Clear();
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadBinary()
+ *
+ *  This method is used for mapping a binary scene file.  The
+ *  header and the extent of every array are checked, and the
+ *  records are then read straight from the mapping.
+ ***********************************************************/
+bool SceneFile::LoadBinary(const char* filename)
+{
+	Clear();
+
+	if (m_mappedFile.Open(filename) == false)
+	{
+		std::cout << "Could not map the scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pData = m_mappedFile.GetData();
+	size_t fileBytes = m_mappedFile.GetSize();
+	const FILE_HEADER* pHeader = (const FILE_HEADER*)pData;
+
+	if ((fileBytes < sizeof(FILE_HEADER)) ||
+		(pHeader->magic != g_SceneFileMagic) ||
+		(pHeader->version != g_SceneFileVersion) ||
+		(pHeader->fileBytes != fileBytes) ||
+		(IsArrayInFile(pHeader->textureOffset, pHeader->textureCount, sizeof(TEXTURE_RECORD), fileBytes) == false) ||
+		(IsArrayInFile(pHeader->materialOffset, pHeader->materialCount, sizeof(MATERIAL_RECORD), fileBytes) == false) ||
+		(IsArrayInFile(pHeader->lightOffset, pHeader->lightCount, sizeof(LIGHT_RECORD), fileBytes) == false) ||
+		(IsArrayInFile(pHeader->nodeOffset, pHeader->nodeCount, sizeof(NODE_RECORD), fileBytes) == false) ||
+		(IsArrayInFile(pHeader->stringOffset, pHeader->stringBytes, 1, fileBytes) == false) ||
+		(pHeader->stringBytes == 0) ||
+		(pData[pHeader->stringOffset + pHeader->stringBytes - 1] != '\0'))
+	{
+		std::cout << "The scene file " << filename << " is not a valid binary scene of version " << g_SceneFileVersion << std::endl;
+		Clear();
+		return(false);
+	}
+
+	m_pTextures = (const TEXTURE_RECORD*)(pData + pHeader->textureOffset);
+	m_textureCount = (int)pHeader->textureCount;
+	m_pMaterials = (const MATERIAL_RECORD*)(pData + pHeader->materialOffset);
+	m_materialCount = (int)pHeader->materialCount;
+	m_pLights = (const LIGHT_RECORD*)(pData + pHeader->lightOffset);
+	m_lightCount = (int)pHeader->lightCount;
+	m_pNodes = (const NODE_RECORD*)(pData + pHeader->nodeOffset);
+	m_nodeCount = (int)pHeader->nodeCount;
+	m_pStrings = (const char*)(pData + pHeader->stringOffset);
+	m_stringBytes = pHeader->stringBytes;
+
+	return(true);
+}
+
+/***********************************************************
+ *  SaveText()
+ *
+ *  This method is used for writing the records as a text
+ *  scene file.  The parents are written as tags, so a node
+ *  whose parent tag is reused by a later node is reported.
+ ***********************************************************/
+bool SceneFile::SaveText(const char* filename) const
+{
+	std::ofstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not write the scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	file << "# scene description - the records are explained in SceneFile.h" << std::endl;
+
+	for (int i = 0; i < m_textureCount; i++)
+	{
+		file << "texture " << GetString(m_pTextures[i].tagOffset)
+			<< " " << GetString(m_pTextures[i].filenameOffset) << std::endl;
+	}
+
+	for (int i = 0; i < m_materialCount; i++)
+	{
+		const MATERIAL_RECORD& material = m_pMaterials[i];
+		file << "material " << GetString(material.tagOffset);
+		WriteValues(file, "ambient", material.ambientColor, 3);
+		WriteValues(file, "strength", &material.ambientStrength, 1);
+		WriteValues(file, "diffuse", material.diffuseColor, 3);
+		WriteValues(file, "specular", material.specularColor, 3);
+		WriteValues(file, "shininess", &material.shininess, 1);
+		file << std::endl;
+	}
+
+	for (int i = 0; i < m_lightCount; i++)
+	{
+		const LIGHT_RECORD& light = m_pLights[i];
+		file << "light";
+		WriteValues(file, "position", light.position, 3);
+		WriteValues(file, "ambient", light.ambientColor, 3);
+		WriteValues(file, "diffuse", light.diffuseColor, 3);
+		WriteValues(file, "specular", light.specularColor, 3);
+		WriteValues(file, "focal", &light.focalStrength, 1);
+		WriteValues(file, "intensity", &light.specularIntensity, 1);
+		if (light.radius > 0.0f)
+		{
+			WriteValues(file, "radius", &light.radius, 1);
+		}
+		file << std::endl;
+	}
+
+	std::map<std::string, int> nodeIndices;
+	for (int i = 0; i < m_nodeCount; i++)
+	{
+		const NODE_RECORD& node = m_pNodes[i];
+		std::string tag = GetString(node.tagOffset);
+
+		if (node.mesh == SceneGraph::MESH_NONE)
+		{
+			file << "group " << tag;
+		}
+		else
+		{
+			file << "node " << tag << " " << GetMeshName((SceneGraph::MESH_TYPE)node.mesh);
+		}
+		if ((node.parentIndex >= 0) && (node.parentIndex < i))
+		{
+			std::string parentTag = GetString(m_pNodes[node.parentIndex].tagOffset);
+			if (nodeIndices[parentTag] != node.parentIndex)
+			{
+				std::cout << "Scene node " << tag << " will be attached to the last node tagged " << parentTag << std::endl;
+			}
+			file << " parent " << parentTag;
+		}
+		WriteValues(file, "scale", node.scaleXYZ, 3);
+		WriteValues(file, "rotation", node.rotationDegrees, 3);
+		WriteValues(file, "position", node.positionXYZ, 3);
+		if (node.mesh != SceneGraph::MESH_NONE)
+		{
+			if (node.textureTagOffset != NO_STRING)
+			{
+				file << " texture " << GetString(node.textureTagOffset);
+			}
+			if (node.materialTagOffset != NO_STRING)
+			{
+				file << " material " << GetString(node.materialTagOffset);
+			}
+			WriteValues(file, "color", node.color, 4);
+		}
+		file << std::endl;
+
+		nodeIndices[tag] = i;
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  SaveBinary()
+ *
+ *  This method is used for writing the records as a binary
+ *  scene file.  The arrays follow the header in a fixed
+ *  order, each starting on the record alignment.
+ ***********************************************************/
+bool SceneFile::SaveBinary(const char* filename) const
+{
+	FILE_HEADER header = {};
+	unsigned int offset = AlignUp(sizeof(FILE_HEADER));
+
+	header.magic = g_SceneFileMagic;
+	header.version = g_SceneFileVersion;
+	header.textureCount = (unsigned int)m_textureCount;
+	header.textureOffset = offset;
+	offset = AlignUp(offset + m_textureCount * sizeof(TEXTURE_RECORD));
+	header.materialCount = (unsigned int)m_materialCount;
+	header.materialOffset = offset;
+	offset = AlignUp(offset + m_materialCount * sizeof(MATERIAL_RECORD));
+	header.lightCount = (unsigned int)m_lightCount;
+	header.lightOffset = offset;
+	offset = AlignUp(offset + m_lightCount * sizeof(LIGHT_RECORD));
+	header.nodeCount = (unsigned int)m_nodeCount;
+	header.nodeOffset = offset;
+	offset = AlignUp(offset + m_nodeCount * sizeof(NODE_RECORD));
+	header.stringBytes = m_stringBytes;
+	header.stringOffset = offset;
+	header.fileBytes = offset + m_stringBytes;
+
+	std::vector<unsigned char> contents(header.fileBytes, 0);
+	memcpy(&contents[0], &header, sizeof(header));
+	if (m_textureCount > 0)
+	{
+		memcpy(&contents[header.textureOffset], m_pTextures, m_textureCount * sizeof(TEXTURE_RECORD));
+	}
+	if (m_materialCount > 0)
+	{
+		memcpy(&contents[header.materialOffset], m_pMaterials, m_materialCount * sizeof(MATERIAL_RECORD));
+	}
+	if (m_lightCount > 0)
+	{
+		memcpy(&contents[header.lightOffset], m_pLights, m_lightCount * sizeof(LIGHT_RECORD));
+	}
+	if (m_nodeCount > 0)
+	{
+		memcpy(&contents[header.nodeOffset], m_pNodes, m_nodeCount * sizeof(NODE_RECORD));
+	}
+	memcpy(&contents[header.stringOffset], m_pStrings, m_stringBytes);
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if ((!file.is_open()) || (!file.write((const char*)&contents[0], contents.size())))
+	{
+		std::cout << "Could not write the scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for converting a text scene file into
+ *  a binary scene file, as an offline step.
+ ***********************************************************/
+bool SceneFile::Compile(const char* textFilename, const char* binaryFilename)
+{
+	SceneFile sceneFile;
+
+	if (sceneFile.LoadText(textFilename) == false)
+	{
+		return(false);
+	}
+	if (sceneFile.SaveBinary(binaryFilename) == false)
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Compiled " << sceneFile.GetNodeCount() << " scene nodes into " << binaryFilename << std::endl;
+
+	return(true);
+}
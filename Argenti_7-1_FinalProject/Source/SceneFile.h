@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// read and write the scene description as text or as a mapped binary file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+#include "SceneGraph.h"
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class holds the textures, materials, lights and
+ *  nodes of a 3D scene as flat records.  The records are
+ *  read from a text file that is written by hand, one record
+ *  per line:
+ *
+ *    texture <tag> <image file>
+ *    material <tag> ambient r g b strength s diffuse r g b
+ *        specular r g b shininess s
+ *    light position x y z ambient r g b diffuse r g b
+ *        specular r g b focal f intensity i [radius r]
+ *    group <tag> [parent <tag>] [transform]
+ *    node <tag> <mesh> [parent <tag>] [transform]
+ *        [texture <tag>] [material <tag>] [color r g b a]
+ *
+ *  where the transform is scale x y z, rotation x y z in
+ *  degrees and position x y z, and everything after a # is a
+ *  comment.  A parent is the last node before the child with
+ *  that tag, and the children have to follow their parent.
+ *  A light without a radius reaches the whole scene.
+ *
+ *  The compiled binary file holds the same records in the
+ *  layout of the structures below, each array at an offset
+ *  in the header that is aligned to 16 bytes, with the tags
+ *  stored as offsets into one table of strings.  The binary
+ *  file is memory mapped and its records are used in place,
+ *  so loading it does not parse anything.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// offset of the empty string, used for the unset tags
+	static const unsigned int NO_STRING = 0;
+
+	struct TEXTURE_RECORD
+	{
+		unsigned int tagOffset;
+		unsigned int filenameOffset;
+	};
+
+	struct MATERIAL_RECORD
+	{
+		float ambientColor[3];
+		float ambientStrength;
+		float diffuseColor[3];
+		float shininess;
+		float specularColor[3];
+		unsigned int tagOffset;
+	};
+
+	struct LIGHT_RECORD
+	{
+		float position[3];
+		float focalStrength;
+		float ambientColor[3];
+		float specularIntensity;
+		float diffuseColor[3];
+		float specularColor[3];
+		// 0 for a light that reaches the whole scene
+		float radius;
+	};
+
+	struct NODE_RECORD
+	{
+		// index of the parent record, -1 for a root node
+		int parentIndex;
+		// SceneGraph::MESH_TYPE, MESH_NONE for a group node
+		int mesh;
+		unsigned int tagOffset;
+		// NO_STRING when the node is drawn with its color
+		unsigned int textureTagOffset;
+		unsigned int materialTagOffset;
+		float scaleXYZ[3];
+		float rotationDegrees[3];
+		float positionXYZ[3];
+		float color[4];
+	};
+
+private:
+	// header at the start of the binary file
+	struct FILE_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned int fileBytes;
+		unsigned int textureCount;
+		unsigned int textureOffset;
+		unsigned int materialCount;
+		unsigned int materialOffset;
+		unsigned int lightCount;
+		unsigned int lightOffset;
+		unsigned int nodeCount;
+		unsigned int nodeOffset;
+		unsigned int stringBytes;
+		unsigned int stringOffset;
+		unsigned int padding[3];
+	};
+
+	// records that were parsed from a text file or added, these
+	// stay empty while the records come from a mapped file
+	std::vector<TEXTURE_RECORD> m_textures;
+	std::vector<MATERIAL_RECORD> m_materials;
+	std::vector<LIGHT_RECORD> m_lights;
+	std::vector<NODE_RECORD> m_nodes;
+	std::vector<char> m_strings;
+	// offsets of the strings in the table, so every tag is only
+	// stored once
+	std::map<std::string, unsigned int> m_stringOffsets;
+	// the mapped binary file
+	MappedFile m_mappedFile;
+
+	// the records in use, in the vectors or in the mapped file
+	const TEXTURE_RECORD* m_pTextures;
+	int m_textureCount;
+	const MATERIAL_RECORD* m_pMaterials;
+	int m_materialCount;
+	const LIGHT_RECORD* m_pLights;
+	int m_lightCount;
+	const NODE_RECORD* m_pNodes;
+	int m_nodeCount;
+	const char* m_pStrings;
+	unsigned int m_stringBytes;
+
+	// point the records in use at the vectors
+	void UseVectors();
+	// copy the records of the mapped file into the vectors
+	void CopyMappedRecords();
+	// add a string to the table, returns its offset
+	unsigned int AddString(const std::string& text);
+	// parse one line of a text file
+	bool ParseLine(
+		const std::string& line,
+		std::map<std::string, int>& nodeIndices,
+		std::string& error);
+
+public:
+	// read a text or a binary file, told apart by their start
+	bool Load(const char* filename);
+	// parse a text file
+	bool LoadText(const char* filename);
+	// map a binary file and use its records in place
+	bool LoadBinary(const char* filename);
+	// write the records as a text file
+	bool SaveText(const char* filename) const;
+	// write the records as a binary file
+	bool SaveBinary(const char* filename) const;
+	// convert a text file into a binary file
+	static bool Compile(const char* textFilename, const char* binaryFilename);
+
+	// remove all the records
+	void Clear();
+
+	// add records, returns the index of the record
+	int AddTexture(
+		const std::string& tag,
+		const std::string& filename);
+	int AddMaterial(
+		const std::string& tag,
+		glm::vec3 ambientColor,
+		float ambientStrength,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float shininess);
+	int AddLight(
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity,
+		float radius);
+	int AddNode(
+		const std::string& tag,
+		int parentIndex,
+		SceneGraph::MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		glm::vec3 rotationDegrees,
+		glm::vec3 positionXYZ,
+		const std::string& textureTag,
+		const std::string& materialTag,
+		glm::vec4 color);
+
+	// access the records
+	int GetTextureCount() const { return m_textureCount; }
+	const TEXTURE_RECORD& GetTexture(int index) const { return m_pTextures[index]; }
+	int GetMaterialCount() const { return m_materialCount; }
+	const MATERIAL_RECORD& GetMaterial(int index) const { return m_pMaterials[index]; }
+	int GetLightCount() const { return m_lightCount; }
+	const LIGHT_RECORD& GetLight(int index) const { return m_pLights[index]; }
+	int GetNodeCount() const { return m_nodeCount; }
+	const NODE_RECORD& GetNode(int index) const { return m_pNodes[index]; }
+	// get a string of the table, the empty string for a bad offset
+	const char* GetString(unsigned int offset) const;
+
+	// names of the meshes in the text file
+	static const char* GetMeshName(SceneGraph::MESH_TYPE mesh);
+	static bool FindMesh(const std::string& name, SceneGraph::MESH_TYPE& mesh);
+};
@@ -0,0 +1,405 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.cpp
+// ============
+// retained scene representation with cached world transformations
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneGraph.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  SceneGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneGraph::SceneGraph()
+{
+	m_bDirty = false;
+}
+
+/***********************************************************
+ *  ~SceneGraph()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneGraph::~SceneGraph()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  ComposeTransform()
+ *
+ *  This method is used for composing the model matrix from
+ *  the passed in transformation values, in the closed form
+ *  of the transform batch.
+ ***********************************************************/
+glm::mat4 SceneGraph::ComposeTransform(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	TransformBatch::TRANSFORM_ARRAYS transforms;
+	glm::mat4 modelMatrix;
+
+	transforms.pScaleX = &scaleXYZ.x;
+	transforms.pScaleY = &scaleXYZ.y;
+	transforms.pScaleZ = &scaleXYZ.z;
+	transforms.pRotationX = &XrotationDegrees;
+	transforms.pRotationY = &YrotationDegrees;
+	transforms.pRotationZ = &ZrotationDegrees;
+	transforms.pPositionX = &positionXYZ.x;
+	transforms.pPositionY = &positionXYZ.y;
+	transforms.pPositionZ = &positionXYZ.z;
+	TransformBatch::ComposeTransforms(transforms, 1, &modelMatrix);
+
+	return(modelMatrix);
+}
+
+/***********************************************************
+ *  AddGroupNode()
+ *
+ *  This method is used for adding a node that is not drawn
+ *  but that groups its children, so that they can be moved
+ *  together.
+ ***********************************************************/
+int SceneGraph::AddGroupNode(
+	std::string tag,
+	int parentIndex)
+{
+	return(AddNode(
+		tag,
+		parentIndex,
+		MESH_NONE,
+		glm::vec3(1.0f, 1.0f, 1.0f),
+		0.0f,
+		0.0f,
+		0.0f,
+		glm::vec3(0.0f, 0.0f, 0.0f)));
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node to the scene.  The
+ *  children of a parent node must be added before the next
+ *  node outside of that parent, so that every subtree stays
+ *  in one contiguous range of the node list.
+ ***********************************************************/
+int SceneGraph::AddNode(
+	std::string tag,
+	int parentIndex,
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	int nodeIndex = (int)m_nodes.size();
+
+	if (parentIndex >= nodeIndex)
+	{
+		std::cout << "Scene node " << tag << " has an invalid parent index " << parentIndex << std::endl;
+		return(-1);
+	}
+	// the new node is appended at the end of the list, so the
+	// subtree of the parent has to end at the end of the list
+	if ((parentIndex >= 0) &&
+		(m_nodes[parentIndex].lastDescendant != nodeIndex - 1))
+	{
+		std::cout << "Scene node " << tag << " would split the subtree of " << m_nodes[parentIndex].tag << std::endl;
+		return(-1);
+	}
+
+	SCENE_NODE node;
+	node.tag = tag;
+	node.parentIndex = parentIndex;
+	node.lastDescendant = nodeIndex;
+	node.scaleXYZ = scaleXYZ;
+	node.XrotationDegrees = XrotationDegrees;
+	node.YrotationDegrees = YrotationDegrees;
+	node.ZrotationDegrees = ZrotationDegrees;
+	node.positionXYZ = positionXYZ;
+	node.worldMatrix = glm::mat4(1.0f);
+	node.bDirty = true;
+	node.mesh = mesh;
+	node.bUseTexture = false;
+	node.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	node.textureHandle = -1;
+	node.materialHandle = -1;
+
+	m_nodes.push_back(node);
+	m_bDirty = true;
+
+	// extend the subtree range of all the parent nodes
+	int ancestor = parentIndex;
+	while (ancestor >= 0)
+	{
+		m_nodes[ancestor].lastDescendant = nodeIndex;
+		ancestor = m_nodes[ancestor].parentIndex;
+	}
+
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  CopySubtree()
+ *
+ *  This method is used for appending a copy of a node and all
+ *  of its children below the passed in parent.  The copy keeps
+ *  the local transforms and the resolved handles, so it can
+ *  be moved as a whole through the returned node.
+ ***********************************************************/
+int SceneGraph::CopySubtree(
+	int sourceIndex,
+	int parentIndex)
+{
+	int nodeIndex = (int)m_nodes.size();
+
+	if ((sourceIndex < 0) || (sourceIndex >= nodeIndex) || (parentIndex >= nodeIndex))
+	{
+		std::cout << "Scene node " << sourceIndex << " can not be copied below " << parentIndex << std::endl;
+		return(-1);
+	}
+	if ((parentIndex >= 0) &&
+		(m_nodes[parentIndex].lastDescendant != nodeIndex - 1))
+	{
+		std::cout << "The copy of " << m_nodes[sourceIndex].tag << " would split the subtree of " << m_nodes[parentIndex].tag << std::endl;
+		return(-1);
+	}
+
+	int lastSource = m_nodes[sourceIndex].lastDescendant;
+	int offset = nodeIndex - sourceIndex;
+	m_nodes.reserve(m_nodes.size() + (lastSource - sourceIndex + 1));
+
+	for (int i = sourceIndex; i <= lastSource; i++)
+	{
+		SCENE_NODE node = m_nodes[i];
+		node.parentIndex = (i == sourceIndex) ? parentIndex : node.parentIndex + offset;
+		node.lastDescendant += offset;
+		node.bDirty = true;
+		m_nodes.push_back(node);
+	}
+	m_bDirty = true;
+
+	// extend the subtree range of all the parent nodes
+	int ancestor = parentIndex;
+	while (ancestor >= 0)
+	{
+		m_nodes[ancestor].lastDescendant = (int)m_nodes.size() - 1;
+		ancestor = m_nodes[ancestor].parentIndex;
+	}
+
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  SetNodeTransform()
+ *
+ *  This method is used for changing the local transformation
+ *  values of a node.  The node and its whole subtree get
+ *  marked for updating their world matrices.
+ ***********************************************************/
+void SceneGraph::SetNodeTransform(
+	int nodeIndex,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	SCENE_NODE& node = m_nodes[nodeIndex];
+	node.scaleXYZ = scaleXYZ;
+	node.XrotationDegrees = XrotationDegrees;
+	node.YrotationDegrees = YrotationDegrees;
+	node.ZrotationDegrees = ZrotationDegrees;
+	node.positionXYZ = positionXYZ;
+
+	for (int i = nodeIndex; i <= node.lastDescendant; i++)
+	{
+		m_nodes[i].bDirty = true;
+	}
+	m_bDirty = true;
+}
+
+/***********************************************************
+ *  SetNodeColor()
+ *
+ *  This method is used for drawing a node with a solid color
+ *  instead of a texture.
+ ***********************************************************/
+void SceneGraph::SetNodeColor(
+	int nodeIndex,
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[nodeIndex].bUseTexture = false;
+	m_nodes[nodeIndex].color = glm::vec4(
+		redColorValue,
+		greenColorValue,
+		blueColorValue,
+		alphaValue);
+}
+
+/***********************************************************
+ *  SetNodeTexture()
+ *
+ *  This method is used for drawing a node with the texture
+ *  associated with the passed in tag.
+ ***********************************************************/
+void SceneGraph::SetNodeTexture(
+	int nodeIndex,
+	std::string textureTag)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[nodeIndex].bUseTexture = true;
+	m_nodes[nodeIndex].textureTag = textureTag;
+}
+
+/***********************************************************
+ *  SetNodeMaterial()
+ *
+ *  This method is used for setting the material that is
+ *  used for the lighting of a node.
+ ***********************************************************/
+void SceneGraph::SetNodeMaterial(
+	int nodeIndex,
+	std::string materialTag)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[nodeIndex].materialTag = materialTag;
+}
+
+/***********************************************************
+ *  SetNodeHandles()
+ *
+ *  This method is used for setting the texture and material
+ *  handles that were resolved from the tags of a node.
+ ***********************************************************/
+void SceneGraph::SetNodeHandles(
+	int nodeIndex,
+	int textureHandle,
+	int materialHandle)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[nodeIndex].textureHandle = textureHandle;
+	m_nodes[nodeIndex].materialHandle = materialHandle;
+}
+
+/***********************************************************
+ *  FindNode()
+ *
+ *  This method is used for getting the index of the node
+ *  associated with the passed in tag.
+ ***********************************************************/
+int SceneGraph::FindNode(std::string tag) const
+{
+	for (int i = 0; i < (int)m_nodes.size(); i++)
+	{
+		if (m_nodes[i].tag.compare(tag) == 0)
+		{
+			return(i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  UpdateWorldTransforms()
+ *
+ *  This method is used for recalculating the world matrices
+ *  of the changed nodes.  The local matrices of all the
+ *  changed nodes are composed in one batch, and then parents
+ *  are stored before their children, so one pass over the
+ *  changed nodes is enough to apply the parent matrices.
+ *  Nothing is calculated when no node has been changed, and
+ *  false is returned.
+ ***********************************************************/
+bool SceneGraph::UpdateWorldTransforms()
+{
+	if (m_bDirty == false)
+	{
+		return(false);
+	}
+
+	m_dirtyNodes.clear();
+	m_localTransforms.Clear();
+	for (int i = 0; i < (int)m_nodes.size(); i++)
+	{
+		const SCENE_NODE& node = m_nodes[i];
+		if (node.bDirty == false)
+		{
+			continue;
+		}
+
+		m_dirtyNodes.push_back(i);
+		m_localTransforms.Add(
+			node.scaleXYZ,
+			node.XrotationDegrees,
+			node.YrotationDegrees,
+			node.ZrotationDegrees,
+			node.positionXYZ);
+	}
+
+	m_localMatrices.resize(m_dirtyNodes.size());
+	m_localTransforms.Compose(m_localMatrices.data());
+
+	for (int i = 0; i < (int)m_dirtyNodes.size(); i++)
+	{
+		SCENE_NODE& node = m_nodes[m_dirtyNodes[i]];
+
+		if (node.parentIndex >= 0)
+		{
+			node.worldMatrix = m_nodes[node.parentIndex].worldMatrix * m_localMatrices[i];
+		}
+		else
+		{
+			node.worldMatrix = m_localMatrices[i];
+		}
+		node.bDirty = false;
+	}
+
+	m_bDirty = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the scene nodes.
+ ***********************************************************/
+void SceneGraph::Clear()
+{
+	m_nodes.clear();
+	m_bDirty = false;
+}
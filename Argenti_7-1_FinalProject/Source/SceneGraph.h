@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.h
+// ============
+// retained scene representation with cached world transformations
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformBatch.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneGraph
+ *
+ *  This class keeps the objects of the 3D scene in a flat
+ *  list of nodes with a parent/child hierarchy.  The world
+ *  matrix of each node is only recalculated when the node
+ *  or one of its parents has been changed.
+ ***********************************************************/
+class SceneGraph
+{
+public:
+	// constructor
+	SceneGraph();
+	// destructor
+	~SceneGraph();
+
+	// basic shape meshes that a scene node can be drawn with
+	enum MESH_TYPE
+	{
+		MESH_NONE = -1,		// group node - only carries a transform
+		MESH_BOX,
+		MESH_PLANE,
+		MESH_CYLINDER,
+		MESH_CONE,
+		MESH_PRISM,
+		MESH_PYRAMID4,
+		MESH_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_HALF_TORUS
+	};
+
+	struct SCENE_NODE
+	{
+		std::string tag;
+		// index of the parent node, -1 for a root node
+		int parentIndex;
+		// index of the last node in the subtree of this node - the
+		// subtree is always stored in one contiguous range
+		int lastDescendant;
+
+		// local transformation values relative to the parent
+		glm::vec3 scaleXYZ;
+		float XrotationDegrees;
+		float YrotationDegrees;
+		float ZrotationDegrees;
+		glm::vec3 positionXYZ;
+
+		// cached world transformation
+		glm::mat4 worldMatrix;
+		bool bDirty;
+
+		// draw settings
+		MESH_TYPE mesh;
+		bool bUseTexture;
+		std::string textureTag;
+		glm::vec4 color;
+		std::string materialTag;
+
+		// handles resolved from the tags, used while rendering
+		int textureHandle;
+		int materialHandle;
+	};
+
+private:
+	// all the scene nodes, a parent is always stored before its children
+	std::vector<SCENE_NODE> m_nodes;
+	// true when at least one node needs its world matrix updated
+	bool m_bDirty;
+	// the changed nodes, their local transforms and the local
+	// matrices composed from them, kept between the updates
+	std::vector<int> m_dirtyNodes;
+	TransformBatch m_localTransforms;
+	std::vector<glm::mat4> m_localMatrices;
+
+public:
+	// compose the model matrix from the transformation values
+	static glm::mat4 ComposeTransform(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// add a node that only groups its children
+	int AddGroupNode(
+		std::string tag,
+		int parentIndex);
+
+	// add a node that is drawn with one of the basic meshes
+	int AddNode(
+		std::string tag,
+		int parentIndex,
+		MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// append a copy of a node and its whole subtree
+	int CopySubtree(
+		int sourceIndex,
+		int parentIndex);
+
+	// change the local transformation of a node
+	void SetNodeTransform(
+		int nodeIndex,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the draw settings of a node
+	void SetNodeColor(
+		int nodeIndex,
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+	void SetNodeTexture(
+		int nodeIndex,
+		std::string textureTag);
+	void SetNodeMaterial(
+		int nodeIndex,
+		std::string materialTag);
+
+	// set the texture and material handles resolved from the tags
+	void SetNodeHandles(
+		int nodeIndex,
+		int textureHandle,
+		int materialHandle);
+
+	// find a node by tag
+	int FindNode(std::string tag) const;
+
+	// recalculate the world matrices of all the changed nodes,
+	// returns true when any matrix was recalculated
+	bool UpdateWorldTransforms();
+
+	// remove all the nodes
+	void Clear();
+
+	// access the flat list of nodes
+	const std::vector<SCENE_NODE>& GetNodes() const { return m_nodes; }
+	int GetNodeCount() const { return (int)m_nodes.size(); }
+};
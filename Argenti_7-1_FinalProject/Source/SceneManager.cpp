@@ -1,1054 +1,3753 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.cpp
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables and defines
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager* pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	// create the shape meshes object
-	m_basicMeshes = new ShapeMeshes();
-
-	// initialize the texture collection
-	for (int i = 0; i < 16; i++)
-	{
-		m_textureIDs[i].tag = "/0";
-		m_textureIDs[i].ID = -1;
-	}
-	m_loadedTextures = 0;
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	// free the allocated objects
-	m_pShaderManager = NULL;
-	if (NULL != m_basicMeshes)
-	{
-		delete m_basicMeshes;
-		m_basicMeshes = NULL;
-	}
-
-	// free the allocated OpenGL textures
-	DestroyGLTextures();
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** The code in the methods BELOW is for preparing and     ***/
-/*** rendering the 3D replicated scenes.                    ***/
-/**************************************************************/
-
-/***********************************************************
- *  LoadSceneTextures()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene
- *  rendering
- ***********************************************************/
-void SceneManager::LoadSceneTextures()
-{
-	bool bReturn = false;
-
-	bReturn = CreateGLTexture("../../Utilities/textures/marble.jpg", "marble");			// 
-
-	bReturn = CreateGLTexture("../../Utilities/textures/superhero-face.jpg", "face");   // source: Wr3d Texture Prem  https://www.facebook.com/profile.php?id=100088732373912
-
-	bReturn = CreateGLTexture("../../Utilities/textures/superhero-body.jpg", "body");   // source: Wr3d Texture Prem
-
-	bReturn = CreateGLTexture("../../Utilities/textures/superhero-arm.jpg", "arm");		// source: Wr3d Texture Prem
-
-	bReturn = CreateGLTexture("../../Utilities/textures/superhero-leg.jpg", "leg");		// source: Wr3d Texture Prem
-
-	bReturn = CreateGLTexture("../../Utilities/textures/soda-can.jpg", "can"); // source: Fienne https://www.artstation.com/artwork/nERVG4, and the CocaCola Company
-
-	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
-	BindGLTextures();
-}
-
-/***********************************************************
- *  DefineObjectMaterials()
- *
- *  This method is used for configuring the various material
- *  settings for all of the objects within the 3D scene.
- ***********************************************************/
-void SceneManager::DefineObjectMaterials()
-{
-	OBJECT_MATERIAL plasticMaterial;
-	plasticMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	plasticMaterial.ambientStrength = 0.3f;
-	plasticMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	plasticMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
-	plasticMaterial.shininess = 12.0;
-	plasticMaterial.tag = "plastic";
-
-	m_objectMaterials.push_back(plasticMaterial);
-
-	OBJECT_MATERIAL metalMaterial;
-	metalMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	metalMaterial.ambientStrength = 0.3f;
-	metalMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	metalMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
-	metalMaterial.shininess = 22.0;
-	metalMaterial.tag = "metal";
-
-	m_objectMaterials.push_back(metalMaterial);
-
-	OBJECT_MATERIAL clothMaterial;
-	clothMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	clothMaterial.ambientStrength = 0.2f;
-	clothMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
-	clothMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	clothMaterial.shininess = 0.3;
-	clothMaterial.tag = "cloth";
-
-	m_objectMaterials.push_back(clothMaterial);
-
-	OBJECT_MATERIAL glassMaterial;
-	glassMaterial.ambientColor = glm::vec3(0.4f, 0.4f, 0.4f);
-	glassMaterial.ambientStrength = 0.3f;
-	glassMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
-	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
-	glassMaterial.shininess = 85.0;
-	glassMaterial.tag = "glass";
-
-	m_objectMaterials.push_back(glassMaterial);
-
-	OBJECT_MATERIAL matteMaterial;
-	matteMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	matteMaterial.ambientStrength = 0.2f;
-	matteMaterial.diffuseColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	matteMaterial.specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
-	matteMaterial.shininess = 0.0;
-	matteMaterial.tag = "matteFinish";
-
-	m_objectMaterials.push_back(matteMaterial);
-
-}
-
-/***********************************************************
- *  SetupSceneLights()
- *
- *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
- ***********************************************************/
-void SceneManager::SetupSceneLights()
-{
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting - to use the default rendered 
-	// lighting then comment out the following line
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
-
-	// lamp light																			// starting values below:
-	m_pShaderManager->setVec3Value("lightSources[0].position", 7.75f, 10.0f, -17.75f);      // -3.0f, 5.0f, -6.0f
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.4f, 0.4f, 0.4f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.7f);
-
-	m_pShaderManager->setVec3Value("lightSources[1].position", 13.0f, 10.0f, 6.0f);			//3.0f, 0.0f, 6.0f
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.2f);
-
-
-	m_pShaderManager->setVec3Value("lightSources[2].position", -20.0f, 10.0f, 2.0f);		//0.0f, 3.0f, 2.0f
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.0f, 0.0f, 0.0f);		//0.8f, 0.8f, 0.8f
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.2f);
-
-	//ceiling light
-	m_pShaderManager->setVec3Value("lightSources[3].position", 0.0f, 32.0f, 32.0f);
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", 0.6f, 0.6f, 0.1f);
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 3.0f);
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.5f);
-}
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	// load the texture image files for the textures applied
-	// to objects in the 3D scene
-	LoadSceneTextures();
-	// define the materials that will be used for the objects
-	// in the 3D scene
-	DefineObjectMaterials();
-	// add and defile the light sources for the 3D scene
-	SetupSceneLights();
-
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadPrismMesh();
-	m_basicMeshes->LoadPyramid4Mesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	RenderDesktop();
-	RenderLegoMan();
-	RenderSodaCan();
-	RenderHeadPhones();
-	RenderLampBase();
-}
-void SceneManager::RenderDesktop()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 30.0f); // original scale (20, 1, 10) X,Z scaled up by 0.5
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = -25.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(10.0f, -1.0f, 0.0f);  // original position (0, 0, 0) Y lowered to reduce floor clipping
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.5, 0.5, 0.5, 1);
-	SetShaderTexture("marble");
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderTexture("glass");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
-	/****************************************************************/
-
-}
-
-void SceneManager::RenderLegoMan()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-
-	/*----------Lego Man L Leg-----------*/
-	scaleXYZ = glm::vec3(1.75f, 2.7f, 1.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-0.2f, 0.4f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0, 1.0, 0.0, 1);
-
-	SetShaderMaterial("cloth");
-	SetShaderTexture("leg");
-
-	m_basicMeshes->DrawBoxMesh();
-
-
-	/*----------Lego Man R Leg-----------*/
-
-	scaleXYZ = glm::vec3(1.75f, 2.7f, 1.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-2.2f, 0.4f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0, 1.0, 0.0, 1);
-	SetShaderMaterial("cloth");
-	SetShaderTexture("leg");
-
-	m_basicMeshes->DrawBoxMesh();
-
-
-	/*----------Lego Man Hip-----------*/
-	scaleXYZ = glm::vec3(4.2f, 1.0f, 1.7f);
-	XrotationDegrees = 180.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-1.25f, 2.05f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(0.2, 0.2, 0.2, 1);
-	SetShaderMaterial("cloth");
-	SetShaderTexture("leg");
-
-	m_basicMeshes->DrawBoxMesh();
-
-
-	/*----------Lego Man Body-----------*/
-	scaleXYZ = glm::vec3(2.25f, 4.0f, 1.25f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 180.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-1.25f, 2.5f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0, 0.0, 0.0, 1);
-	SetShaderMaterial("cloth");
-	SetShaderTexture("body");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/*----------Lego Man Neck-----------*/
-	scaleXYZ = glm::vec3(2.25f, 0.1f, 1.25f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-1.25f, 6.5f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 0.2, 0.2, 1);
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/*----------Lego Man Shoulders-----------*/
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-1.25f, 6.5f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 0.2, 0.2, 1);
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/*----------Lego Man Head-----------*/
-	scaleXYZ = glm::vec3(1.5f, 1.75f, 1.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-1.25f, 8.5f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0, 0.0, 0.0, 1);
-	SetShaderMaterial("cloth");
-	SetShaderTexture("face");
-
-	m_basicMeshes->DrawSphereMesh();
-
-
-	/*----------Lego Man L Arm-----------*/
-	scaleXYZ = glm::vec3(0.5f, 3.5f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 180.0f;
-	ZrotationDegrees = -10.0f;
-
-	positionXYZ = glm::vec3(1.5f, 3.0f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0, 0.0, 0.0, 1);
-	SetShaderTexture("arm");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/*----------Lego Man R Arm-----------*/
-	scaleXYZ = glm::vec3(0.5f, 3.5f, 0.5f);
-	XrotationDegrees = -30.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = -10.0f;
-
-	positionXYZ = glm::vec3(-4.0f, 3.0f, 1.7f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	//SetShaderColor(1.0, 0.0, 0.0, 1);
-	SetShaderTexture("arm");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/*----------Lego Man L Hand-----------*/
-	scaleXYZ = glm::vec3(0.7f, 0.7f, 0.7f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(1.6f, 2.5f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 0.2, 0.2, 1);
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawSphereMesh();
-
-
-	/*----------Lego Man R Hand-----------*/
-	scaleXYZ = glm::vec3(0.7f, 0.7f, 0.7f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-4.1f, 2.5f, 2.1f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.2, 0.2, 0.2, 1);
-
-	m_basicMeshes->DrawSphereMesh();
-}
-
-void SceneManager::RenderSodaCan()
-{
-	// initialize values
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*----------Soda body-----------*/
-	scaleXYZ = glm::vec3(3.5f, 9.0f, 3.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(10.0f, -0.9f, 10.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1.0, 1.0, 0.0, 1);
-	SetShaderMaterial("plastic");
-	SetShaderTexture("can");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/*----------Soda Rim-----------*/
-	scaleXYZ = glm::vec3(3.5f, 0.1f, 3.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(10.0f, 8.1f, 10.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.7, 0.7, 0.7, 1);
-	SetShaderMaterial("metal");
-
-	m_basicMeshes->DrawTaperedCylinderMesh();
-}
-
-void SceneManager::RenderHeadPhones()
-{
-	// initialize values
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*----------Headphone Body-----------*/
-	scaleXYZ = glm::vec3(5.0f, 16.0f, 7.0f);
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = -7.5f;
-	ZrotationDegrees = 255.0f;
-
-	positionXYZ = glm::vec3(10.0f, 2.75f, -3.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1.0, 1.0, 1.0, 1);
-	SetShaderMaterial("matteFinish");
-
-	m_basicMeshes->DrawHalfTorusMesh();
-
-	/*----------Headphone L Earpiece-----------*/
-	scaleXYZ = glm::vec3(3.15f, 3.15f, 3.15f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 90.0f;
-
-	positionXYZ = glm::vec3(9.0f, 2.25f, -0.25f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1.0, 1.0, 1.0, 1);
-	SetShaderMaterial("matteFinish");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/*----------Headphone R Earpiece-----------*/
-	scaleXYZ = glm::vec3(3.15f, 3.15f, 3.15f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 115.0f;
-	ZrotationDegrees = 90.0f;
-
-	positionXYZ = glm::vec3(6.0f, 2.25f, -7.75f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1.0, 1.0, 1.0, 1);
-	SetShaderMaterial("matteFinish");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-}
-
-void SceneManager::RenderLampBase() 
-{
-	// initialize values
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*----------Lamp Base-----------*/	
-	// base of the base
-	scaleXYZ = glm::vec3(15.0f, 1.5f, 10.5f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(7.75f, 0.0f, -17.75f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.1, 0.1, 0.2, 1);
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	// upper box
-	scaleXYZ = glm::vec3(4.5f, 4.5f, 8.25f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(2.5f, 1.5f, -18.9f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.1, 0.1, 0.2, 1);
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	// triangular part
-	scaleXYZ = glm::vec3(4.5f, 4.5f, 4.5f);
-
-	XrotationDegrees = -90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 90.0f;
-	positionXYZ = glm::vec3(2.5f, 1.5f, -14.77f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.1, 0.1, 0.2, 1);
-	SetShaderMaterial("plastic");
-
-	m_basicMeshes->DrawPrismMesh();
-
-}
-
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables and defines
+namespace
+{
+	// distance of the far plane of the projection set up in
+	// ViewManager, used for quantizing the draw depth
+	const float g_FarPlaneDistance = 100.0f;
+
+	// most textures that are uploaded in one frame
+	const int g_TextureUploadsPerFrame = 2;
+
+	// fewest packets in a run that are worth an instanced draw
+	const int g_MinimumInstances = 2;
+	// sort key shader field of the packets that are drawn with the
+	// indirect draw calls, which take their own path through the
+	// vertex shader
+	const int g_IndirectDrawShader = 1;
+	// distance between the copies of the scene, larger than the desk
+	const float g_SceneCopySpacing = 70.0f;
+	// starting size of the frame arena blocks, which grow to the
+	// largest frame - one copy of the scene needs a few kilobytes
+	const size_t g_FrameArenaBytes = 256 * 1024;
+	// starting size of every stream buffer region, which grows to
+	// the largest frame
+	const size_t g_StreamRegionBytes = 512 * 1024;
+
+	// object space bounding spheres of the basic shape meshes, in
+	// the same order as the SceneGraph::MESH_TYPE values
+	struct MESH_BOUNDS
+	{
+		glm::vec3 center;
+		float radius;
+	};
+	const MESH_BOUNDS g_MeshBounds[] =
+	{
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 0.8661f },	// box, 1 x 1 x 1
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 1.4143f },	// plane, 2 x 2
+		{ glm::vec3(0.0f, 0.5f, 0.0f), 1.1181f },	// cylinder, radius 1 and height 1
+		{ glm::vec3(0.0f, 0.5f, 0.0f), 1.1181f },	// cone, radius 1 and height 1
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 0.8661f },	// prism, 1 x 1 x 1
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 0.8661f },	// pyramid, 1 x 1 x 1
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 1.0001f },	// sphere, radius 1
+		{ glm::vec3(0.0f, 0.5f, 0.0f), 1.1181f },	// tapered cylinder, radius 1 and height 1
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 1.5f },		// torus
+		{ glm::vec3(0.0f, 0.0f, 0.0f), 1.5f }		// half torus
+	};
+	const int g_MeshBoundsCount = sizeof(g_MeshBounds) / sizeof(g_MeshBounds[0]);
+
+	// a level of detail is used while the projected radius of an
+	// object is below its threshold, as a fraction of half the
+	// screen height - the hysteresis widens the thresholds in the
+	// direction that the level is not changing, so an object on a
+	// threshold does not switch back and forth
+	const float g_LodThresholds[InstancedMeshes::LOD_LEVEL_COUNT - 1] = { 0.25f, 0.08f };
+	const float g_LodHysteresis = 0.2f;
+
+	// image files of the scene textures and their tags
+	struct SCENE_TEXTURE
+	{
+		const char* filename;
+		const char* tag;
+	};
+
+	const SCENE_TEXTURE g_SceneTextures[] =
+	{
+		{ "../../Utilities/textures/marble.jpg", "marble" },
+		{ "../../Utilities/textures/superhero-face.jpg", "face" },	// source: Wr3d Texture Prem  https://www.facebook.com/profile.php?id=100088732373912
+		{ "../../Utilities/textures/superhero-body.jpg", "body" },	// source: Wr3d Texture Prem
+		{ "../../Utilities/textures/superhero-arm.jpg", "arm" },		// source: Wr3d Texture Prem
+		{ "../../Utilities/textures/superhero-leg.jpg", "leg" },		// source: Wr3d Texture Prem
+		{ "../../Utilities/textures/soda-can.jpg", "can" }			// source: Fienne https://www.artstation.com/artwork/nERVG4, and the CocaCola Company
+	};
+	const int g_SceneTextureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+
+	/***********************************************************
+	 *  CopyInstanceData()
+	 *
+	 *  This function is used for copying the transform, color
+	 *  and material of a draw packet into the layout that the
+	 *  instanced and the indirect draws read in the shader.
+	 ***********************************************************/
+	void CopyInstanceData(const RenderQueue::DRAW_PACKET& packet, InstancedMeshes::INSTANCE_DATA& instance)
+	{
+		instance.model = *packet.pModelMatrix;
+		instance.color = packet.color;
+		instance.materialIndex = (packet.materialHandle >= 0) ? packet.materialHandle : 0;
+		instance.padding[0] = 0;
+		instance.padding[1] = 0;
+		instance.padding[2] = 0;
+	}
+
+	/***********************************************************
+	 *  ReadMaterialRecord()
+	 *
+	 *  This function is used for converting a material of a
+	 *  scene file into an object material.
+	 ***********************************************************/
+	SceneManager::OBJECT_MATERIAL ReadMaterialRecord(const SceneFile& sceneFile, const SceneFile::MATERIAL_RECORD& record)
+	{
+		SceneManager::OBJECT_MATERIAL material;
+		material.ambientColor = glm::vec3(record.ambientColor[0], record.ambientColor[1], record.ambientColor[2]);
+		material.ambientStrength = record.ambientStrength;
+		material.diffuseColor = glm::vec3(record.diffuseColor[0], record.diffuseColor[1], record.diffuseColor[2]);
+		material.specularColor = glm::vec3(record.specularColor[0], record.specularColor[1], record.specularColor[2]);
+		material.shininess = record.shininess;
+		material.tag = sceneFile.GetString(record.tagOffset);
+
+		return(material);
+	}
+
+	/***********************************************************
+	 *  BuildMaterialEntry()
+	 *
+	 *  This function is used for converting an object material
+	 *  into the std140 layout of the material table.
+	 ***********************************************************/
+	ShaderUniforms::MATERIAL_ENTRY BuildMaterialEntry(const SceneManager::OBJECT_MATERIAL& material)
+	{
+		ShaderUniforms::MATERIAL_ENTRY entry;
+		entry.ambientColor = material.ambientColor;
+		entry.ambientStrength = material.ambientStrength;
+		entry.diffuseColor = material.diffuseColor;
+		entry.shininess = material.shininess;
+		entry.specularColor = material.specularColor;
+		entry.padding0 = 0.0f;
+
+		return(entry);
+	}
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(
+	ShaderManager* pShaderManager,
+	ShaderUniforms* pShaderUniforms)
+{
+	m_pShaderManager = pShaderManager;
+	m_pShaderUniforms = pShaderUniforms;
+	// the shape meshes come from the mesh cache that is set
+	// before the scene is prepared
+	m_pMeshCache = NULL;
+	m_bOwnsMeshCache = false;
+	// create the scene graph object
+	m_pSceneGraph = new SceneGraph();
+	// create the texture loader object
+	m_pTextureLoader = new TextureLoader();
+	// create the render queue object
+	m_pRenderQueue = new RenderQueue();
+	m_pInstancedMeshes = NULL;
+	// create the view frustum culler object
+	m_pCuller = new VisibilityCuller();
+	m_bUseCulling = true;
+	m_bUseLevelOfDetail = true;
+	// create the frame arena object
+	m_pFrameArena = new FrameArena(g_FrameArenaBytes);
+	m_reportedArenaBytes = 0;
+	// create the stream buffer object
+	m_pStreamBuffer = new StreamBuffer();
+	m_pFrameData = NULL;
+	m_frameDataOffset = 0;
+	m_frameDataCount = 0;
+	m_frameDataCapacity = 0;
+	m_frameDataWritten = 0;
+	m_bStreamObjectData = false;
+	m_bFrameDataBound = false;
+	m_bUseInstancing = true;
+	m_pDrawCommands = NULL;
+	m_drawCommandOffset = 0;
+	m_drawCommandCount = 0;
+	m_bUseIndirectDraws = true;
+	// create the compute shader culler object
+	m_pGpuCuller = new GpuCuller();
+	m_pCullObjects = NULL;
+	m_pBatchFirstCommands = NULL;
+	m_batchCount = 0;
+	m_bUseGpuCulling = false;
+	m_renderMode = RENDER_MODE_FRONT_TO_BACK;
+	m_bMultiView = false;
+	// create the light clusters object
+	m_pLightClusters = new LightClusters();
+	for (int i = 0; i < 4; i++)
+	{
+		m_viewport[i] = 0;
+	}
+	m_pProfiler = NULL;
+	m_pProgramCache = NULL;
+	m_pJobSystem = NULL;
+	m_bUseParallelRecording = true;
+	m_desktopNode = -1;
+	m_legoManNode = -1;
+	m_sodaCanNode = -1;
+	m_headPhonesNode = -1;
+	m_lampBaseNode = -1;
+	m_sceneNodeCount = 0;
+	m_pSceneFile = NULL;
+	m_sceneCopyCount = 1;
+	m_pFileWatcher = NULL;
+
+	// create the texture arrays object
+	m_pTextureArrays = new TextureArrays(pShaderUniforms);
+	// create the texture streamer object
+	m_pTextureStreamer = new TextureStreamer(m_pTextureArrays, m_pTextureLoader);
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	// the watcher thread is stopped before the assets go away
+	if (NULL != m_pFileWatcher)
+	{
+		delete m_pFileWatcher;
+		m_pFileWatcher = NULL;
+	}
+	// free the allocated objects
+	m_pShaderManager = NULL;
+	m_pShaderUniforms = NULL;
+	// the meshes of the scene are released, and a shared cache
+	// frees the ones that no other scene uses
+	if (NULL != m_pMeshCache)
+	{
+		for (int i = 0; i < (int)m_acquiredMeshes.size(); i++)
+		{
+			m_pMeshCache->ReleaseMesh(m_acquiredMeshes[i], MeshCache::TESSELLATION_BASIC);
+			m_pMeshCache->ReleaseMesh(m_acquiredMeshes[i], MeshCache::TESSELLATION_LOD_CHAIN);
+		}
+		m_acquiredMeshes.clear();
+		if (m_bOwnsMeshCache == true)
+		{
+			delete m_pMeshCache;
+		}
+		m_pMeshCache = NULL;
+	}
+	m_pInstancedMeshes = NULL;
+	if (NULL != m_pSceneGraph)
+	{
+		delete m_pSceneGraph;
+		m_pSceneGraph = NULL;
+	}
+	if (NULL != m_pTextureStreamer)
+	{
+		delete m_pTextureStreamer;
+		m_pTextureStreamer = NULL;
+	}
+	if (NULL != m_pTextureLoader)
+	{
+		delete m_pTextureLoader;
+		m_pTextureLoader = NULL;
+	}
+	if (NULL != m_pRenderQueue)
+	{
+		delete m_pRenderQueue;
+		m_pRenderQueue = NULL;
+	}
+	if (NULL != m_pCuller)
+	{
+		delete m_pCuller;
+		m_pCuller = NULL;
+	}
+	if (NULL != m_pGpuCuller)
+	{
+		delete m_pGpuCuller;
+		m_pGpuCuller = NULL;
+	}
+	if (NULL != m_pLightClusters)
+	{
+		delete m_pLightClusters;
+		m_pLightClusters = NULL;
+	}
+	if (NULL != m_pJobSystem)
+	{
+		delete m_pJobSystem;
+		m_pJobSystem = NULL;
+	}
+	if (NULL != m_pSceneFile)
+	{
+		delete m_pSceneFile;
+		m_pSceneFile = NULL;
+	}
+	// the arrays of the frame are released with their buffers
+	m_pFrameData = NULL;
+	m_pDrawCommands = NULL;
+	m_pCullObjects = NULL;
+	m_pBatchFirstCommands = NULL;
+	if (NULL != m_pFrameArena)
+	{
+		delete m_pFrameArena;
+		m_pFrameArena = NULL;
+	}
+	for (int i = 0; i < (int)m_recordSections.size(); i++)
+	{
+		delete m_recordSections[i].pCommandList;
+	}
+	m_recordSections.clear();
+	if (NULL != m_pStreamBuffer)
+	{
+		delete m_pStreamBuffer;
+		m_pStreamBuffer = NULL;
+	}
+
+	// free the allocated OpenGL textures
+	DestroyGLTextures();
+	if (NULL != m_pTextureArrays)
+	{
+		delete m_pTextureArrays;
+		m_pTextureArrays = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for creating the texture for an image
+ *  file in the next available texture slot in memory.  The
+ *  image is loaded in the background by the texture loader,
+ *  so the texture can be used right away.  Only the small
+ *  mipmap levels are loaded at first, and the texture streamer
+ *  loads the finer ones once they are needed.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, const std::string& tag)
+{
+	// every tag can only be associated with one texture
+	if (m_textureRegistry.Find(tag) != HandleRegistry::INVALID_HANDLE)
+	{
+		std::cout << "A texture is already loaded for the tag:" << tag << std::endl;
+		return false;
+	}
+
+	// the texture shows the placeholder until the image is decoded
+	// on a worker thread and stored into a texture array layer
+	int textureHandle = m_pTextureArrays->AddTexture();
+	if (textureHandle < 0)
+	{
+		std::cout << "Could not add the texture for the tag:" << tag << std::endl;
+		return false;
+	}
+
+	// register the texture and associate it with the special tag string -
+	// the handle of the texture is its index in the texture table
+	m_textureRegistry.Register(tag);
+	m_pTextureStreamer->AddTexture(textureHandle, filename);
+	WatchAssetFile(filename, RELOAD_TEXTURE, textureHandle);
+
+	return true;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the texture arrays to
+ *  OpenGL texture memory slots and uploading the texture
+ *  table, so every loaded texture can be selected by handle.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	m_pTextureArrays->BindTextureArrays();
+}
+
+/***********************************************************
+ *  StoreLoadedTextures()
+ *
+ *  This method is used for moving the textures that have
+ *  finished loading in the background into their texture
+ *  array layers.  The failed loads are only passed on to the
+ *  texture streamer, so it can stream the texture again.
+ ***********************************************************/
+void SceneManager::StoreLoadedTextures()
+{
+	m_completedLoads.clear();
+	m_pTextureLoader->ProcessCompletedLoads(g_TextureUploadsPerFrame, m_completedLoads);
+
+	for (int i = 0; i < (int)m_completedLoads.size(); i++)
+	{
+		const TextureLoader::COMPLETED_LOAD& load = m_completedLoads[i];
+
+		m_pTextureStreamer->CompleteLoad(load.textureHandle);
+		if (load.bFailed == true)
+		{
+			continue;
+		}
+
+		m_pTextureArrays->StoreTexture(
+			load.textureHandle,
+			load.textureID,
+			load.width,
+			load.height,
+			load.internalFormat,
+			load.levelCount,
+			load.firstLevel);
+
+		// the layer holds a copy, so the loaded texture is freed
+		glDeleteTextures(1, &load.textureID);
+	}
+
+	m_pTextureArrays->UploadLocations();
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	if (NULL != m_pTextureArrays)
+	{
+		m_pTextureArrays->Destroy();
+	}
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ *  The ID is the texture array that holds the texture.
+ ***********************************************************/
+int SceneManager::FindTextureID(const std::string& tag)
+{
+	int textureSlot = FindTextureSlot(tag);
+
+	if (textureSlot < 0)
+	{
+		return(-1);
+	}
+
+	return(m_pTextureArrays->GetArrayTextureID(textureSlot));
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.  The
+ *  slot index is the texture handle used by the render path.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(const std::string& tag)
+{
+	return(m_textureRegistry.Find(tag));
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the handle of a previously
+ *  defined material that is associated with the passed in tag.
+ *  The handle is the position of the material in the shader
+ *  material table.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag)
+{
+	return(m_materialRegistry.Find(tag));
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	SetTransformations(SceneGraph::ComposeTransform(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ));
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using an already composed model matrix, such as the
+ *  cached world matrix of a scene node.
+ ***********************************************************/
+void SceneManager::SetTransformations(const glm::mat4& modelView)
+{
+	if (NULL != m_pShaderUniforms)
+	{
+		m_pShaderUniforms->setMat4Value(ShaderUniforms::UNIFORM_MODEL, modelView);
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderUniforms)
+	{
+		m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_USE_TEXTURE, false);
+		m_pShaderUniforms->setVec4Value(ShaderUniforms::UNIFORM_OBJECT_COLOR, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in tag into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const std::string& textureTag)
+{
+	SetShaderTexture(FindTextureSlot(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in handle into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	int textureHandle)
+{
+	if (NULL != m_pShaderUniforms)
+	{
+		m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_USE_TEXTURE, true);
+
+		if (textureHandle >= 0)
+		{
+			m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_TEXTURE_INDEX, textureHandle);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderUniforms)
+	{
+		m_pShaderUniforms->setVec2Value(ShaderUniforms::UNIFORM_UV_SCALE, glm::vec2(u, v));
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting the material associated
+ *  with the passed in tag for the next draw command.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
+{
+	SetShaderMaterial(FindMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting the material associated
+ *  with the passed in handle for the next draw command.  A
+ *  handle past the end of the shader material table selects
+ *  the first material, so the shader never reads past it.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	int materialHandle)
+{
+	if (materialHandle >= ShaderUniforms::MAX_MATERIALS)
+	{
+		materialHandle = 0;
+	}
+
+	// the material values are already in the shader material
+	// table, so only the table index needs to be set
+	if ((NULL != m_pShaderUniforms) && (materialHandle >= 0))
+	{
+		m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_MATERIAL_INDEX, materialHandle);
+	}
+}
+
+/**************************************************************/
+/*** The code in the methods BELOW is for preparing and     ***/
+/*** rendering the 3D replicated scenes.                    ***/
+/**************************************************************/
+
+/***********************************************************
+ *  LoadSceneTextures()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene
+ *  rendering
+ ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	if (NULL != m_pSceneFile)
+	{
+		for (int i = 0; i < m_pSceneFile->GetTextureCount(); i++)
+		{
+			const SceneFile::TEXTURE_RECORD& texture = m_pSceneFile->GetTexture(i);
+			CreateGLTexture(m_pSceneFile->GetString(texture.filenameOffset), m_pSceneFile->GetString(texture.tagOffset));
+		}
+	}
+	else
+	{
+		for (int i = 0; i < g_SceneTextureCount; i++)
+		{
+			CreateGLTexture(g_SceneTextures[i].filename, g_SceneTextures[i].tag);
+		}
+	}
+
+	// the texture arrays need to be bound to texture slots - the
+	// textures are packed into one array per size and format, so
+	// the number of textures is not limited by the slots
+	BindGLTextures();
+}
+
+/***********************************************************
+ *  BakeSceneTextures()
+ *
+ *  This method is used for converting all the texture images
+ *  of the 3D scene into compressed files with their mipmaps,
+ *  which are then loaded instead of the images.  It is run
+ *  as an offline step and does not need an OpenGL context.
+ *  The textures of the passed in scene file are baked when
+ *  it is not NULL.
+ ***********************************************************/
+bool SceneManager::BakeSceneTextures(const char* sceneFilename)
+{
+	bool bReturn = true;
+	std::vector<std::string> filenames;
+
+	if (NULL != sceneFilename)
+	{
+		SceneFile sceneFile;
+		if (sceneFile.Load(sceneFilename) == false)
+		{
+			return(false);
+		}
+		for (int i = 0; i < sceneFile.GetTextureCount(); i++)
+		{
+			filenames.push_back(sceneFile.GetString(sceneFile.GetTexture(i).filenameOffset));
+		}
+	}
+	else
+	{
+		for (int i = 0; i < g_SceneTextureCount; i++)
+		{
+			filenames.push_back(g_SceneTextures[i].filename);
+		}
+	}
+
+	for (int i = 0; i < (int)filenames.size(); i++)
+	{
+		std::string bakedFilename = CompressedTexture::GetBakedFilename(filenames[i].c_str());
+
+		if (CompressedTexture::Bake(filenames[i].c_str(), bakedFilename.c_str()) == false)
+		{
+			bReturn = false;
+		}
+	}
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for configuring the various material
+ *  settings for all of the objects within the 3D scene.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	if (NULL != m_pSceneFile)
+	{
+		for (int i = 0; i < m_pSceneFile->GetMaterialCount(); i++)
+		{
+			m_objectMaterials.push_back(ReadMaterialRecord(*m_pSceneFile, m_pSceneFile->GetMaterial(i)));
+		}
+
+		RegisterObjectMaterials();
+		return;
+	}
+
+	OBJECT_MATERIAL plasticMaterial;
+	plasticMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	plasticMaterial.ambientStrength = 0.3f;
+	plasticMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	plasticMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	plasticMaterial.shininess = 12.0;
+	plasticMaterial.tag = "plastic";
+
+	m_objectMaterials.push_back(plasticMaterial);
+
+	OBJECT_MATERIAL metalMaterial;
+	metalMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	metalMaterial.ambientStrength = 0.3f;
+	metalMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	metalMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	metalMaterial.shininess = 22.0;
+	metalMaterial.tag = "metal";
+
+	m_objectMaterials.push_back(metalMaterial);
+
+	OBJECT_MATERIAL clothMaterial;
+	clothMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	clothMaterial.ambientStrength = 0.2f;
+	clothMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	clothMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	clothMaterial.shininess = 0.3;
+	clothMaterial.tag = "cloth";
+
+	m_objectMaterials.push_back(clothMaterial);
+
+	OBJECT_MATERIAL glassMaterial;
+	glassMaterial.ambientColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	glassMaterial.ambientStrength = 0.3f;
+	glassMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
+	glassMaterial.shininess = 85.0;
+	glassMaterial.tag = "glass";
+
+	m_objectMaterials.push_back(glassMaterial);
+
+	OBJECT_MATERIAL matteMaterial;
+	matteMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	matteMaterial.ambientStrength = 0.2f;
+	matteMaterial.diffuseColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	matteMaterial.specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	matteMaterial.shininess = 0.0;
+	matteMaterial.tag = "matteFinish";
+
+	m_objectMaterials.push_back(matteMaterial);
+
+	// hand out the material handles and upload all of the
+	// defined materials into the shader material table
+	RegisterObjectMaterials();
+}
+
+/***********************************************************
+ *  RegisterObjectMaterials()
+ *
+ *  This method is used for registering the handles of the
+ *  defined materials and for uploading them into the shader
+ *  material table.  The handle of a material is its index in
+ *  the material table.
+ ***********************************************************/
+void SceneManager::RegisterObjectMaterials()
+{
+	std::vector<ShaderUniforms::MATERIAL_ENTRY> materialTable;
+
+	m_materialRegistry.Clear();
+	for (int i = 0; i < (int)m_objectMaterials.size(); i++)
+	{
+		// the table is built in handle order, so a duplicated tag
+		// keeps the first material that was defined with it
+		if (m_materialRegistry.Register(m_objectMaterials[i].tag) != (int)materialTable.size())
+		{
+			std::cout << "The material tag " << m_objectMaterials[i].tag << " is defined more than once" << std::endl;
+			continue;
+		}
+
+		materialTable.push_back(BuildMaterialEntry(m_objectMaterials[i]));
+	}
+
+	if ((NULL != m_pShaderUniforms) && (materialTable.size() > 0))
+	{
+		m_pShaderUniforms->UploadMaterialBlock(&materialTable[0], (int)materialTable.size());
+	}
+}
+
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is called to add and configure the light
+ *  sources for the 3D scene.  The light sources are shaded
+ *  with clustered lighting, so a scene file can hold many
+ *  more of them than the 4 of the built-in scene.
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	// this line of code is NEEDED for telling the shaders to render 
+	// the 3D scene with custom lighting - to use the default rendered 
+	// lighting then comment out the following line
+	m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_USE_LIGHTING, true);
+
+	ShaderUniforms::LIGHT_SOURCE lightSource = {};
+
+	if (NULL != m_pSceneFile)
+	{
+		// the count is limited to the size of the light buffer
+		m_pShaderUniforms->SetLightCount(m_pSceneFile->GetLightCount());
+		for (int i = 0; i < m_pShaderUniforms->GetLightCount(); i++)
+		{
+			const SceneFile::LIGHT_RECORD& record = m_pSceneFile->GetLight(i);
+			lightSource.position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+			lightSource.ambientColor = glm::vec3(record.ambientColor[0], record.ambientColor[1], record.ambientColor[2]);
+			lightSource.diffuseColor = glm::vec3(record.diffuseColor[0], record.diffuseColor[1], record.diffuseColor[2]);
+			lightSource.specularColor = glm::vec3(record.specularColor[0], record.specularColor[1], record.specularColor[2]);
+			lightSource.focalStrength = record.focalStrength;
+			lightSource.specularIntensity = record.specularIntensity;
+			lightSource.radius = record.radius;
+			m_pShaderUniforms->SetLightSource(i, lightSource);
+		}
+
+		m_pShaderUniforms->UploadLightBlock();
+		return;
+	}
+
+	// the built-in lights have no radius, so they reach the
+	// whole scene - the third one adds no color, so it is left
+	// out of the clusters
+	m_pShaderUniforms->SetLightCount(4);
+
+	// lamp light																			// starting values below:
+	lightSource.position = glm::vec3(7.75f, 10.0f, -17.75f);								// -3.0f, 5.0f, -6.0f
+	lightSource.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	lightSource.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	lightSource.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	lightSource.focalStrength = 32.0f;
+	lightSource.specularIntensity = 0.7f;
+	m_pShaderUniforms->SetLightSource(0, lightSource);
+
+	lightSource.position = glm::vec3(13.0f, 10.0f, 6.0f);								//3.0f, 0.0f, 6.0f
+	lightSource.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	lightSource.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	lightSource.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	lightSource.focalStrength = 32.0f;
+	lightSource.specularIntensity = 0.2f;
+	m_pShaderUniforms->SetLightSource(1, lightSource);
+
+
+	lightSource.position = glm::vec3(-20.0f, 10.0f, 2.0f);								//0.0f, 3.0f, 2.0f
+	lightSource.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	lightSource.diffuseColor = glm::vec3(0.0f, 0.0f, 0.0f);								//0.8f, 0.8f, 0.8f
+	lightSource.specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	lightSource.focalStrength = 12.0f;
+	lightSource.specularIntensity = 0.2f;
+	m_pShaderUniforms->SetLightSource(2, lightSource);
+
+	//ceiling light
+	lightSource.position = glm::vec3(0.0f, 32.0f, 32.0f);
+	lightSource.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	lightSource.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	lightSource.specularColor = glm::vec3(0.6f, 0.6f, 0.1f);
+	lightSource.focalStrength = 3.0f;
+	lightSource.specularIntensity = 0.5f;
+	m_pShaderUniforms->SetLightSource(3, lightSource);
+
+	// upload all of the light sources with one buffer update
+	m_pShaderUniforms->UploadLightBlock();
+}
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// load the texture image files for the textures applied
+	// to objects in the 3D scene
+	LoadSceneTextures();
+	// define the materials that will be used for the objects
+	// in the 3D scene
+	DefineObjectMaterials();
+	// add and defile the light sources for the 3D scene
+	SetupSceneLights();
+
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn,
+	// and it is shared with the other scenes through the cache
+	if (NULL == m_pMeshCache)
+	{
+		m_pMeshCache = new MeshCache();
+		m_bOwnsMeshCache = true;
+	}
+	m_pInstancedMeshes = m_pMeshCache->GetInstancedMeshes();
+
+	// the per-draw data of the instanced, indirect and single draws
+	// is streamed through one ring buffer, and without it every
+	// object is drawn on its own with the data in the uniforms
+	if (m_pStreamBuffer->Create(g_StreamRegionBytes) == false)
+	{
+		std::cout << "The stream buffer could not be created, every object is drawn on its own" << std::endl;
+		m_bUseInstancing = false;
+		m_bUseIndirectDraws = false;
+		m_bUseLevelOfDetail = false;
+	}
+	// the single draws read their data from the same storage
+	// buffer as the indirect draws
+	m_bStreamObjectData = (m_pStreamBuffer->IsCreated() == true) &&
+		(GLEW_ARB_shader_storage_buffer_object);
+
+	// the instanced meshes share one vertex and index buffer, so
+	// they can all be drawn with indirect draw calls when the
+	// driver supports them
+	if ((m_bUseIndirectDraws == true) &&
+		((!GLEW_ARB_multi_draw_indirect) ||
+		 (!GLEW_ARB_shader_draw_parameters) ||
+		 (!GLEW_ARB_shader_storage_buffer_object)))
+	{
+		std::cout << "Multi-draw indirect is not supported, the shared meshes are drawn one run at a time" << std::endl;
+		m_bUseIndirectDraws = false;
+	}
+
+	// the GPU culling compacts the indirect draw commands, so it
+	// needs the indirect draws, compute shaders and draw counts
+	// that are read from a buffer - and it culls them for one
+	// camera, which is not enough for the multi-view mode
+	if ((m_bUseGpuCulling == true) && (m_bMultiView == true))
+	{
+		std::cout << "GPU culling is not used with several views, the scene is culled on the CPU" << std::endl;
+		m_bUseGpuCulling = false;
+	}
+	if (m_bUseGpuCulling == true)
+	{
+		if ((m_bUseIndirectDraws == false) ||
+			(!GLEW_ARB_compute_shader) ||
+			(!GLEW_ARB_indirect_parameters))
+		{
+			std::cout << "GPU culling is not supported, the scene is culled on the CPU" << std::endl;
+			m_bUseGpuCulling = false;
+		}
+		else if (m_pGpuCuller->LoadShader("Shaders/cullShader.glsl", m_pProgramCache) == false)
+		{
+			m_bUseGpuCulling = false;
+		}
+	}
+
+	// the light sources are assigned to the clusters of the
+	// window, and without the cluster shader every fragment is
+	// shaded with all of them
+	glGetIntegerv(GL_VIEWPORT, m_viewport);
+	if ((m_pLightClusters->IsEnabled() == true) && (m_bMultiView == true))
+	{
+		std::cout << "The light clusters are not used with several views, every fragment is shaded with all the lights" << std::endl;
+		m_pLightClusters->SetEnabled(false);
+	}
+	if (m_pLightClusters->IsEnabled() == true)
+	{
+		if (m_pLightClusters->LoadShader("Shaders/clusterShader.glsl", m_pProgramCache) == false)
+		{
+			std::cout << "Clustered lighting is not available, every fragment is shaded with all the lights" << std::endl;
+			m_pLightClusters->SetEnabled(false);
+		}
+	}
+
+	// add the objects of the 3D scene to the scene graph and
+	// calculate their world matrices once
+	DefineSceneNodes();
+	ResolveSceneNodeHandles();
+	m_pSceneGraph->UpdateWorldTransforms();
+	UpdateSceneBounds();
+	AcquireSceneMeshes();
+
+	// the command lists are recorded on the render thread when
+	// there is no spare core for a worker thread
+	DefineRecordSections();
+	if (m_bUseParallelRecording == true)
+	{
+		m_pJobSystem = new JobSystem();
+		if (m_pJobSystem->GetWorkerCount() == 0)
+		{
+			std::cout << "No spare CPU core, the command lists are recorded on the render thread" << std::endl;
+			delete m_pJobSystem;
+			m_pJobSystem = NULL;
+			m_bUseParallelRecording = false;
+		}
+	}
+
+	if (TransformBatch::GetInstructionSet() == TransformBatch::INSTRUCTIONS_SCALAR)
+	{
+		std::cout << "No supported SIMD instructions, the transforms are composed one at a time" << std::endl;
+	}
+
+	// the shaders and the material values of a scene file are
+	// rebuilt when they are edited, the meshes are generated in
+	// code and stay as they are
+	if (NULL != m_pFileWatcher)
+	{
+		WatchAssetFile("Shaders/vertexShader.glsl", RELOAD_SCENE_SHADER, -1);
+		WatchAssetFile("Shaders/fragmentShader.glsl", RELOAD_SCENE_SHADER, -1);
+		if (m_pLightClusters->IsEnabled() == true)
+		{
+			WatchAssetFile("Shaders/clusterShader.glsl", RELOAD_CLUSTER_SHADER, -1);
+		}
+		if (m_bUseGpuCulling == true)
+		{
+			WatchAssetFile("Shaders/cullShader.glsl", RELOAD_CULL_SHADER, -1);
+		}
+		if (NULL != m_pSceneFile)
+		{
+			WatchAssetFile(m_sceneFilename.c_str(), RELOAD_SCENE_MATERIALS, -1);
+		}
+
+		if (m_pFileWatcher->Start() == false)
+		{
+			std::cout << "The asset files can not be watched, they are not reloaded when edited" << std::endl;
+			delete m_pFileWatcher;
+			m_pFileWatcher = NULL;
+		}
+	}
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene.  The parts
+ *  of the scene record their draw packets into command lists,
+ *  which are merged into the render queue, sorted by state
+ *  and executed in one pass.
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	ProfileZone renderZone(m_pProfiler, FrameProfiler::ZONE_RENDER_SCENE);
+
+	// the edited assets are rebuilt between two frames
+	ApplyAssetReloads();
+
+	// store the meshes that were built in the background, before
+	// any of the draws are recorded
+	m_pMeshCache->ProcessLoads();
+
+	// the transient data of the frame before the previous one is
+	// released all at once
+	m_pFrameArena->BeginFrame();
+
+	// replace the placeholders of the textures that have finished
+	// loading in the background since the last frame
+	StoreLoadedTextures();
+
+	// only the nodes that have been changed since the last
+	// frame get their world matrices recalculated, and only then
+	// the bounding volumes are rebuilt
+	if (m_pSceneGraph->UpdateWorldTransforms() == true)
+	{
+		UpdateSceneBounds();
+	}
+	CullSceneNodes();
+	UpdateTextureStreaming();
+
+	{
+		ProfileZone zone(m_pProfiler, FrameProfiler::ZONE_RECORD_COMMAND_LISTS);
+		RecordCommandLists();
+	}
+
+	m_pRenderQueue->Sort();
+	{
+		ProfileZone zone(m_pProfiler, FrameProfiler::ZONE_ASSIGN_LIGHTS);
+		AssignLightClusters();
+	}
+	{
+		ProfileZone zone(m_pProfiler, FrameProfiler::ZONE_EXECUTE_RENDER_QUEUE);
+		ExecuteRenderQueue();
+	}
+	RecordRenderQueueStats();
+	ReportFrameArenaPeak();
+	RecordResidencyStats();
+}
+
+void SceneManager::RenderDesktop(RenderQueue* pCommandList)
+{
+	SubmitSceneNodes(m_desktopNode, pCommandList);
+}
+
+void SceneManager::RenderLegoMan(RenderQueue* pCommandList)
+{
+	SubmitSceneNodes(m_legoManNode, pCommandList);
+}
+
+void SceneManager::RenderSodaCan(RenderQueue* pCommandList)
+{
+	SubmitSceneNodes(m_sodaCanNode, pCommandList);
+}
+
+void SceneManager::RenderHeadPhones(RenderQueue* pCommandList)
+{
+	SubmitSceneNodes(m_headPhonesNode, pCommandList);
+}
+
+void SceneManager::RenderLampBase(RenderQueue* pCommandList)
+{
+	SubmitSceneNodes(m_lampBaseNode, pCommandList);
+}
+
+/***********************************************************
+ *  DefineRecordSections()
+ *
+ *  This method is used for setting up the parts of the scene
+ *  that get their own command lists.  Every copy of the scene
+ *  is a part of its own, so the copies spread over the
+ *  worker threads.  A scene from a scene file has no Render
+ *  methods, so each of its root nodes is a part instead.
+ ***********************************************************/
+void SceneManager::DefineRecordSections()
+{
+	for (int i = 0; i < (int)m_recordSections.size(); i++)
+	{
+		delete m_recordSections[i].pCommandList;
+	}
+	m_recordSections.clear();
+
+	RECORD_SECTION section;
+	section.pSceneManager = this;
+	section.rootNode = -1;
+
+	void (SceneManager::*recordFunctions[])(RenderQueue*) =
+	{
+		&SceneManager::RenderDesktop,
+		&SceneManager::RenderLegoMan,
+		&SceneManager::RenderSodaCan,
+		&SceneManager::RenderHeadPhones,
+		&SceneManager::RenderLampBase
+	};
+	FrameProfiler::PROFILE_ZONE zones[] =
+	{
+		FrameProfiler::ZONE_RENDER_DESKTOP,
+		FrameProfiler::ZONE_RENDER_LEGO_MAN,
+		FrameProfiler::ZONE_RENDER_SODA_CAN,
+		FrameProfiler::ZONE_RENDER_HEAD_PHONES,
+		FrameProfiler::ZONE_RENDER_LAMP_BASE
+	};
+	for (int i = 0; (NULL == m_pSceneFile) && (i < (int)(sizeof(zones) / sizeof(zones[0]))); i++)
+	{
+		section.pRecordFunction = recordFunctions[i];
+		section.zone = zones[i];
+		section.pCommandList = new RenderQueue();
+		m_recordSections.push_back(section);
+	}
+
+	section.pRecordFunction = NULL;
+	section.zone = FrameProfiler::ZONE_COUNT;
+	for (int i = 0; (NULL != m_pSceneFile) && (i < (int)m_scenePartNodes.size()); i++)
+	{
+		section.rootNode = m_scenePartNodes[i];
+		section.pCommandList = new RenderQueue();
+		m_recordSections.push_back(section);
+	}
+	for (int i = 0; i < (int)m_sceneCopyNodes.size(); i++)
+	{
+		section.rootNode = m_sceneCopyNodes[i];
+		section.pCommandList = new RenderQueue();
+		m_recordSections.push_back(section);
+	}
+}
+
+/***********************************************************
+ *  RecordSection()
+ *
+ *  This method is used for recording the command list of a
+ *  part of the scene.  The parts cover separate ranges of
+ *  the scene nodes, so the parts can be recorded at the same
+ *  time without locking.
+ ***********************************************************/
+void SceneManager::RecordSection(const RECORD_SECTION& section)
+{
+	section.pCommandList->Clear();
+	if (NULL != section.pRecordFunction)
+	{
+		(this->*section.pRecordFunction)(section.pCommandList);
+	}
+	else
+	{
+		SubmitSceneNodes(section.rootNode, section.pCommandList);
+	}
+}
+
+void SceneManager::RecordSectionJob(void* pData)
+{
+	const RECORD_SECTION* pSection = (const RECORD_SECTION*)pData;
+	pSection->pSceneManager->RecordSection(*pSection);
+}
+
+/***********************************************************
+ *  RecordCommandLists()
+ *
+ *  This method is used for recording the command lists of
+ *  all the parts of the scene and merging them into the
+ *  render queue.  The lists are recorded as jobs on the job
+ *  system, and the render thread records lists too while it
+ *  waits.  The lists are merged in the same order every
+ *  frame, so the sorted queue does not depend on which
+ *  thread finished first.  The profiler is only used from
+ *  the render thread, so the parts only get their own zones
+ *  when they are recorded one after the other.
+ ***********************************************************/
+void SceneManager::RecordCommandLists()
+{
+	if ((m_bUseParallelRecording == true) && (NULL != m_pJobSystem))
+	{
+		JobSystem::JOB_COUNTER counter;
+		for (int i = 0; i < (int)m_recordSections.size(); i++)
+		{
+			m_pJobSystem->Submit(RecordSectionJob, &m_recordSections[i], counter);
+		}
+		m_pJobSystem->Wait(counter);
+	}
+	else
+	{
+		for (int i = 0; i < (int)m_recordSections.size(); i++)
+		{
+			ProfileZone zone(m_pProfiler, m_recordSections[i].zone);
+			RecordSection(m_recordSections[i]);
+		}
+	}
+
+	m_pRenderQueue->Clear();
+	for (int i = 0; i < (int)m_recordSections.size(); i++)
+	{
+		m_pRenderQueue->Append(*m_recordSections[i].pCommandList);
+	}
+}
+
+/***********************************************************
+ *  UpdateSceneBounds()
+ *
+ *  This method is used for calculating the world space
+ *  bounding sphere of every drawn scene node from the bounds
+ *  of its mesh and its world matrix, and for rebuilding the
+ *  hierarchy of the culler over them.  The radius is scaled
+ *  by the largest axis scale, so the sphere stays around the
+ *  mesh under non-uniform scaling.
+ ***********************************************************/
+void SceneManager::UpdateSceneBounds()
+{
+	const std::vector<SceneGraph::SCENE_NODE>& nodes = m_pSceneGraph->GetNodes();
+	std::vector<VisibilityCuller::BOUNDING_SPHERE> spheres;
+	std::vector<int> nodeIndices;
+
+	spheres.reserve(nodes.size());
+	nodeIndices.reserve(nodes.size());
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		const SceneGraph::SCENE_NODE& node = nodes[i];
+		if ((node.mesh < 0) || (node.mesh >= g_MeshBoundsCount))
+		{
+			continue;
+		}
+
+		const glm::mat4& world = node.worldMatrix;
+		float maxScale = glm::max(
+			glm::length(glm::vec3(world[0])),
+			glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+
+		VisibilityCuller::BOUNDING_SPHERE sphere;
+		sphere.center = glm::vec3(world * glm::vec4(g_MeshBounds[node.mesh].center, 1.0f));
+		sphere.radius = g_MeshBounds[node.mesh].radius * maxScale;
+		spheres.push_back(sphere);
+		nodeIndices.push_back(i);
+	}
+
+	m_pCuller->Build(spheres, nodeIndices);
+	m_nodeVisible.assign(nodes.size(), 1);
+
+	VisibilityCuller::BOUNDING_SPHERE noBounds;
+	noBounds.center = glm::vec3(0.0f, 0.0f, 0.0f);
+	noBounds.radius = 0.0f;
+	m_nodeBounds.assign(nodes.size(), noBounds);
+	for (int i = 0; i < (int)spheres.size(); i++)
+	{
+		m_nodeBounds[nodeIndices[i]] = spheres[i];
+	}
+	if (m_nodeLodLevels.size() != nodes.size())
+	{
+		m_nodeLodLevels.assign(nodes.size(), 0);
+	}
+}
+
+/***********************************************************
+ *  CullSceneNodes()
+ *
+ *  This method is used for finding the scene nodes inside of
+ *  the view frustum of the camera, before any packets are
+ *  submitted.  The frustum is taken from the view and the
+ *  projection matrices set by the view manager, and in the
+ *  multi-view mode the frusta of all the views are joined.
+ ***********************************************************/
+void SceneManager::CullSceneNodes()
+{
+	if (m_nodeVisible.size() != m_pSceneGraph->GetNodes().size())
+	{
+		UpdateSceneBounds();
+	}
+
+	if ((m_bUseCulling == false) || (NULL == m_pShaderUniforms))
+	{
+		std::fill(m_nodeVisible.begin(), m_nodeVisible.end(), (unsigned char)1);
+		return;
+	}
+
+	const ShaderUniforms::CAMERA_BLOCK& camera = m_pShaderUniforms->GetCameraBlock();
+	VisibilityCuller::FRUSTUM frustum = VisibilityCuller::ExtractFrustum(camera.projection * camera.view);
+	m_pCuller->Cull(frustum, m_nodeVisible);
+
+	// the packets are recorded once for all the views, so a node
+	// is kept when any of the views can see it - the camera is
+	// the last of the views and has already been tested
+	int viewCount = GetRenderViewCount();
+	for (int view = 0; view < viewCount - 1; view++)
+	{
+		const ShaderUniforms::CAMERA_BLOCK& viewCamera = m_pShaderUniforms->GetViewBlock(view);
+
+		m_viewVisible = m_nodeVisible;
+		m_pCuller->Cull(VisibilityCuller::ExtractFrustum(viewCamera.projection * viewCamera.view), m_viewVisible);
+		for (int i = 0; i < (int)m_nodeVisible.size(); i++)
+		{
+			m_nodeVisible[i] |= m_viewVisible[i];
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateTextureStreaming()
+ *
+ *  This method is used for asking the texture streamer for
+ *  the mipmap levels of the textures of the visible scene
+ *  nodes.  The level is picked from the size of the bounding
+ *  sphere on screen, so that one texel of it covers about one
+ *  pixel, and the finest level is asked for when the camera
+ *  is inside of the sphere.
+ ***********************************************************/
+void SceneManager::UpdateTextureStreaming()
+{
+	if (m_pTextureStreamer->IsEnabled() == false)
+	{
+		return;
+	}
+
+	const std::vector<SceneGraph::SCENE_NODE>& nodes = m_pSceneGraph->GetNodes();
+	glm::vec3 viewPosition = glm::vec3(m_pShaderUniforms->GetCameraBlock().viewPosition);
+	float projectionScale = m_pShaderUniforms->GetCameraBlock().projection[1][1];
+
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		const SceneGraph::SCENE_NODE& node = nodes[i];
+		if ((node.bUseTexture == false) ||
+			(node.textureHandle < 0) ||
+			(m_nodeVisible[i] == 0) ||
+			(m_pTextureArrays->IsTextureStored(node.textureHandle) == false))
+		{
+			continue;
+		}
+
+		const VisibilityCuller::BOUNDING_SPHERE& bounds = m_nodeBounds[i];
+		float distance = glm::length(bounds.center - viewPosition);
+		int level = 0;
+
+		if (distance > bounds.radius)
+		{
+			// the diameter of the sphere in pixels
+			float screenPixels = bounds.radius * projectionScale / distance * (float)m_viewport[3];
+			int width = m_pTextureArrays->GetTextureWidth(node.textureHandle);
+			int height = m_pTextureArrays->GetTextureHeight(node.textureHandle);
+			float textureSize = (float)((width > height) ? width : height);
+
+			if (screenPixels < 1.0f)
+			{
+				screenPixels = 1.0f;
+			}
+			if (textureSize > screenPixels)
+			{
+				level = (int)std::floor(std::log2(textureSize / screenPixels));
+			}
+		}
+
+		m_pTextureStreamer->NoteTextureUse(node.textureHandle, level);
+	}
+
+	m_pTextureStreamer->Update();
+	m_pTextureArrays->UploadLocations();
+}
+
+/***********************************************************
+ *  SelectLodLevel()
+ *
+ *  This method is used for selecting the level of detail of
+ *  a scene node from the projected size of its bounding
+ *  sphere.  The projection scale is 1 / tan(fov / 2) of the
+ *  camera, so zooming in selects a more detailed level just
+ *  like moving closer.  The selected level is kept per node
+ *  for the hysteresis.
+ ***********************************************************/
+int SceneManager::SelectLodLevel(int nodeIndex, const glm::vec3& viewPosition, float projectionScale)
+{
+	const SceneGraph::SCENE_NODE& node = m_pSceneGraph->GetNodes()[nodeIndex];
+	InstancedMeshes::INSTANCED_MESH instancedMesh = GetInstancedMesh(node.mesh);
+
+	if ((m_bUseLevelOfDetail == false) ||
+		(instancedMesh == InstancedMeshes::INSTANCED_MESH_COUNT) ||
+		(m_pInstancedMeshes->GetLevelCount(instancedMesh) <= 1))
+	{
+		return(0);
+	}
+
+	const VisibilityCuller::BOUNDING_SPHERE& bounds = m_nodeBounds[nodeIndex];
+	float distance = glm::length(bounds.center - viewPosition);
+	int currentLevel = m_nodeLodLevels[nodeIndex];
+
+	if (distance > bounds.radius)
+	{
+		float screenSize = bounds.radius * projectionScale / distance;
+		int levelCount = m_pInstancedMeshes->GetLevelCount(instancedMesh);
+		int coarserLevel = 0;
+		int finerLevel = 0;
+
+		for (int level = 0; level < levelCount - 1; level++)
+		{
+			if (screenSize < g_LodThresholds[level] * (1.0f - g_LodHysteresis))
+			{
+				coarserLevel = level + 1;
+			}
+			if (screenSize < g_LodThresholds[level] * (1.0f + g_LodHysteresis))
+			{
+				finerLevel = level + 1;
+			}
+		}
+
+		if (coarserLevel > currentLevel)
+		{
+			currentLevel = coarserLevel;
+		}
+		else if (finerLevel < currentLevel)
+		{
+			currentLevel = finerLevel;
+		}
+	}
+	else
+	{
+		// the camera is inside of the bounds
+		currentLevel = 0;
+	}
+
+	m_nodeLodLevels[nodeIndex] = (unsigned char)currentLevel;
+
+	return(currentLevel);
+}
+
+/***********************************************************
+ *  SubmitSceneNodes()
+ *
+ *  This method is used for recording a draw packet for the
+ *  passed in node and all of its children into a command
+ *  list.  The subtree is stored in one range of the flat
+ *  node list, so it can be walked in order.  It only writes
+ *  to the passed in list and the level of detail of the
+ *  walked nodes, so it can run on any thread.
+ ***********************************************************/
+void SceneManager::SubmitSceneNodes(int nodeIndex, RenderQueue* pCommandList)
+{
+	const std::vector<SceneGraph::SCENE_NODE>& nodes = m_pSceneGraph->GetNodes();
+	glm::vec3 viewPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	if ((NULL == pCommandList) || (nodeIndex < 0) || (nodeIndex >= (int)nodes.size()))
+	{
+		return;
+	}
+
+	float projectionScale = 1.0f;
+
+	if (NULL != m_pShaderUniforms)
+	{
+		viewPosition = glm::vec3(m_pShaderUniforms->GetCameraBlock().viewPosition);
+		projectionScale = m_pShaderUniforms->GetCameraBlock().projection[1][1];
+	}
+
+	for (int i = nodeIndex; i <= nodes[nodeIndex].lastDescendant; i++)
+	{
+		const SceneGraph::SCENE_NODE& node = nodes[i];
+
+		// group nodes only carry a transform, and the objects
+		// outside of the view frustum are skipped
+		// the indirect draws are culled by the compute pass when
+		// the GPU culling is enabled
+		bool bCulled = (m_nodeVisible[i] == 0);
+		if ((m_bUseGpuCulling == true) && (UsesIndirectDraw(node.mesh) == true))
+		{
+			bCulled = false;
+		}
+
+		if ((node.mesh == SceneGraph::MESH_NONE) || (bCulled == true))
+		{
+			continue;
+		}
+
+		RenderQueue::DRAW_PACKET packet;
+		packet.nodeIndex = i;
+		packet.pModelMatrix = &node.worldMatrix;
+		packet.mesh = node.mesh;
+		packet.lodLevel = SelectLodLevel(i, viewPosition, projectionScale);
+		packet.bUseTexture = node.bUseTexture;
+		packet.textureHandle = node.bUseTexture ? node.textureHandle : -1;
+		packet.color = node.color;
+		packet.materialHandle = node.materialHandle;
+		// the lit textures are written without their alpha
+		packet.bTransparent = (node.bUseTexture == false) && (node.color.a < 1.0f);
+
+		// the depth of the object is the distance between the camera
+		// and the origin of its world matrix
+		float viewDepth = glm::length(glm::vec3(node.worldMatrix[3]) - viewPosition);
+
+		// instanced meshes read the material from the instance data,
+		// so the material is left out of the key to keep the
+		// instances of a mesh next to each other
+		int sortMaterial = packet.materialHandle;
+		if (((m_bUseInstancing == true) || (m_bUseIndirectDraws == true)) &&
+			(GetInstancedMesh(packet.mesh) != InstancedMeshes::INSTANCED_MESH_COUNT))
+		{
+			sortMaterial = -1;
+		}
+
+		// the packets of the indirect draws are sorted after all the
+		// other packets, so that they are only split by texture
+		int sortShader = 0;
+		if (UsesIndirectDraw(packet.mesh) == true)
+		{
+			sortShader = g_IndirectDrawShader;
+		}
+
+		// the transparent packets are blended back to front after
+		// all the opaque packets
+		RenderQueue::SORT_ORDER sortOrder = RenderQueue::SORT_BY_STATE;
+		if (packet.bTransparent == true)
+		{
+			sortOrder = RenderQueue::SORT_BACK_TO_FRONT;
+		}
+		else if (m_renderMode == RENDER_MODE_FRONT_TO_BACK)
+		{
+			sortOrder = RenderQueue::SORT_FRONT_TO_BACK;
+		}
+
+		packet.sortKey = RenderQueue::BuildSortKey(
+			sortOrder,
+			sortShader,
+			packet.textureHandle,
+			sortMaterial,
+			packet.mesh,
+			packet.lodLevel,
+			viewDepth,
+			g_FarPlaneDistance);
+
+		pCommandList->Submit(packet);
+	}
+}
+
+/***********************************************************
+ *  ExecuteRenderQueue()
+ *
+ *  This method is used for drawing the sorted packets of the
+ *  render queue.  The opaque packets are drawn first without
+ *  blending, and the transparent packets are then blended
+ *  over them without writing their depth.  With the depth
+ *  pre-pass, the opaque packets are drawn twice - first only
+ *  into the depth buffer with a fragment shader that skips
+ *  the lighting, and then with the lighting for the fragments
+ *  whose depth is equal to the stored one, so every pixel is
+ *  only lit once.  The opaque samples of both passes are
+ *  counted by the profiler to report the overdraw that was
+ *  saved.  The per-draw data of all the paths is written
+ *  straight into the mapped stream buffer.
+ ***********************************************************/
+void SceneManager::ExecuteRenderQueue()
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	// offset of the next command in the indirect draw buffer and
+	// index of the next indirect draw call
+	int commandOffset = 0;
+	int batchIndex = 0;
+
+	m_pRenderQueue->ResetStats();
+
+	if (NULL == m_pShaderUniforms)
+	{
+		return;
+	}
+
+	int packetCount = (int)packets.size();
+	int opaqueCount = m_pRenderQueue->GetOpaqueCount();
+	int viewCount = GetRenderViewCount();
+	bool bDepthPrepass = (m_renderMode == RENDER_MODE_DEPTH_PREPASS) && (opaqueCount > 0);
+
+	// the reduced levels of detail are only in the instanced
+	// meshes, so the frame data is also needed without instancing -
+	// it is written by the first pass over the packets, and the
+	// lit pass after the depth pre-pass and the other views draw
+	// from the same entries again - without it, the packets are
+	// drawn with the uniforms
+	bool bFrameData = PrepareFrameData(packetCount);
+	PrepareIndirectDraws();
+	if ((bFrameData == true) && (packetCount > 0))
+	{
+		BindDrawData(true);
+	}
+	int firstDataIndex = m_frameDataCount;
+	m_frameDataWritten = firstDataIndex;
+
+	glDisable(GL_BLEND);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	// the opaque surfaces are tested against the depth buffer as
+	// usual, or only shaded where the pre-pass left them
+	GLenum opaqueDepthFunc = GL_LESS;
+	GLboolean bOpaqueDepthMask = GL_TRUE;
+
+	if (bDepthPrepass == true)
+	{
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_DEPTH_ONLY, true);
+		if (NULL != m_pProfiler)
+		{
+			m_pProfiler->BeginSampleCount(FrameProfiler::COUNTER_PREPASS_KILOSAMPLES);
+		}
+
+		for (int view = 0; view < viewCount; view++)
+		{
+			BeginViewPass(view, firstDataIndex, commandOffset, batchIndex);
+			DrawPacketRange(0, opaqueCount, commandOffset, batchIndex);
+		}
+
+		if (NULL != m_pProfiler)
+		{
+			m_pProfiler->EndSampleCount(FrameProfiler::COUNTER_PREPASS_KILOSAMPLES);
+		}
+		m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_DEPTH_ONLY, false);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+		// the depth buffer already holds the nearest opaque surfaces,
+		// and the lit pass draws the same commands again
+		opaqueDepthFunc = GL_EQUAL;
+		bOpaqueDepthMask = GL_FALSE;
+	}
+
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->BeginSampleCount(FrameProfiler::COUNTER_SHADED_KILOSAMPLES);
+	}
+
+	// the draw data and the commands of the transparent packets
+	// follow those of the opaque packets
+	int transparentDataIndex = firstDataIndex;
+	int transparentCommandOffset = 0;
+	int transparentBatchIndex = 0;
+
+	glDepthFunc(opaqueDepthFunc);
+	glDepthMask(bOpaqueDepthMask);
+	for (int view = 0; view < viewCount; view++)
+	{
+		BeginViewPass(view, firstDataIndex, commandOffset, batchIndex);
+		DrawPacketRange(0, opaqueCount, commandOffset, batchIndex);
+
+		transparentDataIndex = m_frameDataCount;
+		transparentCommandOffset = commandOffset;
+		transparentBatchIndex = batchIndex;
+	}
+
+	// only the opaque samples are counted, because the pre-pass
+	// does not draw the transparent packets
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndSampleCount(FrameProfiler::COUNTER_SHADED_KILOSAMPLES);
+	}
+
+	// the views cover separate parts of the depth buffer, so the
+	// transparent packets of each view are only blended over the
+	// opaque surfaces of that view
+	if (opaqueCount < packetCount)
+	{
+		// the transparent packets are tested against the opaque
+		// depth, but do not hide each other
+		glEnable(GL_BLEND);
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_FALSE);
+
+		for (int view = 0; view < viewCount; view++)
+		{
+			BeginViewPass(view, transparentDataIndex, commandOffset, batchIndex);
+			commandOffset = transparentCommandOffset;
+			batchIndex = transparentBatchIndex;
+			DrawPacketRange(opaqueCount, packetCount, commandOffset, batchIndex);
+		}
+
+		glDisable(GL_BLEND);
+	}
+
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	if (viewCount > 1)
+	{
+		glViewport(m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+		m_pShaderUniforms->BindCameraView(-1);
+	}
+
+	// the regions of the stream buffer are written again once the
+	// draws of this frame have finished
+	m_pStreamBuffer->EndFrame();
+}
+
+/***********************************************************
+ *  GetRenderViewCount()
+ *
+ *  This method is used for getting the number of views that
+ *  the packets of the frame are drawn into.  Without the
+ *  multi-view mode they are only drawn into the window.
+ ***********************************************************/
+int SceneManager::GetRenderViewCount() const
+{
+	if ((m_bMultiView == true) && (NULL != m_pShaderUniforms) &&
+		(m_pShaderUniforms->GetViewCount() > 1))
+	{
+		return(m_pShaderUniforms->GetViewCount());
+	}
+
+	return(1);
+}
+
+/***********************************************************
+ *  BeginViewPass()
+ *
+ *  This method is used for starting a pass over the sorted
+ *  packets.  The pass draws from the frame data and the
+ *  indirect commands that the first pass has written, so
+ *  only the draw calls are issued again.  In the multi-view
+ *  mode the pass is drawn into the quarter of the window of
+ *  the view, with the camera of the view.
+ ***********************************************************/
+void SceneManager::BeginViewPass(int viewIndex, int firstDataIndex, int& commandOffset, int& batchIndex)
+{
+	m_frameDataCount = firstDataIndex;
+	commandOffset = 0;
+	batchIndex = 0;
+
+	if (GetRenderViewCount() <= 1)
+	{
+		return;
+	}
+
+	// the views are laid out two by two, starting at the top left
+	int width = m_viewport[2] / 2;
+	int height = m_viewport[3] / 2;
+	int column = viewIndex % 2;
+	int row = viewIndex / 2;
+
+	glViewport(m_viewport[0] + column * width, m_viewport[1] + (1 - row) * height, width, height);
+	m_pShaderUniforms->BindCameraView(viewIndex);
+}
+
+/***********************************************************
+ *  DrawPacketRange()
+ *
+ *  This method is used for drawing a range of the sorted
+ *  packets.  The shader state that is already set from the
+ *  previous packet is not uploaded again, and the issued
+ *  state changes are counted in the queue statistics.  When
+ *  instancing is enabled, runs of packets that only differ
+ *  in their transform, color and material are drawn with one
+ *  instanced draw call.  When indirect drawing is enabled,
+ *  all the packets of the shared meshes with the same texture
+ *  are drawn with one multi-draw indirect call instead.  When
+ *  the stream buffer could not give any room for the frame
+ *  data, every packet is drawn with its own uniforms.
+ ***********************************************************/
+void SceneManager::DrawPacketRange(int firstPacket, int endPacket, int& commandOffset, int& batchIndex)
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	RenderQueue::QUEUE_STATS& stats = m_pRenderQueue->GetStats();
+
+	// the state left in the shader by the previous packet - the
+	// first packet always sets all of its state
+	bool bStateValid = false;
+	bool bLastUseTexture = false;
+	int lastTexture = -1;
+	glm::vec4 lastColor = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+	int lastMaterial = -1;
+	int lastMesh = -1;
+	// true while the vertex shader reads the per-object values
+	// from the draw data
+	bool bDrawDataEnabled = false;
+	// the instanced, indirect and streamed draws all read the
+	// frame data
+	bool bFrameData = (NULL != m_pFrameData);
+
+	int i = firstPacket;
+	while (i < endPacket)
+	{
+		const RenderQueue::DRAW_PACKET& packet = packets[i];
+		bool bIndirectDraw = (bFrameData == true) && (UsesIndirectDraw(packet.mesh) == true);
+		int runLength = 1;
+
+		if (bIndirectDraw == true)
+		{
+			runLength = FindIndirectBatch(i, endPacket);
+		}
+		else if ((bFrameData == true) && (m_bUseInstancing == true))
+		{
+			runLength = FindInstanceRun(i, endPacket);
+		}
+
+		if ((bStateValid == false) || (packet.bUseTexture != bLastUseTexture))
+		{
+			m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_USE_TEXTURE, packet.bUseTexture);
+			bLastUseTexture = packet.bUseTexture;
+			stats.textureModeChanges++;
+		}
+
+		if (packet.bUseTexture == true)
+		{
+			if ((packet.textureHandle >= 0) &&
+				((bStateValid == false) || (packet.textureHandle != lastTexture)))
+			{
+				m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_TEXTURE_INDEX, packet.textureHandle);
+				lastTexture = packet.textureHandle;
+				stats.textureChanges++;
+			}
+		}
+
+		// the basic shape meshes bind their own vertex arrays, so
+		// only the switches between different meshes are counted
+		if ((bStateValid == false) || (packet.mesh != lastMesh))
+		{
+			lastMesh = packet.mesh;
+			stats.meshChanges++;
+		}
+
+		// the draw data takes precedence over the instance
+		// attributes in the vertex shader, so it is switched off
+		// for the instanced draws and on for the other streamed draws
+		bool bUseDrawData = (bIndirectDraw == true) ||
+			((bFrameData == true) && (m_bStreamObjectData == true) &&
+			(runLength < g_MinimumInstances) && (packet.lodLevel == 0));
+		if (bUseDrawData != bDrawDataEnabled)
+		{
+			m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_USE_DRAW_DATA, bUseDrawData);
+			bDrawDataEnabled = bUseDrawData;
+			stats.instancingChanges++;
+		}
+
+		if (bIndirectDraw == true)
+		{
+			// every packet of the batch is one command, and its
+			// transform, color and material come from the draw data
+			DrawIndirectBatch(commandOffset, runLength, batchIndex);
+			commandOffset += runLength;
+			batchIndex++;
+
+			stats.instancingChanges++;
+			stats.indirectDraws++;
+			stats.indirectPackets += runLength;
+		}
+		else if ((bFrameData == true) &&
+			((runLength >= g_MinimumInstances) || (packet.lodLevel > 0)))
+		{
+			// the transform, color and material of every packet in
+			// the run come from the instance attributes
+			DrawInstanceRun(i, runLength);
+
+			stats.instancingChanges += 2;
+			stats.instancedDraws++;
+			stats.instancedPackets += runLength;
+		}
+		else if ((bFrameData == true) && (m_bStreamObjectData == true))
+		{
+			// the transform, color and material are written into the
+			// stream buffer, and only their index is uploaded
+			DrawStreamedPacket(packet);
+		}
+		else
+		{
+			// every object has its own model matrix
+			SetTransformations(*packet.pModelMatrix);
+
+			if ((packet.bUseTexture == false) &&
+				((bStateValid == false) || (packet.color != lastColor)))
+			{
+				m_pShaderUniforms->setVec4Value(ShaderUniforms::UNIFORM_OBJECT_COLOR, packet.color);
+				lastColor = packet.color;
+				stats.colorChanges++;
+			}
+
+			if ((packet.materialHandle >= 0) &&
+				((bStateValid == false) || (packet.materialHandle != lastMaterial)))
+			{
+				m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_MATERIAL_INDEX, packet.materialHandle);
+				lastMaterial = packet.materialHandle;
+				stats.materialChanges++;
+			}
+
+			DrawSceneMesh((SceneGraph::MESH_TYPE)packet.mesh);
+		}
+
+		bStateValid = true;
+		stats.drawCount++;
+		stats.packetCount += runLength;
+		stats.naiveStateChanges += RenderQueue::STATES_PER_PACKET * runLength;
+		i += runLength;
+	}
+
+	if (bDrawDataEnabled == true)
+	{
+		m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_USE_DRAW_DATA, false);
+	}
+}
+
+/***********************************************************
+ *  GetInstancedMesh()
+ *
+ *  This method is used for getting the instanced version of
+ *  a basic shape mesh.  INSTANCED_MESH_COUNT is returned for
+ *  the meshes that can not be drawn instanced.
+ ***********************************************************/
+InstancedMeshes::INSTANCED_MESH SceneManager::GetInstancedMesh(int mesh) const
+{
+	InstancedMeshes::INSTANCED_MESH instancedMesh = InstancedMeshes::INSTANCED_MESH_COUNT;
+
+	switch (mesh)
+	{
+	case SceneGraph::MESH_BOX:
+		instancedMesh = InstancedMeshes::INSTANCED_BOX;
+		break;
+	case SceneGraph::MESH_CYLINDER:
+		instancedMesh = InstancedMeshes::INSTANCED_CYLINDER;
+		break;
+	case SceneGraph::MESH_SPHERE:
+		instancedMesh = InstancedMeshes::INSTANCED_SPHERE;
+		break;
+	default:
+		break;
+	}
+
+	if ((NULL == m_pInstancedMeshes) ||
+		(m_pInstancedMeshes->IsMeshLoaded(instancedMesh) == false))
+	{
+		instancedMesh = InstancedMeshes::INSTANCED_MESH_COUNT;
+	}
+
+	return(instancedMesh);
+}
+
+/***********************************************************
+ *  FindInstanceRun()
+ *
+ *  This method is used for counting the packets, starting at
+ *  the passed in packet and ending before endPacket, that can
+ *  be drawn together with one instanced draw call.  They need
+ *  the same mesh, level of detail and texture, everything
+ *  else comes from the instance data.
+ ***********************************************************/
+int SceneManager::FindInstanceRun(int firstPacket, int endPacket) const
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	const RenderQueue::DRAW_PACKET& first = packets[firstPacket];
+	int runLength = 1;
+
+	if (GetInstancedMesh(first.mesh) == InstancedMeshes::INSTANCED_MESH_COUNT)
+	{
+		return(runLength);
+	}
+
+	while (firstPacket + runLength < endPacket)
+	{
+		const RenderQueue::DRAW_PACKET& packet = packets[firstPacket + runLength];
+
+		if ((packet.mesh != first.mesh) ||
+			(packet.lodLevel != first.lodLevel) ||
+			(packet.bTransparent != first.bTransparent) ||
+			(packet.bUseTexture != first.bUseTexture) ||
+			(packet.textureHandle != first.textureHandle))
+		{
+			break;
+		}
+		runLength++;
+	}
+
+	return(runLength);
+}
+
+/***********************************************************
+ *  PrepareFrameData()
+ *
+ *  This method is used for getting the room for the per-draw
+ *  data and the indirect commands of the frame from the
+ *  stream buffer.  Every packet is drawn by exactly one of
+ *  the paths, so exactly one entry is kept for each packet,
+ *  and the depth pre-pass draws the opaque packets again
+ *  from the entries that were already written for them.  The
+ *  region of the frame is only handed out once the GPU has
+ *  finished with it.
+ ***********************************************************/
+bool SceneManager::PrepareFrameData(int packetCount)
+{
+	size_t dataBytes = sizeof(InstancedMeshes::INSTANCE_DATA) * packetCount;
+	size_t commandBytes = sizeof(InstancedMeshes::DRAW_COMMAND) * packetCount;
+
+	m_pFrameData = NULL;
+	m_frameDataCount = 0;
+	m_frameDataCapacity = packetCount;
+	m_frameDataWritten = 0;
+	m_pDrawCommands = NULL;
+
+	if (m_pStreamBuffer->IsCreated() == false)
+	{
+		return(false);
+	}
+
+	m_pStreamBuffer->BeginFrame(dataBytes + commandBytes + 2 * m_pStreamBuffer->GetOffsetAlignment());
+	m_pFrameData = (InstancedMeshes::INSTANCE_DATA*)m_pStreamBuffer->Allocate(dataBytes, m_frameDataOffset);
+	if (m_bUseIndirectDraws == true)
+	{
+		m_pDrawCommands = (InstancedMeshes::DRAW_COMMAND*)m_pStreamBuffer->Allocate(commandBytes, m_drawCommandOffset);
+	}
+
+	return(NULL != m_pFrameData);
+}
+
+/***********************************************************
+ *  BindDrawData()
+ *
+ *  This method is used for binding the draw data that the
+ *  vertex shader reads.  The single draws and the indirect
+ *  draws that were not culled on the GPU read the frame data,
+ *  and the culled indirect draws read the draw data that the
+ *  compute pass compacted.
+ ***********************************************************/
+void SceneManager::BindDrawData(bool bFrameData)
+{
+	if (bFrameData == true)
+	{
+		glBindBufferRange(
+			GL_SHADER_STORAGE_BUFFER,
+			ShaderUniforms::DRAW_DATA_STORAGE_BINDING,
+			m_pStreamBuffer->GetBuffer(),
+			m_frameDataOffset,
+			sizeof(InstancedMeshes::INSTANCE_DATA) * m_frameDataCapacity);
+	}
+	else
+	{
+		glBindBufferBase(
+			GL_SHADER_STORAGE_BUFFER,
+			ShaderUniforms::DRAW_DATA_STORAGE_BINDING,
+			m_pGpuCuller->GetVisibleDrawDataBuffer());
+	}
+	m_bFrameDataBound = bFrameData;
+}
+
+/***********************************************************
+ *  DrawInstanceRun()
+ *
+ *  This method is used for writing the transforms, colors
+ *  and materials of a run of packets into the frame data and
+ *  drawing them with one instanced draw call.
+ ***********************************************************/
+void SceneManager::DrawInstanceRun(int firstPacket, int runLength)
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	GLintptr bufferOffset = m_frameDataOffset + sizeof(InstancedMeshes::INSTANCE_DATA) * m_frameDataCount;
+	InstancedMeshes::INSTANCE_DATA* pInstanceData = m_pFrameData + m_frameDataCount;
+
+	// a later pass over the same packets finds the run already written
+	if (m_frameDataCount + runLength > m_frameDataWritten)
+	{
+		for (int i = 0; i < runLength; i++)
+		{
+			CopyInstanceData(packets[firstPacket + i], pInstanceData[i]);
+		}
+		m_pStreamBuffer->Flush(bufferOffset, sizeof(InstancedMeshes::INSTANCE_DATA) * runLength);
+		m_frameDataWritten = m_frameDataCount + runLength;
+	}
+	m_frameDataCount += runLength;
+
+	GLuint instanceBuffer = m_pStreamBuffer->GetBuffer();
+
+	m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_USE_INSTANCING, true);
+
+	switch (GetInstancedMesh(packets[firstPacket].mesh))
+	{
+	case InstancedMeshes::INSTANCED_BOX:
+		m_pInstancedMeshes->DrawBoxMeshInstanced(runLength, instanceBuffer, bufferOffset);
+		break;
+	case InstancedMeshes::INSTANCED_CYLINDER:
+		m_pInstancedMeshes->DrawCylinderMeshInstanced(runLength, instanceBuffer, bufferOffset, packets[firstPacket].lodLevel);
+		break;
+	case InstancedMeshes::INSTANCED_SPHERE:
+		m_pInstancedMeshes->DrawSphereMeshInstanced(runLength, instanceBuffer, bufferOffset, packets[firstPacket].lodLevel);
+		break;
+	default:
+		break;
+	}
+
+	m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_USE_INSTANCING, false);
+}
+
+/***********************************************************
+ *  DrawStreamedPacket()
+ *
+ *  This method is used for drawing a packet on its own with
+ *  its transform, color and material in the frame data.
+ *  Writing the data is a copy into mapped memory, and only
+ *  the index of the entry is uploaded, because the basic
+ *  shape meshes draw without a base instance.
+ ***********************************************************/
+void SceneManager::DrawStreamedPacket(const RenderQueue::DRAW_PACKET& packet)
+{
+	int dataIndex = m_frameDataCount++;
+
+	if (dataIndex >= m_frameDataWritten)
+	{
+		CopyInstanceData(packet, m_pFrameData[dataIndex]);
+		m_pStreamBuffer->Flush(
+			m_frameDataOffset + sizeof(InstancedMeshes::INSTANCE_DATA) * dataIndex,
+			sizeof(InstancedMeshes::INSTANCE_DATA));
+		m_frameDataWritten = dataIndex + 1;
+	}
+
+	if (m_bFrameDataBound == false)
+	{
+		BindDrawData(true);
+	}
+	m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_DRAW_DATA_OFFSET, dataIndex);
+
+	DrawSceneMesh((SceneGraph::MESH_TYPE)packet.mesh);
+}
+
+/***********************************************************
+ *  UsesIndirectDraw()
+ *
+ *  This method is used for checking whether the packets of
+ *  the passed in mesh are drawn with the indirect draw calls.
+ ***********************************************************/
+bool SceneManager::UsesIndirectDraw(int mesh) const
+{
+	return((m_bUseIndirectDraws == true) &&
+		(GetInstancedMesh(mesh) != InstancedMeshes::INSTANCED_MESH_COUNT));
+}
+
+/***********************************************************
+ *  PrepareIndirectDraws()
+ *
+ *  This method is used for writing one indirect draw command
+ *  and one draw data entry for every packet of the shared
+ *  meshes, in the sorted packet order, straight into the
+ *  stream buffer.  The draw data is the start of the frame
+ *  data, and it is read in the vertex shader by the index of
+ *  the command in its draw call.
+ *  With the GPU culling, the commands are then culled and
+ *  compacted by the compute pass, which also writes the
+ *  number of visible commands of every batch.
+ ***********************************************************/
+void SceneManager::PrepareIndirectDraws()
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+
+	m_drawCommandCount = 0;
+	m_batchCount = 0;
+
+	if ((m_bUseIndirectDraws == false) || (packets.empty() == true) ||
+		(NULL == m_pFrameData) || (NULL == m_pDrawCommands))
+	{
+		return;
+	}
+
+	// there are never more commands or batches than packets, so
+	// the culling inputs are allocated once for the whole frame
+	m_pCullObjects = m_pFrameArena->AllocateArray<GpuCuller::CULL_OBJECT>(packets.size());
+	m_pBatchFirstCommands = m_pFrameArena->AllocateArray<GLuint>(packets.size());
+
+	int i = 0;
+	while (i < (int)packets.size())
+	{
+		if (UsesIndirectDraw(packets[i].mesh) == false)
+		{
+			i++;
+			continue;
+		}
+
+		// the batches are found the same way as when they are drawn
+		int batchLength = FindIndirectBatch(i, (int)packets.size());
+		GLuint batch = (GLuint)m_batchCount;
+		m_pBatchFirstCommands[m_batchCount++] = (GLuint)m_drawCommandCount;
+
+		for (int j = i; j < i + batchLength; j++)
+		{
+			const RenderQueue::DRAW_PACKET& packet = packets[j];
+			InstancedMeshes::DRAW_COMMAND& command = m_pDrawCommands[m_drawCommandCount];
+			GpuCuller::CULL_OBJECT& object = m_pCullObjects[m_drawCommandCount];
+
+			m_pInstancedMeshes->BuildDrawCommand(GetInstancedMesh(packet.mesh), packet.lodLevel, command);
+			CopyInstanceData(packet, m_pFrameData[m_drawCommandCount]);
+
+			const VisibilityCuller::BOUNDING_SPHERE& bounds = m_nodeBounds[packet.nodeIndex];
+			object.sphere = glm::vec4(bounds.center, bounds.radius);
+			object.batch = batch;
+			object.padding[0] = 0;
+			object.padding[1] = 0;
+			object.padding[2] = 0;
+
+			m_drawCommandCount++;
+		}
+		i += batchLength;
+	}
+
+	// the rest of the frame data follows the draw data
+	m_frameDataCount = m_drawCommandCount;
+	if (m_drawCommandCount == 0)
+	{
+		return;
+	}
+
+	m_pStreamBuffer->Flush(m_frameDataOffset, sizeof(InstancedMeshes::INSTANCE_DATA) * m_drawCommandCount);
+	m_pStreamBuffer->Flush(m_drawCommandOffset, sizeof(InstancedMeshes::DRAW_COMMAND) * m_drawCommandCount);
+
+	if (m_bUseGpuCulling == true)
+	{
+		const ShaderUniforms::CAMERA_BLOCK& camera = m_pShaderUniforms->GetCameraBlock();
+		m_pGpuCuller->Cull(
+			VisibilityCuller::ExtractFrustum(camera.projection * camera.view),
+			m_pStreamBuffer->GetBuffer(),
+			m_frameDataOffset,
+			m_drawCommandOffset,
+			m_pCullObjects,
+			m_drawCommandCount,
+			m_pBatchFirstCommands,
+			m_batchCount);
+		m_pShaderManager->use();
+	}
+}
+
+/***********************************************************
+ *  AssignLightClusters()
+ *
+ *  This method is used for assigning the light sources to
+ *  the clusters of the camera that was uploaded for the
+ *  frame.  The pass is skipped by the light clusters when
+ *  the view and the lights have not changed.
+ ***********************************************************/
+void SceneManager::AssignLightClusters()
+{
+	if (m_pLightClusters->Assign(m_pShaderUniforms, m_viewport) == true)
+	{
+		// the compute pass unbinds the scene shader program
+		m_pShaderManager->use();
+	}
+}
+
+/***********************************************************
+ *  FindIndirectBatch()
+ *
+ *  This method is used for counting the packets, starting at
+ *  the passed in packet and ending before endPacket, that can
+ *  be drawn together with one indirect draw call.  The
+ *  texture is the only state that they need to share, because
+ *  the sampler array can not be indexed per draw.
+ ***********************************************************/
+int SceneManager::FindIndirectBatch(int firstPacket, int endPacket) const
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	const RenderQueue::DRAW_PACKET& first = packets[firstPacket];
+	int batchLength = 1;
+
+	while (firstPacket + batchLength < endPacket)
+	{
+		const RenderQueue::DRAW_PACKET& packet = packets[firstPacket + batchLength];
+
+		if ((UsesIndirectDraw(packet.mesh) == false) ||
+			(packet.bTransparent != first.bTransparent) ||
+			(packet.bUseTexture != first.bUseTexture) ||
+			(packet.textureHandle != first.textureHandle))
+		{
+			break;
+		}
+		batchLength++;
+	}
+
+	return(batchLength);
+}
+
+/***********************************************************
+ *  DrawIndirectBatch()
+ *
+ *  This method is used for drawing a batch of the uploaded
+ *  commands with one multi-draw indirect call.  The vertex
+ *  shader adds the draw index to the offset of the batch to
+ *  find the draw data of each command.  The culled batches
+ *  draw the visible commands that the compute pass counted.
+ ***********************************************************/
+void SceneManager::DrawIndirectBatch(int firstCommand, int batchLength, int batchIndex)
+{
+	GLintptr bufferOffset = sizeof(InstancedMeshes::DRAW_COMMAND) * firstCommand;
+
+	m_pShaderUniforms->setIntValue(ShaderUniforms::UNIFORM_DRAW_DATA_OFFSET, firstCommand);
+	if (m_bUseGpuCulling == true)
+	{
+		if (m_bFrameDataBound == true)
+		{
+			BindDrawData(false);
+		}
+		m_pInstancedMeshes->DrawMeshesIndirectCount(
+			m_pGpuCuller->GetVisibleCommandBuffer(),
+			bufferOffset,
+			m_pGpuCuller->GetBatchCountBuffer(),
+			sizeof(GLuint) * batchIndex,
+			batchLength);
+	}
+	else
+	{
+		m_pInstancedMeshes->DrawMeshesIndirect(
+			m_pStreamBuffer->GetBuffer(),
+			m_drawCommandOffset + bufferOffset,
+			batchLength);
+	}
+}
+
+/***********************************************************
+ *  SetIndirectDrawing()
+ *
+ *  This method is used for switching between drawing the
+ *  shared meshes with multi-draw indirect calls and drawing
+ *  them with instanced or single draw calls.
+ ***********************************************************/
+void SceneManager::SetIndirectDrawing(bool bEnabled)
+{
+	m_bUseIndirectDraws = bEnabled;
+}
+
+/***********************************************************
+ *  SetGpuCulling()
+ *
+ *  This method is used for switching between culling the
+ *  indirect draws with a compute shader and culling them on
+ *  the CPU.  It must be called before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetGpuCulling(bool bEnabled)
+{
+	m_bUseGpuCulling = bEnabled;
+}
+
+/***********************************************************
+ *  SetClusteredLighting()
+ *
+ *  This method is used for switching between shading every
+ *  fragment with only the lights of its view space cluster
+ *  and shading it with all the light sources.  It must be
+ *  called before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetClusteredLighting(bool bEnabled)
+{
+	m_pLightClusters->SetEnabled(bEnabled);
+}
+
+/***********************************************************
+ *  SetRenderMode()
+ *
+ *  This method is used for selecting whether the opaque
+ *  packets are batched by their state, drawn front to back,
+ *  or drawn after a depth pre-pass.
+ ***********************************************************/
+void SceneManager::SetRenderMode(RENDER_MODE renderMode)
+{
+	m_renderMode = renderMode;
+}
+
+/***********************************************************
+ *  SetMultiView()
+ *
+ *  This method is used for drawing the packets of every frame
+ *  into all the views that the view manager uploads, with one
+ *  culled set of packets and one copy of the draw data.  The
+ *  compute passes work on the frustum of one camera, so the
+ *  GPU culling and the light clusters are switched off when
+ *  the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetMultiView(bool bEnabled)
+{
+	m_bMultiView = bEnabled;
+}
+
+/***********************************************************
+ *  SetViewport()
+ *
+ *  This method is used for setting the viewport that the
+ *  scene is drawn into, when the window has been resized or
+ *  the scene is rendered at a lower resolution.  The light
+ *  clusters are laid out over it again on the next frame.
+ ***********************************************************/
+void SceneManager::SetViewport(int x, int y, int width, int height)
+{
+	m_viewport[0] = x;
+	m_viewport[1] = y;
+	m_viewport[2] = width;
+	m_viewport[3] = height;
+}
+
+/***********************************************************
+ *  SetTextureStreaming()
+ *
+ *  This method is used for switching the streaming of the
+ *  texture levels on and off, and for setting the video
+ *  memory that the resident levels may take.  The first load
+ *  of a texture already depends on it, so it must be called
+ *  before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetTextureStreaming(bool bEnabled, size_t budgetBytes)
+{
+	m_pTextureStreamer->SetEnabled(bEnabled);
+	m_pTextureStreamer->SetBudget(budgetBytes);
+}
+
+/***********************************************************
+ *  SetHotReload()
+ *
+ *  This method is used for switching the reloading of the
+ *  edited asset files on and off.  The files are watched on
+ *  a background thread once the scene is prepared, so it
+ *  must be called before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetHotReload(bool bEnabled)
+{
+	if ((bEnabled == true) && (NULL == m_pFileWatcher))
+	{
+		m_pFileWatcher = new FileWatcher();
+	}
+	else if ((bEnabled == false) && (NULL != m_pFileWatcher))
+	{
+		delete m_pFileWatcher;
+		m_pFileWatcher = NULL;
+	}
+	m_reloadAssets.clear();
+}
+
+/***********************************************************
+ *  WatchAssetFile()
+ *
+ *  This method is used for adding a file to the watcher,
+ *  together with the asset that it is rebuilt into.
+ ***********************************************************/
+void SceneManager::WatchAssetFile(const char* filename, RELOAD_TYPE type, int handle)
+{
+	if (NULL == m_pFileWatcher)
+	{
+		return;
+	}
+
+	int fileIndex = m_pFileWatcher->WatchFile(filename);
+	if (fileIndex < 0)
+	{
+		return;
+	}
+
+	// a file that is already watched keeps its first asset
+	if (fileIndex >= (int)m_reloadAssets.size())
+	{
+		RELOAD_ASSET asset;
+		asset.type = type;
+		asset.handle = handle;
+		m_reloadAssets.resize(fileIndex + 1, asset);
+	}
+}
+
+/***********************************************************
+ *  ApplyAssetReloads()
+ *
+ *  This method is used for rebuilding the assets of the files
+ *  that have been edited since the last frame, on the GL
+ *  thread.  Only the changed asset is rebuilt - a shader
+ *  program is linked again, a single texture is decoded in
+ *  the background and copied over its layer, or the edited
+ *  entries of the material table are uploaded - and all the
+ *  other assets stay resident.
+ ***********************************************************/
+void SceneManager::ApplyAssetReloads()
+{
+	if ((NULL == m_pFileWatcher) || (m_pFileWatcher->CollectChanges(m_changedFiles) == 0))
+	{
+		return;
+	}
+
+	// the vertex and the fragment shader are linked together, so
+	// the program is only rebuilt once when both were saved
+	bool bSceneShaderChanged = false;
+
+	for (int i = 0; i < (int)m_changedFiles.size(); i++)
+	{
+		int fileIndex = m_changedFiles[i];
+		if ((fileIndex < 0) || (fileIndex >= (int)m_reloadAssets.size()))
+		{
+			continue;
+		}
+
+		const RELOAD_ASSET& asset = m_reloadAssets[fileIndex];
+		const char* filename = m_pFileWatcher->GetFilename(fileIndex);
+		std::cout << "Reloading the edited file:" << filename << std::endl;
+
+		switch (asset.type)
+		{
+		case RELOAD_SCENE_SHADER:
+			bSceneShaderChanged = true;
+			break;
+		case RELOAD_CLUSTER_SHADER:
+			// a shader that does not build keeps the previous program
+			if (m_pLightClusters->LoadShader(filename, m_pProgramCache) == true)
+			{
+				m_pShaderManager->use();
+			}
+			break;
+		case RELOAD_CULL_SHADER:
+			if (m_pGpuCuller->LoadShader(filename, m_pProgramCache) == true)
+			{
+				m_pShaderManager->use();
+			}
+			break;
+		case RELOAD_TEXTURE:
+			// the image is decoded again on a worker thread, and the
+			// texture keeps showing the old image until it is stored
+			m_pTextureStreamer->ReloadTexture(asset.handle, filename);
+			break;
+		case RELOAD_SCENE_MATERIALS:
+			ReloadSceneMaterials();
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (bSceneShaderChanged == true)
+	{
+		ReloadSceneShader();
+	}
+}
+
+/***********************************************************
+ *  ReloadSceneShader()
+ *
+ *  This method is used for compiling and linking the scene
+ *  shader program again after one of its files was edited.
+ *  The program cache hashes the shader sources, so it always
+ *  builds the edited program.  The previous program is kept
+ *  when the edited one does not build, and otherwise the
+ *  uniform locations, the shader blocks and the uniforms that
+ *  are only set once are set up for the new program.
+ ***********************************************************/
+void SceneManager::ReloadSceneShader()
+{
+	if (NULL == m_pProgramCache)
+	{
+		std::cout << "The scene shader can only be reloaded through the program cache" << std::endl;
+		return;
+	}
+
+	GLuint programID = m_pProgramCache->LoadProgram(
+		"Shaders/vertexShader.glsl",
+		"Shaders/fragmentShader.glsl",
+		"sceneShader");
+	if (0 == programID)
+	{
+		std::cout << "The edited scene shader did not build, the previous program is kept" << std::endl;
+		return;
+	}
+
+	if (0 != m_pShaderManager->m_programID)
+	{
+		glDeleteProgram(m_pShaderManager->m_programID);
+	}
+	m_pShaderManager->m_programID = programID;
+	m_pShaderManager->use();
+
+	m_pShaderUniforms->ResolveLocations(programID);
+	m_pTextureArrays->BindTextureArrays();
+	m_pShaderUniforms->setBoolValue(ShaderUniforms::UNIFORM_USE_LIGHTING, true);
+}
+
+/***********************************************************
+ *  ReloadSceneMaterials()
+ *
+ *  This method is used for reading the edited scene file and
+ *  patching the entries of the material table whose values
+ *  have changed.  The nodes, textures and lights of the file
+ *  are left as they are, and a material with a new tag needs
+ *  the scene to be prepared again.
+ ***********************************************************/
+void SceneManager::ReloadSceneMaterials()
+{
+	SceneFile sceneFile;
+	if (sceneFile.Load(m_sceneFilename.c_str()) == false)
+	{
+		std::cout << "The edited scene file could not be read, the materials are kept" << std::endl;
+		return;
+	}
+
+	for (int i = 0; i < sceneFile.GetMaterialCount(); i++)
+	{
+		OBJECT_MATERIAL material = ReadMaterialRecord(sceneFile, sceneFile.GetMaterial(i));
+		int materialHandle = m_materialRegistry.Find(material.tag);
+		if (materialHandle == HandleRegistry::INVALID_HANDLE)
+		{
+			std::cout << "The new material " << material.tag << " is added when the scene is loaded again" << std::endl;
+			continue;
+		}
+
+		// the table entry of a tag is its first defined material
+		for (int j = 0; j < (int)m_objectMaterials.size(); j++)
+		{
+			OBJECT_MATERIAL& objectMaterial = m_objectMaterials[j];
+			if (objectMaterial.tag != material.tag)
+			{
+				continue;
+			}
+
+			if ((objectMaterial.ambientColor != material.ambientColor) ||
+				(objectMaterial.ambientStrength != material.ambientStrength) ||
+				(objectMaterial.diffuseColor != material.diffuseColor) ||
+				(objectMaterial.specularColor != material.specularColor) ||
+				(objectMaterial.shininess != material.shininess))
+			{
+				objectMaterial = material;
+				m_pShaderUniforms->UploadMaterialEntry(materialHandle, BuildMaterialEntry(objectMaterial));
+			}
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetParallelRecording()
+ *
+ *  This method is used for switching between recording the
+ *  command lists of the scene parts on the job system threads
+ *  and recording them on the render thread.  It must be
+ *  called before the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetParallelRecording(bool bEnabled)
+{
+	m_bUseParallelRecording = bEnabled;
+}
+
+/***********************************************************
+ *  SetInstancedRendering()
+ *
+ *  This method is used for switching between drawing the
+ *  repeated meshes with instanced draw calls and drawing
+ *  every object with its own draw call.
+ ***********************************************************/
+void SceneManager::SetInstancedRendering(bool bEnabled)
+{
+	m_bUseInstancing = bEnabled;
+}
+
+/***********************************************************
+ *  SetFrustumCulling()
+ *
+ *  This method is used for switching between skipping the
+ *  objects outside of the view frustum and drawing every
+ *  object.
+ ***********************************************************/
+void SceneManager::SetFrustumCulling(bool bEnabled)
+{
+	m_bUseCulling = bEnabled;
+}
+
+/***********************************************************
+ *  SetLevelOfDetail()
+ *
+ *  This method is used for switching between drawing the
+ *  small and distant round objects with fewer vertices and
+ *  always drawing them at full detail.
+ ***********************************************************/
+void SceneManager::SetLevelOfDetail(bool bEnabled)
+{
+	m_bUseLevelOfDetail = bEnabled;
+}
+
+/***********************************************************
+ *  SetSceneCopies()
+ *
+ *  This method is used for rendering the whole scene the
+ *  passed in number of times, to measure how the renderer
+ *  scales with the number of objects.
+ ***********************************************************/
+void SceneManager::SetSceneCopies(int copyCount)
+{
+	m_sceneCopyCount = (copyCount > 1) ? copyCount : 1;
+}
+
+/***********************************************************
+ *  IsSceneLoaded()
+ *
+ *  This method is used for checking that all the textures
+ *  requested from the background loader have been stored.
+ ***********************************************************/
+bool SceneManager::IsSceneLoaded() const
+{
+	return(m_pTextureLoader->GetPendingCount() == 0);
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method is used for getting the number of objects that
+ *  were submitted to the render queue in the last frame.
+ ***********************************************************/
+int SceneManager::GetObjectCount() const
+{
+	return(m_pRenderQueue->GetStats().packetCount);
+}
+
+/***********************************************************
+ *  SetProfiler()
+ *
+ *  This method is used for measuring the parts of the scene
+ *  rendering with the passed in profiler.  NULL stops the
+ *  measurements.
+ ***********************************************************/
+void SceneManager::SetProfiler(FrameProfiler* pProfiler)
+{
+	m_pProfiler = pProfiler;
+}
+
+/***********************************************************
+ *  SetProgramCache()
+ *
+ *  This method is used for loading the shader programs of
+ *  the scene through the passed in cache.  The cache stays
+ *  owned by the caller, and NULL compiles the shaders.
+ ***********************************************************/
+void SceneManager::SetProgramCache(ProgramBinaryCache* pProgramCache)
+{
+	m_pProgramCache = pProgramCache;
+}
+
+/***********************************************************
+ *  SetMeshCache()
+ *
+ *  This method is used for drawing the scene with the meshes
+ *  of the passed in cache, which are shared with the other
+ *  scenes that use it.  The cache stays owned by the caller
+ *  and has to outlive the scene.  Without one, the scene
+ *  makes its own cache.
+ ***********************************************************/
+void SceneManager::SetMeshCache(MeshCache* pMeshCache)
+{
+	if (NULL == m_pMeshCache)
+	{
+		m_pMeshCache = pMeshCache;
+	}
+}
+
+/***********************************************************
+ *  LoadSceneFile()
+ *
+ *  This method is used for describing the scene with the
+ *  textures, materials, lights and nodes of a scene file in
+ *  place of the built-in scene.  A binary file stays mapped
+ *  while the scene is prepared.  The built-in scene is kept
+ *  when the file can not be loaded.
+ ***********************************************************/
+bool SceneManager::LoadSceneFile(const char* filename)
+{
+	SceneFile* pSceneFile = new SceneFile();
+
+	if (pSceneFile->Load(filename) == false)
+	{
+		delete pSceneFile;
+		return(false);
+	}
+
+	if (NULL != m_pSceneFile)
+	{
+		delete m_pSceneFile;
+	}
+	m_pSceneFile = pSceneFile;
+	m_sceneFilename = filename;
+	std::cout << "Loaded " << m_pSceneFile->GetNodeCount() << " scene nodes from " << filename << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  SaveSceneFile()
+ *
+ *  This method is used for writing the prepared scene into a
+ *  scene file, so the built-in scene can be used as the
+ *  start of a new scene file.  The copies of the scene are
+ *  left out.
+ ***********************************************************/
+bool SceneManager::SaveSceneFile(const char* filename) const
+{
+	SceneFile sceneFile;
+
+	if (NULL != m_pSceneFile)
+	{
+		for (int i = 0; i < m_pSceneFile->GetTextureCount(); i++)
+		{
+			const SceneFile::TEXTURE_RECORD& texture = m_pSceneFile->GetTexture(i);
+			sceneFile.AddTexture(m_pSceneFile->GetString(texture.tagOffset), m_pSceneFile->GetString(texture.filenameOffset));
+		}
+	}
+	else
+	{
+		for (int i = 0; i < g_SceneTextureCount; i++)
+		{
+			sceneFile.AddTexture(g_SceneTextures[i].tag, g_SceneTextures[i].filename);
+		}
+	}
+
+	for (int i = 0; i < (int)m_objectMaterials.size(); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		sceneFile.AddMaterial(
+			material.tag,
+			material.ambientColor,
+			material.ambientStrength,
+			material.diffuseColor,
+			material.specularColor,
+			material.shininess);
+	}
+
+	for (int i = 0; i < m_pShaderUniforms->GetLightCount(); i++)
+	{
+		const ShaderUniforms::LIGHT_SOURCE& light = m_pShaderUniforms->GetLightSource(i);
+		sceneFile.AddLight(
+			light.position,
+			light.ambientColor,
+			light.diffuseColor,
+			light.specularColor,
+			light.focalStrength,
+			light.specularIntensity,
+			light.radius);
+	}
+
+	const std::vector<SceneGraph::SCENE_NODE>& nodes = m_pSceneGraph->GetNodes();
+	for (int i = 0; i < m_sceneNodeCount; i++)
+	{
+		const SceneGraph::SCENE_NODE& node = nodes[i];
+		sceneFile.AddNode(
+			node.tag,
+			node.parentIndex,
+			node.mesh,
+			node.scaleXYZ,
+			glm::vec3(node.XrotationDegrees, node.YrotationDegrees, node.ZrotationDegrees),
+			node.positionXYZ,
+			(node.bUseTexture == true) ? node.textureTag : std::string(),
+			node.materialTag,
+			node.color);
+	}
+
+	std::string name = filename;
+	std::string binaryExtension = ".sceneb";
+	if ((name.size() >= binaryExtension.size()) &&
+		(name.compare(name.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension) == 0))
+	{
+		return(sceneFile.SaveBinary(filename));
+	}
+
+	return(sceneFile.SaveText(filename));
+}
+
+/***********************************************************
+ *  GetDrawCallCount()
+ *
+ *  This method is used for getting the number of draw calls
+ *  issued by the last rendered frame.
+ ***********************************************************/
+int SceneManager::GetDrawCallCount() const
+{
+	return(m_pRenderQueue->GetStats().drawCount);
+}
+
+/***********************************************************
+ *  GetFrameArenaBytes()
+ *
+ *  This method is used for getting the number of bytes that
+ *  the last rendered frame allocated from the frame arena.
+ ***********************************************************/
+int SceneManager::GetFrameArenaBytes() const
+{
+	return((int)m_pFrameArena->GetUsedBytes());
+}
+
+/***********************************************************
+ *  RecordRenderQueueStats()
+ *
+ *  This method is used for handing the packet, draw and state
+ *  change counters of the render queue to the profiler, which
+ *  shows their averages in the window title and writes them
+ *  into its CSV file.  Nothing is printed while the scene is
+ *  rendered, because culling and the levels of detail change
+ *  the counts on almost every frame.
+ ***********************************************************/
+void SceneManager::RecordRenderQueueStats()
+{
+	if (NULL == m_pProfiler)
+	{
+		return;
+	}
+
+	const RenderQueue::QUEUE_STATS& stats = m_pRenderQueue->GetStats();
+	int culledObjects = m_bUseCulling ? m_pCuller->GetObjectCount() - m_pCuller->GetVisibleCount() : 0;
+
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_RENDER_PACKETS, stats.packetCount);
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_INSTANCED_DRAWS, stats.instancedDraws);
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_INDIRECT_DRAWS, stats.indirectDraws);
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_STATE_CHANGES, stats.GetIssuedStateChanges());
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_SAVED_STATE_CHANGES, stats.GetSavedStateChanges());
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_CULLED_OBJECTS, culledObjects);
+}
+
+/***********************************************************
+ *  RecordResidencyStats()
+ *
+ *  This method is used for handing the residency of the
+ *  cached meshes and the streamed textures to the profiler,
+ *  instead of printing it while they are loaded.
+ ***********************************************************/
+void SceneManager::RecordResidencyStats()
+{
+	if (NULL == m_pProfiler)
+	{
+		return;
+	}
+
+	MeshCache::RESIDENCY_STATS meshStats = m_pMeshCache->GetStats();
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_RESIDENT_MESHES, meshStats.residentMeshes);
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_MESH_DRAW_LOADS, meshStats.drawLoads);
+
+	TextureStreamer::STREAMING_STATS textureStats = m_pTextureStreamer->GetStats();
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_TEXTURE_RESIDENT_KILOBYTES, (int)(textureStats.residentBytes / 1024));
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_TEXTURE_PENDING_LOADS, textureStats.pendingLoads);
+	m_pProfiler->SetCounter(FrameProfiler::COUNTER_TEXTURE_EVICTED_LEVELS, textureStats.evictedLevels);
+}
+
+/***********************************************************
+ *  ReportFrameArenaPeak()
+ *
+ *  This method is used for printing the peak of the frame
+ *  arena whenever a frame needed more than any frame before,
+ *  and how often the blocks had to grow.  Once the scene has
+ *  reached its largest frame the arena does not allocate, and
+ *  nothing more is printed.
+ ***********************************************************/
+void SceneManager::ReportFrameArenaPeak()
+{
+	if (m_pFrameArena->GetPeakBytes() == m_reportedArenaBytes)
+	{
+		return;
+	}
+
+	std::cout << "INFO: Frame arena peak:" << m_pFrameArena->GetPeakBytes()
+		<< " bytes, grown:" << m_pFrameArena->GetGrowCount() << " times" << std::endl;
+
+	m_reportedArenaBytes = m_pFrameArena->GetPeakBytes();
+}
+
+/***********************************************************
+ *  ResolveSceneNodeHandles()
+ *
+ *  This method is used for looking up the texture and material
+ *  handles for the tags of all the scene nodes once, so that
+ *  no strings are used while the scene is rendered.  Only the
+ *  first MAX_MATERIALS materials fit into the shader material
+ *  table, and the nodes that use a later one are drawn with
+ *  the first material instead.
+ ***********************************************************/
+void SceneManager::ResolveSceneNodeHandles()
+{
+	const std::vector<SceneGraph::SCENE_NODE>& nodes = m_pSceneGraph->GetNodes();
+
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		int textureHandle = HandleRegistry::INVALID_HANDLE;
+		int materialHandle = HandleRegistry::INVALID_HANDLE;
+
+		if (nodes[i].textureTag.length() > 0)
+		{
+			textureHandle = FindTextureSlot(nodes[i].textureTag);
+			if (textureHandle < 0)
+			{
+				std::cout << "Scene node " << nodes[i].tag << " uses the unknown texture " << nodes[i].textureTag << std::endl;
+			}
+		}
+		if (nodes[i].materialTag.length() > 0)
+		{
+			materialHandle = FindMaterialIndex(nodes[i].materialTag);
+			if (materialHandle < 0)
+			{
+				std::cout << "Scene node " << nodes[i].tag << " uses the unknown material " << nodes[i].materialTag << std::endl;
+			}
+			else if (materialHandle >= ShaderUniforms::MAX_MATERIALS)
+			{
+				std::cout << "Scene node " << nodes[i].tag << " uses the material " << nodes[i].materialTag
+					<< ", which does not fit into the material table of " << ShaderUniforms::MAX_MATERIALS
+					<< " materials, the first material is used instead" << std::endl;
+				materialHandle = 0;
+			}
+		}
+
+		m_pSceneGraph->SetNodeHandles(i, textureHandle, materialHandle);
+	}
+}
+
+/***********************************************************
+ *  DrawSceneMesh()
+ *
+ *  This method is used for drawing the basic shape mesh
+ *  that is used by a scene node.  The cache loads the mesh
+ *  the first time it is drawn.
+ ***********************************************************/
+void SceneManager::DrawSceneMesh(SceneGraph::MESH_TYPE mesh)
+{
+	m_pMeshCache->DrawBasicMesh(mesh);
+}
+
+/***********************************************************
+ *  AcquireSceneMeshes()
+ *
+ *  This method is used for holding the meshes of the scene
+ *  nodes in the mesh cache.  The basic meshes are loaded
+ *  when they are first drawn, and the levels of detail of
+ *  the repeated meshes are built in the background.  Until
+ *  they are stored, those nodes are drawn with the basic
+ *  meshes.
+ ***********************************************************/
+void SceneManager::AcquireSceneMeshes()
+{
+	const std::vector<SceneGraph::SCENE_NODE>& nodes = m_pSceneGraph->GetNodes();
+	bool bUsed[MeshCache::PRIMITIVE_COUNT] = { false };
+
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		if ((nodes[i].mesh >= 0) && (nodes[i].mesh < MeshCache::PRIMITIVE_COUNT))
+		{
+			bUsed[nodes[i].mesh] = true;
+		}
+	}
+
+	for (int mesh = 0; mesh < MeshCache::PRIMITIVE_COUNT; mesh++)
+	{
+		if (bUsed[mesh] == false)
+		{
+			continue;
+		}
+
+		m_acquiredMeshes.push_back((SceneGraph::MESH_TYPE)mesh);
+		m_pMeshCache->AcquireMesh((SceneGraph::MESH_TYPE)mesh, MeshCache::TESSELLATION_BASIC);
+		m_pMeshCache->AcquireMesh((SceneGraph::MESH_TYPE)mesh, MeshCache::TESSELLATION_LOD_CHAIN);
+		if ((m_bUseInstancing == true) || (m_bUseIndirectDraws == true))
+		{
+			m_pMeshCache->PrefetchMesh((SceneGraph::MESH_TYPE)mesh, MeshCache::TESSELLATION_LOD_CHAIN);
+		}
+	}
+}
+
+/***********************************************************
+ *  DefineSceneNodes()
+ *
+ *  This method is used for adding all of the objects of the
+ *  3D scene to the scene graph.  Each part of the scene gets
+ *  a group node, so that the part can be moved as a whole.
+ ***********************************************************/
+void SceneManager::DefineSceneNodes()
+{
+	m_pSceneGraph->Clear();
+	m_scenePartNodes.clear();
+
+	if (NULL != m_pSceneFile)
+	{
+		DefineFileSceneNodes();
+	}
+	else
+	{
+		DefineDesktop();
+		DefineLegoMan();
+		DefineSodaCan();
+		DefineHeadPhones();
+		DefineLampBase();
+
+		int sceneParts[] = { m_desktopNode, m_legoManNode, m_sodaCanNode, m_headPhonesNode, m_lampBaseNode };
+		m_scenePartNodes.assign(sceneParts, sceneParts + sizeof(sceneParts) / sizeof(sceneParts[0]));
+	}
+
+	m_sceneNodeCount = m_pSceneGraph->GetNodeCount();
+	DefineSceneCopies();
+}
+
+/***********************************************************
+ *  DefineFileSceneNodes()
+ *
+ *  This method is used for adding the node records of the
+ *  loaded scene file to the scene graph.  The records are
+ *  read in place, and every root node becomes a part of the
+ *  scene.  A record that the scene graph rejects is skipped
+ *  along with its children.
+ ***********************************************************/
+void SceneManager::DefineFileSceneNodes()
+{
+	// scene graph index of every record, -1 for a skipped record
+	std::vector<int> nodeIndices(m_pSceneFile->GetNodeCount(), -1);
+
+	for (int i = 0; i < m_pSceneFile->GetNodeCount(); i++)
+	{
+		const SceneFile::NODE_RECORD& record = m_pSceneFile->GetNode(i);
+		const char* tag = m_pSceneFile->GetString(record.tagOffset);
+		int parentIndex = -1;
+
+		if ((record.parentIndex >= i) ||
+			((record.mesh < SceneGraph::MESH_NONE) || (record.mesh > SceneGraph::MESH_HALF_TORUS)))
+		{
+			std::cout << "Scene file node " << tag << " has an invalid parent or mesh" << std::endl;
+			continue;
+		}
+		if (record.parentIndex >= 0)
+		{
+			parentIndex = nodeIndices[record.parentIndex];
+			if (parentIndex < 0)
+			{
+				continue;
+			}
+		}
+
+		int nodeIndex = m_pSceneGraph->AddNode(
+			tag,
+			parentIndex,
+			(SceneGraph::MESH_TYPE)record.mesh,
+			glm::vec3(record.scaleXYZ[0], record.scaleXYZ[1], record.scaleXYZ[2]),
+			record.rotationDegrees[0],
+			record.rotationDegrees[1],
+			record.rotationDegrees[2],
+			glm::vec3(record.positionXYZ[0], record.positionXYZ[1], record.positionXYZ[2]));
+		if (nodeIndex < 0)
+		{
+			continue;
+		}
+		nodeIndices[i] = nodeIndex;
+
+		m_pSceneGraph->SetNodeColor(nodeIndex, record.color[0], record.color[1], record.color[2], record.color[3]);
+		if (record.textureTagOffset != SceneFile::NO_STRING)
+		{
+			m_pSceneGraph->SetNodeTexture(nodeIndex, m_pSceneFile->GetString(record.textureTagOffset));
+		}
+		if (record.materialTagOffset != SceneFile::NO_STRING)
+		{
+			m_pSceneGraph->SetNodeMaterial(nodeIndex, m_pSceneFile->GetString(record.materialTagOffset));
+		}
+		if (parentIndex < 0)
+		{
+			m_scenePartNodes.push_back(nodeIndex);
+		}
+	}
+}
+
+/***********************************************************
+ *  DefineSceneCopies()
+ *
+ *  This method is used for adding the copies of the whole
+ *  scene set with SetSceneCopies().  The copies are placed on
+ *  a square grid that runs away from the camera, with the
+ *  original scene in the middle of the front row.
+ ***********************************************************/
+void SceneManager::DefineSceneCopies()
+{
+	m_sceneCopyNodes.clear();
+	if (m_sceneCopyCount <= 1)
+	{
+		return;
+	}
+
+	int gridSize = (int)ceil(sqrt((double)m_sceneCopyCount));
+	int originalCell = gridSize / 2;
+	int cell = 0;
+
+	m_sceneCopyNodes.reserve(m_sceneCopyCount - 1);
+	while ((int)m_sceneCopyNodes.size() < m_sceneCopyCount - 1)
+	{
+		if (cell == originalCell)
+		{
+			cell++;
+			continue;
+		}
+
+		glm::vec3 positionXYZ(
+			(float)(cell % gridSize - originalCell) * g_SceneCopySpacing,
+			0.0f,
+			-(float)(cell / gridSize) * g_SceneCopySpacing);
+		int copyNode = m_pSceneGraph->AddGroupNode("sceneCopy", -1);
+		m_pSceneGraph->SetNodeTransform(copyNode, glm::vec3(1.0f, 1.0f, 1.0f), 0.0f, 0.0f, 0.0f, positionXYZ);
+
+		for (int i = 0; i < (int)m_scenePartNodes.size(); i++)
+		{
+			m_pSceneGraph->CopySubtree(m_scenePartNodes[i], copyNode);
+		}
+		m_sceneCopyNodes.push_back(copyNode);
+		cell++;
+	}
+}
+
+void SceneManager::DefineDesktop()
+{
+	// declare the variables for the transformations
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+	int nodeIndex = -1;
+
+	m_desktopNode = m_pSceneGraph->AddGroupNode("desktop", -1);
+
+	/*** Set needed transformations before adding the scene node.   ***/
+	/*** This same ordering of code should be used for transforming ***/
+	/*** and adding all the basic 3D shapes.						***/
+	/******************************************************************/
+
+	// set the XYZ scale for the mesh
+	scaleXYZ = glm::vec3(20.0f, 1.0f, 30.0f); // original scale (20, 1, 10) X,Z scaled up by 0.5
+
+	// set the XYZ rotation for the mesh
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = -25.0f;
+	ZrotationDegrees = 0.0f;
+
+	// set the XYZ position for the mesh
+	positionXYZ = glm::vec3(10.0f, -1.0f, 0.0f);  // original position (0, 0, 0) Y lowered to reduce floor clipping
+
+	// add the mesh with transformation values to the scene
+	nodeIndex = m_pSceneGraph->AddNode(
+		"desktopPlane",
+		m_desktopNode,
+		SceneGraph::MESH_PLANE,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "marble");
+	// the desk was lit with the plastic material that was left
+	// in the shader by the last drawn lamp part
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+	/****************************************************************/
+
+}
+
+void SceneManager::DefineLegoMan()
+{
+	// declare the variables for the transformations
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+	int nodeIndex = -1;
+
+	m_legoManNode = m_pSceneGraph->AddGroupNode("legoMan", -1);
+
+	/*----------Lego Man L Leg-----------*/
+	scaleXYZ = glm::vec3(1.75f, 2.7f, 1.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-0.2f, 0.4f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManLeftLeg",
+		m_legoManNode,
+		SceneGraph::MESH_BOX,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "leg");
+
+
+	/*----------Lego Man R Leg-----------*/
+
+	scaleXYZ = glm::vec3(1.75f, 2.7f, 1.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-2.2f, 0.4f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManRightLeg",
+		m_legoManNode,
+		SceneGraph::MESH_BOX,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "leg");
+
+
+	/*----------Lego Man Hip-----------*/
+	scaleXYZ = glm::vec3(4.2f, 1.0f, 1.7f);
+	XrotationDegrees = 180.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-1.25f, 2.05f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManHip",
+		m_legoManNode,
+		SceneGraph::MESH_BOX,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "leg");
+
+
+	/*----------Lego Man Body-----------*/
+	scaleXYZ = glm::vec3(2.25f, 4.0f, 1.25f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 180.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-1.25f, 2.5f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManBody",
+		m_legoManNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "body");
+
+	/*----------Lego Man Neck-----------*/
+	scaleXYZ = glm::vec3(2.25f, 0.1f, 1.25f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-1.25f, 6.5f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManNeck",
+		m_legoManNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.2, 0.2, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+	/*----------Lego Man Shoulders-----------*/
+	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-1.25f, 6.5f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManShoulders",
+		m_legoManNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.2, 0.2, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+
+	/*----------Lego Man Head-----------*/
+	scaleXYZ = glm::vec3(1.5f, 1.75f, 1.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-1.25f, 8.5f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManHead",
+		m_legoManNode,
+		SceneGraph::MESH_SPHERE,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "face");
+
+
+	/*----------Lego Man L Arm-----------*/
+	scaleXYZ = glm::vec3(0.5f, 3.5f, 0.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 180.0f;
+	ZrotationDegrees = -10.0f;
+
+	positionXYZ = glm::vec3(1.5f, 3.0f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManLeftArm",
+		m_legoManNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "arm");
+
+
+	/*----------Lego Man R Arm-----------*/
+	scaleXYZ = glm::vec3(0.5f, 3.5f, 0.5f);
+	XrotationDegrees = -30.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = -10.0f;
+
+	positionXYZ = glm::vec3(-4.0f, 3.0f, 1.7f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManRightArm",
+		m_legoManNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "cloth");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "arm");
+
+
+	/*----------Lego Man L Hand-----------*/
+	scaleXYZ = glm::vec3(0.7f, 0.7f, 0.7f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(1.6f, 2.5f, 0.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManLeftHand",
+		m_legoManNode,
+		SceneGraph::MESH_SPHERE,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.2, 0.2, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+
+	/*----------Lego Man R Hand-----------*/
+	scaleXYZ = glm::vec3(0.7f, 0.7f, 0.7f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-4.1f, 2.5f, 2.1f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"legoManRightHand",
+		m_legoManNode,
+		SceneGraph::MESH_SPHERE,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.2, 0.2, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+}
+
+void SceneManager::DefineSodaCan()
+{
+	// initialize values
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+	int nodeIndex = -1;
+
+	m_sodaCanNode = m_pSceneGraph->AddGroupNode("sodaCan", -1);
+
+	/*----------Soda body-----------*/
+	scaleXYZ = glm::vec3(3.5f, 9.0f, 3.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(10.0f, -0.9f, 10.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"sodaCanBody",
+		m_sodaCanNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+	m_pSceneGraph->SetNodeTexture(nodeIndex, "can");
+
+	/*----------Soda Rim-----------*/
+	scaleXYZ = glm::vec3(3.5f, 0.1f, 3.5f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(10.0f, 8.1f, 10.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"sodaCanRim",
+		m_sodaCanNode,
+		SceneGraph::MESH_TAPERED_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.7, 0.7, 0.7, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "metal");
+}
+
+void SceneManager::DefineHeadPhones()
+{
+	// initialize values
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+	int nodeIndex = -1;
+
+	m_headPhonesNode = m_pSceneGraph->AddGroupNode("headPhones", -1);
+
+	/*----------Headphone Body-----------*/
+	scaleXYZ = glm::vec3(5.0f, 16.0f, 7.0f);
+	XrotationDegrees = 90.0f;
+	YrotationDegrees = -7.5f;
+	ZrotationDegrees = 255.0f;
+
+	positionXYZ = glm::vec3(10.0f, 2.75f, -3.0f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"headPhonesBody",
+		m_headPhonesNode,
+		SceneGraph::MESH_HALF_TORUS,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 1.0, 1.0, 1.0, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "matteFinish");
+
+	/*----------Headphone L Earpiece-----------*/
+	scaleXYZ = glm::vec3(3.15f, 3.15f, 3.15f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 90.0f;
+	ZrotationDegrees = 90.0f;
+
+	positionXYZ = glm::vec3(9.0f, 2.25f, -0.25f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"headPhonesLeftEarpiece",
+		m_headPhonesNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 1.0, 1.0, 1.0, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "matteFinish");
+
+	/*----------Headphone R Earpiece-----------*/
+	scaleXYZ = glm::vec3(3.15f, 3.15f, 3.15f);
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 115.0f;
+	ZrotationDegrees = 90.0f;
+
+	positionXYZ = glm::vec3(6.0f, 2.25f, -7.75f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"headPhonesRightEarpiece",
+		m_headPhonesNode,
+		SceneGraph::MESH_CYLINDER,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 1.0, 1.0, 1.0, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "matteFinish");
+
+}
+
+void SceneManager::DefineLampBase() 
+{
+	// initialize values
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+	int nodeIndex = -1;
+
+	m_lampBaseNode = m_pSceneGraph->AddGroupNode("lampBase", -1);
+
+	/*----------Lamp Base-----------*/	
+	// base of the base
+	scaleXYZ = glm::vec3(15.0f, 1.5f, 10.5f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(7.75f, 0.0f, -17.75f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"lampBaseBottom",
+		m_lampBaseNode,
+		SceneGraph::MESH_BOX,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.1, 0.1, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+	// upper box
+	scaleXYZ = glm::vec3(4.5f, 4.5f, 8.25f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(2.5f, 1.5f, -18.9f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"lampBaseUpperBox",
+		m_lampBaseNode,
+		SceneGraph::MESH_BOX,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.1, 0.1, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+	// triangular part
+	scaleXYZ = glm::vec3(4.5f, 4.5f, 4.5f);
+
+	XrotationDegrees = -90.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 90.0f;
+	positionXYZ = glm::vec3(2.5f, 1.5f, -14.77f);
+
+	nodeIndex = m_pSceneGraph->AddNode(
+		"lampBasePrism",
+		m_lampBaseNode,
+		SceneGraph::MESH_PRISM,
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_pSceneGraph->SetNodeColor(nodeIndex, 0.1, 0.1, 0.2, 1);
+	m_pSceneGraph->SetNodeMaterial(nodeIndex, "plastic");
+
+}
+
@@ -10,7 +10,25 @@
 #pragma once
 
 #include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "ShaderUniforms.h"
+#include "MeshCache.h"
+#include "SceneGraph.h"
+#include "HandleRegistry.h"
+#include "RenderQueue.h"
+#include "InstancedMeshes.h"
+#include "TextureLoader.h"
+#include "TextureArrays.h"
+#include "TextureStreamer.h"
+#include "FrameProfiler.h"
+#include "FrameArena.h"
+#include "FileWatcher.h"
+#include "StreamBuffer.h"
+#include "GpuCuller.h"
+#include "ProgramBinaryCache.h"
+#include "SceneFile.h"
+#include "JobSystem.h"
+#include "LightClusters.h"
+#include "VisibilityCuller.h"
 
 #include <string>
 #include <vector>
@@ -25,16 +43,12 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(
+		ShaderManager *pShaderManager,
+		ShaderUniforms *pShaderUniforms);
 	// destructor
 	~SceneManager();
 
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
 	struct OBJECT_MATERIAL
 	{
 		float ambientStrength;
@@ -45,29 +59,199 @@ public:
 		std::string tag;
 	};
 
+	// order and passes that the sorted packets are drawn in - the
+	// transparent packets are always blended last, back to front
+	enum RENDER_MODE
+	{
+		// batch the state of the opaque packets
+		RENDER_MODE_STATE_SORTED = 0,
+		// draw the opaque packets front to back in depth layers
+		RENDER_MODE_FRONT_TO_BACK,
+		// write the depth of the opaque packets first, then shade
+		// only the visible fragments
+		RENDER_MODE_DEPTH_PREPASS
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	// pointer to the resolved shader uniform locations
+	ShaderUniforms* m_pShaderUniforms;
+	// pointer to the cache that holds the shape meshes, and true
+	// when the scene made its own cache because none was set
+	MeshCache* m_pMeshCache;
+	bool m_bOwnsMeshCache;
+	// primitives of the scene nodes that are held in the cache
+	std::vector<SceneGraph::MESH_TYPE> m_acquiredMeshes;
+	// pointer to the scene graph object
+	SceneGraph* m_pSceneGraph;
+	// pointer to the background texture loader object
+	TextureLoader* m_pTextureLoader;
+	// pointer to the render queue object
+	RenderQueue* m_pRenderQueue;
+	// pointer to the instanced meshes of the mesh cache
+	InstancedMeshes* m_pInstancedMeshes;
+	// pointer to the arena that holds the transient data of the frame
+	FrameArena* m_pFrameArena;
+	// peak of the frame arena that was printed last
+	size_t m_reportedArenaBytes;
+	// pointer to the ring buffer that streams the per-draw data
+	StreamBuffer* m_pStreamBuffer;
+	// per-draw data of the frame, written into the stream buffer -
+	// the indirect draws come first, followed by the instanced and
+	// the single draws in the order they are drawn
+	InstancedMeshes::INSTANCE_DATA* m_pFrameData;
+	GLintptr m_frameDataOffset;
+	int m_frameDataCount;
+	int m_frameDataCapacity;
+	// entries of the frame data that have been written - the
+	// later passes over the same packets draw from them again
+	int m_frameDataWritten;
+	// true when the single draws read their data from the stream
+	// buffer instead of the uniforms
+	bool m_bStreamObjectData;
+	// true while the frame data is bound for the vertex shader,
+	// and false while the culled draw data is bound
+	bool m_bFrameDataBound;
+	// true to draw the repeated meshes with instanced draw calls
+	bool m_bUseInstancing;
+	// commands of the indirect draws, written into the stream buffer
+	InstancedMeshes::DRAW_COMMAND* m_pDrawCommands;
+	GLintptr m_drawCommandOffset;
+	int m_drawCommandCount;
+	// true to draw the shared meshes with indirect draw calls
+	bool m_bUseIndirectDraws;
+	// pointer to the compute shader culler object
+	GpuCuller* m_pGpuCuller;
+	// bounding spheres and batches of the indirect draw commands
+	GpuCuller::CULL_OBJECT* m_pCullObjects;
+	GLuint* m_pBatchFirstCommands;
+	int m_batchCount;
+	// true to cull the indirect draws on the GPU instead of the CPU
+	bool m_bUseGpuCulling;
+	// pointer to the compute shader that assigns the light sources
+	// to the view space clusters
+	LightClusters* m_pLightClusters;
+	// viewport that the clusters are laid out over, as x, y,
+	// width and height
+	int m_viewport[4];
+	// order and passes of the opaque packets
+	RENDER_MODE m_renderMode;
+	// true to draw the packets of the frame into the four views
+	// of the view manager instead of the window
+	bool m_bMultiView;
+	// pointer to the view frustum culler object
+	VisibilityCuller* m_pCuller;
+	// visibility of every scene node in the current frame
+	std::vector<unsigned char> m_nodeVisible;
+	// visibility of the scene nodes in one of the views
+	std::vector<unsigned char> m_viewVisible;
+	// true to skip the objects outside of the view frustum
+	bool m_bUseCulling;
+	// world space bounding sphere of every scene node
+	std::vector<VisibilityCuller::BOUNDING_SPHERE> m_nodeBounds;
+	// selected level of detail of every scene node
+	std::vector<unsigned char> m_nodeLodLevels;
+	// true to draw small objects with fewer vertices
+	bool m_bUseLevelOfDetail;
+	// pointer to the frame profiler, NULL when not profiling
+	FrameProfiler* m_pProfiler;
+	// pointer to the program cache, NULL to compile the shaders
+	ProgramBinaryCache* m_pProgramCache;
+	// a part of the scene that is recorded into its own command
+	// list, either by one of the Render methods or, for the
+	// scene copies, from its group node
+	struct RECORD_SECTION
+	{
+		SceneManager* pSceneManager;
+		void (SceneManager::*pRecordFunction)(RenderQueue* pCommandList);
+		int rootNode;
+		FrameProfiler::PROFILE_ZONE zone;
+		RenderQueue* pCommandList;
+	};
+	// pointer to the job system that records the command lists
+	JobSystem* m_pJobSystem;
+	// parts of the scene in the order their lists are merged
+	std::vector<RECORD_SECTION> m_recordSections;
+	// true to record the command lists on the job system threads
+	bool m_bUseParallelRecording;
+	// group nodes for the parts of the 3D scene
+	int m_desktopNode;
+	int m_legoManNode;
+	int m_sodaCanNode;
+	int m_headPhonesNode;
+	int m_lampBaseNode;
+	// root nodes of the parts that are copied along with the scene,
+	// and the number of nodes before the copies
+	std::vector<int> m_scenePartNodes;
+	int m_sceneNodeCount;
+	// pointer to the loaded scene file, NULL for the built-in scene
+	SceneFile* m_pSceneFile;
+	std::string m_sceneFilename;
+	// group nodes of the copies of the whole scene, for benchmarking
+	int m_sceneCopyCount;
+	std::vector<int> m_sceneCopyNodes;
+	// pointer to the texture arrays holding all the scene textures
+	TextureArrays* m_pTextureArrays;
+	// pointer to the streamer of the mipmap levels of the textures
+	TextureStreamer* m_pTextureStreamer;
+	// textures uploaded by the loader in the current frame
+	std::vector<TextureLoader::COMPLETED_LOAD> m_completedLoads;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// handles for the texture and material tags
+	HandleRegistry m_textureRegistry;
+	HandleRegistry m_materialRegistry;
+
+	// the kind of asset that a watched file is rebuilt into
+	enum RELOAD_TYPE
+	{
+		RELOAD_SCENE_SHADER = 0,
+		RELOAD_CLUSTER_SHADER,
+		RELOAD_CULL_SHADER,
+		RELOAD_TEXTURE,
+		RELOAD_SCENE_MATERIALS
+	};
+
+	// the asset of a watched file, the texture handle for textures
+	struct RELOAD_ASSET
+	{
+		RELOAD_TYPE type;
+		int handle;
+	};
+
+	// pointer to the watcher of the asset files, NULL when the
+	// assets are not reloaded
+	FileWatcher* m_pFileWatcher;
+	// asset of every watched file, in the order of the watcher
+	std::vector<RELOAD_ASSET> m_reloadAssets;
+	// files that were changed since the last frame
+	std::vector<int> m_changedFiles;
+
+	// watch a file for changes that are rebuilt into an asset
+	void WatchAssetFile(const char* filename, RELOAD_TYPE type, int handle);
+	// rebuild the assets of the files that have changed
+	void ApplyAssetReloads();
+	// compile and link the scene shader program again
+	void ReloadSceneShader();
+	// patch the material table from the edited scene file
+	void ReloadSceneMaterials();
 
 	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
+	bool CreateGLTexture(const char* filename, const std::string& tag);
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
+	// move the textures loaded in the background into the arrays
+	void StoreLoadedTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
+	// find the index of a defined material by tag
+	int FindMaterialIndex(const std::string& tag);
+	// register the material handles and upload the material table
+	void RegisterObjectMaterials();
 
 	// set the transformation values 
 	// into the transform buffer
@@ -77,6 +261,8 @@ private:
 		float YrotationDegrees,
 		float ZrotationDegrees,
 		glm::vec3 positionXYZ);
+	void SetTransformations(
+		const glm::mat4& modelView);
 
 	// set the color values into the shader
 	void SetShaderColor(
@@ -87,7 +273,9 @@ private:
 
 	// set the texture data into the shader
 	void SetShaderTexture(
-		std::string textureTag);
+		const std::string& textureTag);
+	void SetShaderTexture(
+		int textureHandle);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
@@ -95,22 +283,158 @@ private:
 
 	// set the object material into the shader
 	void SetShaderMaterial(
-		std::string materialTag);
+		const std::string& materialTag);
+	void SetShaderMaterial(
+		int materialHandle);
+
+	// look up the texture and material handles of the scene nodes
+	void ResolveSceneNodeHandles();
+	// rebuild the bounding volumes after the world matrices changed
+	void UpdateSceneBounds();
+	// find the scene nodes inside of the view frustum
+	void CullSceneNodes();
+	// select the level of detail of a scene node from its size on screen
+	int SelectLodLevel(int nodeIndex, const glm::vec3& viewPosition, float projectionScale);
+	// stream the texture levels that the visible scene nodes need
+	void UpdateTextureStreaming();
+	// record draw packets for a scene node and all of its children
+	void SubmitSceneNodes(int nodeIndex, RenderQueue* pCommandList);
+	// set up the parts of the scene that are recorded on their own
+	void DefineRecordSections();
+	// record the command list of a part of the scene
+	void RecordSection(const RECORD_SECTION& section);
+	static void RecordSectionJob(void* pData);
+	// record the command lists of all the parts and merge them
+	void RecordCommandLists();
+	// draw the sorted packets of the render queue
+	void ExecuteRenderQueue();
+	// draw a range of the sorted packets, the offset and index of
+	// the next indirect batch are passed in and updated
+	void DrawPacketRange(int firstPacket, int endPacket, int& commandOffset, int& batchIndex);
+	// hand the render queue counters of the frame to the profiler
+	void RecordRenderQueueStats();
+	// hand the residency of the meshes and textures to the profiler
+	void RecordResidencyStats();
+	// print the peak of the frame arena when it grows
+	void ReportFrameArenaPeak();
+	// get the instanced version of a basic shape mesh
+	InstancedMeshes::INSTANCED_MESH GetInstancedMesh(int mesh) const;
+	// count the packets before endPacket that can be drawn with one
+	// instanced draw
+	int FindInstanceRun(int firstPacket, int endPacket) const;
+	// get room in the stream buffer for the per-draw data of the frame
+	bool PrepareFrameData(int packetCount);
+	// bind the frame data or the culled draw data for the vertex shader
+	void BindDrawData(bool bFrameData);
+	// draw a run of packets with one instanced draw call
+	void DrawInstanceRun(int firstPacket, int runLength);
+	// draw a packet with the data written into the stream buffer
+	void DrawStreamedPacket(const RenderQueue::DRAW_PACKET& packet);
+	// check whether a mesh is drawn with the indirect draw calls
+	bool UsesIndirectDraw(int mesh) const;
+	// upload the draw data and commands of the indirect draws
+	void PrepareIndirectDraws();
+	// count the packets before endPacket that can be drawn with one
+	// indirect draw
+	int FindIndirectBatch(int firstPacket, int endPacket) const;
+	// draw a batch of commands with one indirect draw call
+	void DrawIndirectBatch(int firstCommand, int batchLength, int batchIndex);
+	// draw the basic shape mesh of a scene node
+	void DrawSceneMesh(SceneGraph::MESH_TYPE mesh);
+	// number of views the packets are drawn into, 1 for the window
+	int GetRenderViewCount() const;
+	// start a pass over the packets in one of the views
+	void BeginViewPass(int viewIndex, int firstDataIndex, int& commandOffset, int& batchIndex);
+	// hold the meshes of the scene nodes in the mesh cache
+	void AcquireSceneMeshes();
+	// assign the light sources to the clusters of the current view
+	void AssignLightClusters();
 
 public:
 	// The following methods are for the students to 
 	// customize for their own 3D scene
 	void PrepareScene();
 	void RenderScene();
-	void RenderDesktop();
-	void RenderLegoMan();
-	void RenderSodaCan();
-	void RenderHeadPhones();
-	void RenderLampBase();
+	void RenderDesktop(RenderQueue* pCommandList);
+	void RenderLegoMan(RenderQueue* pCommandList);
+	void RenderSodaCan(RenderQueue* pCommandList);
+	void RenderHeadPhones(RenderQueue* pCommandList);
+	void RenderLampBase(RenderQueue* pCommandList);
+
+	// draw the repeated meshes with instanced draw calls
+	void SetInstancedRendering(bool bEnabled);
+	// draw the shared meshes with multi-draw indirect calls
+	void SetIndirectDrawing(bool bEnabled);
+	// cull the indirect draws with a compute shader
+	void SetGpuCulling(bool bEnabled);
+	// skip the objects outside of the view frustum
+	void SetFrustumCulling(bool bEnabled);
+	// draw the small objects with fewer vertices
+	void SetLevelOfDetail(bool bEnabled);
+	// record the parts of the scene on several threads
+	void SetParallelRecording(bool bEnabled);
+	// shade every fragment with the lights of its view space cluster
+	void SetClusteredLighting(bool bEnabled);
+	// select the order and passes of the opaque packets
+	void SetRenderMode(RENDER_MODE renderMode);
+	// draw the frame into the views uploaded by the view manager,
+	// must be set before PrepareScene()
+	void SetMultiView(bool bEnabled);
+	// rebuild the shaders, textures and materials when their files
+	// are edited, must be set before PrepareScene()
+	void SetHotReload(bool bEnabled);
+	// stream the finer texture levels as they are needed, within a
+	// video memory budget, must be set before PrepareScene()
+	void SetTextureStreaming(bool bEnabled, size_t budgetBytes);
+
+	// render the whole scene this many times, must be set before PrepareScene()
+	void SetSceneCopies(int copyCount);
+	// true when all the textures have finished loading
+	bool IsSceneLoaded() const;
+	// number of objects submitted by the last RenderScene()
+	int GetObjectCount() const;
+
+	// set the viewport of the bound framebuffer that the next
+	// RenderScene() draws into, as x, y, width and height
+	void SetViewport(int x, int y, int width, int height);
+
+	// measure the parts of RenderScene() with the passed in profiler
+	void SetProfiler(FrameProfiler* pProfiler);
+	// load the shader programs through the passed in cache, must be
+	// set before PrepareScene()
+	void SetProgramCache(ProgramBinaryCache* pProgramCache);
+	// share the meshes of the passed in cache with the other scenes,
+	// must be set before PrepareScene()
+	void SetMeshCache(MeshCache* pMeshCache);
+	// describe the scene with the passed in text or binary scene
+	// file instead of the built-in scene, must be called before
+	// PrepareScene()
+	bool LoadSceneFile(const char* filename);
+	// write the prepared scene into a scene file, as binary when
+	// the file name ends with .sceneb and as text otherwise
+	bool SaveSceneFile(const char* filename) const;
+
+	// number of draw calls issued by the last RenderScene()
+	int GetDrawCallCount() const;
+	// bytes of transient data allocated by the last RenderScene()
+	int GetFrameArenaBytes() const;
 
+	// add the objects of the 3D scene to the scene graph
+	void DefineSceneNodes();
+	void DefineDesktop();
+	void DefineLegoMan();
+	void DefineSodaCan();
+	void DefineHeadPhones();
+	void DefineLampBase();
+	void DefineSceneCopies();
+	// add the nodes of the loaded scene file to the scene graph
+	void DefineFileSceneNodes();
 
 	// loads textures from image files
 	void LoadSceneTextures();
+	// convert the texture images into compressed baked files, the
+	// images of the passed in scene file when it is not NULL
+	static bool BakeSceneTextures(const char* sceneFilename = NULL);
 
 	// pre-define object material for lighting effects
 	void DefineObjectMaterials();
@@ -0,0 +1,565 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderuniforms.cpp
+// ============
+// cache the shader uniform locations for the per-draw setters and
+// manage the uniform buffer blocks shared by the shader programs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderUniforms.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// uniform names in the same order as the UNIFORM_ID values
+	const char* g_UniformNames[ShaderUniforms::UNIFORM_COUNT] =
+	{
+		"model",
+		"objectColor",
+		"objectTextureArrays",
+		"textureIndex",
+		"bUseTexture",
+		"bUseLighting",
+		"UVscale",
+		"materialIndex",
+		"bUseInstancing",
+		"bUseDrawData",
+		"drawDataOffset",
+		"bDepthOnly"
+	};
+
+	// shader block names in the same order as the BLOCK_BINDING values
+	const char* g_BlockNames[ShaderUniforms::BLOCK_BINDING_COUNT] =
+	{
+		"CameraBlock",
+		"MaterialBlock",
+		"TextureBlock"
+	};
+
+	// storage block names in the same order as the STORAGE_BINDING values
+	const char* g_StorageBlockNames[ShaderUniforms::STORAGE_BINDING_COUNT] =
+	{
+		"DrawDataBlock",
+		"LightBlock",
+		"ClusterBlock"
+	};
+
+	// sizes of the shader blocks in the same order as the BLOCK_BINDING values
+	const GLsizeiptr g_BlockSizes[ShaderUniforms::BLOCK_BINDING_COUNT] =
+	{
+		sizeof(ShaderUniforms::CAMERA_BLOCK),
+		sizeof(ShaderUniforms::MATERIAL_ENTRY) * ShaderUniforms::MAX_MATERIALS,
+		sizeof(ShaderUniforms::TEXTURE_LOCATION) * ShaderUniforms::MAX_TEXTURES
+	};
+
+	// the block structures must match the layouts in the shaders
+	static_assert(sizeof(ShaderUniforms::CAMERA_BLOCK) == 144, "CameraBlock does not match the std140 layout");
+	static_assert(sizeof(ShaderUniforms::LIGHT_SOURCE) == 64, "LightSource does not match the std430 layout");
+	static_assert(sizeof(ShaderUniforms::MATERIAL_ENTRY) == 48, "Material does not match the std140 layout");
+	static_assert(sizeof(ShaderUniforms::TEXTURE_LOCATION) == 16, "TextureLocation does not match the std140 layout");
+}
+
+/***********************************************************
+ *  ShaderUniforms()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderUniforms::ShaderUniforms()
+{
+	m_programID = 0;
+	for (int i = 0; i < UNIFORM_COUNT; i++)
+	{
+		m_locations[i] = -1;
+	}
+	for (int i = 0; i < BLOCK_BINDING_COUNT; i++)
+	{
+		m_blockBuffers[i] = 0;
+	}
+	m_lightBuffer = 0;
+	m_lightRevision = 0;
+	m_cameraBlock.view = glm::mat4(1.0f);
+	m_cameraBlock.projection = glm::mat4(1.0f);
+	m_cameraBlock.viewPosition = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	m_viewBuffer = 0;
+	m_viewStride = 0;
+	for (int i = 0; i < MAX_VIEWS; i++)
+	{
+		m_viewBlocks[i] = m_cameraBlock;
+	}
+	m_viewCount = 0;
+	m_uploadCount = 0;
+}
+
+/***********************************************************
+ *  ~ShaderUniforms()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderUniforms::~ShaderUniforms()
+{
+	// free the uniform buffer objects
+	for (int i = 0; i < BLOCK_BINDING_COUNT; i++)
+	{
+		if (0 != m_blockBuffers[i])
+		{
+			glDeleteBuffers(1, &m_blockBuffers[i]);
+			m_blockBuffers[i] = 0;
+		}
+	}
+	if (0 != m_lightBuffer)
+	{
+		glDeleteBuffers(1, &m_lightBuffer);
+		m_lightBuffer = 0;
+	}
+	if (0 != m_viewBuffer)
+	{
+		glDeleteBuffers(1, &m_viewBuffer);
+		m_viewBuffer = 0;
+	}
+	m_programID = 0;
+}
+
+/***********************************************************
+ *  ResolveLocations()
+ *
+ *  This method is used for looking up the locations of all
+ *  the uniforms in the passed in shader program, and for
+ *  attaching its shader blocks to the uniform buffers.  It
+ *  must be called again whenever the program is relinked.
+ ***********************************************************/
+bool ShaderUniforms::ResolveLocations(GLuint programID)
+{
+	if (0 == programID)
+	{
+		std::cout << "Could not resolve uniform locations, no shader program is loaded" << std::endl;
+		return(false);
+	}
+
+	m_programID = programID;
+
+	for (int i = 0; i < UNIFORM_COUNT; i++)
+	{
+		m_locations[i] = glGetUniformLocation(programID, g_UniformNames[i]);
+	}
+
+	// the buffers are shared by all programs, so they are only
+	// created the first time
+	CreateBlockBuffers();
+	BindProgramBlocks(programID);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateBlockBuffers()
+ *
+ *  This method is used for creating the uniform buffer
+ *  objects and binding them to their binding points.  The
+ *  light storage buffer is sized when the lights are
+ *  uploaded.
+ ***********************************************************/
+void ShaderUniforms::CreateBlockBuffers()
+{
+	for (int i = 0; i < BLOCK_BINDING_COUNT; i++)
+	{
+		if (0 != m_blockBuffers[i])
+		{
+			continue;
+		}
+
+		glGenBuffers(1, &m_blockBuffers[i]);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_blockBuffers[i]);
+		glBufferData(GL_UNIFORM_BUFFER, g_BlockSizes[i], NULL, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, i, m_blockBuffers[i]);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if (0 == m_lightBuffer)
+	{
+		glGenBuffers(1, &m_lightBuffer);
+	}
+}
+
+/***********************************************************
+ *  BindProgramBlocks()
+ *
+ *  This method is used for attaching the uniform blocks and
+ *  the storage blocks that are declared in the passed in
+ *  program to their binding points.
+ ***********************************************************/
+void ShaderUniforms::BindProgramBlocks(GLuint programID)
+{
+	for (int i = 0; i < BLOCK_BINDING_COUNT; i++)
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(programID, g_BlockNames[i]);
+		if (GL_INVALID_INDEX == blockIndex)
+		{
+			std::cout << "Shader program does not declare the uniform block " << g_BlockNames[i] << std::endl;
+			continue;
+		}
+		glUniformBlockBinding(programID, blockIndex, i);
+	}
+
+	for (int i = 0; i < STORAGE_BINDING_COUNT; i++)
+	{
+		GLuint blockIndex = glGetProgramResourceIndex(programID, GL_SHADER_STORAGE_BLOCK, g_StorageBlockNames[i]);
+		if (GL_INVALID_INDEX == blockIndex)
+		{
+			std::cout << "Shader program does not declare the storage block " << g_StorageBlockNames[i] << std::endl;
+			continue;
+		}
+		glShaderStorageBlockBinding(programID, blockIndex, i);
+	}
+}
+
+/***********************************************************
+ *  GetLocation()
+ *
+ *  This method is used for getting the resolved location of
+ *  the passed in uniform.
+ ***********************************************************/
+GLint ShaderUniforms::GetLocation(UNIFORM_ID uniform) const
+{
+	if ((uniform < 0) || (uniform >= UNIFORM_COUNT))
+	{
+		return(-1);
+	}
+
+	return(m_locations[uniform]);
+}
+
+/***********************************************************
+ *  UpdateCameraBlock()
+ *
+ *  This method is used for uploading the per-frame camera
+ *  data into the CameraBlock with one buffer update.  A copy
+ *  is kept for the CPU side of the renderer.
+ ***********************************************************/
+void ShaderUniforms::UpdateCameraBlock(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	m_cameraBlock.view = view;
+	m_cameraBlock.projection = projection;
+	m_cameraBlock.viewPosition = glm::vec4(viewPosition, 1.0f);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_blockBuffers[CAMERA_BLOCK_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(m_cameraBlock), &m_cameraBlock);
+	m_uploadCount++;
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateViewBlocks()
+ *
+ *  This method is used for uploading the cameras of all the
+ *  views that are drawn from one frame of draw data.  Every
+ *  camera gets a slot of the view buffer at the uniform
+ *  buffer offset alignment, so the CameraBlock can be bound
+ *  to any of them without uploading it again.
+ ***********************************************************/
+void ShaderUniforms::UpdateViewBlocks(const CAMERA_BLOCK* pViews, int viewCount)
+{
+	if ((NULL == pViews) || (viewCount <= 0))
+	{
+		m_viewCount = 0;
+		return;
+	}
+	if (viewCount > MAX_VIEWS)
+	{
+		viewCount = MAX_VIEWS;
+	}
+
+	if (0 == m_viewBuffer)
+	{
+		GLint alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (alignment <= 0)
+		{
+			alignment = 256;
+		}
+		m_viewStride = ((sizeof(CAMERA_BLOCK) + alignment - 1) / alignment) * alignment;
+
+		glGenBuffers(1, &m_viewBuffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_viewBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, m_viewStride * MAX_VIEWS, NULL, GL_DYNAMIC_DRAW);
+		m_viewUploadData.assign(m_viewStride * MAX_VIEWS, 0);
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_viewBuffer);
+	}
+
+	for (int i = 0; i < viewCount; i++)
+	{
+		m_viewBlocks[i] = pViews[i];
+		memcpy(&m_viewUploadData[m_viewStride * i], &pViews[i], sizeof(CAMERA_BLOCK));
+	}
+	m_viewCount = viewCount;
+
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, m_viewStride * viewCount, m_viewUploadData.data());
+	m_uploadCount++;
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  GetViewBlock()
+ *
+ *  This method is used for getting the camera of one of the
+ *  uploaded views.  The frame camera is returned for an index
+ *  outside of the uploaded views.
+ ***********************************************************/
+const ShaderUniforms::CAMERA_BLOCK& ShaderUniforms::GetViewBlock(int viewIndex) const
+{
+	if ((viewIndex < 0) || (viewIndex >= m_viewCount))
+	{
+		return(m_cameraBlock);
+	}
+
+	return(m_viewBlocks[viewIndex]);
+}
+
+/***********************************************************
+ *  BindCameraView()
+ *
+ *  This method is used for pointing the CameraBlock of the
+ *  shaders at the slot of one uploaded view, and for pointing
+ *  it back at the frame camera when -1 is passed in.
+ ***********************************************************/
+void ShaderUniforms::BindCameraView(int viewIndex)
+{
+	if ((viewIndex < 0) || (viewIndex >= m_viewCount) || (0 == m_viewBuffer))
+	{
+		glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, m_blockBuffers[CAMERA_BLOCK_BINDING]);
+		return;
+	}
+
+	glBindBufferRange(
+		GL_UNIFORM_BUFFER,
+		CAMERA_BLOCK_BINDING,
+		m_viewBuffer,
+		m_viewStride * viewIndex,
+		sizeof(CAMERA_BLOCK));
+}
+
+/***********************************************************
+ *  SetLightCount()
+ *
+ *  This method is used for changing the number of light
+ *  sources.  The added light sources are dark until they are
+ *  set.
+ ***********************************************************/
+void ShaderUniforms::SetLightCount(int lightCount)
+{
+	if (lightCount > MAX_LIGHTS)
+	{
+		std::cout << "Only the first " << MAX_LIGHTS << " of " << lightCount << " light sources are used" << std::endl;
+		lightCount = MAX_LIGHTS;
+	}
+
+	m_lightSources.resize((lightCount > 0) ? lightCount : 0, LIGHT_SOURCE());
+}
+
+/***********************************************************
+ *  SetLightSource()
+ *
+ *  This method is used for changing the local copy of one
+ *  light source, adding the light sources up to it when it
+ *  is past the end.  UploadLightBlock() must be called after
+ *  all the light sources are changed.
+ ***********************************************************/
+void ShaderUniforms::SetLightSource(int lightIndex, const LIGHT_SOURCE& lightSource)
+{
+	if ((lightIndex < 0) || (lightIndex >= MAX_LIGHTS))
+	{
+		std::cout << "Light source index " << lightIndex << " is out of range" << std::endl;
+		return;
+	}
+
+	if (lightIndex >= (int)m_lightSources.size())
+	{
+		SetLightCount(lightIndex + 1);
+	}
+	m_lightSources[lightIndex] = lightSource;
+}
+
+/***********************************************************
+ *  GetLightSource()
+ *
+ *  This method is used for getting the local copy of one
+ *  light source.  An index out of range returns a dark
+ *  light source.
+ ***********************************************************/
+const ShaderUniforms::LIGHT_SOURCE& ShaderUniforms::GetLightSource(int lightIndex) const
+{
+	static const LIGHT_SOURCE darkLight = LIGHT_SOURCE();
+
+	if ((lightIndex < 0) || (lightIndex >= (int)m_lightSources.size()))
+	{
+		std::cout << "Light source index " << lightIndex << " is out of range" << std::endl;
+		return(darkLight);
+	}
+
+	return(m_lightSources[lightIndex]);
+}
+
+/***********************************************************
+ *  UploadLightBlock()
+ *
+ *  This method is used for uploading all of the light
+ *  sources into the LightBlock with one buffer update.  The
+ *  buffer is sized for the lights every time, since they
+ *  are rarely uploaded.
+ ***********************************************************/
+void ShaderUniforms::UploadLightBlock()
+{
+	if (0 == m_lightBuffer)
+	{
+		std::cout << "Could not upload the light sources, the shader blocks are not created" << std::endl;
+		return;
+	}
+
+	// an empty block still needs a buffer to be bound
+	const LIGHT_SOURCE darkLight = LIGHT_SOURCE();
+	GLsizeiptr lightBytes = sizeof(LIGHT_SOURCE) * (m_lightSources.empty() ? 1 : m_lightSources.size());
+	const void* pLights = m_lightSources.empty() ? (const void*)&darkLight : (const void*)&m_lightSources[0];
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, lightBytes, pLights, GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_STORAGE_BINDING, m_lightBuffer);
+	m_uploadCount++;
+	m_lightRevision++;
+}
+
+/***********************************************************
+ *  UploadMaterialBlock()
+ *
+ *  This method is used for uploading the material table
+ *  into the MaterialBlock.  A material is then selected for
+ *  a draw by setting its index into the materialIndex uniform.
+ ***********************************************************/
+void ShaderUniforms::UploadMaterialBlock(const MATERIAL_ENTRY* pMaterials, int materialCount)
+{
+	if (materialCount > MAX_MATERIALS)
+	{
+		std::cout << "Only the first " << MAX_MATERIALS << " of " << materialCount << " materials fit into the material table" << std::endl;
+		materialCount = MAX_MATERIALS;
+	}
+	if ((NULL == pMaterials) || (materialCount <= 0))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_blockBuffers[MATERIAL_BLOCK_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(MATERIAL_ENTRY) * materialCount, pMaterials);
+	m_uploadCount++;
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UploadMaterialEntry()
+ *
+ *  This method is used for uploading a single entry of the
+ *  material table, when one material has been edited.
+ ***********************************************************/
+void ShaderUniforms::UploadMaterialEntry(int materialIndex, const MATERIAL_ENTRY& material)
+{
+	if ((materialIndex < 0) || (materialIndex >= MAX_MATERIALS))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_blockBuffers[MATERIAL_BLOCK_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(MATERIAL_ENTRY) * materialIndex, sizeof(MATERIAL_ENTRY), &material);
+	m_uploadCount++;
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UploadTextureBlock()
+ *
+ *  This method is used for uploading the table that maps the
+ *  texture handles to their texture array and layer into the
+ *  TextureBlock.
+ ***********************************************************/
+void ShaderUniforms::UploadTextureBlock(const TEXTURE_LOCATION* pLocations, int textureCount)
+{
+	if (textureCount > MAX_TEXTURES)
+	{
+		std::cout << "Only the first " << MAX_TEXTURES << " of " << textureCount << " textures fit into the texture table" << std::endl;
+		textureCount = MAX_TEXTURES;
+	}
+	if ((NULL == pLocations) || (textureCount <= 0))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_blockBuffers[TEXTURE_BLOCK_BINDING]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(TEXTURE_LOCATION) * textureCount, pLocations);
+	m_uploadCount++;
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  The following methods are used for setting the uniform
+ *  values into the active shader program by uniform ID.
+ ***********************************************************/
+void ShaderUniforms::setBoolValue(UNIFORM_ID uniform, bool value) const
+{
+	glUniform1i(GetLocation(uniform), (int)value);
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setIntValue(UNIFORM_ID uniform, int value) const
+{
+	glUniform1i(GetLocation(uniform), value);
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setFloatValue(UNIFORM_ID uniform, float value) const
+{
+	glUniform1f(GetLocation(uniform), value);
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setSampler2DValue(UNIFORM_ID uniform, int value) const
+{
+	glUniform1i(GetLocation(uniform), value);
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setSamplerArrayValue(UNIFORM_ID uniform, const int* pValues, int count) const
+{
+	glUniform1iv(GetLocation(uniform), count, pValues);
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setVec2Value(UNIFORM_ID uniform, const glm::vec2& value) const
+{
+	glUniform2fv(GetLocation(uniform), 1, glm::value_ptr(value));
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setVec3Value(UNIFORM_ID uniform, const glm::vec3& value) const
+{
+	glUniform3fv(GetLocation(uniform), 1, glm::value_ptr(value));
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setVec4Value(UNIFORM_ID uniform, const glm::vec4& value) const
+{
+	glUniform4fv(GetLocation(uniform), 1, glm::value_ptr(value));
+	m_uploadCount++;
+}
+
+void ShaderUniforms::setMat4Value(UNIFORM_ID uniform, const glm::mat4& value) const
+{
+	glUniformMatrix4fv(GetLocation(uniform), 1, GL_FALSE, glm::value_ptr(value));
+	m_uploadCount++;
+}
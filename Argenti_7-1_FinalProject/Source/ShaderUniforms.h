@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderuniforms.h
+// ============
+// cache the shader uniform locations for the per-draw setters and
+// manage the uniform buffer blocks shared by the shader programs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  ShaderUniforms
+ *
+ *  This class looks up the locations of all the uniforms
+ *  used by the scene once, after the shaders are loaded.
+ *  The setters take a compile-time uniform ID instead of a
+ *  name, so no string lookup is done in the driver while
+ *  the scene is rendered.
+ *
+ *  The per-frame camera data, the material table and the
+ *  texture locations are kept in std140 uniform buffer blocks,
+ *  so they are uploaded with one buffer update each.  The
+ *  light sources are kept in a shader storage block, so there
+ *  can be many more of them, and the per-draw data of the
+ *  indirect draws is read from a shader storage block that the
+ *  scene manager fills.
+ ***********************************************************/
+class ShaderUniforms
+{
+public:
+	// constructor
+	ShaderUniforms();
+	// destructor
+	~ShaderUniforms();
+
+	// IDs of the uniforms used by the scene and view managers
+	enum UNIFORM_ID
+	{
+		UNIFORM_MODEL = 0,
+		UNIFORM_OBJECT_COLOR,
+		UNIFORM_TEXTURE_ARRAYS,
+		UNIFORM_TEXTURE_INDEX,
+		UNIFORM_USE_TEXTURE,
+		UNIFORM_USE_LIGHTING,
+		UNIFORM_UV_SCALE,
+		UNIFORM_MATERIAL_INDEX,
+		UNIFORM_USE_INSTANCING,
+		UNIFORM_USE_DRAW_DATA,
+		UNIFORM_DRAW_DATA_OFFSET,
+		UNIFORM_DEPTH_ONLY,
+		UNIFORM_COUNT
+	};
+
+	// binding points of the uniform buffer blocks
+	enum BLOCK_BINDING
+	{
+		CAMERA_BLOCK_BINDING = 0,
+		MATERIAL_BLOCK_BINDING,
+		TEXTURE_BLOCK_BINDING,
+		BLOCK_BINDING_COUNT
+	};
+
+	// binding points of the shader storage blocks
+	enum STORAGE_BINDING
+	{
+		DRAW_DATA_STORAGE_BINDING = 0,
+		LIGHT_STORAGE_BINDING,
+		CLUSTER_STORAGE_BINDING,
+		STORAGE_BINDING_COUNT
+	};
+
+	// sizes of the arrays declared in the shader blocks
+	static const int MAX_LIGHTS = 1024;
+	static const int MAX_MATERIALS = 32;
+	static const int MAX_TEXTURES = 256;
+	static const int MAX_TEXTURE_ARRAYS = 16;
+	// most cameras of the views that are drawn in one frame
+	static const int MAX_VIEWS = 4;
+
+	// std140 layout of the CameraBlock
+	struct CAMERA_BLOCK
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec4 viewPosition;
+	};
+
+	// std430 layout of one lightSources[] entry in the LightBlock -
+	// a light with a radius of 0 reaches the whole scene
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		float focalStrength;
+		glm::vec3 ambientColor;
+		float specularIntensity;
+		glm::vec3 diffuseColor;
+		float radius;
+		glm::vec3 specularColor;
+		float padding0;
+	};
+
+	// std140 layout of one materials[] entry in the MaterialBlock
+	struct MATERIAL_ENTRY
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		float shininess;
+		glm::vec3 specularColor;
+		float padding0;
+	};
+
+	// std140 layout of one textureLocations[] entry in the TextureBlock
+	struct TEXTURE_LOCATION
+	{
+		GLint arrayIndex;
+		GLint layer;
+		// finest mipmap level of the layer that holds the image
+		GLint firstLevel;
+		GLint padding0;
+	};
+
+private:
+	// the shader program the locations were resolved for
+	GLuint m_programID;
+	// resolved uniform locations, -1 when not used by the shader
+	GLint m_locations[UNIFORM_COUNT];
+	// uniform buffer objects for the shader blocks
+	GLuint m_blockBuffers[BLOCK_BINDING_COUNT];
+	// local copy of the light sources, uploaded all at once
+	std::vector<LIGHT_SOURCE> m_lightSources;
+	// shader storage buffer of the LightBlock
+	GLuint m_lightBuffer;
+	// counts the light uploads, so a change can be noticed
+	int m_lightRevision;
+	// local copy of the last uploaded camera data
+	CAMERA_BLOCK m_cameraBlock;
+	// uniform buffer with the cameras of all the views, one
+	// CameraBlock per aligned slot, and the local copy of them
+	GLuint m_viewBuffer;
+	GLsizeiptr m_viewStride;
+	CAMERA_BLOCK m_viewBlocks[MAX_VIEWS];
+	int m_viewCount;
+	std::vector<unsigned char> m_viewUploadData;
+	// number of uniform and block uploads since the last reset
+	mutable int m_uploadCount;
+
+	// create the uniform buffer objects for the shader blocks
+	void CreateBlockBuffers();
+	// attach the uniform and storage blocks of a program to their
+	// binding points
+	void BindProgramBlocks(GLuint programID);
+
+public:
+	// look up all the uniform locations in the shader program
+	bool ResolveLocations(GLuint programID);
+
+	// get a resolved uniform location
+	GLint GetLocation(UNIFORM_ID uniform) const;
+
+	// upload the per-frame camera data
+	void UpdateCameraBlock(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
+
+	// get the last uploaded camera data
+	const CAMERA_BLOCK& GetCameraBlock() const { return m_cameraBlock; }
+
+	// upload the cameras of the views that share one frame into
+	// the view buffer with one buffer update
+	void UpdateViewBlocks(const CAMERA_BLOCK* pViews, int viewCount);
+	int GetViewCount() const { return m_viewCount; }
+	const CAMERA_BLOCK& GetViewBlock(int viewIndex) const;
+	// read the CameraBlock from one of the uploaded views, or from
+	// the frame camera for -1
+	void BindCameraView(int viewIndex);
+
+	// change the number of light sources, the new ones are dark
+	void SetLightCount(int lightCount);
+	int GetLightCount() const { return (int)m_lightSources.size(); }
+	// change a light source and upload all the light sources
+	void SetLightSource(int lightIndex, const LIGHT_SOURCE& lightSource);
+	const LIGHT_SOURCE& GetLightSource(int lightIndex) const;
+	void UploadLightBlock();
+	// the uploaded light sources, for the light cluster pass
+	GLuint GetLightBuffer() const { return m_lightBuffer; }
+	int GetLightRevision() const { return m_lightRevision; }
+
+	// upload the material table
+	void UploadMaterialBlock(const MATERIAL_ENTRY* pMaterials, int materialCount);
+	// patch one entry of the material table
+	void UploadMaterialEntry(int materialIndex, const MATERIAL_ENTRY& material);
+
+	// upload the texture location table
+	void UploadTextureBlock(const TEXTURE_LOCATION* pLocations, int textureCount);
+
+	// number of uniform and block uploads, counted for the profiler
+	int GetUploadCount() const { return m_uploadCount; }
+	void ResetUploadCount() { m_uploadCount = 0; }
+
+	// set the uniform values by ID
+	void setBoolValue(UNIFORM_ID uniform, bool value) const;
+	void setIntValue(UNIFORM_ID uniform, int value) const;
+	void setFloatValue(UNIFORM_ID uniform, float value) const;
+	void setSampler2DValue(UNIFORM_ID uniform, int value) const;
+	void setSamplerArrayValue(UNIFORM_ID uniform, const int* pValues, int count) const;
+	void setVec2Value(UNIFORM_ID uniform, const glm::vec2& value) const;
+	void setVec3Value(UNIFORM_ID uniform, const glm::vec3& value) const;
+	void setVec4Value(UNIFORM_ID uniform, const glm::vec4& value) const;
+	void setMat4Value(UNIFORM_ID uniform, const glm::mat4& value) const;
+};
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// simulationthread.cpp
+// ============
+// step the camera and the scene logic apart from the render thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SimulationThread.h"
+
+#include "ViewManager.h"
+
+#include <chrono>
+
+/***********************************************************
+ *  SimulationThread()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SimulationThread::SimulationThread(ViewManager* pViewManager, FrameMailbox* pMailbox)
+{
+	m_pViewManager = pViewManager;
+	m_pMailbox = pMailbox;
+	m_bRunning.store(false);
+}
+
+/***********************************************************
+ *  ~SimulationThread()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SimulationThread::~SimulationThread()
+{
+	Stop();
+	m_pViewManager = NULL;
+	m_pMailbox = NULL;
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the simulation thread.
+ *  The first snapshot is published before the thread starts,
+ *  so the renderer never sees an empty mailbox.
+ ***********************************************************/
+void SimulationThread::Start()
+{
+	if ((m_bRunning.load() == true) || (NULL == m_pViewManager) || (NULL == m_pMailbox))
+	{
+		return;
+	}
+
+	FrameMailbox::FRAME_SNAPSHOT& snapshot = m_pMailbox->BeginWrite();
+	m_pViewManager->BuildFrameSnapshot(snapshot);
+	snapshot.stepNumber = 0;
+	snapshot.simulationTime = 0.0;
+	m_pMailbox->Publish();
+
+	m_bRunning.store(true);
+	m_thread = std::thread(&SimulationThread::Run, this);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for asking the simulation thread to
+ *  finish and waiting until it has.
+ ***********************************************************/
+void SimulationThread::Stop()
+{
+	m_bRunning.store(false);
+	if (m_thread.joinable() == true)
+	{
+		m_thread.join();
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is the loop of the simulation thread.  The
+ *  steps are scheduled on a fixed clock, and the step time
+ *  passed to the camera is the time that actually passed,
+ *  so a late step still moves the camera by the right amount.
+ ***********************************************************/
+void SimulationThread::Run()
+{
+	const std::chrono::microseconds stepDuration(1000000 / STEPS_PER_SECOND);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point lastStep = start;
+	std::chrono::steady_clock::time_point nextStep = start + stepDuration;
+	unsigned int stepNumber = 0;
+
+	while (m_bRunning.load() == true)
+	{
+		std::this_thread::sleep_until(nextStep);
+		nextStep += stepDuration;
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		float deltaTime = std::chrono::duration<float>(now - lastStep).count();
+		lastStep = now;
+
+		// do not try to catch up on the steps that were missed
+		if (nextStep < now)
+		{
+			nextStep = now + stepDuration;
+		}
+
+		m_pViewManager->UpdateCamera(deltaTime);
+
+		FrameMailbox::FRAME_SNAPSHOT& snapshot = m_pMailbox->BeginWrite();
+		m_pViewManager->BuildFrameSnapshot(snapshot);
+		snapshot.stepNumber = ++stepNumber;
+		snapshot.simulationTime = std::chrono::duration<double>(now - start).count();
+		m_pMailbox->Publish();
+	}
+}
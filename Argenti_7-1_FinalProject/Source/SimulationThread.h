@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// simulationthread.h
+// ============
+// step the camera and the scene logic apart from the render thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameMailbox.h"
+
+#include <atomic>
+#include <thread>
+
+class ViewManager;
+
+/***********************************************************
+ *  SimulationThread
+ *
+ *  This class runs the simulation on its own thread at a
+ *  fixed rate.  Every step reads the input that the main
+ *  thread has captured, moves the camera and publishes a
+ *  frame snapshot to the mailbox, so a slow frame on the
+ *  render thread does not delay the input, and the input does
+ *  not wait for the frame to finish.
+ ***********************************************************/
+class SimulationThread
+{
+public:
+	// constructor
+	SimulationThread(ViewManager* pViewManager, FrameMailbox* pMailbox);
+	// destructor
+	~SimulationThread();
+
+	// simulation steps per second
+	static const int STEPS_PER_SECOND = 240;
+
+private:
+	// the view manager that owns the camera
+	ViewManager* m_pViewManager;
+	// the mailbox the snapshots are published to
+	FrameMailbox* m_pMailbox;
+	std::thread m_thread;
+	// cleared to ask the thread to finish
+	std::atomic<bool> m_bRunning;
+
+	// the loop of the simulation thread
+	void Run();
+
+public:
+	// start and stop the simulation thread
+	void Start();
+	void Stop();
+};
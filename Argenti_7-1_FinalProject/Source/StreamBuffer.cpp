@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+// streambuffer.cpp
+// ============
+// stream the per-draw data of every frame through a mapped ring buffer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StreamBuffer.h"
+
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// the buffer is bound as a vertex buffer, an indirect buffer
+	// and a storage buffer, so it is created on a neutral target
+	const GLenum g_StreamTarget = GL_COPY_WRITE_BUFFER;
+	// nanoseconds to wait for a fence before checking again
+	const GLuint64 g_FenceTimeout = 1000000;
+
+	// round a size or an offset up to a multiple of the alignment
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return(((value + alignment - 1) / alignment) * alignment);
+	}
+}
+
+/***********************************************************
+ *  StreamBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StreamBuffer::StreamBuffer()
+{
+	m_buffer = 0;
+	m_pMemory = NULL;
+	m_bPersistent = false;
+	m_regionBytes = 0;
+	m_currentRegion = 0;
+	m_usedBytes = 0;
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		m_fences[i] = NULL;
+	}
+	m_offsetAlignment = 16;
+}
+
+/***********************************************************
+ *  ~StreamBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StreamBuffer::~StreamBuffer()
+{
+	DestroyStorage();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the buffer.  The offset
+ *  alignment covers the storage buffer bindings, so any
+ *  allocation can be bound as a storage buffer.
+ ***********************************************************/
+bool StreamBuffer::Create(size_t regionBytes)
+{
+	DestroyStorage();
+
+	m_bPersistent = (GLEW_ARB_buffer_storage) ? true : false;
+	if (m_bPersistent == false)
+	{
+		std::cout << "Persistent buffers are not supported, the draw data is uploaded with glBufferSubData" << std::endl;
+	}
+
+	m_offsetAlignment = 16;
+	if (GLEW_ARB_shader_storage_buffer_object)
+	{
+		GLint storageAlignment = 0;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+		if ((size_t)storageAlignment > m_offsetAlignment)
+		{
+			m_offsetAlignment = (size_t)storageAlignment;
+		}
+	}
+
+	return(CreateStorage(regionBytes));
+}
+
+/***********************************************************
+ *  CreateStorage()
+ *
+ *  This method is used for creating the buffer with room for
+ *  all the regions, and for mapping it for the lifetime of
+ *  the buffer.
+ ***********************************************************/
+bool StreamBuffer::CreateStorage(size_t regionBytes)
+{
+	const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	m_regionBytes = AlignUp(regionBytes, m_offsetAlignment);
+	m_currentRegion = 0;
+	m_usedBytes = 0;
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(g_StreamTarget, m_buffer);
+	if (m_bPersistent == true)
+	{
+		glBufferStorage(g_StreamTarget, m_regionBytes * REGION_COUNT, NULL, mapFlags);
+		m_pMemory = (unsigned char*)glMapBufferRange(g_StreamTarget, 0, m_regionBytes * REGION_COUNT, mapFlags);
+	}
+	else
+	{
+		glBufferData(g_StreamTarget, m_regionBytes * REGION_COUNT, NULL, GL_STREAM_DRAW);
+		m_pMemory = new unsigned char[m_regionBytes * REGION_COUNT];
+	}
+	glBindBuffer(g_StreamTarget, 0);
+
+	if (NULL == m_pMemory)
+	{
+		std::cout << "Could not map the stream buffer of " << m_regionBytes * REGION_COUNT << " bytes" << std::endl;
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+		m_regionBytes = 0;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyStorage()
+ *
+ *  This method is used for waiting until the GPU has finished
+ *  with all the regions, and for unmapping and freeing the
+ *  buffer.
+ ***********************************************************/
+void StreamBuffer::DestroyStorage()
+{
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		WaitForRegion(i);
+	}
+
+	if ((NULL != m_pMemory) && (m_bPersistent == true))
+	{
+		glBindBuffer(g_StreamTarget, m_buffer);
+		glUnmapBuffer(g_StreamTarget);
+		glBindBuffer(g_StreamTarget, 0);
+	}
+	else if (NULL != m_pMemory)
+	{
+		delete[] m_pMemory;
+	}
+	m_pMemory = NULL;
+
+	if (0 != m_buffer)
+	{
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+	m_regionBytes = 0;
+	m_usedBytes = 0;
+}
+
+/***********************************************************
+ *  WaitForRegion()
+ *
+ *  This method is used for waiting until the draws that read
+ *  a region have finished.  The commands are flushed while
+ *  waiting, so the fence is sure to be reached.
+ ***********************************************************/
+void StreamBuffer::WaitForRegion(int region)
+{
+	if (NULL == m_fences[region])
+	{
+		return;
+	}
+
+	while (glClientWaitSync(m_fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout) == GL_TIMEOUT_EXPIRED)
+	{
+	}
+	glDeleteSync(m_fences[region]);
+	m_fences[region] = NULL;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting to write the data of a
+ *  frame.  When the frame does not fit into a region, all
+ *  the regions are freed and created again with the room for
+ *  the frame and some more, so a growing scene does not grow
+ *  the buffer every frame.
+ ***********************************************************/
+void StreamBuffer::BeginFrame(size_t frameBytes)
+{
+	if (IsCreated() == false)
+	{
+		return;
+	}
+
+	if (frameBytes > m_regionBytes)
+	{
+		size_t regionBytes = frameBytes + frameBytes / 4;
+		DestroyStorage();
+		if (CreateStorage(regionBytes) == false)
+		{
+			return;
+		}
+	}
+	else
+	{
+		m_currentRegion = (m_currentRegion + 1) % REGION_COUNT;
+		WaitForRegion(m_currentRegion);
+	}
+
+	m_usedBytes = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing the fence after the draws
+ *  of the frame, so the region is not written again while
+ *  the GPU is still reading it.
+ ***********************************************************/
+void StreamBuffer::EndFrame()
+{
+	if ((IsCreated() == false) || (m_usedBytes == 0))
+	{
+		return;
+	}
+
+	m_fences[m_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for getting room for the data of a
+ *  draw in the region of the current frame.  The data is
+ *  written straight into the returned memory.
+ ***********************************************************/
+void* StreamBuffer::Allocate(size_t bytes, GLintptr& bufferOffset)
+{
+	size_t offset = AlignUp(m_usedBytes, m_offsetAlignment);
+
+	if ((IsCreated() == false) || (offset + bytes > m_regionBytes))
+	{
+		bufferOffset = 0;
+		return(NULL);
+	}
+
+	m_usedBytes = offset + bytes;
+	bufferOffset = (GLintptr)(m_regionBytes * m_currentRegion + offset);
+
+	return(m_pMemory + bufferOffset);
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for making the data written into an
+ *  allocation visible to the GPU.  The mapping is coherent,
+ *  so only the copy in memory has to be uploaded.
+ ***********************************************************/
+void StreamBuffer::Flush(GLintptr bufferOffset, size_t bytes)
+{
+	if ((m_bPersistent == true) || (IsCreated() == false) || (bytes == 0))
+	{
+		return;
+	}
+
+	glBindBuffer(g_StreamTarget, m_buffer);
+	glBufferSubData(g_StreamTarget, bufferOffset, bytes, m_pMemory + bufferOffset);
+	glBindBuffer(g_StreamTarget, 0);
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// streambuffer.h
+// ============
+// stream the per-draw data of every frame through a mapped ring buffer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+/***********************************************************
+ *  StreamBuffer
+ *
+ *  This class keeps one buffer object with a region for each
+ *  of the frames that the GPU can still be drawing, and the
+ *  data of a frame is written straight into its region
+ *  through a persistent, coherent mapping.  A fence is placed
+ *  after the draws of a frame, and a region is only written
+ *  again after its fence has passed, so the driver never has
+ *  to wait for the GPU or copy the data.  Without buffer
+ *  storage support the data is written into a copy in memory
+ *  and uploaded into the fenced region with glBufferSubData.
+ ***********************************************************/
+class StreamBuffer
+{
+public:
+	// constructor
+	StreamBuffer();
+	// destructor
+	~StreamBuffer();
+
+	// frames that are written, queued and drawn at the same time
+	static const int REGION_COUNT = 3;
+
+private:
+	GLuint m_buffer;
+	// mapping of all the regions, or their copy in memory
+	unsigned char* m_pMemory;
+	bool m_bPersistent;
+	size_t m_regionBytes;
+	// region of the current frame and the bytes written into it
+	int m_currentRegion;
+	size_t m_usedBytes;
+	// fence after the last draws that read each region
+	GLsync m_fences[REGION_COUNT];
+	// smallest alignment of the offsets the buffer is bound at
+	size_t m_offsetAlignment;
+
+	// create and map the buffer with room for the regions
+	bool CreateStorage(size_t regionBytes);
+	// unmap and free the buffer
+	void DestroyStorage();
+	// wait until the GPU has finished with a region
+	void WaitForRegion(int region);
+
+public:
+	// create the buffer with the passed in size of every region
+	bool Create(size_t regionBytes);
+	// check whether the buffer has been created
+	bool IsCreated() const { return (0 != m_buffer); }
+	// true when the regions are written through a mapping
+	bool IsPersistent() const { return m_bPersistent; }
+
+	// switch to the region of the next frame and wait until it is
+	// free - the region grows when the frame needs more room
+	void BeginFrame(size_t frameBytes);
+	// place the fence after the draws of the frame
+	void EndFrame();
+
+	// get room for data in the region of the current frame, and its
+	// offset in the buffer - NULL when the region is full
+	void* Allocate(size_t bytes, GLintptr& bufferOffset);
+	// make the written data visible to the GPU - only uploads the
+	// data when the buffer is not mapped
+	void Flush(GLintptr bufferOffset, size_t bytes);
+
+	GLuint GetBuffer() const { return m_buffer; }
+	// alignment of the allocations, for binding them as storage
+	size_t GetOffsetAlignment() const { return m_offsetAlignment; }
+};
@@ -0,0 +1,702 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearrays.cpp
+// ============
+// pack the scene textures into texture arrays of the same size and format
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureArrays.h"
+
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// layers of a new array, the capacity doubles when it is full
+	const int g_InitialLayerCapacity = 4;
+	// color shown until the texture image is stored
+	const unsigned char g_PlaceholderColor[4] = { 128, 128, 128, 255 };
+}
+
+/***********************************************************
+ *  TextureArrays()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureArrays::TextureArrays(ShaderUniforms* pShaderUniforms)
+{
+	m_pShaderUniforms = pShaderUniforms;
+	m_bLocationsChanged = false;
+	m_maxLayers = 0;
+	m_bSparseSupported = false;
+}
+
+/***********************************************************
+ *  ~TextureArrays()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureArrays::~TextureArrays()
+{
+	Destroy();
+	m_pShaderUniforms = NULL;
+}
+
+/***********************************************************
+ *  CreateArrayTexture()
+ *
+ *  This method is used for creating the immutable storage of
+ *  an array texture with the size, format and mipmap levels
+ *  of the passed in array.  The storage is sparse when the
+ *  driver supports it and the size is a multiple of the page
+ *  size of the format, and only the pages that are committed
+ *  for a layer then take video memory.
+ ***********************************************************/
+GLuint TextureArrays::CreateArrayTexture(TEXTURE_ARRAY& textureArray, int layerCapacity)
+{
+	GLuint textureID = 0;
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+	textureArray.bSparse = false;
+	textureArray.sparseLevelCount = 0;
+	if ((m_bSparseSupported == true) && (textureArray.levelCount > 1))
+	{
+		GLint pageSizeCount = 0;
+		GLint pageWidth = 0;
+		GLint pageHeight = 0;
+		glGetInternalformativ(GL_TEXTURE_2D_ARRAY, textureArray.internalFormat, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &pageSizeCount);
+		if (pageSizeCount > 0)
+		{
+			glGetInternalformativ(GL_TEXTURE_2D_ARRAY, textureArray.internalFormat, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageWidth);
+			glGetInternalformativ(GL_TEXTURE_2D_ARRAY, textureArray.internalFormat, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageHeight);
+		}
+		if ((pageWidth > 0) && (pageHeight > 0) &&
+			(textureArray.width % pageWidth == 0) &&
+			(textureArray.height % pageHeight == 0))
+		{
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+			textureArray.bSparse = true;
+		}
+	}
+
+	glTexStorage3D(
+		GL_TEXTURE_2D_ARRAY,
+		textureArray.levelCount,
+		textureArray.internalFormat,
+		textureArray.width,
+		textureArray.height,
+		layerCapacity);
+
+	// the levels that are smaller than a page are kept together
+	// in the mip tail, which is committed as a whole
+	if (textureArray.bSparse == true)
+	{
+		GLint sparseLevelCount = 0;
+		glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevelCount);
+		textureArray.sparseLevelCount = sparseLevelCount;
+	}
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, textureArray.levelCount - 1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  CreatePlaceholderArray()
+ *
+ *  This method is used for creating the first array, which
+ *  holds the 1x1 placeholder color in its only layer.
+ ***********************************************************/
+void TextureArrays::CreatePlaceholderArray()
+{
+	TEXTURE_ARRAY placeholder;
+	placeholder.width = 1;
+	placeholder.height = 1;
+	placeholder.internalFormat = GL_RGBA8;
+	placeholder.levelCount = 1;
+	placeholder.layerCount = 1;
+	placeholder.layerCapacity = 1;
+	placeholder.textureID = CreateArrayTexture(placeholder, 1);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder.textureID);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, g_PlaceholderColor);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	m_arrays.push_back(placeholder);
+
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &m_maxLayers);
+	m_bSparseSupported = (GLEW_ARB_sparse_texture != GL_FALSE);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture that shows the
+ *  placeholder until its image is stored.  The handles are
+ *  given out in order, starting at zero.
+ ***********************************************************/
+int TextureArrays::AddTexture()
+{
+	if ((int)m_locations.size() >= ShaderUniforms::MAX_TEXTURES)
+	{
+		std::cout << "The texture table is full, only " << ShaderUniforms::MAX_TEXTURES << " textures can be loaded" << std::endl;
+		return(-1);
+	}
+
+	if (m_arrays.empty() == true)
+	{
+		CreatePlaceholderArray();
+	}
+
+	ShaderUniforms::TEXTURE_LOCATION location = {};
+	location.arrayIndex = 0;
+	location.layer = 0;
+	location.firstLevel = 0;
+	m_locations.push_back(location);
+	m_bLocationsChanged = true;
+
+	return((int)m_locations.size() - 1);
+}
+
+/***********************************************************
+ *  FindArray()
+ *
+ *  This method is used for finding the array that holds the
+ *  textures of the passed in size and format.  A new array is
+ *  created when there is none yet.
+ ***********************************************************/
+int TextureArrays::FindArray(int width, int height, GLenum internalFormat, int levelCount)
+{
+	// the placeholder array is never shared
+	for (int i = 1; i < (int)m_arrays.size(); i++)
+	{
+		if ((m_arrays[i].width == width) &&
+			(m_arrays[i].height == height) &&
+			(m_arrays[i].internalFormat == internalFormat) &&
+			(m_arrays[i].levelCount == levelCount))
+		{
+			return(i);
+		}
+	}
+
+	if ((int)m_arrays.size() >= ShaderUniforms::MAX_TEXTURE_ARRAYS)
+	{
+		std::cout << "Only " << ShaderUniforms::MAX_TEXTURE_ARRAYS << " different texture sizes and formats can be used" << std::endl;
+		return(-1);
+	}
+
+	TEXTURE_ARRAY textureArray;
+	textureArray.width = width;
+	textureArray.height = height;
+	textureArray.internalFormat = internalFormat;
+	textureArray.levelCount = levelCount;
+	textureArray.layerCount = 0;
+	textureArray.layerCapacity = g_InitialLayerCapacity;
+	textureArray.textureID = CreateArrayTexture(textureArray, textureArray.layerCapacity);
+	m_arrays.push_back(textureArray);
+
+	// the new array gets the next texture unit
+	glActiveTexture(GL_TEXTURE0 + (int)m_arrays.size() - 1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureID);
+
+	return((int)m_arrays.size() - 1);
+}
+
+/***********************************************************
+ *  GrowArray()
+ *
+ *  This method is used for making room for one more layer in
+ *  a full array.  A new array with twice the layers is created
+ *  and the stored layers are copied over on the GPU.  The
+ *  pages of a sparse array are committed for the levels that
+ *  the layers hold first, because a copy into pages that are
+ *  not committed is dropped.
+ ***********************************************************/
+bool TextureArrays::GrowArray(int arrayIndex)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+
+	if (textureArray.layerCount < textureArray.layerCapacity)
+	{
+		return(true);
+	}
+	if (textureArray.layerCapacity >= m_maxLayers)
+	{
+		std::cout << "The texture array for " << textureArray.width << "x" << textureArray.height << " textures is full" << std::endl;
+		return(false);
+	}
+
+	int layerCapacity = textureArray.layerCapacity * 2;
+	if (layerCapacity > m_maxLayers)
+	{
+		layerCapacity = m_maxLayers;
+	}
+
+	GLuint textureID = CreateArrayTexture(textureArray, layerCapacity);
+	for (int i = 0; i < (int)m_locations.size(); i++)
+	{
+		if (m_locations[i].arrayIndex == arrayIndex)
+		{
+			ChangeLayerResidency(
+				textureID,
+				textureArray,
+				m_locations[i].layer,
+				textureArray.levelCount,
+				m_locations[i].firstLevel);
+		}
+	}
+
+	int width = textureArray.width;
+	int height = textureArray.height;
+	for (int level = 0; level < textureArray.levelCount; level++)
+	{
+		glCopyImageSubData(
+			textureArray.textureID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+			textureID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+			width, height, textureArray.layerCount);
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	glDeleteTextures(1, &textureArray.textureID);
+	textureArray.textureID = textureID;
+	textureArray.layerCapacity = layerCapacity;
+
+	glActiveTexture(GL_TEXTURE0 + arrayIndex);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureID);
+
+	return(true);
+}
+
+/***********************************************************
+ *  StoreTexture()
+ *
+ *  This method is used for copying the mipmap levels of a
+ *  loaded 2D texture from firstLevel on into a layer of the
+ *  array for its size and format.  The copy is done on the
+ *  GPU, so the source texture can be deleted afterwards.  A
+ *  texture that is stored again with the same size and
+ *  format, after its image was edited or more of its levels
+ *  were streamed in, is copied over its old layer.
+ ***********************************************************/
+bool TextureArrays::StoreTexture(
+	int textureHandle,
+	GLuint sourceTexture,
+	int width,
+	int height,
+	GLenum internalFormat,
+	int levelCount,
+	int firstLevel)
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(false);
+	}
+	if (firstLevel < 0)
+	{
+		firstLevel = 0;
+	}
+	if (firstLevel > levelCount - 1)
+	{
+		firstLevel = levelCount - 1;
+	}
+
+	// the placeholder array is never written
+	ShaderUniforms::TEXTURE_LOCATION& location = m_locations[textureHandle];
+	if (location.arrayIndex > 0)
+	{
+		const TEXTURE_ARRAY& storedArray = m_arrays[location.arrayIndex];
+		if ((storedArray.width == width) &&
+			(storedArray.height == height) &&
+			(storedArray.internalFormat == internalFormat) &&
+			(storedArray.levelCount == levelCount))
+		{
+			ChangeLayerResidency(storedArray.textureID, storedArray, location.layer, location.firstLevel, firstLevel);
+			CopyLevels(sourceTexture, storedArray, location.layer, firstLevel);
+			if (location.firstLevel != firstLevel)
+			{
+				location.firstLevel = firstLevel;
+				m_bLocationsChanged = true;
+			}
+			return(true);
+		}
+
+		// the texture moves to the array of its new size, and the
+		// pages of its old layer are freed
+		ChangeLayerResidency(storedArray.textureID, storedArray, location.layer, location.firstLevel, storedArray.levelCount);
+	}
+
+	int arrayIndex = FindArray(width, height, internalFormat, levelCount);
+	if ((arrayIndex < 0) || (GrowArray(arrayIndex) == false))
+	{
+		return(false);
+	}
+
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	int layer = textureArray.layerCount;
+	ChangeLayerResidency(textureArray.textureID, textureArray, layer, textureArray.levelCount, firstLevel);
+	CopyLevels(sourceTexture, textureArray, layer, firstLevel);
+	textureArray.layerCount++;
+
+	m_locations[textureHandle].arrayIndex = arrayIndex;
+	m_locations[textureHandle].layer = layer;
+	m_locations[textureHandle].firstLevel = firstLevel;
+	m_bLocationsChanged = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  EvictLevels()
+ *
+ *  This method is used for leaving out the levels of a stored
+ *  texture that are finer than firstLevel.  The shader stops
+ *  sampling them with the next upload of the location table,
+ *  and the pages of a sparse array are freed right away -
+ *  the GPU keeps the pages that the frames in flight still
+ *  read until they are done with them.
+ ***********************************************************/
+bool TextureArrays::EvictLevels(int textureHandle, int firstLevel)
+{
+	if (IsTextureStored(textureHandle) == false)
+	{
+		return(false);
+	}
+
+	ShaderUniforms::TEXTURE_LOCATION& location = m_locations[textureHandle];
+	const TEXTURE_ARRAY& textureArray = m_arrays[location.arrayIndex];
+	if (firstLevel > textureArray.levelCount - 1)
+	{
+		firstLevel = textureArray.levelCount - 1;
+	}
+	if (firstLevel <= location.firstLevel)
+	{
+		return(false);
+	}
+
+	ChangeLayerResidency(textureArray.textureID, textureArray, location.layer, location.firstLevel, firstLevel);
+	location.firstLevel = firstLevel;
+	m_bLocationsChanged = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CopyLevels()
+ *
+ *  This method is used for copying the mipmap levels of a
+ *  loaded 2D texture from firstLevel on into a layer of a
+ *  texture array.
+ ***********************************************************/
+void TextureArrays::CopyLevels(
+	GLuint sourceTexture,
+	const TEXTURE_ARRAY& textureArray,
+	int layer,
+	int firstLevel)
+{
+	for (int level = firstLevel; level < textureArray.levelCount; level++)
+	{
+		int width = textureArray.width >> level;
+		int height = textureArray.height >> level;
+
+		glCopyImageSubData(
+			sourceTexture, GL_TEXTURE_2D, level, 0, 0, 0,
+			textureArray.textureID, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+			(width > 0) ? width : 1,
+			(height > 0) ? height : 1,
+			1);
+	}
+}
+
+/***********************************************************
+ *  ChangeLayerResidency()
+ *
+ *  This method is used for committing the pages of the levels
+ *  of a layer that are added when its first level moves to a
+ *  finer level, and for freeing the pages of the levels that
+ *  are left out when it moves to a coarser one.  A first
+ *  level of levelCount stands for a layer without any levels.
+ *  The mip tail is committed with the first levels of the
+ *  layer, and is only freed with the whole array, because
+ *  the layers of some drivers share it.  Nothing has to be
+ *  done for an array that is not sparse.
+ ***********************************************************/
+void TextureArrays::ChangeLayerResidency(
+	GLuint textureID,
+	const TEXTURE_ARRAY& textureArray,
+	int layer,
+	int oldFirstLevel,
+	int newFirstLevel)
+{
+	if ((textureArray.bSparse == false) || (oldFirstLevel == newFirstLevel))
+	{
+		return;
+	}
+
+	bool bCommit = (newFirstLevel < oldFirstLevel);
+	int startLevel = bCommit ? newFirstLevel : oldFirstLevel;
+	int endLevel = bCommit ? oldFirstLevel : newFirstLevel;
+	if (endLevel > textureArray.sparseLevelCount)
+	{
+		endLevel = textureArray.sparseLevelCount;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+	for (int level = startLevel; level < endLevel; level++)
+	{
+		glTexPageCommitmentARB(
+			GL_TEXTURE_2D_ARRAY,
+			level,
+			0, 0, layer,
+			textureArray.width >> level,
+			textureArray.height >> level,
+			1,
+			bCommit ? GL_TRUE : GL_FALSE);
+	}
+
+	if ((bCommit == true) &&
+		(oldFirstLevel >= textureArray.levelCount) &&
+		(textureArray.sparseLevelCount < textureArray.levelCount))
+	{
+		int tailLevel = textureArray.sparseLevelCount;
+		int width = textureArray.width >> tailLevel;
+		int height = textureArray.height >> tailLevel;
+		glTexPageCommitmentARB(
+			GL_TEXTURE_2D_ARRAY,
+			tailLevel,
+			0, 0, layer,
+			(width > 0) ? width : 1,
+			(height > 0) ? height : 1,
+			1,
+			GL_TRUE);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  BindTextureArrays()
+ *
+ *  This method is used for binding every array to the texture
+ *  unit of its index, and for pointing the sampler array in
+ *  the shader at those units.
+ ***********************************************************/
+void TextureArrays::BindTextureArrays()
+{
+	int textureUnits[ShaderUniforms::MAX_TEXTURE_ARRAYS];
+
+	for (int i = 0; i < ShaderUniforms::MAX_TEXTURE_ARRAYS; i++)
+	{
+		textureUnits[i] = i;
+	}
+	for (int i = 0; i < (int)m_arrays.size(); i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_arrays[i].textureID);
+	}
+
+	if (NULL != m_pShaderUniforms)
+	{
+		m_pShaderUniforms->setSamplerArrayValue(
+			ShaderUniforms::UNIFORM_TEXTURE_ARRAYS,
+			textureUnits,
+			ShaderUniforms::MAX_TEXTURE_ARRAYS);
+	}
+
+	UploadLocations();
+}
+
+/***********************************************************
+ *  UploadLocations()
+ *
+ *  This method is used for uploading the texture location
+ *  table after textures have been added or stored.
+ ***********************************************************/
+void TextureArrays::UploadLocations()
+{
+	if ((m_bLocationsChanged == false) || (NULL == m_pShaderUniforms))
+	{
+		return;
+	}
+
+	m_pShaderUniforms->UploadTextureBlock(m_locations.data(), (int)m_locations.size());
+	m_bLocationsChanged = false;
+}
+
+/***********************************************************
+ *  GetArrayTextureID()
+ *
+ *  This method is used for getting the OpenGL ID of the array
+ *  texture that currently holds the passed in texture.
+ ***********************************************************/
+GLuint TextureArrays::GetArrayTextureID(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(0);
+	}
+
+	return(m_arrays[m_locations[textureHandle].arrayIndex].textureID);
+}
+
+/***********************************************************
+ *  IsTextureStored()
+ *
+ *  This method is used for checking whether the image of a
+ *  texture has been stored, instead of the placeholder.
+ ***********************************************************/
+bool TextureArrays::IsTextureStored(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(false);
+	}
+
+	return(m_locations[textureHandle].arrayIndex > 0);
+}
+
+/***********************************************************
+ *  GetTextureWidth() / GetTextureHeight()
+ *
+ *  These methods are used for getting the size of the first
+ *  level of the image of a texture, 1 for the placeholder.
+ ***********************************************************/
+int TextureArrays::GetTextureWidth(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(0);
+	}
+
+	return(m_arrays[m_locations[textureHandle].arrayIndex].width);
+}
+
+int TextureArrays::GetTextureHeight(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(0);
+	}
+
+	return(m_arrays[m_locations[textureHandle].arrayIndex].height);
+}
+
+/***********************************************************
+ *  GetTextureLevelCount()
+ *
+ *  This method is used for getting the number of mipmap
+ *  levels of the image of a texture.
+ ***********************************************************/
+int TextureArrays::GetTextureLevelCount(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(0);
+	}
+
+	return(m_arrays[m_locations[textureHandle].arrayIndex].levelCount);
+}
+
+/***********************************************************
+ *  GetTextureFirstLevel()
+ *
+ *  This method is used for getting the finest mipmap level of
+ *  a texture that holds its image.
+ ***********************************************************/
+int TextureArrays::GetTextureFirstLevel(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_locations.size()))
+	{
+		return(0);
+	}
+
+	return(m_locations[textureHandle].firstLevel);
+}
+
+/***********************************************************
+ *  GetTextureBytes()
+ *
+ *  This method is used for getting the video memory that the
+ *  levels of a stored texture from firstLevel on take.
+ ***********************************************************/
+size_t TextureArrays::GetTextureBytes(int textureHandle, int firstLevel) const
+{
+	if (IsTextureStored(textureHandle) == false)
+	{
+		return(0);
+	}
+
+	const TEXTURE_ARRAY& textureArray = m_arrays[m_locations[textureHandle].arrayIndex];
+	size_t textureBytes = 0;
+	for (int level = (firstLevel > 0) ? firstLevel : 0; level < textureArray.levelCount; level++)
+	{
+		textureBytes += GetLevelBytes(textureArray, level);
+	}
+
+	return(textureBytes);
+}
+
+/***********************************************************
+ *  GetLevelBytes()
+ *
+ *  This method is used for getting the size of one mipmap
+ *  level of an array layer.  The compressed formats are
+ *  stored in blocks of 4x4 texels, and the uncompressed ones
+ *  take 4 bytes per texel, because the drivers pad RGB8 to
+ *  RGBA8.
+ ***********************************************************/
+size_t TextureArrays::GetLevelBytes(const TEXTURE_ARRAY& textureArray, int level)
+{
+	size_t width = (size_t)(textureArray.width >> level);
+	size_t height = (size_t)(textureArray.height >> level);
+	if (width < 1)
+	{
+		width = 1;
+	}
+	if (height < 1)
+	{
+		height = 1;
+	}
+
+	switch (textureArray.internalFormat)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		return(((width + 3) / 4) * ((height + 3) / 4) * 8);
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		return(((width + 3) / 4) * ((height + 3) / 4) * 16);
+	default:
+		return(width * height * 4);
+	}
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the memory of all the
+ *  array textures, with all their committed pages.
+ ***********************************************************/
+void TextureArrays::Destroy()
+{
+	for (int i = 0; i < (int)m_arrays.size(); i++)
+	{
+		if (0 != m_arrays[i].textureID)
+		{
+			glDeleteTextures(1, &m_arrays[i].textureID);
+			m_arrays[i].textureID = 0;
+		}
+	}
+	m_arrays.clear();
+	m_locations.clear();
+	m_bLocationsChanged = false;
+}
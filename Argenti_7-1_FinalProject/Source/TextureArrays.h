@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearrays.h
+// ============
+// pack the scene textures into texture arrays of the same size and format
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderUniforms.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  TextureArrays
+ *
+ *  This class keeps all the scene textures as layers of a
+ *  few GL_TEXTURE_2D_ARRAY textures, one for every size and
+ *  format.  The arrays stay bound to their texture units, and
+ *  a texture is selected in the shader by its handle, which
+ *  is looked up in the texture location table.  A texture
+ *  shows the placeholder layer until its image is stored.
+ *  The finest levels of a layer can be left out, and the
+ *  shader then samples the texture no finer than the first
+ *  level that holds the image.  With sparse texture support
+ *  the pages of the left out levels are not committed, so
+ *  they do not take any video memory.
+ ***********************************************************/
+class TextureArrays
+{
+public:
+	// constructor
+	TextureArrays(ShaderUniforms* pShaderUniforms);
+	// destructor
+	~TextureArrays();
+
+private:
+	struct TEXTURE_ARRAY
+	{
+		GLuint textureID;
+		int width;
+		int height;
+		GLenum internalFormat;
+		int levelCount;
+		int layerCount;
+		int layerCapacity;
+		// true when the pages of the levels are committed per layer,
+		// for the levels before the mip tail
+		bool bSparse;
+		int sparseLevelCount;
+	};
+
+	// pointer to the shader uniforms the tables are uploaded with
+	ShaderUniforms* m_pShaderUniforms;
+	// the texture arrays, the array index is also the texture unit
+	std::vector<TEXTURE_ARRAY> m_arrays;
+	// array and layer of every texture handle
+	std::vector<ShaderUniforms::TEXTURE_LOCATION> m_locations;
+	// true when the location table has to be uploaded again
+	bool m_bLocationsChanged;
+	// most layers the driver supports in one array
+	int m_maxLayers;
+	// true when the driver supports sparse textures
+	bool m_bSparseSupported;
+
+	// create the array that holds the placeholder layer
+	void CreatePlaceholderArray();
+	// find or create the array for a size and format
+	int FindArray(int width, int height, GLenum internalFormat, int levelCount);
+	// copy the mipmap levels of a loaded texture into an array layer
+	void CopyLevels(
+		GLuint sourceTexture,
+		const TEXTURE_ARRAY& textureArray,
+		int layer,
+		int firstLevel);
+	// commit or free the pages of the levels of a layer that change
+	// between the two first levels
+	void ChangeLayerResidency(
+		GLuint textureID,
+		const TEXTURE_ARRAY& textureArray,
+		int layer,
+		int oldFirstLevel,
+		int newFirstLevel);
+	// make room for one more layer in an array
+	bool GrowArray(int arrayIndex);
+	// create the storage of an array texture
+	GLuint CreateArrayTexture(TEXTURE_ARRAY& textureArray, int layerCapacity);
+
+	// size of one mipmap level of an array
+	static size_t GetLevelBytes(const TEXTURE_ARRAY& textureArray, int level);
+
+public:
+	// add a texture that shows the placeholder until it is stored
+	int AddTexture();
+	// copy the mipmap levels of a loaded texture from firstLevel on
+	// into an array layer
+	bool StoreTexture(
+		int textureHandle,
+		GLuint sourceTexture,
+		int width,
+		int height,
+		GLenum internalFormat,
+		int levelCount,
+		int firstLevel = 0);
+	// leave out the levels of a texture before firstLevel
+	bool EvictLevels(int textureHandle, int firstLevel);
+
+	// bind the arrays to their texture units and set the samplers
+	void BindTextureArrays();
+	// upload the location table when it has changed
+	void UploadLocations();
+
+	// get the array texture that holds a texture
+	GLuint GetArrayTextureID(int textureHandle) const;
+	// true once the image of a texture has been stored
+	bool IsTextureStored(int textureHandle) const;
+	// size and levels of the image of a stored texture
+	int GetTextureWidth(int textureHandle) const;
+	int GetTextureHeight(int textureHandle) const;
+	int GetTextureLevelCount(int textureHandle) const;
+	// finest level of a texture that holds its image
+	int GetTextureFirstLevel(int textureHandle) const;
+	// video memory of the levels of a texture from firstLevel on
+	size_t GetTextureBytes(int textureHandle, int firstLevel) const;
+	// true when the left out levels free their video memory
+	bool IsSparse() const { return m_bSparseSupported; }
+	// number of added textures
+	int GetTextureCount() const { return (int)m_locations.size(); }
+	// number of created arrays
+	int GetArrayCount() const { return (int)m_arrays.size(); }
+
+	// free all the arrays
+	void Destroy();
+};
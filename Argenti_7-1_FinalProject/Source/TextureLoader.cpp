@@ -0,0 +1,532 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode texture images on worker threads and upload them on the GL thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+
+#include "stb_image.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables and defines
+namespace
+{
+	// the staging buffer is split into slots, so the next image can
+	// be copied while the previous upload is still in flight
+	const int g_StagingSlotCount = 2;
+	const GLsizeiptr g_StagingSlotSize = 16 * 1024 * 1024;
+	// most decode threads that are started
+	const unsigned int g_MaxWorkerThreads = 4;
+	// texture unit the loaded textures are bound to while they are
+	// uploaded, above the units that are used for rendering
+	const int g_UploadTextureUnit = 31;
+
+	/***********************************************************
+	 *  CountMipmapLevels()
+	 *
+	 *  This function is used for getting the number of mipmap
+	 *  levels down to 1x1 for an image size.
+	 ***********************************************************/
+	int CountMipmapLevels(int width, int height)
+	{
+		int levelCount = 1;
+
+		for (int size = (width > height) ? width : height; size > 1; size /= 2)
+		{
+			levelCount++;
+		}
+
+		return(levelCount);
+	}
+
+	/***********************************************************
+	 *  CreateUploadTexture()
+	 *
+	 *  This function is used for creating the 2D texture a
+	 *  loaded image is uploaded into, and for binding it to the
+	 *  upload texture unit.
+	 ***********************************************************/
+	GLuint CreateUploadTexture()
+	{
+		GLuint textureID = 0;
+
+		glGenTextures(1, &textureID);
+		glActiveTexture(GL_TEXTURE0 + g_UploadTextureUnit);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+
+		// set texture filtering parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		return(textureID);
+	}
+}
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLoader::TextureLoader()
+{
+	m_bStopWorkers = false;
+	m_pendingCount = 0;
+	m_stagingBuffer = 0;
+	m_pStagingMemory = NULL;
+	m_nextStagingSlot = 0;
+	m_bStagingChecked = false;
+
+	// the flip setting is global in stb_image, so it is set once
+	// before any of the worker threads start decoding
+	stbi_set_flip_vertically_on_load(true);
+
+	// leave one core for the GL thread
+	unsigned int workerCount = std::thread::hardware_concurrency();
+	if (workerCount > 1)
+	{
+		workerCount--;
+	}
+	if (workerCount < 1)
+	{
+		workerCount = 1;
+	}
+	if (workerCount > g_MaxWorkerThreads)
+	{
+		workerCount = g_MaxWorkerThreads;
+	}
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureLoader::WorkerThread, this));
+	}
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	// stop the worker threads - images that are still being
+	// decoded are finished first
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_bStopWorkers = true;
+		m_requests.clear();
+	}
+	m_requestAvailable.notify_all();
+	for (int i = 0; i < (int)m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+
+	// free the images that were never uploaded
+	while (m_decodedImages.empty() == false)
+	{
+		FreeImage(m_decodedImages.front());
+		m_decodedImages.pop_front();
+	}
+
+	// free the staging buffer
+	for (int i = 0; i < (int)m_stagingSlots.size(); i++)
+	{
+		if (NULL != m_stagingSlots[i].fence)
+		{
+			glDeleteSync(m_stagingSlots[i].fence);
+			m_stagingSlots[i].fence = NULL;
+		}
+	}
+	if (0 != m_stagingBuffer)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &m_stagingBuffer);
+		m_stagingBuffer = 0;
+		m_pStagingMemory = NULL;
+	}
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method is run by every worker thread.  It takes the
+ *  next load request, decodes the image file, and hands the
+ *  pixels over to the GL thread.
+ ***********************************************************/
+void TextureLoader::WorkerThread()
+{
+	while (true)
+	{
+		LOAD_REQUEST request;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			while ((m_bStopWorkers == false) && (m_requests.empty() == true))
+			{
+				m_requestAvailable.wait(lock);
+			}
+			if (m_bStopWorkers == true)
+			{
+				return;
+			}
+			request = m_requests.front();
+			m_requests.pop_front();
+		}
+
+		DECODED_IMAGE image;
+		image.request = request;
+		image.width = 0;
+		image.height = 0;
+		image.colorChannels = 0;
+		image.pixels = NULL;
+		image.pCompressed = NULL;
+
+		// a baked compressed file only has to be mapped, so it
+		// is used instead of decoding the image when it exists
+		if (request.bUseBaked == true)
+		{
+			CompressedTexture* pCompressed = new CompressedTexture();
+			if (pCompressed->Load(CompressedTexture::GetBakedFilename(request.filename.c_str()).c_str()) == true)
+			{
+				image.pCompressed = pCompressed;
+			}
+			else
+			{
+				delete pCompressed;
+			}
+		}
+
+		if (NULL == image.pCompressed)
+		{
+			// try to parse the image data from the specified image file
+			image.pixels = stbi_load(
+				request.filename.c_str(),
+				&image.width,
+				&image.height,
+				&image.colorChannels,
+				0);
+		}
+
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_decodedImages.push_back(image);
+	}
+}
+
+/***********************************************************
+ *  RequestTexture()
+ *
+ *  This method is used for queueing an image file to be
+ *  decoded on a worker thread.  The passed in handle is
+ *  returned with the texture once it has been uploaded.  A
+ *  baked file is older than an image that was just edited,
+ *  so it can be skipped.  A streamed texture only asks for
+ *  the levels up to a size, and the larger levels of a baked
+ *  file are then never read.
+ ***********************************************************/
+void TextureLoader::RequestTexture(const char* filename, int textureHandle, bool bUseBaked, int maxSize)
+{
+	LOAD_REQUEST request;
+	request.filename = filename;
+	request.textureHandle = textureHandle;
+	// baked files can only be used when the driver decodes S3TC
+	request.bUseBaked = bUseBaked && (GLEW_EXT_texture_compression_s3tc != GL_FALSE);
+	request.maxSize = maxSize;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_requests.push_back(request);
+	}
+	m_requestAvailable.notify_one();
+	m_pendingCount++;
+}
+
+/***********************************************************
+ *  FindFirstLevel()
+ *
+ *  This method is used for getting the first mipmap level of
+ *  an image that is not larger than maxSize along either side.
+ *  The last level is returned when even that one is larger.
+ ***********************************************************/
+int TextureLoader::FindFirstLevel(int width, int height, int levelCount, int maxSize)
+{
+	int firstLevel = 0;
+
+	if (maxSize <= 0)
+	{
+		return(0);
+	}
+
+	while ((firstLevel < levelCount - 1) && ((width > maxSize) || (height > maxSize)))
+	{
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+		firstLevel++;
+	}
+
+	return(firstLevel);
+}
+
+/***********************************************************
+ *  ProcessCompletedLoads()
+ *
+ *  This method is used for uploading the images that have
+ *  finished decoding into new 2D textures, which are added to
+ *  the passed in list.  The caller owns the textures.  The
+ *  images that could not be loaded or uploaded are added as
+ *  failed loads, so the caller knows they are no longer
+ *  pending.  At most maxUploads images are uploaded per call,
+ *  so that a burst of finished images is spread over several
+ *  frames.
+ ***********************************************************/
+int TextureLoader::ProcessCompletedLoads(int maxUploads, std::vector<COMPLETED_LOAD>& completedLoads)
+{
+	int uploadCount = 0;
+
+	while ((uploadCount < maxUploads) && (m_pendingCount > 0))
+	{
+		DECODED_IMAGE image;
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			if (m_decodedImages.empty() == true)
+			{
+				break;
+			}
+			image = m_decodedImages.front();
+			m_decodedImages.pop_front();
+		}
+
+		COMPLETED_LOAD completedLoad;
+		bool bUploaded = false;
+		completedLoad.textureHandle = image.request.textureHandle;
+		completedLoad.textureID = 0;
+
+		if (NULL != image.pCompressed)
+		{
+			bUploaded = UploadCompressedImage(image, completedLoad);
+		}
+		else if (NULL != image.pixels)
+		{
+			std::cout << "Successfully loaded image:" << image.request.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+			bUploaded = UploadImage(image, completedLoad);
+		}
+		else
+		{
+			std::cout << "Could not load image:" << image.request.filename << std::endl;
+		}
+		FreeImage(image);
+
+		completedLoad.bFailed = (bUploaded == false);
+		completedLoads.push_back(completedLoad);
+
+		m_pendingCount--;
+		uploadCount++;
+	}
+
+	return(uploadCount);
+}
+
+/***********************************************************
+ *  CreateStagingBuffer()
+ *
+ *  This method is used for creating the pixel buffer that the
+ *  decoded images are copied into.  It stays mapped for the
+ *  lifetime of the loader.  Without buffer storage support the
+ *  images are uploaded straight from the decoded pixels.
+ ***********************************************************/
+bool TextureLoader::CreateStagingBuffer()
+{
+	const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	if (m_bStagingChecked == true)
+	{
+		return(NULL != m_pStagingMemory);
+	}
+	m_bStagingChecked = true;
+
+	if (!GLEW_ARB_buffer_storage)
+	{
+		std::cout << "Persistent pixel buffers are not supported, textures are uploaded directly" << std::endl;
+		return(false);
+	}
+
+	glGenBuffers(1, &m_stagingBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, g_StagingSlotSize * g_StagingSlotCount, NULL, mapFlags);
+	m_pStagingMemory = (unsigned char*)glMapBufferRange(
+		GL_PIXEL_UNPACK_BUFFER,
+		0,
+		g_StagingSlotSize * g_StagingSlotCount,
+		mapFlags);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (NULL == m_pStagingMemory)
+	{
+		std::cout << "Could not map the texture staging buffer, textures are uploaded directly" << std::endl;
+		glDeleteBuffers(1, &m_stagingBuffer);
+		m_stagingBuffer = 0;
+		return(false);
+	}
+
+	for (int i = 0; i < g_StagingSlotCount; i++)
+	{
+		STAGING_SLOT slot;
+		slot.offset = g_StagingSlotSize * i;
+		slot.fence = NULL;
+		m_stagingSlots.push_back(slot);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadImage()
+ *
+ *  This method is used for uploading a decoded image into a
+ *  new texture, and for generating the mipmaps.
+ ***********************************************************/
+bool TextureLoader::UploadImage(const DECODED_IMAGE& image, COMPLETED_LOAD& completedLoad)
+{
+	GLenum internalFormat = GL_RGB8;
+	GLenum pixelFormat = GL_RGB;
+	GLsizeiptr imageSize = (GLsizeiptr)image.width * image.height * image.colorChannels;
+	const void* pPixelData = image.pixels;
+	STAGING_SLOT* pSlot = NULL;
+
+	// if the loaded image is in RGB format
+	if (image.colorChannels == 3)
+	{
+		internalFormat = GL_RGB8;
+		pixelFormat = GL_RGB;
+	}
+	// if the loaded image is in RGBA format - it supports transparency
+	else if (image.colorChannels == 4)
+	{
+		internalFormat = GL_RGBA8;
+		pixelFormat = GL_RGBA;
+	}
+	else
+	{
+		std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+		return(false);
+	}
+
+	// copy the pixels into the next staging slot, after the
+	// upload that used the slot before has finished
+	if ((CreateStagingBuffer() == true) && (imageSize <= g_StagingSlotSize))
+	{
+		pSlot = &m_stagingSlots[m_nextStagingSlot];
+		m_nextStagingSlot = (m_nextStagingSlot + 1) % (int)m_stagingSlots.size();
+
+		if (NULL != pSlot->fence)
+		{
+			while (glClientWaitSync(pSlot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+			{
+			}
+			glDeleteSync(pSlot->fence);
+			pSlot->fence = NULL;
+		}
+
+		memcpy(m_pStagingMemory + pSlot->offset, image.pixels, imageSize);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+		// with a bound pixel buffer the data pointer is an offset into it
+		pPixelData = (const void*)pSlot->offset;
+	}
+
+	GLuint textureID = CreateUploadTexture();
+
+	// decoded RGB rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, pixelFormat, GL_UNSIGNED_BYTE, pPixelData);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// generate the texture mipmaps for mapping textures to lower resolutions
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	// the slot can be reused once the GPU has read the pixels
+	if (NULL != pSlot)
+	{
+		pSlot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	completedLoad.textureID = textureID;
+	completedLoad.width = image.width;
+	completedLoad.height = image.height;
+	completedLoad.internalFormat = internalFormat;
+	completedLoad.levelCount = CountMipmapLevels(image.width, image.height);
+	// the whole image had to be decoded, but only the requested
+	// levels are stored
+	completedLoad.firstLevel = FindFirstLevel(image.width, image.height, completedLoad.levelCount, image.request.maxSize);
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadCompressedImage()
+ *
+ *  This method is used for uploading the compressed mipmap
+ *  levels of a baked file into a new texture.  The blocks are
+ *  read by the driver straight from the mapped file, and no
+ *  mipmaps have to be generated.  Only the requested levels
+ *  are uploaded, so the pages of the larger levels are never
+ *  read from the disk.
+ ***********************************************************/
+bool TextureLoader::UploadCompressedImage(const DECODED_IMAGE& image, COMPLETED_LOAD& completedLoad)
+{
+	const std::vector<CompressedTexture::MIP_LEVEL>& levels = image.pCompressed->GetLevels();
+	int firstLevel = FindFirstLevel(levels[0].width, levels[0].height, (int)levels.size(), image.request.maxSize);
+
+	std::cout << "Successfully loaded baked image:" << image.request.filename << ", width:" << levels[0].width << ", height:" << levels[0].height << ", levels:" << levels.size() - firstLevel << " of " << levels.size() << std::endl;
+
+	GLuint textureID = CreateUploadTexture();
+
+	for (int level = firstLevel; level < (int)levels.size(); level++)
+	{
+		glCompressedTexImage2D(
+			GL_TEXTURE_2D,
+			level,
+			image.pCompressed->GetInternalFormat(),
+			levels[level].width,
+			levels[level].height,
+			0,
+			levels[level].imageSize,
+			levels[level].pData);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	completedLoad.textureID = textureID;
+	completedLoad.width = levels[0].width;
+	completedLoad.height = levels[0].height;
+	completedLoad.internalFormat = image.pCompressed->GetInternalFormat();
+	completedLoad.levelCount = (int)levels.size();
+	completedLoad.firstLevel = firstLevel;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used for freeing the decoded pixels or the
+ *  mapped baked file of an image.
+ ***********************************************************/
+void TextureLoader::FreeImage(DECODED_IMAGE& image)
+{
+	if (NULL != image.pixels)
+	{
+		stbi_image_free(image.pixels);
+		image.pixels = NULL;
+	}
+	if (NULL != image.pCompressed)
+	{
+		delete image.pCompressed;
+		image.pCompressed = NULL;
+	}
+}
@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode texture images on worker threads and upload them on the GL thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CompressedTexture.h"
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  This class decodes the texture image files on a pool of
+ *  worker threads.  Once an image is decoded, it is uploaded
+ *  on the GL thread through a persistently mapped pixel
+ *  buffer, so loading never blocks the rendering.  When
+ *  a baked compressed file exists for the image, its mipmap
+ *  levels are uploaded straight from the mapped file instead.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+	// constructor
+	TextureLoader();
+	// destructor
+	~TextureLoader();
+
+	// a texture that has been uploaded - the size and the level
+	// count are those of the whole image, and only the levels from
+	// firstLevel on hold the image.  A load that failed only holds
+	// its texture handle.
+	struct COMPLETED_LOAD
+	{
+		int textureHandle;
+		bool bFailed;
+		GLuint textureID;
+		int width;
+		int height;
+		GLenum internalFormat;
+		int levelCount;
+		int firstLevel;
+	};
+
+private:
+	struct LOAD_REQUEST
+	{
+		std::string filename;
+		int textureHandle;
+		// true to look for a baked compressed file first
+		bool bUseBaked;
+		// largest size of the first uploaded level, 0 for all levels
+		int maxSize;
+	};
+
+	struct DECODED_IMAGE
+	{
+		LOAD_REQUEST request;
+		unsigned char* pixels;
+		int width;
+		int height;
+		int colorChannels;
+		// mapped baked file, used instead of the pixels when found
+		CompressedTexture* pCompressed;
+	};
+
+	// one region of the staging buffer with the fence of its last upload
+	struct STAGING_SLOT
+	{
+		GLintptr offset;
+		GLsync fence;
+	};
+
+	// worker threads and the queues shared with them
+	std::vector<std::thread> m_workers;
+	std::mutex m_queueMutex;
+	std::condition_variable m_requestAvailable;
+	std::deque<LOAD_REQUEST> m_requests;
+	std::deque<DECODED_IMAGE> m_decodedImages;
+	bool m_bStopWorkers;
+	// requests that have not been uploaded yet
+	int m_pendingCount;
+
+	// persistently mapped pixel buffer for the uploads
+	GLuint m_stagingBuffer;
+	unsigned char* m_pStagingMemory;
+	std::vector<STAGING_SLOT> m_stagingSlots;
+	int m_nextStagingSlot;
+	bool m_bStagingChecked;
+
+	// decode the requested images until the loader is destroyed
+	void WorkerThread();
+	// create the persistently mapped staging buffer
+	bool CreateStagingBuffer();
+	// upload one decoded image into a new texture
+	bool UploadImage(const DECODED_IMAGE& image, COMPLETED_LOAD& completedLoad);
+	// upload the mipmap levels of a baked file into a new texture
+	bool UploadCompressedImage(const DECODED_IMAGE& image, COMPLETED_LOAD& completedLoad);
+	// free the pixels or the baked file of a decoded image
+	void FreeImage(DECODED_IMAGE& image);
+
+public:
+	// queue an image file to be loaded for a texture handle - the
+	// baked files are skipped when an edited image is reloaded, and
+	// the levels larger than maxSize are left out unless it is 0
+	void RequestTexture(const char* filename, int textureHandle, bool bUseBaked = true, int maxSize = 0);
+
+	// upload the images that have been decoded since the last call -
+	// must be called on the GL thread
+	int ProcessCompletedLoads(int maxUploads, std::vector<COMPLETED_LOAD>& completedLoads);
+
+	// number of requested textures that have not been uploaded yet
+	int GetPendingCount() const { return m_pendingCount; }
+
+	// get the first mipmap level of an image that is not larger
+	// than maxSize, 0 when maxSize is 0
+	static int FindFirstLevel(int width, int height, int levelCount, int maxSize);
+};
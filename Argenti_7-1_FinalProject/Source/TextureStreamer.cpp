@@ -0,0 +1,479 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.cpp
+// ============
+// stream the mipmap levels of the scene textures within a memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreamer.h"
+
+#include <climits>
+
+// declaration of global variables and defines
+namespace
+{
+	// largest size of the levels a texture is first loaded with
+	const int g_InitialTextureSize = 64;
+	// video memory the resident levels may take by default
+	const size_t g_DefaultBudgetBytes = 256 * 1024 * 1024;
+	// loads of finer levels that are queued per frame
+	const int g_StreamLoadsPerFrame = 2;
+}
+
+/***********************************************************
+ *  TextureStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureStreamer::TextureStreamer(TextureArrays* pTextureArrays, TextureLoader* pTextureLoader)
+{
+	m_pTextureArrays = pTextureArrays;
+	m_pTextureLoader = pTextureLoader;
+	// frame 0 stands for a texture that has never been drawn
+	m_frameNumber = 1;
+	m_budgetBytes = g_DefaultBudgetBytes;
+	m_bEnabled = true;
+	m_streamLoads = 0;
+	m_evictedLevels = 0;
+	m_streamedTextures = 0;
+	m_pendingLoads = 0;
+	m_residentBytes = 0;
+}
+
+/***********************************************************
+ *  ~TextureStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureStreamer::~TextureStreamer()
+{
+	// the arrays and the loader are owned by the scene manager
+	m_pTextureArrays = NULL;
+	m_pTextureLoader = NULL;
+	m_textures.clear();
+}
+
+/***********************************************************
+ *  GetTexture()
+ *
+ *  This method is used for getting the streamed texture of a
+ *  handle, NULL when no texture was added for it.
+ ***********************************************************/
+TextureStreamer::STREAMED_TEXTURE* TextureStreamer::GetTexture(int textureHandle)
+{
+	if ((textureHandle < 0) ||
+		(textureHandle >= (int)m_textures.size()) ||
+		(m_textures[textureHandle].filename.empty() == true))
+	{
+		return(NULL);
+	}
+
+	return(&m_textures[textureHandle]);
+}
+
+/***********************************************************
+ *  GetInitialLevel()
+ *
+ *  This method is used for getting the level a stored texture
+ *  was first loaded with.  The levels from there on are never
+ *  left out, so a texture always shows its image once it has
+ *  been loaded.
+ ***********************************************************/
+int TextureStreamer::GetInitialLevel(int textureHandle) const
+{
+	return(TextureLoader::FindFirstLevel(
+		m_pTextureArrays->GetTextureWidth(textureHandle),
+		m_pTextureArrays->GetTextureHeight(textureHandle),
+		m_pTextureArrays->GetTextureLevelCount(textureHandle),
+		g_InitialTextureSize));
+}
+
+/***********************************************************
+ *  GetLevelSize()
+ *
+ *  This method is used for getting the size of the larger
+ *  side of a level of a stored texture, which is the largest
+ *  size the loader is asked for to get the levels from there
+ *  on.
+ ***********************************************************/
+int TextureStreamer::GetLevelSize(int textureHandle, int firstLevel) const
+{
+	int width = m_pTextureArrays->GetTextureWidth(textureHandle);
+	int height = m_pTextureArrays->GetTextureHeight(textureHandle);
+	int levelSize = ((width > height) ? width : height) >> firstLevel;
+
+	return((levelSize > 0) ? levelSize : 1);
+}
+
+/***********************************************************
+ *  GetResidentBytes()
+ *
+ *  This method is used for adding up the video memory of the
+ *  resident levels of all the stored textures.
+ ***********************************************************/
+size_t TextureStreamer::GetResidentBytes() const
+{
+	size_t residentBytes = 0;
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		if (m_pTextureArrays->IsTextureStored(i) == true)
+		{
+			residentBytes += m_pTextureArrays->GetTextureBytes(i, m_pTextureArrays->GetTextureFirstLevel(i));
+		}
+	}
+
+	return(residentBytes);
+}
+
+/***********************************************************
+ *  GetPendingBytes()
+ *
+ *  This method is used for adding up the video memory that
+ *  the queued loads of finer levels are going to add, so that
+ *  it is kept free for them.
+ ***********************************************************/
+size_t TextureStreamer::GetPendingBytes() const
+{
+	size_t pendingBytes = 0;
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		const STREAMED_TEXTURE& texture = m_textures[i];
+		if ((texture.pendingLoads == 0) || (m_pTextureArrays->IsTextureStored(i) == false))
+		{
+			continue;
+		}
+
+		int firstLevel = m_pTextureArrays->GetTextureFirstLevel(i);
+		if (texture.requestedLevel < firstLevel)
+		{
+			pendingBytes +=
+				m_pTextureArrays->GetTextureBytes(i, texture.requestedLevel) -
+				m_pTextureArrays->GetTextureBytes(i, firstLevel);
+		}
+	}
+
+	return(pendingBytes);
+}
+
+/***********************************************************
+ *  EvictLeastRecentlyUsed()
+ *
+ *  This method is used for leaving out the finest resident
+ *  level of the texture that was drawn the longest time ago,
+ *  and the larger one of two that were drawn in the same
+ *  frame.  A texture drawn in this frame only gives up the
+ *  levels that are finer than it needs, unless bAllowUsed is
+ *  true.  The freed video memory is returned, 0 when no level
+ *  could be left out.
+ ***********************************************************/
+size_t TextureStreamer::EvictLeastRecentlyUsed(bool bAllowUsed)
+{
+	int victim = -1;
+	unsigned int victimFrame = 0;
+	size_t victimBytes = 0;
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		const STREAMED_TEXTURE& texture = m_textures[i];
+		if ((texture.filename.empty() == true) ||
+			(texture.pendingLoads > 0) ||
+			(m_pTextureArrays->IsTextureStored(i) == false))
+		{
+			continue;
+		}
+
+		int lowestLevel = GetInitialLevel(i);
+		if ((texture.lastUsedFrame == m_frameNumber) &&
+			(bAllowUsed == false) &&
+			(texture.usedLevel < lowestLevel))
+		{
+			lowestLevel = texture.usedLevel;
+		}
+
+		int firstLevel = m_pTextureArrays->GetTextureFirstLevel(i);
+		if (firstLevel >= lowestLevel)
+		{
+			continue;
+		}
+
+		size_t levelBytes =
+			m_pTextureArrays->GetTextureBytes(i, firstLevel) -
+			m_pTextureArrays->GetTextureBytes(i, firstLevel + 1);
+		if ((victim < 0) ||
+			(texture.lastUsedFrame < victimFrame) ||
+			((texture.lastUsedFrame == victimFrame) && (levelBytes > victimBytes)))
+		{
+			victim = i;
+			victimFrame = texture.lastUsedFrame;
+			victimBytes = levelBytes;
+		}
+	}
+
+	if (victim < 0)
+	{
+		return(0);
+	}
+
+	m_pTextureArrays->EvictLevels(victim, m_pTextureArrays->GetTextureFirstLevel(victim) + 1);
+	m_evictedLevels++;
+
+	return(victimBytes);
+}
+
+/***********************************************************
+ *  StreamNextTexture()
+ *
+ *  This method is used for queueing the load of the finer
+ *  levels of the texture drawn in this frame that misses the
+ *  most of the levels it needs.  The textures that were not
+ *  drawn in this frame give up their levels first, when the
+ *  new levels would not fit into the budget otherwise.
+ ***********************************************************/
+bool TextureStreamer::StreamNextTexture(size_t& residentBytes)
+{
+	int candidate = -1;
+	int candidateMissing = 0;
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		const STREAMED_TEXTURE& texture = m_textures[i];
+		if ((texture.filename.empty() == true) ||
+			(texture.pendingLoads > 0) ||
+			(texture.lastUsedFrame != m_frameNumber) ||
+			(m_pTextureArrays->IsTextureStored(i) == false))
+		{
+			continue;
+		}
+
+		int missingLevels = m_pTextureArrays->GetTextureFirstLevel(i) - texture.usedLevel;
+		if (missingLevels > candidateMissing)
+		{
+			candidate = i;
+			candidateMissing = missingLevels;
+		}
+	}
+
+	if (candidate < 0)
+	{
+		return(false);
+	}
+
+	STREAMED_TEXTURE& texture = m_textures[candidate];
+	int firstLevel = m_pTextureArrays->GetTextureFirstLevel(candidate);
+	size_t addedBytes =
+		m_pTextureArrays->GetTextureBytes(candidate, texture.usedLevel) -
+		m_pTextureArrays->GetTextureBytes(candidate, firstLevel);
+
+	while (residentBytes + GetPendingBytes() + addedBytes > m_budgetBytes)
+	{
+		size_t freedBytes = EvictLeastRecentlyUsed(false);
+		if (freedBytes == 0)
+		{
+			return(false);
+		}
+		residentBytes -= freedBytes;
+	}
+
+	texture.pendingLoads++;
+	m_pendingLoads++;
+	texture.requestedLevel = texture.usedLevel;
+	m_pTextureLoader->RequestTexture(
+		texture.filename.c_str(),
+		candidate,
+		true,
+		GetLevelSize(candidate, texture.usedLevel));
+	m_streamLoads++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture and queueing the
+ *  load of its small levels.  The whole image is loaded when
+ *  the streaming is disabled.
+ ***********************************************************/
+void TextureStreamer::AddTexture(int textureHandle, const char* filename)
+{
+	if ((textureHandle < 0) || (NULL == filename))
+	{
+		return;
+	}
+
+	if (textureHandle >= (int)m_textures.size())
+	{
+		STREAMED_TEXTURE emptyTexture = {};
+		m_textures.resize(textureHandle + 1, emptyTexture);
+	}
+
+	STREAMED_TEXTURE& texture = m_textures[textureHandle];
+	if (texture.filename.empty() == true)
+	{
+		m_streamedTextures++;
+	}
+	m_pendingLoads += 1 - texture.pendingLoads;
+	texture.filename = filename;
+	texture.wantedLevel = INT_MAX;
+	texture.usedLevel = INT_MAX;
+	texture.lastUsedFrame = 0;
+	texture.pendingLoads = 1;
+	texture.requestedLevel = 0;
+
+	m_pTextureLoader->RequestTexture(filename, textureHandle, true, (m_bEnabled == true) ? g_InitialTextureSize : 0);
+}
+
+/***********************************************************
+ *  ReloadTexture()
+ *
+ *  This method is used for loading the edited image of a
+ *  texture again, with the levels that it holds now.  The
+ *  baked files are skipped, because they still hold the old
+ *  image.
+ ***********************************************************/
+void TextureStreamer::ReloadTexture(int textureHandle, const char* filename)
+{
+	STREAMED_TEXTURE* pTexture = GetTexture(textureHandle);
+	int maxSize = 0;
+
+	if ((NULL != pTexture) && (m_bEnabled == true))
+	{
+		maxSize = g_InitialTextureSize;
+		if (m_pTextureArrays->IsTextureStored(textureHandle) == true)
+		{
+			pTexture->requestedLevel = m_pTextureArrays->GetTextureFirstLevel(textureHandle);
+			maxSize = GetLevelSize(textureHandle, pTexture->requestedLevel);
+		}
+	}
+	if (NULL != pTexture)
+	{
+		pTexture->pendingLoads++;
+		m_pendingLoads++;
+	}
+
+	m_pTextureLoader->RequestTexture(filename, textureHandle, false, maxSize);
+}
+
+/***********************************************************
+ *  CompleteLoad()
+ *
+ *  This method is used for noting that a load of a texture
+ *  has been stored in its array, or has failed.  Either way
+ *  the texture can be streamed and evicted again.
+ ***********************************************************/
+void TextureStreamer::CompleteLoad(int textureHandle)
+{
+	STREAMED_TEXTURE* pTexture = GetTexture(textureHandle);
+
+	if ((NULL != pTexture) && (pTexture->pendingLoads > 0))
+	{
+		pTexture->pendingLoads--;
+		m_pendingLoads--;
+	}
+}
+
+/***********************************************************
+ *  NoteTextureUse()
+ *
+ *  This method is used for asking for the levels of a texture
+ *  from level on, for one of the draws of this frame.  The
+ *  finest level that is asked for in a frame is streamed in.
+ ***********************************************************/
+void TextureStreamer::NoteTextureUse(int textureHandle, int level)
+{
+	STREAMED_TEXTURE* pTexture = GetTexture(textureHandle);
+
+	if (NULL == pTexture)
+	{
+		return;
+	}
+
+	if (level < 0)
+	{
+		level = 0;
+	}
+	if (level < pTexture->wantedLevel)
+	{
+		pTexture->wantedLevel = level;
+	}
+	pTexture->lastUsedFrame = m_frameNumber;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for leaving out the least recently
+ *  used levels while the resident levels take more than the
+ *  budget, and then queueing the loads of the finer levels
+ *  that the draws of this frame need.  The levels are stored
+ *  by the scene manager once the loads complete.
+ ***********************************************************/
+void TextureStreamer::Update()
+{
+	if (m_bEnabled == true)
+	{
+		for (int i = 0; i < (int)m_textures.size(); i++)
+		{
+			if (m_textures[i].lastUsedFrame == m_frameNumber)
+			{
+				m_textures[i].usedLevel = m_textures[i].wantedLevel;
+			}
+		}
+
+		// the levels finer than the draws need go first, and the
+		// textures in view only when that is not enough
+		size_t residentBytes = GetResidentBytes();
+		while (residentBytes + GetPendingBytes() > m_budgetBytes)
+		{
+			size_t freedBytes = EvictLeastRecentlyUsed(false);
+			if (freedBytes == 0)
+			{
+				freedBytes = EvictLeastRecentlyUsed(true);
+			}
+			if (freedBytes == 0)
+			{
+				break;
+			}
+			residentBytes -= freedBytes;
+		}
+
+		for (int i = 0; i < g_StreamLoadsPerFrame; i++)
+		{
+			if (StreamNextTexture(residentBytes) == false)
+			{
+				break;
+			}
+		}
+		m_residentBytes = residentBytes;
+	}
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		m_textures[i].wantedLevel = INT_MAX;
+	}
+	m_frameNumber++;
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for getting the counts of the streamed
+ *  textures and the video memory of their resident levels, as
+ *  the last Update() found them.  Without sparse textures the
+ *  left out levels are only no longer sampled, and still take
+ *  their memory.
+ ***********************************************************/
+TextureStreamer::STREAMING_STATS TextureStreamer::GetStats() const
+{
+	STREAMING_STATS stats = {};
+
+	stats.streamedTextures = m_streamedTextures;
+	stats.pendingLoads = m_pendingLoads;
+	stats.streamLoads = m_streamLoads;
+	stats.evictedLevels = m_evictedLevels;
+	stats.residentBytes = m_residentBytes;
+	stats.budgetBytes = m_budgetBytes;
+
+	return(stats);
+}
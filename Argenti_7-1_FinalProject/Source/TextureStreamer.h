@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.h
+// ============
+// stream the mipmap levels of the scene textures within a memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureArrays.h"
+#include "TextureLoader.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureStreamer
+ *
+ *  This class decides which mipmap levels of the scene
+ *  textures are kept in video memory.  Every texture starts
+ *  out with only its small levels, and the finer levels are
+ *  loaded on the worker threads of the texture loader once
+ *  the texture covers enough of the screen to show them.
+ *  When the resident levels take more than the budget, the
+ *  finest levels of the textures that were used the longest
+ *  time ago are left out again.
+ ***********************************************************/
+class TextureStreamer
+{
+public:
+	// constructor
+	TextureStreamer(TextureArrays* pTextureArrays, TextureLoader* pTextureLoader);
+	// destructor
+	~TextureStreamer();
+
+	// residency of the streamed textures
+	struct STREAMING_STATS
+	{
+		int streamedTextures;
+		// loads of finer levels that have not been stored yet
+		int pendingLoads;
+		int streamLoads;
+		// levels that were left out to stay within the budget
+		int evictedLevels;
+		size_t residentBytes;
+		size_t budgetBytes;
+	};
+
+private:
+	struct STREAMED_TEXTURE
+	{
+		std::string filename;
+		// finest level that was asked for in this frame
+		int wantedLevel;
+		// the finest level that was asked for in the last frame the
+		// texture was drawn
+		int usedLevel;
+		unsigned int lastUsedFrame;
+		// level of the loads that have not been stored yet
+		int pendingLoads;
+		int requestedLevel;
+	};
+
+	// pointers to the arrays and the loader of the scene textures
+	TextureArrays* m_pTextureArrays;
+	TextureLoader* m_pTextureLoader;
+	// the streamed textures, indexed by their handle
+	std::vector<STREAMED_TEXTURE> m_textures;
+	unsigned int m_frameNumber;
+	size_t m_budgetBytes;
+	bool m_bEnabled;
+	int m_streamLoads;
+	int m_evictedLevels;
+	// counted as the textures are added and loaded, so that the
+	// stats do not have to go over all the textures
+	int m_streamedTextures;
+	int m_pendingLoads;
+	// resident levels as of the last Update()
+	size_t m_residentBytes;
+
+	// get a streamed texture, NULL when the handle is not streamed
+	STREAMED_TEXTURE* GetTexture(int textureHandle);
+	// coarsest level that a stored texture is allowed to fall back to
+	int GetInitialLevel(int textureHandle) const;
+	// largest size of the levels of a texture from firstLevel on
+	int GetLevelSize(int textureHandle, int firstLevel) const;
+	// video memory of the resident levels and of the pending loads
+	size_t GetResidentBytes() const;
+	size_t GetPendingBytes() const;
+	// leave out the finest level of the least recently used texture,
+	// the textures drawn in this frame only when bAllowUsed is true
+	size_t EvictLeastRecentlyUsed(bool bAllowUsed);
+	// queue the load of the finer levels of the texture that misses
+	// the most of them, false when nothing fits into the budget
+	bool StreamNextTexture(size_t& residentBytes);
+
+public:
+	// add a texture and load its small levels
+	void AddTexture(int textureHandle, const char* filename);
+	// load an edited image again with the levels that are resident
+	void ReloadTexture(int textureHandle, const char* filename);
+	// note that a load of a texture has been stored or has failed
+	void CompleteLoad(int textureHandle);
+
+	// ask for the levels of a texture from level on in this frame
+	void NoteTextureUse(int textureHandle, int level);
+	// leave out and queue the levels for the uses of this frame -
+	// must be called on the GL thread once per frame
+	void Update();
+
+	// set the video memory that the resident levels may take
+	void SetBudget(size_t budgetBytes) { m_budgetBytes = budgetBytes; }
+	// load the whole images right away instead of streaming them -
+	// must be set before the first texture is added
+	void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+	bool IsEnabled() const { return m_bEnabled; }
+
+	// get the residency of the streamed textures as of the last
+	// Update()
+	STREAMING_STATS GetStats() const;
+};
@@ -0,0 +1,256 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// compose the model matrices of many objects at once with SIMD
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformKernel.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// declaration of global variables and defines
+namespace
+{
+	// instruction set picked on the first use, -1 until then
+	int g_InstructionSet = -1;
+
+	/***********************************************************
+	 *  HasAvx2()
+	 *
+	 *  This function is used for checking whether the CPU and
+	 *  the operating system support the AVX2 instructions and
+	 *  registers.
+	 ***********************************************************/
+	bool HasAvx2()
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int cpuInfo[4];
+
+		__cpuid(cpuInfo, 1);
+		// OSXSAVE and AVX, then the OS has to save the AVX registers
+		if (((cpuInfo[2] & (1 << 27)) == 0) || ((cpuInfo[2] & (1 << 28)) == 0))
+		{
+			return(false);
+		}
+		if ((_xgetbv(0) & 6) != 6)
+		{
+			return(false);
+		}
+		__cpuidex(cpuInfo, 7, 0);
+
+		return((cpuInfo[1] & (1 << 5)) != 0);
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		return(__builtin_cpu_supports("avx2") != 0);
+#else
+		return(false);
+#endif
+	}
+}
+
+/***********************************************************
+ *  TransformBatch()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformBatch::TransformBatch()
+{
+}
+
+/***********************************************************
+ *  ~TransformBatch()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransformBatch::~TransformBatch()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  GetInstructionSet()
+ *
+ *  This method is used for getting the instruction set that
+ *  the matrices are composed with.  AVX2 is only used when
+ *  its code was built and the CPU supports it.
+ ***********************************************************/
+TransformBatch::INSTRUCTION_SET TransformBatch::GetInstructionSet()
+{
+	if (g_InstructionSet >= 0)
+	{
+		return((INSTRUCTION_SET)g_InstructionSet);
+	}
+
+	INSTRUCTION_SET instructionSet = INSTRUCTIONS_SCALAR;
+#if defined(TRANSFORM_KERNEL_NEON)
+	instructionSet = INSTRUCTIONS_NEON;
+#elif defined(TRANSFORM_KERNEL_SSE2)
+	instructionSet = INSTRUCTIONS_SSE2;
+	if ((IsAvx2KernelBuilt() == true) && (HasAvx2() == true))
+	{
+		instructionSet = INSTRUCTIONS_AVX2;
+	}
+#endif
+	g_InstructionSet = (int)instructionSet;
+
+	return(instructionSet);
+}
+
+/***********************************************************
+ *  GetInstructionSetName()
+ *
+ *  This method is used for getting the name of the
+ *  instruction set, for the log.
+ ***********************************************************/
+const char* TransformBatch::GetInstructionSetName()
+{
+	switch (GetInstructionSet())
+	{
+	case INSTRUCTIONS_SSE2:
+		return("SSE2");
+	case INSTRUCTIONS_AVX2:
+		return("AVX2");
+	case INSTRUCTIONS_NEON:
+		return("NEON");
+	default:
+		return("scalar");
+	}
+}
+
+/***********************************************************
+ *  ComposeTransforms()
+ *
+ *  This method is used for composing the model matrices of
+ *  the objects in the passed in arrays.  The objects fill
+ *  the widest registers first, and the few that are left
+ *  over are composed one at a time.
+ ***********************************************************/
+void TransformBatch::ComposeTransforms(
+	const TRANSFORM_ARRAYS& transforms,
+	int count,
+	glm::mat4* pMatrices)
+{
+	if ((count <= 0) || (NULL == pMatrices))
+	{
+		return;
+	}
+
+	// glm keeps the 16 floats of a matrix column by column
+	float* pFloats = (float*)pMatrices;
+	int index = 0;
+
+	switch (GetInstructionSet())
+	{
+	case INSTRUCTIONS_AVX2:
+		ComposeTransformsAvx2(transforms, count, pFloats);
+		return;
+#if defined(TRANSFORM_KERNEL_SSE2)
+	case INSTRUCTIONS_SSE2:
+		index = ComposeRange<SSE2_LANES>(transforms, 0, count, pFloats);
+		break;
+#endif
+#if defined(TRANSFORM_KERNEL_NEON)
+	case INSTRUCTIONS_NEON:
+		index = ComposeRange<NEON_LANES>(transforms, 0, count, pFloats);
+		break;
+#endif
+	default:
+		break;
+	}
+
+	ComposeRange<SCALAR_LANES>(transforms, index, count, pFloats);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the objects from the
+ *  batch.  The arrays keep their memory for the next batch.
+ ***********************************************************/
+void TransformBatch::Clear()
+{
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_scaleZ.clear();
+	m_rotationX.clear();
+	m_rotationY.clear();
+	m_rotationZ.clear();
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making room for the passed in
+ *  number of objects in all the arrays.
+ ***********************************************************/
+void TransformBatch::Reserve(int count)
+{
+	m_scaleX.reserve(count);
+	m_scaleY.reserve(count);
+	m_scaleZ.reserve(count);
+	m_rotationX.reserve(count);
+	m_rotationY.reserve(count);
+	m_rotationZ.reserve(count);
+	m_positionX.reserve(count);
+	m_positionY.reserve(count);
+	m_positionZ.reserve(count);
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding the transformation values
+ *  of an object to the batch.  The returned index is the
+ *  position of its matrix in the composed array.
+ ***********************************************************/
+int TransformBatch::Add(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	m_scaleX.push_back(scaleXYZ.x);
+	m_scaleY.push_back(scaleXYZ.y);
+	m_scaleZ.push_back(scaleXYZ.z);
+	m_rotationX.push_back(XrotationDegrees);
+	m_rotationY.push_back(YrotationDegrees);
+	m_rotationZ.push_back(ZrotationDegrees);
+	m_positionX.push_back(positionXYZ.x);
+	m_positionY.push_back(positionXYZ.y);
+	m_positionZ.push_back(positionXYZ.z);
+
+	return((int)m_scaleX.size() - 1);
+}
+
+/***********************************************************
+ *  Compose()
+ *
+ *  This method is used for composing the matrices of all the
+ *  objects in the batch into the passed in array, which needs
+ *  room for one matrix per object.
+ ***********************************************************/
+void TransformBatch::Compose(glm::mat4* pMatrices) const
+{
+	if (m_scaleX.empty() == true)
+	{
+		return;
+	}
+
+	TRANSFORM_ARRAYS transforms;
+	transforms.pScaleX = &m_scaleX[0];
+	transforms.pScaleY = &m_scaleY[0];
+	transforms.pScaleZ = &m_scaleZ[0];
+	transforms.pRotationX = &m_rotationX[0];
+	transforms.pRotationY = &m_rotationY[0];
+	transforms.pRotationZ = &m_rotationZ[0];
+	transforms.pPositionX = &m_positionX[0];
+	transforms.pPositionY = &m_positionY[0];
+	transforms.pPositionZ = &m_positionZ[0];
+
+	ComposeTransforms(transforms, GetCount(), pMatrices);
+}
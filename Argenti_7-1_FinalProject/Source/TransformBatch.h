@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// compose the model matrices of many objects at once with SIMD
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TransformBatch
+ *
+ *  This class composes the translation * rotationX *
+ *  rotationY * rotationZ * scale model matrix of a batch of
+ *  objects.  The transformation values are kept as a
+ *  structure of arrays, so several objects are loaded into
+ *  the lanes of one SIMD register, and the matrix entries
+ *  are calculated in closed form from one sine and cosine
+ *  per axis instead of building and multiplying the five
+ *  matrices.  The matrices are written into one contiguous
+ *  array, ready to be copied into a buffer.  The widest
+ *  instruction set that the CPU supports is picked when the
+ *  first batch is composed - AVX2 or SSE2 on x86, NEON on
+ *  ARM64, and plain C++ everywhere else.
+ ***********************************************************/
+class TransformBatch
+{
+public:
+	// constructor
+	TransformBatch();
+	// destructor
+	~TransformBatch();
+
+	// instruction sets that the matrices can be composed with
+	enum INSTRUCTION_SET
+	{
+		INSTRUCTIONS_SCALAR = 0,
+		INSTRUCTIONS_SSE2,
+		INSTRUCTIONS_AVX2,
+		INSTRUCTIONS_NEON
+	};
+
+	// transformation values of the objects, one array per value,
+	// with the rotations in degrees
+	struct TRANSFORM_ARRAYS
+	{
+		const float* pScaleX;
+		const float* pScaleY;
+		const float* pScaleZ;
+		const float* pRotationX;
+		const float* pRotationY;
+		const float* pRotationZ;
+		const float* pPositionX;
+		const float* pPositionY;
+		const float* pPositionZ;
+	};
+
+private:
+	// the transformation values added to the batch
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+
+public:
+	// compose the matrices of the objects in the passed in arrays
+	static void ComposeTransforms(
+		const TRANSFORM_ARRAYS& transforms,
+		int count,
+		glm::mat4* pMatrices);
+	// the instruction set that the matrices are composed with
+	static INSTRUCTION_SET GetInstructionSet();
+	static const char* GetInstructionSetName();
+
+	// remove the objects from the batch, keeping the memory
+	void Clear();
+	// make room for the passed in number of objects
+	void Reserve(int count);
+	// add the transformation values of an object, returns the
+	// index of its matrix
+	int Add(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// compose the matrices of all the objects in the batch
+	void Compose(glm::mat4* pMatrices) const;
+
+	int GetCount() const { return (int)m_scaleX.size(); }
+};
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatchavx2.cpp
+// ============
+// compose the model matrices of the transform batch with AVX2
+///////////////////////////////////////////////////////////////////////////////
+
+// this file is built with the AVX2 code generation option, and its
+// code is only called after the CPU has been checked for AVX2
+#include "TransformKernel.h"
+
+/***********************************************************
+ *  IsAvx2KernelBuilt()
+ *
+ *  This function is used for checking whether this file was
+ *  built with the AVX2 instructions enabled.
+ ***********************************************************/
+bool IsAvx2KernelBuilt()
+{
+#if defined(TRANSFORM_KERNEL_AVX2)
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  ComposeTransformsAvx2()
+ *
+ *  This function is used for composing the matrices of the
+ *  objects in the full AVX registers, eight at a time.  The
+ *  objects that are left over are composed four at a time
+ *  and then one at a time.
+ ***********************************************************/
+void ComposeTransformsAvx2(
+	const TransformBatch::TRANSFORM_ARRAYS& transforms,
+	int count,
+	float* pMatrices)
+{
+#if defined(TRANSFORM_KERNEL_AVX2)
+	int index = ComposeRange<AVX2_LANES>(transforms, 0, count, pMatrices);
+	index = ComposeRange<SSE2_LANES>(transforms, index, count, pMatrices);
+	ComposeRange<SCALAR_LANES>(transforms, index, count, pMatrices);
+#else
+	ComposeRange<SCALAR_LANES>(transforms, 0, count, pMatrices);
+#endif
+}
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformkernel.h
+// ============
+// SIMD lanes and the closed form matrix kernel of the transform batch
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformBatch.h"
+
+#include <cmath>
+
+// the instruction sets that the compiler allows in the including
+// file - the AVX2 lanes are only compiled in TransformBatchAvx2.cpp,
+// which is built with the AVX2 code generation option
+#if defined(__AVX2__)
+#define TRANSFORM_KERNEL_AVX2
+#include <immintrin.h>
+#endif
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define TRANSFORM_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+#if (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+#define TRANSFORM_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+// check whether the AVX2 lanes were built into the program
+bool IsAvx2KernelBuilt();
+// compose the matrices with the AVX2 lanes
+void ComposeTransformsAvx2(
+	const TransformBatch::TRANSFORM_ARRAYS& transforms,
+	int count,
+	float* pMatrices);
+
+// everything below is compiled separately into each file that
+// includes it, so the code that was generated for one instruction
+// set is never shared with a file built for another one - the
+// kernel also only writes plain floats for the same reason
+namespace
+{
+	// floats in one matrix of the output array
+	const int MATRIX_FLOATS = 16;
+
+	// the polynomials of the sine and the cosine between -45 and
+	// 45 degrees (minimax coefficients from the Cephes library)
+	const float g_SinCoefficient1 = -1.6666654611e-1f;
+	const float g_SinCoefficient2 = 8.3321608736e-3f;
+	const float g_SinCoefficient3 = -1.9515295891e-4f;
+	const float g_CosCoefficient1 = 4.166664568298827e-2f;
+	const float g_CosCoefficient2 = -1.388731625493765e-3f;
+	const float g_CosCoefficient3 = 2.443315711809948e-5f;
+	const float g_RadiansPerDegree = 0.017453292519943296f;
+
+	/***********************************************************
+	 *  SCALAR_LANES
+	 *
+	 *  One object at a time in plain C++, used for the objects
+	 *  that are left over after the last full register and on
+	 *  the CPUs without a supported instruction set.
+	 ***********************************************************/
+	struct SCALAR_LANES
+	{
+		typedef float VALUE;
+		static const int WIDTH = 1;
+
+		static VALUE Load(const float* pValues) { return *pValues; }
+		static VALUE Set(float value) { return value; }
+		static VALUE Add(VALUE a, VALUE b) { return a + b; }
+		static VALUE Sub(VALUE a, VALUE b) { return a - b; }
+		static VALUE Mul(VALUE a, VALUE b) { return a * b; }
+		static VALUE Round(VALUE value) { return std::floor(value + 0.5f); }
+		// a where the bit is set in the whole number, b where it is not
+		static VALUE Select(VALUE wholeNumber, int bit, VALUE a, VALUE b)
+		{
+			return ((((int)wholeNumber) & bit) != 0) ? a : b;
+		}
+		// write the columns of the matrices
+		static void Store(VALUE columns[4][4], float* pMatrices)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					pMatrices[column * 4 + row] = columns[column][row];
+				}
+			}
+		}
+	};
+
+#if defined(TRANSFORM_KERNEL_SSE2)
+	/***********************************************************
+	 *  SSE2_LANES
+	 *
+	 *  Four objects at a time in the SSE registers.
+	 ***********************************************************/
+	struct SSE2_LANES
+	{
+		typedef __m128 VALUE;
+		static const int WIDTH = 4;
+
+		static VALUE Load(const float* pValues) { return _mm_loadu_ps(pValues); }
+		static VALUE Set(float value) { return _mm_set1_ps(value); }
+		static VALUE Add(VALUE a, VALUE b) { return _mm_add_ps(a, b); }
+		static VALUE Sub(VALUE a, VALUE b) { return _mm_sub_ps(a, b); }
+		static VALUE Mul(VALUE a, VALUE b) { return _mm_mul_ps(a, b); }
+		// the conversion rounds to the nearest number by default
+		static VALUE Round(VALUE value) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(value)); }
+		static VALUE Select(VALUE wholeNumber, int bit, VALUE a, VALUE b)
+		{
+			__m128i bits = _mm_set1_epi32(bit);
+			__m128i masked = _mm_and_si128(_mm_cvtps_epi32(wholeNumber), bits);
+			__m128 mask = _mm_castsi128_ps(_mm_cmpeq_epi32(masked, bits));
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+		// write one column of four matrices, the registers hold
+		// the rows of the column for each of the objects
+		static void StoreColumn(__m128 x, __m128 y, __m128 z, __m128 w, float* pColumn)
+		{
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(pColumn, x);
+			_mm_storeu_ps(pColumn + MATRIX_FLOATS, y);
+			_mm_storeu_ps(pColumn + MATRIX_FLOATS * 2, z);
+			_mm_storeu_ps(pColumn + MATRIX_FLOATS * 3, w);
+		}
+		static void Store(VALUE columns[4][4], float* pMatrices)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				StoreColumn(
+					columns[column][0], columns[column][1], columns[column][2], columns[column][3],
+					pMatrices + column * 4);
+			}
+		}
+	};
+#endif
+
+#if defined(TRANSFORM_KERNEL_AVX2)
+	/***********************************************************
+	 *  AVX2_LANES
+	 *
+	 *  Eight objects at a time in the AVX registers.
+	 ***********************************************************/
+	struct AVX2_LANES
+	{
+		typedef __m256 VALUE;
+		static const int WIDTH = 8;
+
+		static VALUE Load(const float* pValues) { return _mm256_loadu_ps(pValues); }
+		static VALUE Set(float value) { return _mm256_set1_ps(value); }
+		static VALUE Add(VALUE a, VALUE b) { return _mm256_add_ps(a, b); }
+		static VALUE Sub(VALUE a, VALUE b) { return _mm256_sub_ps(a, b); }
+		static VALUE Mul(VALUE a, VALUE b) { return _mm256_mul_ps(a, b); }
+		static VALUE Round(VALUE value) { return _mm256_round_ps(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static VALUE Select(VALUE wholeNumber, int bit, VALUE a, VALUE b)
+		{
+			__m256i bits = _mm256_set1_epi32(bit);
+			__m256i masked = _mm256_and_si256(_mm256_cvtps_epi32(wholeNumber), bits);
+			return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(_mm256_cmpeq_epi32(masked, bits)));
+		}
+		// the matrices are written four at a time from the two
+		// halves of the registers
+		static void Store(VALUE columns[4][4], float* pMatrices)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				SSE2_LANES::StoreColumn(
+					_mm256_castps256_ps128(columns[column][0]),
+					_mm256_castps256_ps128(columns[column][1]),
+					_mm256_castps256_ps128(columns[column][2]),
+					_mm256_castps256_ps128(columns[column][3]),
+					pMatrices + column * 4);
+				SSE2_LANES::StoreColumn(
+					_mm256_extractf128_ps(columns[column][0], 1),
+					_mm256_extractf128_ps(columns[column][1], 1),
+					_mm256_extractf128_ps(columns[column][2], 1),
+					_mm256_extractf128_ps(columns[column][3], 1),
+					pMatrices + MATRIX_FLOATS * 4 + column * 4);
+			}
+		}
+	};
+#endif
+
+#if defined(TRANSFORM_KERNEL_NEON)
+	/***********************************************************
+	 *  NEON_LANES
+	 *
+	 *  Four objects at a time in the NEON registers.
+	 ***********************************************************/
+	struct NEON_LANES
+	{
+		typedef float32x4_t VALUE;
+		static const int WIDTH = 4;
+
+		static VALUE Load(const float* pValues) { return vld1q_f32(pValues); }
+		static VALUE Set(float value) { return vdupq_n_f32(value); }
+		static VALUE Add(VALUE a, VALUE b) { return vaddq_f32(a, b); }
+		static VALUE Sub(VALUE a, VALUE b) { return vsubq_f32(a, b); }
+		static VALUE Mul(VALUE a, VALUE b) { return vmulq_f32(a, b); }
+		static VALUE Round(VALUE value) { return vrndnq_f32(value); }
+		static VALUE Select(VALUE wholeNumber, int bit, VALUE a, VALUE b)
+		{
+			uint32x4_t mask = vtstq_s32(vcvtnq_s32_f32(wholeNumber), vdupq_n_s32(bit));
+			return vbslq_f32(mask, a, b);
+		}
+		static void Store(VALUE columns[4][4], float* pMatrices)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				// interleave the rows into (x0 y0 x1 y1) (x2 y2 x3 y3)
+				// and (z0 w0 z1 w1) (z2 w2 z3 w3), then pair the halves
+				float32x4x2_t xy = vzipq_f32(columns[column][0], columns[column][1]);
+				float32x4x2_t zw = vzipq_f32(columns[column][2], columns[column][3]);
+				float* pColumn = pMatrices + column * 4;
+				vst1q_f32(pColumn, vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0])));
+				vst1q_f32(pColumn + MATRIX_FLOATS, vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0])));
+				vst1q_f32(pColumn + MATRIX_FLOATS * 2, vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1])));
+				vst1q_f32(pColumn + MATRIX_FLOATS * 3, vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1])));
+			}
+		}
+	};
+#endif
+
+	/***********************************************************
+	 *  SinCos()
+	 *
+	 *  This function is used for calculating the sine and the
+	 *  cosine of angles in degrees.  The angle is reduced to
+	 *  the nearest quarter turn, which is exact in degrees,
+	 *  and the rest between -45 and 45 degrees is fed into the
+	 *  two polynomials.  The quarter turn then picks which of
+	 *  the two results is the sine and which sign it gets.
+	 ***********************************************************/
+	template <typename LANES>
+	void SinCos(
+		typename LANES::VALUE degrees,
+		typename LANES::VALUE& sine,
+		typename LANES::VALUE& cosine)
+	{
+		typedef typename LANES::VALUE VALUE;
+
+		const VALUE zero = LANES::Set(0.0f);
+		const VALUE one = LANES::Set(1.0f);
+
+		VALUE quarter = LANES::Round(LANES::Mul(degrees, LANES::Set(1.0f / 90.0f)));
+		VALUE angle = LANES::Mul(
+			LANES::Sub(degrees, LANES::Mul(quarter, LANES::Set(90.0f))),
+			LANES::Set(g_RadiansPerDegree));
+		VALUE angle2 = LANES::Mul(angle, angle);
+
+		// sin(a) = a + a^3 * (s1 + a^2 * (s2 + a^2 * s3))
+		VALUE polynomial = LANES::Add(LANES::Set(g_SinCoefficient2), LANES::Mul(angle2, LANES::Set(g_SinCoefficient3)));
+		polynomial = LANES::Add(LANES::Set(g_SinCoefficient1), LANES::Mul(angle2, polynomial));
+		VALUE sinAngle = LANES::Add(angle, LANES::Mul(LANES::Mul(angle, angle2), polynomial));
+
+		// cos(a) = 1 - a^2 / 2 + a^4 * (c1 + a^2 * (c2 + a^2 * c3))
+		polynomial = LANES::Add(LANES::Set(g_CosCoefficient2), LANES::Mul(angle2, LANES::Set(g_CosCoefficient3)));
+		polynomial = LANES::Add(LANES::Set(g_CosCoefficient1), LANES::Mul(angle2, polynomial));
+		VALUE cosAngle = LANES::Add(
+			LANES::Sub(one, LANES::Mul(angle2, LANES::Set(0.5f))),
+			LANES::Mul(LANES::Mul(angle2, angle2), polynomial));
+
+		// an odd quarter turn swaps the sine and the cosine, the sine
+		// is negative in quarters 2 and 3 and the cosine in 1 and 2
+		VALUE sinValue = LANES::Select(quarter, 1, cosAngle, sinAngle);
+		VALUE cosValue = LANES::Select(quarter, 1, sinAngle, cosAngle);
+		sine = LANES::Select(quarter, 2, LANES::Sub(zero, sinValue), sinValue);
+		cosine = LANES::Select(LANES::Add(quarter, one), 2, LANES::Sub(zero, cosValue), cosValue);
+	}
+
+	/***********************************************************
+	 *  ComposeLanes()
+	 *
+	 *  This function is used for composing the matrices of one
+	 *  register full of objects.  With cX, sX the cosine and
+	 *  sine of the X rotation and so on, the rotation part of
+	 *  translation * rotationX * rotationY * rotationZ * scale
+	 *  has the columns
+	 *    (cY cZ, cX sZ + sX sY cZ, sX sZ - cX sY cZ) * scaleX
+	 *    (-cY sZ, cX cZ - sX sY sZ, sX cZ + cX sY sZ) * scaleY
+	 *    (sY, -sX cY, cX cY) * scaleZ
+	 *  and the last column is the position.
+	 ***********************************************************/
+	template <typename LANES>
+	void ComposeLanes(
+		const TransformBatch::TRANSFORM_ARRAYS& transforms,
+		int first,
+		float* pMatrices)
+	{
+		typedef typename LANES::VALUE VALUE;
+
+		VALUE sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCos<LANES>(LANES::Load(transforms.pRotationX + first), sinX, cosX);
+		SinCos<LANES>(LANES::Load(transforms.pRotationY + first), sinY, cosY);
+		SinCos<LANES>(LANES::Load(transforms.pRotationZ + first), sinZ, cosZ);
+
+		VALUE scaleX = LANES::Load(transforms.pScaleX + first);
+		VALUE scaleY = LANES::Load(transforms.pScaleY + first);
+		VALUE scaleZ = LANES::Load(transforms.pScaleZ + first);
+		VALUE zero = LANES::Set(0.0f);
+
+		VALUE sinXsinY = LANES::Mul(sinX, sinY);
+		VALUE cosXsinY = LANES::Mul(cosX, sinY);
+
+		VALUE columns[4][4];
+		columns[0][0] = LANES::Mul(LANES::Mul(cosY, cosZ), scaleX);
+		columns[0][1] = LANES::Mul(LANES::Add(LANES::Mul(cosX, sinZ), LANES::Mul(sinXsinY, cosZ)), scaleX);
+		columns[0][2] = LANES::Mul(LANES::Sub(LANES::Mul(sinX, sinZ), LANES::Mul(cosXsinY, cosZ)), scaleX);
+		columns[0][3] = zero;
+		columns[1][0] = LANES::Mul(LANES::Sub(zero, LANES::Mul(cosY, sinZ)), scaleY);
+		columns[1][1] = LANES::Mul(LANES::Sub(LANES::Mul(cosX, cosZ), LANES::Mul(sinXsinY, sinZ)), scaleY);
+		columns[1][2] = LANES::Mul(LANES::Add(LANES::Mul(sinX, cosZ), LANES::Mul(cosXsinY, sinZ)), scaleY);
+		columns[1][3] = zero;
+		columns[2][0] = LANES::Mul(sinY, scaleZ);
+		columns[2][1] = LANES::Mul(LANES::Sub(zero, LANES::Mul(sinX, cosY)), scaleZ);
+		columns[2][2] = LANES::Mul(LANES::Mul(cosX, cosY), scaleZ);
+		columns[2][3] = zero;
+		columns[3][0] = LANES::Load(transforms.pPositionX + first);
+		columns[3][1] = LANES::Load(transforms.pPositionY + first);
+		columns[3][2] = LANES::Load(transforms.pPositionZ + first);
+		columns[3][3] = LANES::Set(1.0f);
+
+		LANES::Store(columns, pMatrices + first * MATRIX_FLOATS);
+	}
+
+	/***********************************************************
+	 *  ComposeRange()
+	 *
+	 *  This function is used for composing the matrices of the
+	 *  objects from the first one on in full registers, and it
+	 *  returns the first object that did not fill a register.
+	 ***********************************************************/
+	template <typename LANES>
+	int ComposeRange(
+		const TransformBatch::TRANSFORM_ARRAYS& transforms,
+		int first,
+		int count,
+		float* pMatrices)
+	{
+		int index = first;
+		for (; index + LANES::WIDTH <= count; index += LANES::WIDTH)
+		{
+			ComposeLanes<LANES>(transforms, index, pMatrices);
+		}
+
+		return(index);
+	}
+}
@@ -14,14 +14,22 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
 // declaration of the global variables and defines
 namespace
 {
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
+
+	// size of the framebuffer of the window, set by the resize
+	// callback on the main thread and read on the render and
+	// simulation threads
+	std::atomic<int> g_FramebufferWidth(WINDOW_WIDTH);
+	std::atomic<int> g_FramebufferHeight(WINDOW_HEIGHT);
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -39,6 +47,103 @@ namespace
 	// if orthographic projection is on, this value will be
 	// true
 	bool bOrthographicProjection = false;
+
+	// input captured by the callbacks and PollInput() on the main
+	// thread, and taken by UpdateCamera(), which runs on the
+	// simulation thread when there is one
+	ViewManager::INPUT_STATE g_InputState = {};
+	std::mutex g_InputMutex;
+
+	// GLFW keys in the same order as the INPUT_KEY values
+	const int g_InputKeys[ViewManager::INPUT_KEY_COUNT] =
+	{
+		GLFW_KEY_W,
+		GLFW_KEY_S,
+		GLFW_KEY_A,
+		GLFW_KEY_D,
+		GLFW_KEY_Q,
+		GLFW_KEY_E,
+		GLFW_KEY_1,
+		GLFW_KEY_2,
+		GLFW_KEY_3,
+		GLFW_KEY_4
+	};
+
+	// camera settings of a preset view
+	struct CAMERA_VIEW
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+		bool bOrthographic;
+	};
+
+	// the preset views selected with the keys 1 to 4, which are
+	// also the control points of the scripted camera path
+	const CAMERA_VIEW g_CameraViews[] =
+	{
+		// front view
+		{ glm::vec3(0.5f, 5.5f, 10.0f), glm::vec3(0.0f, -0.5f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f), true },
+		// side view
+		{ glm::vec3(10.0f, 4.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), false },
+		// top view
+		{ glm::vec3(0.0f, 7.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), true },
+		// perspective view
+		{ glm::vec3(0.0f, 5.5f, 8.0f), glm::vec3(0.0f, -0.5f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f), false }
+	};
+	const int g_CameraViewCount = sizeof(g_CameraViews) / sizeof(g_CameraViews[0]);
+
+	// seconds the scripted camera takes from one preset view to the next
+	const float g_CameraPathSegmentSeconds = 2.5f;
+
+	// the fixed views of the multi-view layout are the front, side
+	// and top presets, and the camera view is drawn last
+	const int g_FixedViewCount = 3;
+	// field of view of the perspective presets, in degrees
+	const float g_PresetFieldOfView = 80.0f;
+	// half of the height that the orthographic presets show
+	const float g_OrthographicHalfHeight = 6.0f;
+
+	/***********************************************************
+	 *  CatmullRom()
+	 *
+	 *  This function is used for interpolating between p1 and p2
+	 *  on a Catmull-Rom spline through the four control points.
+	 ***********************************************************/
+	glm::vec3 CatmullRom(
+		const glm::vec3& p0,
+		const glm::vec3& p1,
+		const glm::vec3& p2,
+		const glm::vec3& p3,
+		float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+
+		return(0.5f * ((2.0f * p1) +
+			(p2 - p0) * t +
+			(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+	}
+
+	/***********************************************************
+	 *  GetAspectRatio()
+	 *
+	 *  This function is used for getting the aspect ratio of the
+	 *  framebuffer of the window.  A minimized window has no
+	 *  size, and the ratio of the created window is kept then.
+	 ***********************************************************/
+	float GetAspectRatio()
+	{
+		int width = g_FramebufferWidth.load();
+		int height = g_FramebufferHeight.load();
+		if ((width <= 0) || (height <= 0))
+		{
+			return((GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT);
+		}
+
+		return((GLfloat)width / (GLfloat)height);
+	}
 }
 
 /***********************************************************
@@ -47,16 +152,23 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager,
+	ShaderUniforms *pShaderUniforms)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pShaderUniforms = pShaderUniforms;
 	m_pWindow = NULL;
+	m_bScriptedCamera = false;
+	m_cameraPathTime = 0.0f;
+	m_pMailbox = NULL;
+	m_bMultiView = false;
+	m_fixedTimeStep = 0.0f;
 	g_pCamera = new Camera();
 	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.5f, 5.5f, 10.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Position = g_CameraViews[0].position;
+	g_pCamera->Front = g_CameraViews[0].front;
+	g_pCamera->Up = g_CameraViews[0].up;
 	g_pCamera->Zoom = 80;
 }
 
@@ -69,7 +181,9 @@ ViewManager::~ViewManager()
 {
 	// free up allocated memory
 	m_pShaderManager = NULL;
+	m_pShaderUniforms = NULL;
 	m_pWindow = NULL;
+	m_pMailbox = NULL;
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -82,10 +196,14 @@ ViewManager::~ViewManager()
  *
  *  This method is used to create the main display window.
  ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle, bool bVisible)
 {
 	GLFWwindow* window = nullptr;
 
+	// a hidden window only provides the OpenGL context, for
+	// rendering into an offscreen framebuffer
+	glfwWindowHint(GLFW_VISIBLE, bVisible ? GLFW_TRUE : GLFW_FALSE);
+
 	// try to create the displayed OpenGL window
 	window = glfwCreateWindow(
 		WINDOW_WIDTH,
@@ -100,18 +218,30 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	}
 	glfwMakeContextCurrent(window);
 
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+	// the framebuffer can be larger than the window on high DPI
+	// displays, and it changes whenever the window is resized
+	int framebufferWidth = WINDOW_WIDTH;
+	int framebufferHeight = WINDOW_HEIGHT;
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	g_FramebufferWidth.store(framebufferWidth);
+	g_FramebufferHeight.store(framebufferHeight);
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+
+	if (bVisible == true)
+	{
+		// this callback is used to receive mouse moving events
+		glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
 
-	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
+		glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
 
-	// tell GLFW to capture all mouse events
-	// uncommenting the line below will lock the cursor to the window and will allow
-	// the camera to move continuously with the mouse movement
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+		// tell GLFW to capture all mouse events
+		// uncommenting the line below will lock the cursor to the window and will allow
+		// the camera to move continuously with the mouse movement
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
+	// blending for the transparent rendering - it is only enabled
+	// by the scene manager while the transparent objects are drawn
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
@@ -119,6 +249,36 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	return(window);
 }
 
+/***********************************************************
+ *  GetWindowWidth() / GetWindowHeight()
+ *
+ *  These methods are used for getting the size of the
+ *  framebuffer of the display window, which the projection
+ *  follows.  They can be called on any thread.
+ ***********************************************************/
+int ViewManager::GetWindowWidth() const
+{
+	return(g_FramebufferWidth.load());
+}
+
+int ViewManager::GetWindowHeight() const
+{
+	return(g_FramebufferHeight.load());
+}
+
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW on the main
+ *  thread whenever the framebuffer of the window is resized.
+ *  The new size is used from the next frame on.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* /*window*/, int width, int height)
+{
+	g_FramebufferWidth.store(width);
+	g_FramebufferHeight.store(height);
+}
+
 /***********************************************************
  *  Mouse_Position_Callback()
  *
@@ -145,9 +305,10 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
 	gLastX = xMousePos;
 	gLastY = yMousePos;
 
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-
+	// keep the calculated offsets for the next camera update
+	std::lock_guard<std::mutex> lock(g_InputMutex);
+	g_InputState.mouseXOffset += xOffset;
+	g_InputState.mouseYOffset += yOffset;
 }
 
 /***********************************************************
@@ -161,16 +322,19 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
 // and adjust the speed of the camera
 void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset)
 {
-	g_pCamera->ProcessMouseScroll(yOffset);
+	std::lock_guard<std::mutex> lock(g_InputMutex);
+	g_InputState.scrollOffset += (float)yOffset;
 }
 
 /***********************************************************
- *  ProcessKeyboardEvents()
+ *  PollInput()
  *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
+ *  This method is used for capturing the state of the keys
+ *  that control the camera.  GLFW only allows this on the
+ *  main thread, so the state is kept for the next camera
+ *  update, which can run on the simulation thread.
  ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
+void ViewManager::PollInput()
 {
 	// close the window if the escape key has been pressed
 	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -178,95 +342,318 @@ void ViewManager::ProcessKeyboardEvents()
 		glfwSetWindowShouldClose(m_pWindow, true);
 	}
 
+	bool keys[INPUT_KEY_COUNT];
+	for (int i = 0; i < INPUT_KEY_COUNT; i++)
+	{
+		keys[i] = (glfwGetKey(m_pWindow, g_InputKeys[i]) == GLFW_PRESS);
+	}
+
+	std::lock_guard<std::mutex> lock(g_InputMutex);
+	for (int i = 0; i < INPUT_KEY_COUNT; i++)
+	{
+		g_InputState.keys[i] = keys[i];
+	}
+}
+
+/***********************************************************
+ *  UpdateCamera()
+ *
+ *  This method is used for moving the camera by the mouse
+ *  movement, the scrolling and the keys that were captured
+ *  since the last update.  The input is taken even when the
+ *  camera follows the scripted path, so it does not pile up.
+ ***********************************************************/
+void ViewManager::UpdateCamera(float deltaTime)
+{
+	INPUT_STATE input;
+
+	{
+		std::lock_guard<std::mutex> lock(g_InputMutex);
+		input = g_InputState;
+		g_InputState.mouseXOffset = 0.0f;
+		g_InputState.mouseYOffset = 0.0f;
+		g_InputState.scrollOffset = 0.0f;
+	}
+
 	// if the camera object is null, then exit this method
-	if (NULL == g_pCamera)
+	if ((NULL == g_pCamera) || (m_bScriptedCamera == true))
 	{
 		return;
 	}
 
+	// move the 3D camera according to the mouse offsets
+	if ((input.mouseXOffset != 0.0f) || (input.mouseYOffset != 0.0f))
+	{
+		g_pCamera->ProcessMouseMovement(input.mouseXOffset, input.mouseYOffset);
+	}
+	if (input.scrollOffset != 0.0f)
+	{
+		g_pCamera->ProcessMouseScroll(input.scrollOffset);
+	}
+
+	ProcessKeyboardEvents(input, deltaTime);
+}
+
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process the captured state of
+ *  the keys that control the camera.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents(const INPUT_STATE& input, float deltaTime)
+{
 	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_W] == true)
 	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+		g_pCamera->ProcessKeyboard(FORWARD, deltaTime);
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_S] == true)
 	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+		g_pCamera->ProcessKeyboard(BACKWARD, deltaTime);
 	}
 
 	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_A] == true)
 	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+		g_pCamera->ProcessKeyboard(LEFT, deltaTime);
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_D] == true)
 	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+		g_pCamera->ProcessKeyboard(RIGHT, deltaTime);
 	}
 
 	// process camera panning up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_Q] == true)
 	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+		g_pCamera->ProcessKeyboard(UP, deltaTime);
 	}
 
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_E] == true)
 	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+		g_pCamera->ProcessKeyboard(DOWN, deltaTime);
 	}
 
 	// change between different camera views
-	if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS)
+	if (input.keys[INPUT_KEY_1] == true)
 	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
-
 		// change the camera settings to show a front orthographic view
-		g_pCamera->Position = glm::vec3(0.5f, 5.5f, 10.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		SetCameraView(0);
+	}
+	if (input.keys[INPUT_KEY_2] == true)
+	{
+		// change the camera settings to show a side view
+		SetCameraView(1);
+	}
+	if (input.keys[INPUT_KEY_3] == true)
+	{
+		// change the camera settings to show a top orthographic view
+		SetCameraView(2);
+	}
+	if (input.keys[INPUT_KEY_4] == true)
+	{
+		// change the camera settings to show a perspective view
+		SetCameraView(3);
+		g_pCamera->Zoom = 80;
+	}
 
-		//Mouse_Position_Callback(m_pWindow, gLastX, gLastY);
+}
 
-		//std::cout << gLastX << " " << gLastY << std::endl;
+/***********************************************************
+ *  SetCameraView()
+ *
+ *  This method is used for moving the camera to one of the
+ *  preset views.
+ ***********************************************************/
+void ViewManager::SetCameraView(int viewIndex)
+{
+	if ((viewIndex < 0) || (viewIndex >= g_CameraViewCount) || (NULL == g_pCamera))
+	{
+		return;
 	}
 
-	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
+	bOrthographicProjection = g_CameraViews[viewIndex].bOrthographic;
+	g_pCamera->Position = g_CameraViews[viewIndex].position;
+	g_pCamera->Front = g_CameraViews[viewIndex].front;
+	g_pCamera->Up = g_CameraViews[viewIndex].up;
+}
+
+/***********************************************************
+ *  SetCameraPathTime()
+ *
+ *  This method is used for driving the camera along the
+ *  scripted path instead of the keyboard and the mouse.  The
+ *  path is a closed Catmull-Rom spline through the preset
+ *  views, so the same time always gives the same view.
+ ***********************************************************/
+void ViewManager::SetCameraPathTime(float seconds)
+{
+	m_bScriptedCamera = true;
+	m_cameraPathTime = seconds;
+
+	if (NULL == g_pCamera)
 	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = false;
+		return;
+	}
+
+	float pathPosition = fmodf(seconds / g_CameraPathSegmentSeconds, (float)g_CameraViewCount);
+	int segment = (int)pathPosition;
+	float t = pathPosition - (float)segment;
+
+	const CAMERA_VIEW& view0 = g_CameraViews[(segment + g_CameraViewCount - 1) % g_CameraViewCount];
+	const CAMERA_VIEW& view1 = g_CameraViews[segment % g_CameraViewCount];
+	const CAMERA_VIEW& view2 = g_CameraViews[(segment + 1) % g_CameraViewCount];
+	const CAMERA_VIEW& view3 = g_CameraViews[(segment + 2) % g_CameraViewCount];
+
+	g_pCamera->Position = CatmullRom(view0.position, view1.position, view2.position, view3.position, t);
+	g_pCamera->Front = glm::normalize(CatmullRom(
+		glm::normalize(view0.front),
+		glm::normalize(view1.front),
+		glm::normalize(view2.front),
+		glm::normalize(view3.front),
+		t));
+	g_pCamera->Up = glm::normalize(CatmullRom(view0.up, view1.up, view2.up, view3.up, t));
+	g_pCamera->Zoom = 80;
+}
+
+/***********************************************************
+ *  GetCameraPathDuration()
+ *
+ *  This method is used for getting the seconds of one loop
+ *  along the scripted camera path.
+ ***********************************************************/
+float ViewManager::GetCameraPathDuration() const
+{
+	return(g_CameraPathSegmentSeconds * g_CameraViewCount);
+}
 
-		// change the camera settings to show a side orthographic view
-		g_pCamera->Position = glm::vec3(10.0f, 4.0f, 0.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(-1.0f, 0.0f, 0.0f);
+/***********************************************************
+ *  BuildFrameSnapshot()
+ *
+ *  This method is used for filling in the view matrix, the
+ *  projection matrix and the view position of a frame
+ *  snapshot from the current camera.
+ ***********************************************************/
+void ViewManager::BuildFrameSnapshot(FrameMailbox::FRAME_SNAPSHOT& snapshot) const
+{
+	// get the current view matrix from the camera
+	snapshot.view = g_pCamera->GetViewMatrix();
 
-		//Mouse_Position_Callback(m_pWindow, gLastX, gLastY);
+	// define the current projection matrix
+	snapshot.projection = glm::perspective(glm::radians(g_pCamera->Zoom), GetAspectRatio(), 0.1f, 100.0f);
 
-		//std::cout << gLastX << " " << gLastY << std::endl;
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS)
-	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
+	snapshot.viewPosition = g_pCamera->Position;
+}
 
-		// change the camera settings to show a top orthographic view
-		g_pCamera->Position = glm::vec3(0.0f, 7.0f, 0.0f);
-		g_pCamera->Up = glm::vec3(-1.0f, 0.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -1.0f, 0.0f);
+/***********************************************************
+ *  ApplyFrameSnapshot()
+ *
+ *  This method is used for uploading the camera of a frame
+ *  snapshot to the shaders.
+ ***********************************************************/
+void ViewManager::ApplyFrameSnapshot(const FrameMailbox::FRAME_SNAPSHOT& snapshot)
+{
+	// if the shader uniforms object is valid
+	if (NULL != m_pShaderUniforms)
+	{
+		// set the view matrix, the projection matrix and the view
+		// position of the camera into the shader camera block with
+		// one buffer update
+		m_pShaderUniforms->UpdateCameraBlock(
+			snapshot.view,
+			snapshot.projection,
+			snapshot.viewPosition);
+
+		if (m_bMultiView == true)
+		{
+			UploadViewBlocks(snapshot);
+		}
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_4) == GLFW_PRESS)
+}
+
+/***********************************************************
+ *  UploadViewBlocks()
+ *
+ *  This method is used for uploading the cameras of the four
+ *  views of the multi-view layout - the front, side and top
+ *  presets, with their orthographic projections, and the
+ *  camera of the frame snapshot, which can be moved.  Each
+ *  view is drawn into a quarter of the window, which has the
+ *  same aspect ratio as the whole window.
+ ***********************************************************/
+void ViewManager::UploadViewBlocks(const FrameMailbox::FRAME_SNAPSHOT& snapshot)
+{
+	ShaderUniforms::CAMERA_BLOCK views[g_FixedViewCount + 1];
+	float aspectRatio = GetAspectRatio();
+
+	for (int i = 0; i < g_FixedViewCount; i++)
 	{
-		// change to perspective projection
-		bOrthographicProjection = false;
+		const CAMERA_VIEW& preset = g_CameraViews[i];
+
+		views[i].view = glm::lookAt(preset.position, preset.position + preset.front, preset.up);
+		if (preset.bOrthographic == true)
+		{
+			views[i].projection = glm::ortho(
+				-g_OrthographicHalfHeight * aspectRatio,
+				g_OrthographicHalfHeight * aspectRatio,
+				-g_OrthographicHalfHeight,
+				g_OrthographicHalfHeight,
+				0.1f,
+				100.0f);
+		}
+		else
+		{
+			views[i].projection = glm::perspective(glm::radians(g_PresetFieldOfView), aspectRatio, 0.1f, 100.0f);
+		}
+		views[i].viewPosition = glm::vec4(preset.position, 1.0f);
+	}
 
-		// change the camera settings to show a perspective view
-		g_pCamera->Position = glm::vec3(0.0f, 5.5f, 8.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Zoom = 80;
+	views[g_FixedViewCount].view = snapshot.view;
+	views[g_FixedViewCount].projection = snapshot.projection;
+	views[g_FixedViewCount].viewPosition = glm::vec4(snapshot.viewPosition, 1.0f);
+
+	m_pShaderUniforms->UpdateViewBlocks(views, g_FixedViewCount + 1);
+}
+
+/***********************************************************
+ *  SetFixedTimeStep()
+ *
+ *  This method is used for moving the scene clock by the same
+ *  number of seconds every frame, so that a capture renders
+ *  the same frames on every run, and faster than real time
+ *  when the frames are quick to draw.
+ ***********************************************************/
+void ViewManager::SetFixedTimeStep(float seconds)
+{
+	m_fixedTimeStep = (seconds > 0.0f) ? seconds : 0.0f;
+}
+
+/***********************************************************
+ *  SetMultiView()
+ *
+ *  This method is used for drawing the front, side and top
+ *  views in three quarters of the window and the camera view
+ *  in the last one, instead of only the camera view.
+ ***********************************************************/
+void ViewManager::SetMultiView(bool bMultiView)
+{
+	m_bMultiView = bMultiView;
+	if ((m_bMultiView == false) && (NULL != m_pShaderUniforms))
+	{
+		m_pShaderUniforms->UpdateViewBlocks(NULL, 0);
 	}
+}
 
+/***********************************************************
+ *  SetFrameMailbox()
+ *
+ *  This method is used for taking the camera from the latest
+ *  snapshot of the simulation thread instead of moving it
+ *  when the view is prepared.  NULL moves the camera on the
+ *  render thread again.
+ ***********************************************************/
+void ViewManager::SetFrameMailbox(FrameMailbox* pMailbox)
+{
+	m_pMailbox = pMailbox;
 }
 
 /***********************************************************
@@ -278,32 +665,31 @@ void ViewManager::ProcessKeyboardEvents()
  ***********************************************************/
 void ViewManager::PrepareSceneView()
 {
-	glm::mat4 view;
-	glm::mat4 projection;
+	FrameMailbox::FRAME_SNAPSHOT snapshot;
 
-	// per-frame timing
+	// the simulation thread moves the camera, so only the latest
+	// snapshot is uploaded
+	if (NULL != m_pMailbox)
+	{
+		m_pMailbox->AcquireLatest();
+		ApplyFrameSnapshot(m_pMailbox->GetLatest());
+		return;
+	}
+
+	// per-frame timing - with a fixed time step every frame moves
+	// the scene by the same amount, however long it took to draw
 	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
+	gDeltaTime = (m_fixedTimeStep > 0.0f) ? m_fixedTimeStep : currentFrame - gLastFrame;
 	gLastFrame = currentFrame;
 
 	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// event queue, unless the camera follows the scripted path
+	if (m_bScriptedCamera == false)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		PollInput();
 	}
+	UpdateCamera(gDeltaTime);
+
+	BuildFrameSnapshot(snapshot);
+	ApplyFrameSnapshot(snapshot);
 }
\ No newline at end of file
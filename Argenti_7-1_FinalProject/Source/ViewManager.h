@@ -10,6 +10,8 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "ShaderUniforms.h"
+#include "FrameMailbox.h"
 #include "camera.h"
 
 // GLFW library
@@ -20,7 +22,8 @@ class ViewManager
 public:
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderManager* pShaderManager,
+		ShaderUniforms* pShaderUniforms);
 	// destructor
 	~ViewManager();
 
@@ -30,19 +33,92 @@ public:
 	// mouse scroll callback for speeding up and slowing down pan and zoom
 	static void Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset);
 
+	// framebuffer size callback for following the resized window
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
+
+	// keys that move the camera or select a preset view
+	enum INPUT_KEY
+	{
+		INPUT_KEY_W = 0,
+		INPUT_KEY_S,
+		INPUT_KEY_A,
+		INPUT_KEY_D,
+		INPUT_KEY_Q,
+		INPUT_KEY_E,
+		INPUT_KEY_1,
+		INPUT_KEY_2,
+		INPUT_KEY_3,
+		INPUT_KEY_4,
+		INPUT_KEY_COUNT
+	};
+
+	// input captured on the main thread for the next camera update
+	struct INPUT_STATE
+	{
+		bool keys[INPUT_KEY_COUNT];
+		// mouse movement and scrolling since the last camera update
+		float mouseXOffset;
+		float mouseYOffset;
+		float scrollOffset;
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// pointer to the resolved shader uniform locations
+	ShaderUniforms* m_pShaderUniforms;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// true when the camera follows the scripted path
+	bool m_bScriptedCamera;
+	float m_cameraPathTime;
+	// the snapshots of the simulation thread, NULL when the camera
+	// is updated on the render thread
+	FrameMailbox* m_pMailbox;
+	// true when the front, side and top views are drawn next to
+	// the camera view
+	bool m_bMultiView;
+	// seconds the scene clock moves per frame, 0 to follow the
+	// real time
+	float m_fixedTimeStep;
 
 	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
+	void ProcessKeyboardEvents(const INPUT_STATE& input, float deltaTime);
+	// upload the cameras of the preset views and the camera view
+	void UploadViewBlocks(const FrameMailbox::FRAME_SNAPSHOT& snapshot);
 
 public:
 	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle, bool bVisible = true);
+
+	// size of the framebuffer of the display window
+	int GetWindowWidth() const;
+	int GetWindowHeight() const;
+
+	// move the camera to one of the preset views
+	void SetCameraView(int viewIndex);
+	// move the camera along the scripted path through the preset views
+	void SetCameraPathTime(float seconds);
+	float GetCameraPathDuration() const;
 	
+	// capture the keyboard state - only called on the main thread
+	void PollInput();
+	// move the camera by the input captured since the last update
+	void UpdateCamera(float deltaTime);
+	// fill in the camera of a frame snapshot
+	void BuildFrameSnapshot(FrameMailbox::FRAME_SNAPSHOT& snapshot) const;
+	// upload the camera of a frame snapshot to the shaders
+	void ApplyFrameSnapshot(const FrameMailbox::FRAME_SNAPSHOT& snapshot);
+	// take the camera from the snapshots of the simulation thread
+	void SetFrameMailbox(FrameMailbox* pMailbox);
+	// draw the front, side and top views and the camera view in
+	// the four quarters of the window
+	void SetMultiView(bool bMultiView);
+	bool IsMultiView() const { return m_bMultiView; }
+	// move the scene clock by the same step every frame instead of
+	// the time between the frames, 0 to follow the real time again
+	void SetFixedTimeStep(float seconds);
+
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
 };
\ No newline at end of file
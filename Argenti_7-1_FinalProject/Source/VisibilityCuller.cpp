@@ -0,0 +1,363 @@
+///////////////////////////////////////////////////////////////////////////////
+// visibilityculler.cpp
+// ============
+// skip the scene objects that are outside of the view frustum
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VisibilityCuller.h"
+
+#include <algorithm>
+
+// SSE is available on every x64 target, on 32-bit MSVC builds
+// with /arch:SSE or higher, and on GCC/Clang builds with -msse
+#if defined(_M_X64) || defined(__SSE__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#define VISIBILITY_CULLER_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// declaration of global variables and defines
+namespace
+{
+	// most objects kept in one leaf of the hierarchy
+	const int g_MaxLeafObjects = 8;
+
+	// result of testing a box against the frustum
+	enum FRUSTUM_TEST
+	{
+		BOX_OUTSIDE = 0,
+		BOX_INSIDE,
+		BOX_INTERSECTING
+	};
+
+	/***********************************************************
+	 *  TestBox()
+	 *
+	 *  This function is used for testing an axis aligned box
+	 *  against the frustum planes.  For every plane, the corner
+	 *  furthest along the plane normal decides if the box is
+	 *  outside, and the opposite corner if it crosses the plane.
+	 ***********************************************************/
+	FRUSTUM_TEST TestBox(
+		const VisibilityCuller::FRUSTUM& frustum,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax)
+	{
+		FRUSTUM_TEST result = BOX_INSIDE;
+
+		for (int i = 0; i < 6; i++)
+		{
+			const glm::vec4& plane = frustum.planes[i];
+			glm::vec3 positive(
+				(plane.x >= 0.0f) ? boundsMax.x : boundsMin.x,
+				(plane.y >= 0.0f) ? boundsMax.y : boundsMin.y,
+				(plane.z >= 0.0f) ? boundsMax.z : boundsMin.z);
+			glm::vec3 negative(
+				(plane.x >= 0.0f) ? boundsMin.x : boundsMax.x,
+				(plane.y >= 0.0f) ? boundsMin.y : boundsMax.y,
+				(plane.z >= 0.0f) ? boundsMin.z : boundsMax.z);
+
+			if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+			{
+				return(BOX_OUTSIDE);
+			}
+			if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f)
+			{
+				result = BOX_INTERSECTING;
+			}
+		}
+
+		return(result);
+	}
+}
+
+/***********************************************************
+ *  VisibilityCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VisibilityCuller::VisibilityCuller()
+{
+	m_visibleCount = 0;
+}
+
+/***********************************************************
+ *  ~VisibilityCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VisibilityCuller::~VisibilityCuller()
+{
+	m_nodes.clear();
+	m_objectNodes.clear();
+}
+
+/***********************************************************
+ *  ExtractFrustum()
+ *
+ *  This method is used for extracting the six frustum planes
+ *  from the rows of a combined projection * view matrix.  The
+ *  planes are normalized, so the plane distance of a point is
+ *  in world units and can be compared with a sphere radius.
+ ***********************************************************/
+VisibilityCuller::FRUSTUM VisibilityCuller::ExtractFrustum(const glm::mat4& viewProjection)
+{
+	FRUSTUM frustum;
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	frustum.planes[0] = row3 + row0;	// left
+	frustum.planes[1] = row3 - row0;	// right
+	frustum.planes[2] = row3 + row1;	// bottom
+	frustum.planes[3] = row3 - row1;	// top
+	frustum.planes[4] = row3 + row2;	// near
+	frustum.planes[5] = row3 - row2;	// far
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(frustum.planes[i]));
+		if (length > 0.0f)
+		{
+			frustum.planes[i] = frustum.planes[i] * (1.0f / length);
+		}
+	}
+
+	return(frustum);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the hierarchy over the
+ *  bounding spheres of the scene objects.  The objects are
+ *  reordered so that every node covers one contiguous range.
+ ***********************************************************/
+void VisibilityCuller::Build(
+	const std::vector<BOUNDING_SPHERE>& spheres,
+	const std::vector<int>& nodeIndices)
+{
+	int objectCount = (int)spheres.size();
+	std::vector<int> order(objectCount);
+
+	for (int i = 0; i < objectCount; i++)
+	{
+		order[i] = i;
+	}
+
+	m_nodes.clear();
+	m_nodes.reserve(2 * (objectCount / g_MaxLeafObjects + 1));
+	if (objectCount > 0)
+	{
+		BuildNode(order, spheres, 0, objectCount);
+	}
+
+	m_centerX.resize(objectCount);
+	m_centerY.resize(objectCount);
+	m_centerZ.resize(objectCount);
+	m_radius.resize(objectCount);
+	m_objectNodes.resize(objectCount);
+	for (int i = 0; i < objectCount; i++)
+	{
+		const BOUNDING_SPHERE& sphere = spheres[order[i]];
+		m_centerX[i] = sphere.center.x;
+		m_centerY[i] = sphere.center.y;
+		m_centerZ[i] = sphere.center.z;
+		m_radius[i] = sphere.radius;
+		m_objectNodes[i] = nodeIndices[order[i]];
+	}
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for adding the node that bounds a range
+ *  of the objects.  A range with too many objects is split at
+ *  the median of the sphere centers along the longest axis of
+ *  their bounds.
+ ***********************************************************/
+int VisibilityCuller::BuildNode(
+	std::vector<int>& order,
+	const std::vector<BOUNDING_SPHERE>& spheres,
+	int firstObject,
+	int objectCount)
+{
+	BVH_NODE node;
+	glm::vec3 centerMin(spheres[order[firstObject]].center);
+	glm::vec3 centerMax(centerMin);
+
+	node.boundsMin = centerMin - spheres[order[firstObject]].radius;
+	node.boundsMax = centerMax + spheres[order[firstObject]].radius;
+	for (int i = firstObject + 1; i < firstObject + objectCount; i++)
+	{
+		const BOUNDING_SPHERE& sphere = spheres[order[i]];
+		node.boundsMin = glm::min(node.boundsMin, sphere.center - sphere.radius);
+		node.boundsMax = glm::max(node.boundsMax, sphere.center + sphere.radius);
+		centerMin = glm::min(centerMin, sphere.center);
+		centerMax = glm::max(centerMax, sphere.center);
+	}
+	node.firstObject = firstObject;
+	node.objectCount = objectCount;
+	node.leftChild = -1;
+	node.rightChild = -1;
+
+	int nodeIndex = (int)m_nodes.size();
+	m_nodes.push_back(node);
+
+	if (objectCount <= g_MaxLeafObjects)
+	{
+		return(nodeIndex);
+	}
+
+	// split along the longest axis of the sphere centers
+	glm::vec3 extent = centerMax - centerMin;
+	int axis = 0;
+	if ((extent.y > extent.x) && (extent.y >= extent.z))
+	{
+		axis = 1;
+	}
+	else if ((extent.z > extent.x) && (extent.z > extent.y))
+	{
+		axis = 2;
+	}
+
+	int leftCount = objectCount / 2;
+	std::nth_element(
+		order.begin() + firstObject,
+		order.begin() + firstObject + leftCount,
+		order.begin() + firstObject + objectCount,
+		[&spheres, axis](int a, int b) { return spheres[a].center[axis] < spheres[b].center[axis]; });
+
+	int leftChild = BuildNode(order, spheres, firstObject, leftCount);
+	int rightChild = BuildNode(order, spheres, firstObject + leftCount, objectCount - leftCount);
+	m_nodes[nodeIndex].leftChild = leftChild;
+	m_nodes[nodeIndex].rightChild = rightChild;
+
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for finding the objects inside of the
+ *  view frustum.  The hierarchy is walked from the root with
+ *  a small stack instead of recursion.
+ ***********************************************************/
+void VisibilityCuller::Cull(const FRUSTUM& frustum, std::vector<unsigned char>& visible)
+{
+	m_visibleCount = 0;
+	for (int i = 0; i < (int)m_objectNodes.size(); i++)
+	{
+		visible[m_objectNodes[i]] = 0;
+	}
+	if (m_nodes.empty() == true)
+	{
+		return;
+	}
+
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		FRUSTUM_TEST result = TestBox(frustum, node.boundsMin, node.boundsMax);
+
+		if (result == BOX_OUTSIDE)
+		{
+			continue;
+		}
+		if (result == BOX_INSIDE)
+		{
+			AcceptObjects(node.firstObject, node.objectCount, visible);
+		}
+		else if ((node.leftChild < 0) || (stackSize + 2 > 64))
+		{
+			TestObjects(frustum, node.firstObject, node.objectCount, visible);
+		}
+		else
+		{
+			stack[stackSize++] = node.rightChild;
+			stack[stackSize++] = node.leftChild;
+		}
+	}
+}
+
+/***********************************************************
+ *  AcceptObjects()
+ *
+ *  This method is used for marking a range of the objects as
+ *  visible without testing them.
+ ***********************************************************/
+void VisibilityCuller::AcceptObjects(
+	int firstObject,
+	int objectCount,
+	std::vector<unsigned char>& visible)
+{
+	for (int i = firstObject; i < firstObject + objectCount; i++)
+	{
+		visible[m_objectNodes[i]] = 1;
+	}
+	m_visibleCount += objectCount;
+}
+
+/***********************************************************
+ *  TestObjects()
+ *
+ *  This method is used for testing the spheres of a range of
+ *  the objects against the frustum planes.  With SSE the
+ *  spheres are tested four at a time, and the rest of the
+ *  range one by one.
+ ***********************************************************/
+void VisibilityCuller::TestObjects(
+	const FRUSTUM& frustum,
+	int firstObject,
+	int objectCount,
+	std::vector<unsigned char>& visible)
+{
+	int i = firstObject;
+	int lastObject = firstObject + objectCount;
+
+#ifdef VISIBILITY_CULLER_SSE
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= lastObject; i += 4)
+	{
+		__m128 centerX = _mm_loadu_ps(&m_centerX[i]);
+		__m128 centerY = _mm_loadu_ps(&m_centerY[i]);
+		__m128 centerZ = _mm_loadu_ps(&m_centerZ[i]);
+		__m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(&m_radius[i]));
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			const glm::vec4& p = frustum.planes[plane];
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), centerX), _mm_mul_ps(_mm_set1_ps(p.y), centerY)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), centerZ), _mm_set1_ps(p.w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			unsigned char bVisible = (unsigned char)((mask >> lane) & 1);
+			visible[m_objectNodes[i + lane]] = bVisible;
+			m_visibleCount += bVisible;
+		}
+	}
+#endif
+
+	for (; i < lastObject; i++)
+	{
+		bool bInside = true;
+		for (int plane = 0; (plane < 6) && (bInside == true); plane++)
+		{
+			const glm::vec4& p = frustum.planes[plane];
+			float distance = p.x * m_centerX[i] + p.y * m_centerY[i] + p.z * m_centerZ[i] + p.w;
+			bInside = (distance >= -m_radius[i]);
+		}
+		visible[m_objectNodes[i]] = bInside ? 1 : 0;
+		m_visibleCount += bInside ? 1 : 0;
+	}
+}
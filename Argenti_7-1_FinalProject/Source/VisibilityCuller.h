@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// visibilityculler.h
+// ============
+// skip the scene objects that are outside of the view frustum
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  VisibilityCuller
+ *
+ *  This class keeps a bounding sphere for every drawn scene
+ *  node in a bounding volume hierarchy.  Every frame, the
+ *  hierarchy is tested against the planes of the view
+ *  frustum: boxes outside of the frustum are skipped with
+ *  all their objects, boxes inside of it accept all their
+ *  objects, and only the objects of the boxes that cross a
+ *  plane are tested one by one, four at a time with SSE.
+ ***********************************************************/
+class VisibilityCuller
+{
+public:
+	// constructor
+	VisibilityCuller();
+	// destructor
+	~VisibilityCuller();
+
+	// world space bounding sphere of a scene object
+	struct BOUNDING_SPHERE
+	{
+		glm::vec3 center;
+		float radius;
+	};
+
+	// the six planes of a view frustum, the inside of a plane
+	// is where dot(plane.xyz, point) + plane.w >= 0
+	struct FRUSTUM
+	{
+		glm::vec4 planes[6];
+	};
+
+	// extract the frustum planes from a projection * view matrix
+	static FRUSTUM ExtractFrustum(const glm::mat4& viewProjection);
+
+private:
+	struct BVH_NODE
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// range of the objects below this node
+		int firstObject;
+		int objectCount;
+		// child nodes, -1 for a leaf
+		int leftChild;
+		int rightChild;
+	};
+
+	// the hierarchy, the root is the first node
+	std::vector<BVH_NODE> m_nodes;
+	// object spheres in hierarchy order, split into components
+	// so that four spheres can be loaded at once
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_radius;
+	// scene node of every object in hierarchy order
+	std::vector<int> m_objectNodes;
+	// objects accepted by the last Cull()
+	int m_visibleCount;
+
+	// build the node for a range of the objects
+	int BuildNode(
+		std::vector<int>& order,
+		const std::vector<BOUNDING_SPHERE>& spheres,
+		int firstObject,
+		int objectCount);
+	// test a range of the objects one by one
+	void TestObjects(
+		const FRUSTUM& frustum,
+		int firstObject,
+		int objectCount,
+		std::vector<unsigned char>& visible);
+	// accept a range of the objects without testing
+	void AcceptObjects(
+		int firstObject,
+		int objectCount,
+		std::vector<unsigned char>& visible);
+
+public:
+	// build the hierarchy over the bounding spheres of the scene
+	// nodes - nodeIndices[i] is the scene node of spheres[i]
+	void Build(
+		const std::vector<BOUNDING_SPHERE>& spheres,
+		const std::vector<int>& nodeIndices);
+
+	// set visible[node] to 1 for every object in the frustum and
+	// to 0 for every other object - visible must be sized to the
+	// number of scene nodes
+	void Cull(const FRUSTUM& frustum, std::vector<unsigned char>& visible);
+
+	// number of objects in the hierarchy
+	int GetObjectCount() const { return (int)m_objectNodes.size(); }
+	// number of objects accepted by the last Cull()
+	int GetVisibleCount() const { return m_visibleCount; }
+};